@@ -41,8 +41,12 @@ struct RecyclerContext {
   u32 currentCell;
   u32 containerToCellsRatio;
   f32 cellsSize; 
+  f32 containerSize;
   Clay_ElementId containerId;
   Clay_ElementId previousId;
+  // The container's subtree from the previous layout, cells are read from it instead of being looked up one by one
+  Clay_GeometryArray geometry;
+  i32 nextChildIndex;
   bool isVertical;
 };
 
@@ -56,21 +60,9 @@ struct RecyclerItem {
 RecyclerContext BeginRecycler(Clay_String label, bool isVertical, u32 count);
 RecyclerItem recyclerGetNext(RecyclerContext *ctx);
 
-typedef struct TapState TapState;
-struct TapState {
-  Clay_Vector2 point;
-  i32 isPressed;
-};
-
-static TapState tapState;
-
-
-typedef struct IOSAppContext IOSAppContext;
-struct IOSAppContext {
-  u8 buttonSize;
-};
+// Pushed to by the platform's input callbacks, see clay_input.h
+static Clay_InputQueue inputQueue;
 
-IOSAppContext appContext = {.buttonSize = 255};
 
 typedef struct MobileStyle MobileStyle;
 struct MobileStyle {
@@ -82,26 +74,12 @@ struct MobileStyle {
 #define min(a, b) ((a) < (b) ? (a) : (b))
 #define max(x, y) ((x) > (y) ? (x) : (y))
 
-void HandleRendererButtonInteraction(Clay_ElementId elementId, Clay_PointerData pointerInfo, intptr_t userData) {
-  unused(elementId);
-  unused(userData);
-  if (pointerInfo.state == CLAY_POINTER_DATA_PRESSED_THIS_FRAME || pointerInfo.state == CLAY_POINTER_DATA_PRESSED) {
-    appContext.buttonSize = max(200, appContext.buttonSize - 10);
-  }
-}
-
 #define STRING_SLICE(string, size) (CLAY__INIT(Clay_String) { .isStaticallyAllocated = true, .length = size, .chars = (string) })
 
 Clay_RenderCommandArray 
 IOS_layout(void)
 {
-  Clay_SetPointerState(tapState.point, tapState.isPressed > 2);
-  if (tapState.isPressed > 0 && tapState.isPressed <= 2) {
-    tapState.isPressed--;
-  } else if (tapState.isPressed == 0) {
-    tapState.point.x = 0.0f;
-    tapState.point.y = 0.0f;
-  }
+  Clay_Input_Update(&inputQueue);
    
   Clay_BeginLayout();
   Clay_Sizing layoutExpand = {
@@ -122,10 +100,14 @@ IOS_layout(void)
       }, 
       .backgroundColor = gray6 
   }) {
-    Clay_Color buttonColor = {97,85,245,appContext.buttonSize};
+    // the pressed state is a declared target, clay animates towards it on its own
+    Clay_ElementId buttonId = CLAY_ID("ButtonContainer");
+    Clay_PointerDataInteractionState pointerState = Clay_GetCurrentContext()->pointerInfo.state;
+    bool buttonPressed = Clay_PointerOver(buttonId) && (pointerState == CLAY_POINTER_DATA_PRESSED_THIS_FRAME || pointerState == CLAY_POINTER_DATA_PRESSED);
+    Clay_Color buttonColor = buttonPressed ? (Clay_Color){97,85,245,200} : (Clay_Color){97,85,245,255};
 
     CLAY({
-      .id = CLAY_ID("ButtonContainer"), 
+      .id = buttonId, 
       .layout = { 
         .sizing = {CLAY_SIZING_FIT(64, 100), CLAY_SIZING_FIT(64, 100)}, 
         .padding = CLAY_PADDING_ALL(16), 
@@ -133,12 +115,12 @@ IOS_layout(void)
       }, 
       .cornerRadius = CLAY_CORNER_RADIUS(8),
       .backgroundColor = buttonColor,
+      .transition = {
+        .duration = 0.2f,
+        .easing = CLAY_EASING_EASE_OUT,
+        .properties = CLAY_TRANSITION_PROPERTY_BACKGROUND_COLOR
+      },
     }) {
-      if (!Clay_Hovered()) {
-        appContext.buttonSize = min(255, appContext.buttonSize + 10);
-      }
-
-      Clay_OnHover(HandleRendererButtonInteraction, 0);
       CLAY_TEXT(CLAY_STRING("SOME TEXT"), CLAY_TEXT_CONFIG({
           .fontId = 0,
           .fontSize = 24,
@@ -187,6 +169,11 @@ BeginRecycler(Clay_String label, bool isVertical, u32 count)
   result.index = 0;
   result.containerToCellsRatio = 2;
   result.containerId = CLAY_SID(label);
+  result.geometry = Clay_GetSubtreeGeometry(result.containerId);
+  result.nextChildIndex = 1;
+  if (result.geometry.length > 0) {
+    result.containerSize = isVertical ? result.geometry.height[0] : result.geometry.width[0];
+  }
 
   return result;
 }
@@ -199,9 +186,9 @@ recyclerGetNext(RecyclerContext *ctx)
 
   result.id = CLAY_SIDI(ctx->containerId.stringId, ctx->currentCell + 1);
 
-  Clay_ElementData containerData = Clay_GetElementData(ctx->containerId);
-  assert(containerData.found);
-  f32 containerSize = ctx->isVertical ? containerData.boundingBox.height : containerData.boundingBox.width;
+  Clay_GeometryArray *geometry = &ctx->geometry;
+  assert(geometry->length > 0);
+  f32 containerSize = ctx->containerSize;
 
   if (ctx->index >= ctx->count || containerSize < 0.01) {
     return result;
@@ -213,9 +200,19 @@ recyclerGetNext(RecyclerContext *ctx)
     result.valid = true;
     ctx->currentCell = ctx->index % ctx->cells; 
   } else {
-    Clay_ElementData elementData = Clay_GetElementData(ctx->previousId);
-    assert(elementData.found || ctx->currentCell == 0);
-    Clay_BoundingBox bbox = elementData.boundingBox;
+    // Cells are the container's children in order, so the previous cell is usually the next child in the subtree
+    Clay_BoundingBox bbox = {0};
+    i32 cellIndex = ctx->nextChildIndex;
+    if (cellIndex >= geometry->length || geometry->ids[cellIndex] != ctx->previousId.id) {
+      Clay_GetGeometryIndexes(&ctx->previousId, 1, &cellIndex);
+      cellIndex -= geometry->offset;
+    }
+    if (cellIndex > 0 && cellIndex < geometry->length) {
+      bbox = (Clay_BoundingBox) { geometry->x[cellIndex], geometry->y[cellIndex], geometry->width[cellIndex], geometry->height[cellIndex] };
+      ctx->nextChildIndex = geometry->subtreeEnds[cellIndex] - geometry->offset;
+    } else {
+      assert(ctx->currentCell == 0);
+    }
     
     ctx->cells++;
     ctx->currentCell++;
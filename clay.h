@@ -72,6 +72,14 @@
 
 #define CLAY_SIZING_PERCENT(percentOfParent) (CLAY__INIT(Clay_SizingAxis) { .size = { .percent = (percentOfParent) }, .type = CLAY__SIZING_TYPE_PERCENT })
 
+#define CLAY_GRID_TRACK_FIT(...) (CLAY__INIT(Clay_GridTrack) { .size = { .minMax = { __VA_ARGS__ } }, .type = CLAY__GRID_TRACK_TYPE_FIT })
+
+#define CLAY_GRID_TRACK_GROW(...) (CLAY__INIT(Clay_GridTrack) { .size = { .minMax = { __VA_ARGS__ } }, .type = CLAY__GRID_TRACK_TYPE_GROW })
+
+#define CLAY_GRID_TRACK_FIXED(fixedSize) (CLAY__INIT(Clay_GridTrack) { .size = { .minMax = { fixedSize, fixedSize } }, .type = CLAY__GRID_TRACK_TYPE_FIXED })
+
+#define CLAY_GRID_TRACK_FRACTION(fractionOfRemainingSpace) (CLAY__INIT(Clay_GridTrack) { .size = { .fraction = (fractionOfRemainingSpace) }, .type = CLAY__GRID_TRACK_TYPE_FRACTION })
+
 // Note: If a compile error led you here, you might be trying to use CLAY_ID with something other than a string literal. To construct an ID with a dynamic string, use CLAY_SID instead.
 #define CLAY_ID(label) CLAY_IDI(label, 0)
 
@@ -151,6 +159,28 @@ static inline void Clay__SuppressUnusedLatchDefinitionVariableWarning(void) { (v
 
 #define CLAY_TEXT(text, textConfig) Clay__OpenTextElement(text, textConfig)
 
+// Declares text whose contents are identified by the caller, for example a message id and its edit count.
+// While the same contentId and contentVersion were declared in the previous frame, the contents aren't read or hashed, and Clay keeps rendering its stored copy.
+#define CLAY_TEXT_WITH_VERSION(text, contentId, contentVersion, textConfig) Clay__OpenTextElementWithVersion(text, contentId, contentVersion, textConfig)
+
+/* CLAY_MEMO skips re-running the declarations inside it when nothing they depend on has changed:
+
+  CLAY_MEMO(CLAY_ID("Sidebar"), Hash(sidebarState)) {
+    ...elements declared here
+  }
+
+  The first time a key is seen, or when dependencyHash differs from the previous frame, the body runs as normal and Clay records
+  the element, config and text declarations it makes. Otherwise the body is skipped, and the recorded declarations are replayed directly.
+  dependencyHash must cover everything the body reads, including Clay_Hovered() and Clay_PointerOver(). Clay_GetScrollOffset() is re-queried automatically.
+  The recording space is limited by Clay_SetMaxMemoBytes(), and blocks that don't fit simply run every frame.
+*/
+#define CLAY_MEMO(key, dependencyHash)                                                                                                                      \
+    for (                                                                                                                                                   \
+        CLAY__ELEMENT_DEFINITION_LATCH = Clay__BeginMemo(key, dependencyHash) ? 0 : 1;                                                                      \
+        CLAY__ELEMENT_DEFINITION_LATCH < 1;                                                                                                                 \
+        CLAY__ELEMENT_DEFINITION_LATCH=1, Clay__EndMemo()                                                                                                   \
+    )
+
 #ifdef __cplusplus
 
 #define CLAY__INIT(type) type
@@ -264,6 +294,8 @@ typedef CLAY_PACKED_ENUM {
     CLAY_LEFT_TO_RIGHT,
     // Lays out child elements from top to bottom with increasing y.
     CLAY_TOP_TO_BOTTOM,
+    // Lays out child elements in the cells of a grid configured with .grid, filling each row from left to right.
+    CLAY_GRID,
 } Clay_LayoutDirection;
 
 // Controls the alignment along the x axis (horizontal) of child elements.
@@ -326,6 +358,41 @@ typedef struct Clay_Sizing {
     Clay_SizingAxis height;  // Controls the height sizing of the element, along the y axis.
 } Clay_Sizing;
 
+// Controls how a column or row of a CLAY_GRID container is sized.
+typedef CLAY_PACKED_ENUM {
+    // (default) Wraps tightly to the largest child element in the track.
+    CLAY__GRID_TRACK_TYPE_FIT,
+    // Expands to fill the space left over by the other tracks, sharing it equally with other GROW tracks.
+    CLAY__GRID_TRACK_TYPE_GROW,
+    // Shares the space left over by the other tracks in proportion to its fraction, in the same way as CSS "fr" units.
+    CLAY__GRID_TRACK_TYPE_FRACTION,
+    // Clamps the track size to an exact size in pixels.
+    CLAY__GRID_TRACK_TYPE_FIXED,
+} Clay__GridTrackType;
+
+// Controls the size of a single column or row of a CLAY_GRID container.
+typedef struct Clay_GridTrack {
+    union {
+        Clay_SizingMinMax minMax; // Controls the minimum and maximum size in pixels of FIT, GROW and FIXED tracks.
+        float fraction; // The relative share of left over space taken by a FRACTION track.
+    } size;
+    Clay__GridTrackType type; // Controls how the track is sized.
+} Clay_GridTrack;
+
+// Controls the columns and rows of an element with .layoutDirection = CLAY_GRID.
+// Children are placed into cells from left to right, starting a new row after every columnCount children.
+// Track sizes are solved once for the whole grid, so every cell in a column shares the same width and every cell in a row the same height.
+typedef struct Clay_GridLayout {
+    // Sizing for each column, columnCount entries long. When NULL, every column is sized with CLAY_GRID_TRACK_GROW().
+    // Must remain valid until Clay_EndLayout() is called.
+    const Clay_GridTrack *columns;
+    // Sizing for the first rowCount rows. Any further rows repeat the last entry. When NULL, every row is sized with CLAY_GRID_TRACK_FIT().
+    // Must remain valid until Clay_EndLayout() is called.
+    const Clay_GridTrack *rows;
+    uint16_t columnCount; // The number of columns. Treated as 1 if 0.
+    uint16_t rowCount; // The number of entries in .rows.
+} Clay_GridLayout;
+
 // Controls "padding" in pixels, which is a gap between the bounding box of this element and where its children
 // will be placed.
 typedef struct Clay_Padding {
@@ -342,9 +409,10 @@ CLAY__WRAPPER_STRUCT(Clay_Padding);
 typedef struct Clay_LayoutConfig {
     Clay_Sizing sizing; // Controls the sizing of this element inside it's parent container, including FIT, GROW, PERCENT and FIXED sizing.
     Clay_Padding padding; // Controls "padding" in pixels, which is a gap between the bounding box of this element and where its children will be placed.
-    uint16_t childGap; // Controls the gap in pixels between child elements along the layout axis (horizontal gap for LEFT_TO_RIGHT, vertical gap for TOP_TO_BOTTOM).
-    Clay_ChildAlignment childAlignment; // Controls how child elements are aligned on each axis.
+    uint16_t childGap; // Controls the gap in pixels between child elements along the layout axis (horizontal gap for LEFT_TO_RIGHT, vertical gap for TOP_TO_BOTTOM, and both between columns and between rows for GRID).
+    Clay_ChildAlignment childAlignment; // Controls how child elements are aligned on each axis. For GRID, aligns the grid within this element and each child within its cell.
     Clay_LayoutDirection layoutDirection; // Controls the direction in which child elements will be automatically laid out.
+    Clay_GridLayout grid; // Controls the columns and rows that child elements are placed into when .layoutDirection is CLAY_GRID.
 } Clay_LayoutConfig;
 
 CLAY__WRAPPER_STRUCT(Clay_LayoutConfig);
@@ -414,6 +482,8 @@ CLAY__WRAPPER_STRUCT(Clay_AspectRatioElementConfig);
 // Controls various settings related to image elements.
 typedef struct Clay_ImageElementConfig {
     void* imageData; // A transparent pointer used to pass image data through to the renderer.
+    // Change this whenever the pixels behind imageData change, so that Clay_GetDamageRects() repaints the image even though imageData didn't move.
+    uint32_t imageVersion;
 } Clay_ImageElementConfig;
 
 CLAY__WRAPPER_STRUCT(Clay_ImageElementConfig);
@@ -550,6 +620,49 @@ typedef struct Clay_BorderElementConfig {
 
 CLAY__WRAPPER_STRUCT(Clay_BorderElementConfig);
 
+// Transition -----------------------------
+
+// Controls which properties of an element are animated by its transition config.
+// Values are bit flags and can be combined, e.g. CLAY_TRANSITION_PROPERTY_BACKGROUND_COLOR | CLAY_TRANSITION_PROPERTY_OPACITY
+typedef CLAY_PACKED_ENUM {
+    // (default) No properties are animated.
+    CLAY_TRANSITION_PROPERTY_NONE = 0,
+    // Animates the element's .backgroundColor.
+    CLAY_TRANSITION_PROPERTY_BACKGROUND_COLOR = 1,
+    // Animates towards .transition.opacity, which is multiplied into the alpha of the element's own rectangle, border, image and custom render commands.
+    CLAY_TRANSITION_PROPERTY_OPACITY = 2,
+    // Animates towards .transition.offset, which visually translates the element and its children without affecting the layout of siblings or parents.
+    CLAY_TRANSITION_PROPERTY_OFFSET = 4,
+    // Animates the element's bounding box from its previous laid out size to its new one. Only affects the element's own render commands, not its children.
+    CLAY_TRANSITION_PROPERTY_SIZE = 8,
+} Clay_TransitionProperty;
+
+// Controls the easing curve used to interpolate between the start and target values of a transition.
+typedef CLAY_PACKED_ENUM {
+    // (default) Values change at a constant rate.
+    CLAY_EASING_LINEAR,
+    // Starts slowly and accelerates towards the target.
+    CLAY_EASING_EASE_IN,
+    // Starts quickly and decelerates towards the target.
+    CLAY_EASING_EASE_OUT,
+    // Accelerates through the first half and decelerates through the second half.
+    CLAY_EASING_EASE_IN_OUT,
+} Clay_TransitionEasing;
+
+// Controls settings related to animated transitions.
+// Clay retains interpolation state across frames for every element with a transition, keyed by the element's id.
+// When a target value changes, the element animates from its current value to the new target over .duration seconds.
+// Transitions are advanced with Clay_UpdateTransitions(), and never change the size or position of any other element.
+typedef struct Clay_TransitionElementConfig {
+    float duration; // The duration of the transition in seconds. Transitions are disabled if this is zero.
+    Clay_TransitionEasing easing; // Controls the easing curve of the transition.
+    uint8_t properties; // A bitwise combination of Clay_TransitionProperty values that should be animated.
+    float opacity; // The target opacity, from 0 (fully transparent) to 1 (fully opaque). Only used with CLAY_TRANSITION_PROPERTY_OPACITY.
+    Clay_Vector2 offset; // The target visual offset in pixels. Only used with CLAY_TRANSITION_PROPERTY_OFFSET.
+} Clay_TransitionElementConfig;
+
+CLAY__WRAPPER_STRUCT(Clay_TransitionElementConfig);
+
 // Render Command Data -----------------------------
 
 // Render command data when commandType == CLAY_RENDER_COMMAND_TYPE_TEXT
@@ -566,6 +679,13 @@ typedef struct Clay_TextRenderData {
     uint16_t letterSpacing;
     // The height of the bounding box for this line of text.
     uint16_t lineHeight;
+    // Identifies Clay's stored copy of the element's full text, which stringContents.baseChars points to. It stays the same across frames
+    // while the text is declared every frame, and is less than or equal to Clay_GetMaxElementCount(), so it can index a renderer side cache.
+    // Zero if the text couldn't be stored.
+    uint32_t stringHandle;
+    // Unique to the contents behind stringHandle, and never reused. If stringVersion and this line's offset and length from baseChars
+    // are the same as last frame, the line's text is unchanged. Zero if the text couldn't be stored.
+    uint32_t stringVersion;
 } Clay_TextRenderData;
 
 // Render command data when commandType == CLAY_RENDER_COMMAND_TYPE_RECTANGLE
@@ -588,6 +708,8 @@ typedef struct Clay_ImageRenderData {
     Clay_CornerRadius cornerRadius;
     // A pointer transparently passed through from the original element definition, typically used to represent image data.
     void* imageData;
+    // Transparently passed through from the original element definition.
+    uint32_t imageVersion;
 } Clay_ImageRenderData;
 
 // Render command data when commandType == CLAY_RENDER_COMMAND_TYPE_CUSTOM
@@ -661,6 +783,23 @@ typedef struct Clay_ElementData {
     bool found;
 } Clay_ElementData;
 
+// The final geometry of laid out elements, as arrays with one entry per element. Elements are in depth first order, so
+// the descendants of the element at index i are at the indexes from i + 1 up to, but not including, subtreeEnds[i].
+typedef struct Clay_GeometryArray {
+    int32_t length;
+    // The index of the first element of these arrays in the arrays returned by Clay_GetGeometry().
+    // .parents and .subtreeEnds hold indexes into the arrays returned by Clay_GetGeometry(), subtract offset to index these arrays.
+    int32_t offset;
+    const uint32_t *ids;
+    const float *x;
+    const float *y;
+    const float *width;
+    const float *height;
+    // -1 for root elements, including floating elements
+    const int32_t *parents;
+    const int32_t *subtreeEnds;
+} Clay_GeometryArray;
+
 // Used by renderers to determine specific handling for each render command.
 typedef CLAY_PACKED_ENUM {
     // This command type should be skipped.
@@ -715,6 +854,29 @@ typedef struct Clay_RenderCommandArray {
     Clay_RenderCommand* internalArray;
 } Clay_RenderCommandArray;
 
+// Describes which render commands changed during the most recent call to Clay_EndLayout().
+// When only paint properties (colors, corner radius, border widths, userData, image / custom data) changed since the previous layout,
+// Clay skips the sizing and positioning passes entirely and patches the previous render commands in place.
+typedef struct Clay_RenderCommandUpdates {
+    // True if the layout was fully recalculated, in which case every render command should be considered changed and .indexes is empty.
+    bool layoutChanged;
+    // The number of render commands that were updated in place.
+    int32_t length;
+    // The indexes into the render command array of the commands that were updated in place, in ascending order.
+    int32_t *indexes;
+} Clay_RenderCommandUpdates;
+
+// A sized array of screen regions that changed during the most recent call to Clay_EndLayout().
+// Damage rects are in whole pixels, don't overlap significantly, and cover every pixel that could differ from the previous frame.
+typedef struct Clay_DamageRectArray {
+    // The underlying max capacity of the array, not necessarily all initialized.
+    int32_t capacity;
+    // The number of initialized elements in this array. Used for loops and iteration.
+    int32_t length;
+    // A pointer to the first element in the internal array.
+    Clay_BoundingBox* internalArray;
+} Clay_DamageRectArray;
+
 // Represents the current state of interaction with clay this frame.
 typedef CLAY_PACKED_ENUM {
     // A left mouse click, or touch occurred this frame.
@@ -764,6 +926,9 @@ typedef struct Clay_ElementDeclaration {
     Clay_ClipElementConfig clip;
     // Controls settings related to element borders, and will generate BORDER render commands.
     Clay_BorderElementConfig border;
+    // Controls animated transitions of the element's background color, opacity, offset and size.
+    // Note: in order to activate transitions, .transition.duration and .transition.properties must both be set.
+    Clay_TransitionElementConfig transition;
     // A pointer that will be transparently passed through to resulting render commands.
     void *userData;
 } Clay_ElementDeclaration;
@@ -845,7 +1010,20 @@ CLAY_DLL_EXPORT void Clay_SetCurrentContext(Clay_Context* context);
 // - enableDragScrolling when set to true will enable mobile device like "touch drag" scroll of scroll containers, including momentum scrolling after the touch has ended.
 // - scrollDelta is the amount to scroll this frame on each axis in pixels.
 // - deltaTime is the time in seconds since the last "frame" (scroll update)
+// Momentum is a function of time rather than of the number of calls, so this can be called at any rate, and frames can be skipped.
 CLAY_DLL_EXPORT void Clay_UpdateScrollContainers(bool enableDragScrolling, Clay_Vector2 scrollDelta, float deltaTime);
+// Returns the scroll position the scroll container with this id will have timeAhead seconds after the most recent call to Clay_UpdateScrollContainers(),
+// assuming no further input. Useful for laying out the region that will be visible at the next display refresh ahead of time.
+CLAY_DLL_EXPORT Clay_Vector2 Clay_PredictScrollPosition(Clay_ElementId id, float timeAhead);
+// Returns true if any scroll container is still moving from momentum or springing back from overscroll.
+// While this returns false and there is no input, Clay_UpdateScrollContainers() doesn't need to be called.
+CLAY_DLL_EXPORT bool Clay_ScrollAnimationsActive(void);
+// Advances all element transitions declared with .transition, interpolating their current values towards their targets.
+// Intended to be called once per frame before Clay_BeginLayout().
+// - deltaTime is the time in seconds since the last call.
+CLAY_DLL_EXPORT void Clay_UpdateTransitions(float deltaTime);
+// Returns true if any element transition has not yet reached its target, i.e. another frame is required to finish animating.
+CLAY_DLL_EXPORT bool Clay_TransitionsActive(void);
 // Returns the internally stored scroll offset for the currently open element.
 // Generally intended for use with clip elements to create scrolling containers.
 CLAY_DLL_EXPORT Clay_Vector2 Clay_GetScrollOffset(void);
@@ -856,6 +1034,15 @@ CLAY_DLL_EXPORT void Clay_BeginLayout(void);
 // Called when all layout declarations are finished.
 // Computes the layout and generates and returns the array of render commands to draw.
 CLAY_DLL_EXPORT Clay_RenderCommandArray Clay_EndLayout(void);
+// Returns the render commands that changed during the most recent call to Clay_EndLayout().
+// If .layoutChanged is false, only the render commands listed in .indexes differ from the previous frame, and they differ only in paint properties.
+CLAY_DLL_EXPORT Clay_RenderCommandUpdates Clay_GetRenderCommandUpdates(void);
+// Returns the regions of the screen that changed during the most recent call to Clay_EndLayout(), computed by comparing the render commands
+// (geometry, paint data, clipping and draw order) against those of the previous frame. Renderers can repaint only these regions.
+// The first layout, and any layout after the layout dimensions change, damages the entire screen.
+// Note: CUSTOM render commands are always considered damaged, as Clay can't see their contents.
+// IMAGE render commands are damaged when their pixels change only if .imageVersion in their Clay_ImageElementConfig changes along with them.
+CLAY_DLL_EXPORT Clay_DamageRectArray Clay_GetDamageRects(void);
 // Calculates a hash ID from the given idString.
 // Generally only used for dynamic strings when CLAY_ID("stringLiteral") can't be used.
 CLAY_DLL_EXPORT Clay_ElementId Clay_GetElementId(Clay_String idString);
@@ -867,6 +1054,19 @@ CLAY_DLL_EXPORT Clay_ElementId Clay_GetElementIdWithIndex(Clay_String idString,
 // The returned Clay_ElementData contains a `found` bool that will be true if an element with the provided ID was found.
 // This ID can be calculated either with CLAY_ID() for string literal IDs, or Clay_GetElementId for dynamic strings.
 CLAY_DLL_EXPORT Clay_ElementData Clay_GetElementData(Clay_ElementId id);
+// Returns the final geometry of every element from the most recent layout, without any lookups.
+// The arrays stay valid until the next call to Clay_EndLayout().
+CLAY_DLL_EXPORT Clay_GeometryArray Clay_GetGeometry(void);
+// Returns the geometry of the element with the provided id and all of its descendants, as a range of the arrays returned by Clay_GetGeometry().
+// The returned array is empty if the element wasn't laid out by the most recent layout.
+CLAY_DLL_EXPORT Clay_GeometryArray Clay_GetSubtreeGeometry(Clay_ElementId id);
+// Looks up the indexes into the arrays returned by Clay_GetGeometry() of many elements at once, writing -1 for elements that weren't laid out.
+// Returns the number of elements found.
+CLAY_DLL_EXPORT int32_t Clay_GetGeometryIndexes(const Clay_ElementId *ids, int32_t count, int32_t *indexes);
+// Returns the bounding box of the cell at the given row and column of a CLAY_GRID container, as of the most recent layout.
+// The returned Clay_ElementData's `found` bool will be false if the element wasn't laid out as a grid, or the column is out of range.
+// Rows past the last one holding a child are extrapolated from the size of the last row, so a virtualized grid can position cells that weren't declared.
+CLAY_DLL_EXPORT Clay_ElementData Clay_GetGridCellData(Clay_ElementId gridId, int32_t row, int32_t column);
 // Returns true if the pointer position provided by Clay_SetPointerState is within the current element's bounding box.
 // Works during element declaration, e.g. CLAY({ .backgroundColor = Clay_Hovered() ? BLUE : RED });
 CLAY_DLL_EXPORT bool Clay_Hovered(void);
@@ -910,6 +1110,22 @@ CLAY_DLL_EXPORT int32_t Clay_GetMaxMeasureTextCacheWordCount(void);
 // Modifies the maximum number of measured "words" (whitespace seperated runs of characters) that Clay can store in its internal text measurement cache.
 // This may require reallocating additional memory, and re-calling Clay_Initialize();
 CLAY_DLL_EXPORT void Clay_SetMaxMeasureTextCacheWordCount(int32_t maxMeasureTextCacheWordCount);
+// Returns the maximum number of elements with .transition configured that Clay can retain animation state for.
+CLAY_DLL_EXPORT int32_t Clay_GetMaxTransitionCount(void);
+// Modifies the maximum number of elements with .transition configured that Clay can retain animation state for.
+// This may require reallocating additional memory, and re-calling Clay_Initialize();
+CLAY_DLL_EXPORT void Clay_SetMaxTransitionCount(int32_t maxTransitionCount);
+// Returns the number of bytes Clay reserves for recording the declarations inside CLAY_MEMO() blocks.
+CLAY_DLL_EXPORT int32_t Clay_GetMaxMemoBytes(void);
+// Modifies the number of bytes Clay reserves for recording the declarations inside CLAY_MEMO() blocks. Twice this amount is allocated, as the previous frame's recordings are kept for replay.
+// This may require reallocating additional memory, and re-calling Clay_Initialize();
+CLAY_DLL_EXPORT void Clay_SetMaxMemoBytes(int32_t maxMemoBytes);
+// Returns the number of bytes Clay reserves for storing the contents of text elements across frames.
+CLAY_DLL_EXPORT int32_t Clay_GetMaxStringStoreBytes(void);
+// Modifies the number of bytes Clay reserves for storing the contents of text elements across frames.
+// Text that doesn't fit is still rendered, but its render commands have a stringHandle of zero.
+// This may require reallocating additional memory, and re-calling Clay_Initialize();
+CLAY_DLL_EXPORT void Clay_SetMaxStringStoreBytes(int32_t maxStringStoreBytes);
 // Resets Clay's internal text measurement cache. Useful if font mappings have changed or fonts have been reloaded.
 CLAY_DLL_EXPORT void Clay_ResetMeasureTextCache(void);
 
@@ -921,8 +1137,11 @@ CLAY_DLL_EXPORT void Clay__ConfigureOpenElementPtr(const Clay_ElementDeclaration
 CLAY_DLL_EXPORT void Clay__CloseElement(void);
 CLAY_DLL_EXPORT Clay_ElementId Clay__HashString(Clay_String key, uint32_t offset, uint32_t seed);
 CLAY_DLL_EXPORT void Clay__OpenTextElement(Clay_String text, Clay_TextElementConfig *textConfig);
+CLAY_DLL_EXPORT void Clay__OpenTextElementWithVersion(Clay_String text, uint32_t contentId, uint32_t contentVersion, Clay_TextElementConfig *textConfig);
 CLAY_DLL_EXPORT Clay_TextElementConfig *Clay__StoreTextElementConfig(Clay_TextElementConfig config);
 CLAY_DLL_EXPORT uint32_t Clay__GetParentElementId(void);
+CLAY_DLL_EXPORT bool Clay__BeginMemo(Clay_ElementId key, uint32_t dependencyHash);
+CLAY_DLL_EXPORT void Clay__EndMemo(void);
 
 extern Clay_Color Clay__debugViewHighlightColor;
 extern uint32_t Clay__debugViewWidth;
@@ -1019,6 +1238,9 @@ CLAY__ARRAY_DEFINE_FUNCTIONS(typeName, arrayName)   \
 Clay_Context *Clay__currentContext;
 int32_t Clay__defaultMaxElementCount = 8192;
 int32_t Clay__defaultMaxMeasureTextWordCacheCount = 16384;
+int32_t Clay__defaultMaxTransitionCount = 256;
+int32_t Clay__defaultMaxMemoBytes = 256 * 1024;
+int32_t Clay__defaultMaxStringStoreBytes = 128 * 1024;
 
 void Clay__ErrorHandlerFunctionDefault(Clay_ErrorData errorText) {
     (void) errorText;
@@ -1064,6 +1286,8 @@ bool Clay__Array_AddCapacityCheck(int32_t length, int32_t capacity);
 CLAY__ARRAY_DEFINE(bool, Clay__boolArray)
 CLAY__ARRAY_DEFINE(int32_t, Clay__int32_tArray)
 CLAY__ARRAY_DEFINE(char, Clay__charArray)
+CLAY__ARRAY_DEFINE(float, Clay__floatArray)
+CLAY__ARRAY_DEFINE(uint32_t, Clay__uint32_tArray)
 CLAY__ARRAY_DEFINE_FUNCTIONS(Clay_ElementId, Clay_ElementIdArray)
 CLAY__ARRAY_DEFINE(Clay_LayoutConfig, Clay__LayoutConfigArray)
 CLAY__ARRAY_DEFINE(Clay_TextElementConfig, Clay__TextElementConfigArray)
@@ -1075,7 +1299,9 @@ CLAY__ARRAY_DEFINE(Clay_ClipElementConfig, Clay__ClipElementConfigArray)
 CLAY__ARRAY_DEFINE(Clay_BorderElementConfig, Clay__BorderElementConfigArray)
 CLAY__ARRAY_DEFINE(Clay_String, Clay__StringArray)
 CLAY__ARRAY_DEFINE(Clay_SharedElementConfig, Clay__SharedElementConfigArray)
+CLAY__ARRAY_DEFINE(Clay_TransitionElementConfig, Clay__TransitionElementConfigArray)
 CLAY__ARRAY_DEFINE_FUNCTIONS(Clay_RenderCommand, Clay_RenderCommandArray)
+CLAY__ARRAY_DEFINE_FUNCTIONS(Clay_BoundingBox, Clay_DamageRectArray)
 
 typedef CLAY_PACKED_ENUM {
     CLAY__ELEMENT_CONFIG_TYPE_NONE,
@@ -1087,6 +1313,7 @@ typedef CLAY_PACKED_ENUM {
     CLAY__ELEMENT_CONFIG_TYPE_TEXT,
     CLAY__ELEMENT_CONFIG_TYPE_CUSTOM,
     CLAY__ELEMENT_CONFIG_TYPE_SHARED,
+    CLAY__ELEMENT_CONFIG_TYPE_TRANSITION,
 } Clay__ElementConfigType;
 
 typedef union {
@@ -1098,6 +1325,7 @@ typedef union {
     Clay_ClipElementConfig *clipElementConfig;
     Clay_BorderElementConfig *borderElementConfig;
     Clay_SharedElementConfig *sharedElementConfig;
+    Clay_TransitionElementConfig *transitionElementConfig;
 } Clay_ElementConfigUnion;
 
 typedef struct {
@@ -1118,6 +1346,9 @@ typedef struct {
     Clay_String text;
     Clay_Dimensions preferredDimensions;
     int32_t elementIndex;
+    uint32_t contentHash;
+    uint32_t stringHandle;
+    uint32_t stringVersion;
     Clay__WrappedTextLineArraySlice wrappedLines;
 } Clay__TextElementData;
 
@@ -1142,15 +1373,32 @@ typedef struct {
 
 CLAY__ARRAY_DEFINE(Clay_LayoutElement, Clay_LayoutElementArray)
 
+typedef CLAY_PACKED_ENUM {
+    CLAY__SCROLL_MOTION_NONE,
+    CLAY__SCROLL_MOTION_FLING, // Velocity decays exponentially, and springs back after passing the end of the content
+    CLAY__SCROLL_MOTION_SPRING, // Critically damped return to .bound
+} Clay__ScrollMotionType;
+
+// Scroll motion along one axis, defined by its starting state so that it can be evaluated in closed form at any elapsed time
+typedef struct {
+    float elapsed;
+    float startPosition;
+    float startVelocity; // Pixels per second
+    float bound; // The position a spring returns to
+    float position; // The most recently evaluated position, used to detect scroll positions modified from outside
+    Clay__ScrollMotionType type;
+} Clay__ScrollMotion;
+
 typedef struct {
     Clay_LayoutElement *layoutElement;
     Clay_BoundingBox boundingBox;
     Clay_Dimensions contentSize;
     Clay_Vector2 scrollOrigin;
     Clay_Vector2 pointerOrigin;
-    Clay_Vector2 scrollMomentum;
     Clay_Vector2 scrollPosition;
     Clay_Vector2 previousDelta;
+    Clay__ScrollMotion motionX;
+    Clay__ScrollMotion motionY;
     float momentumTime;
     uint32_t elementId;
     bool openThisFrame;
@@ -1159,6 +1407,30 @@ typedef struct {
 
 CLAY__ARRAY_DEFINE(Clay__ScrollContainerDataInternal, Clay__ScrollContainerDataInternalArray)
 
+// The solved size and position of a single column or row of a grid
+typedef struct {
+    float offset; // From the start of the first track, including gaps
+    float size;
+    // Used while solving track sizes
+    float lower;
+    float upper;
+    float weight; // The share of space this track takes while solving, or 0 if its size is settled
+} Clay__GridTrackData;
+
+CLAY__ARRAY_DEFINE(Clay__GridTrackData, Clay__GridTrackDataArray)
+
+// Track sizes for a CLAY_GRID container, retained after the layout so that cells can be queried during the next frame's declarations
+typedef struct {
+    uint32_t elementId;
+    int32_t columnCount;
+    int32_t rowCount;
+    int32_t tracksStart; // columnCount column tracks followed by rowCount row tracks in gridTracks
+    float childGap;
+    Clay_Vector2 origin; // The screen position of the first cell, including scrolling
+} Clay__GridData;
+
+CLAY__ARRAY_DEFINE(Clay__GridData, Clay__GridDataArray)
+
 typedef struct {
     bool collision;
     bool collapsed;
@@ -1175,6 +1447,9 @@ typedef struct { // todo get this struct into a single cache line
     int32_t nextIndex;
     uint32_t generation;
     uint32_t idAlias;
+    int32_t transitionIndex; // -1 if the element has no retained transition state
+    int32_t gridIndex; // The element's Clay__GridData from the most recent layout, valid only if that entry's elementId matches
+    int32_t geometryIndex; // The element's index in the geometry arrays from the most recent layout, valid only if that entry's id matches
     Clay__DebugElementData *debugData;
 } Clay_LayoutElementHashMapItem;
 
@@ -1206,6 +1481,8 @@ typedef struct {
     Clay_LayoutElement *layoutElement;
     Clay_Vector2 position;
     Clay_Vector2 nextChildOffset;
+    int32_t geometryIndex;
+    int32_t parentGeometryIndex;
 } Clay__LayoutElementTreeNode;
 
 CLAY__ARRAY_DEFINE(Clay__LayoutElementTreeNode, Clay__LayoutElementTreeNodeArray)
@@ -1220,9 +1497,123 @@ typedef struct {
 
 CLAY__ARRAY_DEFINE(Clay__LayoutElementTreeRoot, Clay__LayoutElementTreeRootArray)
 
+// Records which element and config produced each render command, so that paint properties can be patched in place when the layout hasn't changed
+typedef struct {
+    int32_t layoutElementIndex;
+    int32_t textOffset; // For text commands, the offset of the wrapped line from the start of the element's text
+    Clay__ElementConfigType configType;
+} Clay__RenderCommandSource;
+
+CLAY__ARRAY_DEFINE(Clay__RenderCommandSource, Clay__RenderCommandSourceArray)
+CLAY__ARRAY_DEFINE(Clay_Dimensions, Clay__DimensionsArray)
+
+// The visible footprint of a single render command, compared between frames to compute damage rects
+typedef struct {
+    uint32_t key; // The render command id combined with the command type
+    uint32_t paintHash;
+    Clay_BoundingBox boundingBox;
+    Clay_BoundingBox visibleBoundingBox; // The bounding box intersected with the active scissor rect and the screen
+    int32_t nextIndex; // The next previous frame record in the same hash bucket, or -1
+    bool matched;
+} Clay__DamageRecord;
+
+CLAY__ARRAY_DEFINE(Clay__DamageRecord, Clay__DamageRecordArray)
+
+typedef CLAY_PACKED_ENUM {
+    CLAY__MEMO_OP_OPEN_ELEMENT,
+    CLAY__MEMO_OP_CONFIGURE_ELEMENT, // Followed by a Clay_ElementDeclaration, then the grid columns and rows it points to
+    CLAY__MEMO_OP_CLOSE_ELEMENT,
+    CLAY__MEMO_OP_TEXT, // Followed by a Clay__MemoTextOp
+    CLAY__MEMO_OP_ON_HOVER, // Followed by a Clay__MemoOnHoverOp
+} Clay__MemoOpType;
+
+// Recorded declarations are stored back to back, each padded to 8 bytes. Strings that aren't statically allocated are copied in after
+// the payload, so that a recording has no pointers into itself and can be moved with a plain copy.
+typedef struct {
+    int32_t size; // Including this header, the payload and any inline string
+    Clay__MemoOpType type;
+    bool hasInlineString;
+    bool scrollOffsetQueried; // The declaration called Clay_GetScrollOffset() for .clip.childOffset
+} Clay__MemoOpHeader;
+
+typedef struct {
+    Clay_TextElementConfig config;
+    Clay_String text;
+    uint32_t contentId;
+    uint32_t contentVersion;
+    bool versioned;
+} Clay__MemoTextOp;
+
+typedef struct {
+    void (*onHoverFunction)(Clay_ElementId elementId, Clay_PointerData pointerInfo, intptr_t userData);
+    intptr_t userData;
+} Clay__MemoOnHoverOp;
+
+// A recorded CLAY_MEMO() block, spanning [start, end) of the ops buffer
+typedef struct {
+    uint32_t id;
+    uint32_t dependencyHash;
+    int32_t start; // -1 while recording if the recording ran out of space
+    int32_t end;
+    int32_t nextIndex; // The next previous frame entry in the same hash bucket, or -1
+} Clay__MemoEntry;
+
+CLAY__ARRAY_DEFINE(Clay__MemoEntry, Clay__MemoEntryArray)
+
+// A string in the cross frame string store, deduplicated by contents, or by the caller's content id for CLAY_TEXT_WITH_VERSION().
+// Owned copies live in a byte heap as an int32_t slot index followed by the characters, so that the heap can be compacted with a single linear walk.
+// Freed blocks store minus their size instead.
+typedef struct {
+    const char *chars; // Into the byte heap, or the caller's memory for statically allocated strings
+    int32_t length;
+    int32_t offset; // Of the block in the byte heap, or -1 if the characters aren't owned by the store
+    uint32_t contentHash; // As used by the text measurement cache
+    uint32_t bucketHash;
+    uint32_t contentId;
+    uint32_t contentVersion;
+    uint32_t version; // Zero for a free slot
+    uint32_t lastUsedGeneration;
+    int32_t nextIndex; // The next slot in the same hash bucket, or -1
+    bool versioned; // Identified by contentId and contentVersion rather than by contents
+} Clay__StoredString;
+
+CLAY__ARRAY_DEFINE(Clay__StoredString, Clay__StoredStringArray)
+
+typedef enum {
+    CLAY__TRANSITION_CHANNEL_COLOR_R,
+    CLAY__TRANSITION_CHANNEL_COLOR_G,
+    CLAY__TRANSITION_CHANNEL_COLOR_B,
+    CLAY__TRANSITION_CHANNEL_COLOR_A,
+    CLAY__TRANSITION_CHANNEL_OPACITY,
+    CLAY__TRANSITION_CHANNEL_OFFSET_X,
+    CLAY__TRANSITION_CHANNEL_OFFSET_Y,
+    CLAY__TRANSITION_CHANNEL_WIDTH,
+    CLAY__TRANSITION_CHANNEL_HEIGHT,
+    CLAY__TRANSITION_CHANNEL_COUNT,
+} Clay__TransitionChannel;
+
+// Retained transition state, stored as parallel arrays so that all active transitions can be advanced in a few tight loops.
+// Per channel values are laid out channel-major, i.e. value[channel * capacity + transitionIndex]
+typedef struct {
+    Clay__uint32_tArray elementIds; // The length of this array is the number of retained transitions
+    Clay__uint32_tArray generations;
+    Clay__floatArray progress;
+    Clay__floatArray inverseDuration;
+    Clay__floatArray easingLinear;
+    Clay__floatArray easingQuadratic;
+    Clay__floatArray easingCubic;
+    Clay__floatArray eased;
+    Clay__floatArray from;
+    Clay__floatArray to;
+    Clay__floatArray current;
+} Clay__TransitionData;
+
 struct Clay_Context {
     int32_t maxElementCount;
     int32_t maxMeasureTextCacheWordCount;
+    int32_t maxTransitionCount;
+    int32_t maxMemoBytes;
+    int32_t maxStringStoreBytes;
     bool warningsEnabled;
     Clay_ErrorHandler errorHandler;
     Clay_BooleanWarnings booleanWarnings;
@@ -1249,6 +1640,8 @@ struct Clay_Context {
     Clay__int32_tArray layoutElementChildrenBuffer;
     Clay__TextElementDataArray textElementData;
     Clay__int32_tArray aspectRatioElementIndexes;
+    Clay__int32_tArray transitionElementIndexes;
+    Clay__int32_tArray gridElementIndexes;
     Clay__int32_tArray reusableElementIndexBuffer;
     Clay__int32_tArray layoutElementClipElementIds;
     // Configs
@@ -1262,6 +1655,7 @@ struct Clay_Context {
     Clay__CustomElementConfigArray customElementConfigs;
     Clay__BorderElementConfigArray borderElementConfigs;
     Clay__SharedElementConfigArray sharedElementConfigs;
+    Clay__TransitionElementConfigArray transitionElementConfigs;
     // Misc Data Structures
     Clay__StringArray layoutElementIdStrings;
     Clay__WrappedTextLineArray wrappedTextLines;
@@ -1280,6 +1674,47 @@ struct Clay_Context {
     Clay__boolArray treeNodeVisited;
     Clay__charArray dynamicStringData;
     Clay__DebugElementDataArray debugElementData;
+    Clay__TransitionData transitions;
+    // Grid layout
+    Clay__GridDataArray gridDatas;
+    Clay__GridTrackDataArray gridTracks;
+    // Geometry export, rebuilt in depth first order by every layout and kept while layouts are skipped
+    Clay__uint32_tArray geometryIds;
+    Clay__floatArray geometryX;
+    Clay__floatArray geometryY;
+    Clay__floatArray geometryWidths;
+    Clay__floatArray geometryHeights;
+    Clay__int32_tArray geometryParents;
+    Clay__int32_tArray geometrySubtreeEnds;
+    // Paint only updates
+    uint32_t layoutHash; // A running hash of every declared property that can affect sizing, positioning or the set of render commands
+    uint32_t previousLayoutHash; // Zero if the previous render commands can't be reused
+    Clay__RenderCommandSourceArray renderCommandSources;
+    Clay__DimensionsArray previousLayoutElementDimensions;
+    Clay__int32_tArray renderCommandUpdates;
+    bool layoutChanged;
+    // Damage tracking
+    Clay__DamageRecordArray damageRecords;
+    Clay__DamageRecordArray previousDamageRecords;
+    Clay__int32_tArray damageRecordsHashMap;
+    Clay_DamageRectArray damageClipStack; // The visible region at each level of scissor nesting
+    Clay_DamageRectArray damageRects;
+    Clay_Dimensions previousDamageLayoutDimensions; // Zero until the first layout, so that it damages the entire screen
+    // Memoized declarations
+    Clay__charArray memoOps;
+    Clay__charArray previousMemoOps;
+    Clay__MemoEntryArray memoEntries;
+    Clay__MemoEntryArray previousMemoEntries;
+    Clay__int32_tArray memoEntriesHashMap;
+    Clay__MemoEntryArray memoStack; // The CLAY_MEMO() blocks currently being recorded, innermost last
+    bool memoReplaying;
+    bool memoScrollOffsetQueried;
+    // Cross frame string store
+    Clay__charArray stringStoreBytes;
+    Clay__StoredStringArray storedStrings; // Indexed by handle - 1
+    Clay__int32_tArray storedStringsFreeList;
+    Clay__int32_tArray storedStringsHashMap;
+    uint32_t stringStoreVersion;
 };
 
 Clay_Context* Clay__Context_Allocate_Arena(Clay_Arena *arena) {
@@ -1327,6 +1762,7 @@ Clay_CustomElementConfig * Clay__StoreCustomElementConfig(Clay_CustomElementConf
 Clay_ClipElementConfig * Clay__StoreClipElementConfig(Clay_ClipElementConfig config) {  return Clay_GetCurrentContext()->booleanWarnings.maxElementsExceeded ? &Clay_ClipElementConfig_DEFAULT : Clay__ClipElementConfigArray_Add(&Clay_GetCurrentContext()->clipElementConfigs, config); }
 Clay_BorderElementConfig * Clay__StoreBorderElementConfig(Clay_BorderElementConfig config) {  return Clay_GetCurrentContext()->booleanWarnings.maxElementsExceeded ? &Clay_BorderElementConfig_DEFAULT : Clay__BorderElementConfigArray_Add(&Clay_GetCurrentContext()->borderElementConfigs, config); }
 Clay_SharedElementConfig * Clay__StoreSharedElementConfig(Clay_SharedElementConfig config) {  return Clay_GetCurrentContext()->booleanWarnings.maxElementsExceeded ? &Clay_SharedElementConfig_DEFAULT : Clay__SharedElementConfigArray_Add(&Clay_GetCurrentContext()->sharedElementConfigs, config); }
+Clay_TransitionElementConfig * Clay__StoreTransitionElementConfig(Clay_TransitionElementConfig config) {  return Clay_GetCurrentContext()->booleanWarnings.maxElementsExceeded ? &Clay_TransitionElementConfig_DEFAULT : Clay__TransitionElementConfigArray_Add(&Clay_GetCurrentContext()->transitionElementConfigs, config); }
 
 Clay_ElementConfig Clay__AttachElementConfig(Clay_ElementConfigUnion config, Clay__ElementConfigType type) {
     Clay_Context* context = Clay_GetCurrentContext();
@@ -1503,7 +1939,7 @@ uint64_t Clay__HashData(const uint8_t* data, size_t length) {
 }
 #endif
 
-uint32_t Clay__HashStringContentsWithConfig(Clay_String *text, Clay_TextElementConfig *config) {
+uint32_t Clay__HashStringContents(Clay_String *text) {
     uint32_t hash = 0;
     if (text->isStaticallyAllocated) {
         hash += (uintptr_t)text->chars;
@@ -1515,7 +1951,12 @@ uint32_t Clay__HashStringContentsWithConfig(Clay_String *text, Clay_TextElementC
     } else {
         hash = Clay__HashData((const uint8_t *)text->chars, text->length) % UINT32_MAX;
     }
+    return hash;
+}
 
+// Combines the hash of a string's contents with the config properties that affect its measurement
+uint32_t Clay__HashStringContentsWithConfig(uint32_t contentHash, Clay_TextElementConfig *config) {
+    uint32_t hash = contentHash;
     hash += config->fontId;
     hash += (hash << 10);
     hash ^= (hash >> 6);
@@ -1534,6 +1975,17 @@ uint32_t Clay__HashStringContentsWithConfig(Clay_String *text, Clay_TextElementC
     return hash + 1; // Reserve the hash result of zero as "null id"
 }
 
+void Clay__HashLayoutInput(uint32_t value) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    context->layoutHash = (context->layoutHash ^ value) * 16777619;
+}
+
+void Clay__HashLayoutInputFloat(float value) {
+    union { float asFloat; uint32_t asInt; } bits;
+    bits.asFloat = value;
+    Clay__HashLayoutInput(bits.asInt);
+}
+
 Clay__MeasuredWord *Clay__AddMeasuredWord(Clay__MeasuredWord word, Clay__MeasuredWord *previousWord) {
     Clay_Context* context = Clay_GetCurrentContext();
     if (context->measuredWordsFreeList.length > 0) {
@@ -1548,7 +2000,7 @@ Clay__MeasuredWord *Clay__AddMeasuredWord(Clay__MeasuredWord word, Clay__Measure
     }
 }
 
-Clay__MeasureTextCacheItem *Clay__MeasureTextCached(Clay_String *text, Clay_TextElementConfig *config) {
+Clay__MeasureTextCacheItem *Clay__MeasureTextCached(Clay_String *text, uint32_t contentHash, Clay_TextElementConfig *config) {
     Clay_Context* context = Clay_GetCurrentContext();
     #ifndef CLAY_WASM
     if (!Clay__MeasureText) {
@@ -1562,7 +2014,7 @@ Clay__MeasureTextCacheItem *Clay__MeasureTextCached(Clay_String *text, Clay_Text
         return &Clay__MeasureTextCacheItem_DEFAULT;
     }
     #endif
-    uint32_t id = Clay__HashStringContentsWithConfig(text, config);
+    uint32_t id = Clay__HashStringContentsWithConfig(contentHash, config);
     uint32_t hashBucket = id % (context->maxMeasureTextCacheWordCount / 32);
     int32_t elementIndexPrevious = 0;
     int32_t elementIndex = context->measureTextHashMap.internalArray[hashBucket];
@@ -1698,7 +2150,7 @@ Clay_LayoutElementHashMapItem* Clay__AddHashMapItem(Clay_ElementId elementId, Cl
     if (context->layoutElementsHashMapInternal.length == context->layoutElementsHashMapInternal.capacity - 1) {
         return NULL;
     }
-    Clay_LayoutElementHashMapItem item = { .elementId = elementId, .layoutElement = layoutElement, .nextIndex = -1, .generation = context->generation + 1, .idAlias = idAlias };
+    Clay_LayoutElementHashMapItem item = { .elementId = elementId, .layoutElement = layoutElement, .nextIndex = -1, .generation = context->generation + 1, .idAlias = idAlias, .transitionIndex = -1, .gridIndex = -1, .geometryIndex = -1 };
     uint32_t hashBucket = elementId.id % context->layoutElementsHashMap.capacity;
     int32_t hashItemPrevious = -1;
     int32_t hashItemIndex = context->layoutElementsHashMap.internalArray[hashBucket];
@@ -1789,13 +2241,111 @@ void Clay__UpdateAspectRatioBox(Clay_LayoutElement *layoutElement) {
     }
 }
 
+// Appends an op to the recording of every open CLAY_MEMO() block, returning a pointer to its payload, or NULL if it didn't fit
+void* Clay__RecordMemoOp(Clay__MemoOpType type, int32_t payloadSize, Clay_String *string) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    bool inlineString = string && !string->isStaticallyAllocated && string->length > 0;
+    int32_t size = (int32_t)sizeof(Clay__MemoOpHeader) + payloadSize + (inlineString ? string->length : 0);
+    size = (size + 7) & ~7;
+    if (context->memoOps.length + size > context->memoOps.capacity) {
+        for (int32_t i = 0; i < context->memoStack.length; ++i) {
+            context->memoStack.internalArray[i].start = -1;
+        }
+        return CLAY__NULL;
+    }
+    Clay__MemoOpHeader *header = (Clay__MemoOpHeader *)(context->memoOps.internalArray + context->memoOps.length);
+    *header = CLAY__INIT(Clay__MemoOpHeader) { .size = size, .type = type, .hasInlineString = inlineString };
+    context->memoOps.length += size;
+    char *payload = (char *)(header + 1);
+    if (inlineString) {
+        char *chars = payload + payloadSize;
+        for (int32_t i = 0; i < string->length; ++i) {
+            chars[i] = string->chars[i];
+        }
+    }
+    return payload;
+}
+
+static inline bool Clay__MemoRecording(Clay_Context *context) {
+    return context->memoStack.length > 0 && !context->memoReplaying;
+}
+
+int32_t Clay__GetGridColumnCount(const Clay_GridLayout *grid) {
+    return grid->columnCount > 0 ? grid->columnCount : 1;
+}
+
+// Returns the sizing of a grid column, or of a grid row if columns is false
+Clay_GridTrack Clay__GetGridTrack(const Clay_GridLayout *grid, bool columns, int32_t index) {
+    if (columns) {
+        return grid->columns && index < grid->columnCount ? grid->columns[index] : CLAY_GRID_TRACK_GROW(0);
+    }
+    return grid->rows && grid->rowCount > 0 ? grid->rows[CLAY__MIN(index, grid->rowCount - 1)] : CLAY_GRID_TRACK_FIT(0);
+}
+
+float Clay__GetGridTrackMin(Clay_GridTrack track) {
+    return track.type == CLAY__GRID_TRACK_TYPE_FRACTION ? 0 : track.size.minMax.min;
+}
+
+float Clay__GetGridTrackMax(Clay_GridTrack track) {
+    switch (track.type) {
+        case CLAY__GRID_TRACK_TYPE_FIXED: return track.size.minMax.min;
+        case CLAY__GRID_TRACK_TYPE_FRACTION: return CLAY__MAXFLOAT;
+        default: return track.size.minMax.max > 0 ? track.size.minMax.max : CLAY__MAXFLOAT;
+    }
+}
+
+// Returns the total size of a grid's columns (or rows) including gaps but not padding, with each track wrapped to its largest child.
+// If minimum is true, tracks are wrapped to the minimum sizes of their children instead.
+float Clay__GetGridContentSize(Clay_LayoutElement *gridElement, bool xAxis, bool minimum) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    Clay_LayoutConfig *layoutConfig = gridElement->layoutConfig;
+    int32_t childCount = gridElement->childrenOrTextContent.children.length;
+    int32_t columnCount = Clay__GetGridColumnCount(&layoutConfig->grid);
+    int32_t trackCount = xAxis ? columnCount : (childCount + columnCount - 1) / columnCount;
+    float contentSize = (float)(CLAY__MAX(trackCount - 1, 0) * layoutConfig->childGap);
+    for (int32_t trackIndex = 0; trackIndex < trackCount; ++trackIndex) {
+        Clay_GridTrack track = Clay__GetGridTrack(&layoutConfig->grid, xAxis, trackIndex);
+        if (track.type == CLAY__GRID_TRACK_TYPE_FIXED) {
+            contentSize += track.size.minMax.min;
+            continue;
+        }
+        // The cells of a column are columnCount children apart, and the cells of a row are adjacent
+        int32_t first = xAxis ? trackIndex : trackIndex * columnCount;
+        int32_t last = xAxis ? childCount : CLAY__MIN(first + columnCount, childCount);
+        int32_t step = xAxis ? columnCount : 1;
+        float trackSize = 0;
+        for (int32_t i = first; i < last; i += step) {
+            Clay_LayoutElement *child = Clay_LayoutElementArray_Get(&context->layoutElements, gridElement->childrenOrTextContent.children.elements[i]);
+            Clay_Dimensions childDimensions = minimum ? child->minDimensions : child->dimensions;
+            trackSize = CLAY__MAX(trackSize, xAxis ? childDimensions.width : childDimensions.height);
+        }
+        contentSize += CLAY__MIN(CLAY__MAX(trackSize, Clay__GetGridTrackMin(track)), Clay__GetGridTrackMax(track));
+    }
+    return contentSize;
+}
+
+// Returns the grid data from the most recent layout of an element, or NULL if it wasn't laid out as a grid
+Clay__GridData *Clay__GetGridData(uint32_t elementId) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    Clay_LayoutElementHashMapItem *hashMapItem = Clay__GetHashMapItem(elementId);
+    if (hashMapItem->gridIndex < 0 || hashMapItem->gridIndex >= context->gridDatas.length) {
+        return CLAY__NULL;
+    }
+    Clay__GridData *gridData = Clay__GridDataArray_Get(&context->gridDatas, hashMapItem->gridIndex);
+    return gridData->elementId == elementId ? gridData : CLAY__NULL;
+}
+
 void Clay__CloseElement(void) {
     Clay_Context* context = Clay_GetCurrentContext();
+    if (Clay__MemoRecording(context)) {
+        Clay__RecordMemoOp(CLAY__MEMO_OP_CLOSE_ELEMENT, 0, CLAY__NULL);
+    }
     if (context->booleanWarnings.maxElementsExceeded) {
         return;
     }
     Clay_LayoutElement *openLayoutElement = Clay__GetOpenLayoutElement();
     Clay_LayoutConfig *layoutConfig = openLayoutElement->layoutConfig;
+    Clay__HashLayoutInput((uint32_t)openLayoutElement->childrenOrTextContent.children.length);
     bool elementHasClipHorizontal = false;
     bool elementHasClipVertical = false;
     for (int32_t i = 0; i < openLayoutElement->elementConfigs.length; i++) {
@@ -1861,6 +2411,17 @@ void Clay__CloseElement(void) {
             openLayoutElement->minDimensions.height += childGap;
         }
     }
+    else if (layoutConfig->layoutDirection == CLAY_GRID) {
+        for (int32_t i = 0; i < openLayoutElement->childrenOrTextContent.children.length; i++) {
+            int32_t childIndex = Clay__int32_tArray_GetValue(&context->layoutElementChildrenBuffer, (int)context->layoutElementChildrenBuffer.length - openLayoutElement->childrenOrTextContent.children.length + i);
+            Clay__int32_tArray_Add(&context->layoutElementChildren, childIndex);
+        }
+        openLayoutElement->dimensions.width = leftRightPadding + Clay__GetGridContentSize(openLayoutElement, true, false);
+        openLayoutElement->dimensions.height = topBottomPadding + Clay__GetGridContentSize(openLayoutElement, false, false);
+        // Minimum size of child elements doesn't matter to clip containers as they can shrink and hide their contents
+        openLayoutElement->minDimensions.width = leftRightPadding + (elementHasClipHorizontal ? 0 : Clay__GetGridContentSize(openLayoutElement, true, true));
+        openLayoutElement->minDimensions.height = topBottomPadding + (elementHasClipVertical ? 0 : Clay__GetGridContentSize(openLayoutElement, false, true));
+    }
 
     context->layoutElementChildrenBuffer.length -= openLayoutElement->childrenOrTextContent.children.length;
 
@@ -1967,6 +2528,9 @@ bool Clay__MemCmp(const char *s1, const char *s2, int32_t length);
 
 void Clay__OpenElement(void) {
     Clay_Context* context = Clay_GetCurrentContext();
+    if (Clay__MemoRecording(context)) {
+        Clay__RecordMemoOp(CLAY__MEMO_OP_OPEN_ELEMENT, 0, CLAY__NULL);
+    }
     if (context->layoutElements.length == context->layoutElements.capacity - 1 || context->booleanWarnings.maxElementsExceeded) {
         context->booleanWarnings.maxElementsExceeded = true;
         return;
@@ -1981,13 +2545,158 @@ void Clay__OpenElement(void) {
     }
 }
 
-void Clay__OpenTextElement(Clay_String text, Clay_TextElementConfig *textConfig) {
+// Clay__HashData and the static string hash mix short inputs weakly, so finish with a multiply to spread them across buckets
+uint32_t Clay__StringStoreBucketHash(uint32_t value, bool versioned) {
+    uint64_t hash = ((uint64_t)value << 1 | versioned) * 0xFF51AFD7ED558CCDULL;
+    return (uint32_t)(hash ^ (hash >> 32));
+}
+
+// Returns the slot holding the caller versioned string, or -1 if it has changed or wasn't used recently
+int32_t Clay__FindVersionedString(uint32_t contentId, uint32_t contentVersion, int32_t length) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    uint32_t bucketHash = Clay__StringStoreBucketHash(contentId, true);
+    for (int32_t index = context->storedStringsHashMap.internalArray[bucketHash % context->storedStringsHashMap.capacity]; index != -1;) {
+        Clay__StoredString *stored = &context->storedStrings.internalArray[index];
+        if (stored->versioned && stored->contentId == contentId && stored->contentVersion == contentVersion && stored->length == length) {
+            stored->lastUsedGeneration = context->generation;
+            return index;
+        }
+        index = stored->nextIndex;
+    }
+    return -1;
+}
+
+// Returns the slot holding a string with the same contents, or the same id and version if versioned, adding one if necessary. Returns -1 if the store is full
+int32_t Clay__StoreString(Clay_String text, uint32_t contentHash, bool versioned, uint32_t contentId, uint32_t contentVersion) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    uint32_t bucketHash = Clay__StringStoreBucketHash(versioned ? contentId : contentHash, versioned);
+    int32_t *bucket = &context->storedStringsHashMap.internalArray[bucketHash % context->storedStringsHashMap.capacity];
+    if (!versioned) {
+        for (int32_t index = *bucket; index != -1;) {
+            Clay__StoredString *stored = &context->storedStrings.internalArray[index];
+            if (!stored->versioned && stored->contentHash == contentHash && stored->length == text.length && Clay__MemCmp(stored->chars, text.chars, text.length)) {
+                stored->lastUsedGeneration = context->generation;
+                return index;
+            }
+            index = stored->nextIndex;
+        }
+    }
+    int32_t offset = -1;
+    const char *chars = text.chars;
+    if (!text.isStaticallyAllocated) {
+        int32_t blockSize = ((int32_t)sizeof(int32_t) + text.length + 3) & ~3;
+        if (context->stringStoreBytes.length + blockSize > context->stringStoreBytes.capacity) {
+            return -1;
+        }
+        offset = context->stringStoreBytes.length;
+        context->stringStoreBytes.length += blockSize;
+        char *block = context->stringStoreBytes.internalArray + offset;
+        for (int32_t i = 0; i < text.length; ++i) {
+            block[sizeof(int32_t) + i] = text.chars[i];
+        }
+        chars = block + sizeof(int32_t);
+    }
+    int32_t index;
+    if (context->storedStringsFreeList.length > 0) {
+        index = Clay__int32_tArray_GetValue(&context->storedStringsFreeList, context->storedStringsFreeList.length - 1);
+        context->storedStringsFreeList.length--;
+    } else if (context->storedStrings.length < context->storedStrings.capacity) {
+        index = context->storedStrings.length++;
+    } else {
+        if (offset >= 0) {
+            context->stringStoreBytes.length = offset;
+        }
+        return -1;
+    }
+    if (offset >= 0) {
+        *(int32_t *)(context->stringStoreBytes.internalArray + offset) = index;
+    }
+    context->storedStrings.internalArray[index] = CLAY__INIT(Clay__StoredString) {
+        .chars = chars, .length = text.length, .offset = offset, .contentHash = contentHash, .bucketHash = bucketHash, .contentId = contentId, .contentVersion = contentVersion,
+        .version = ++context->stringStoreVersion, .lastUsedGeneration = context->generation, .nextIndex = *bucket, .versioned = versioned
+    };
+    *bucket = index;
+    return index;
+}
+
+// Frees the strings that weren't used by the previous frame, and compacts the byte heap once it is more than half full
+void Clay__UpdateStringStore(Clay_Context *context) {
+    Clay__StoredStringArray *strings = &context->storedStrings;
+    Clay__charArray *bytes = &context->stringStoreBytes;
+    for (int32_t i = 0; i < strings->length; ++i) {
+        Clay__StoredString *stored = &strings->internalArray[i];
+        if (stored->version != 0 && stored->lastUsedGeneration + 1 < context->generation) {
+            if (stored->offset >= 0) {
+                *(int32_t *)(bytes->internalArray + stored->offset) = -(((int32_t)sizeof(int32_t) + stored->length + 3) & ~3);
+            }
+            stored->version = 0;
+            Clay__int32_tArray_Add(&context->storedStringsFreeList, i);
+        }
+    }
+    if (bytes->length > bytes->capacity / 2) {
+        int32_t writeOffset = 0;
+        for (int32_t readOffset = 0; readOffset < bytes->length;) {
+            int32_t index = *(int32_t *)(bytes->internalArray + readOffset);
+            if (index < 0) {
+                readOffset -= index;
+                continue;
+            }
+            int32_t blockSize = ((int32_t)sizeof(int32_t) + strings->internalArray[index].length + 3) & ~3;
+            if (writeOffset != readOffset) {
+                for (int32_t i = 0; i < blockSize; ++i) {
+                    bytes->internalArray[writeOffset + i] = bytes->internalArray[readOffset + i];
+                }
+                strings->internalArray[index].offset = writeOffset;
+                strings->internalArray[index].chars = bytes->internalArray + writeOffset + sizeof(int32_t);
+            }
+            writeOffset += blockSize;
+            readOffset += blockSize;
+        }
+        bytes->length = writeOffset;
+    }
+    Clay__int32_tArray *hashMap = &context->storedStringsHashMap;
+    for (int32_t i = 0; i < strings->length; ++i) {
+        hashMap->internalArray[strings->internalArray[i].bucketHash % hashMap->capacity] = -1;
+    }
+    for (int32_t i = 0; i < strings->length; ++i) {
+        Clay__StoredString *stored = &strings->internalArray[i];
+        if (stored->version != 0) {
+            int32_t *bucket = &hashMap->internalArray[stored->bucketHash % hashMap->capacity];
+            stored->nextIndex = *bucket;
+            *bucket = i;
+        }
+    }
+}
+
+void Clay__DeclareTextElement(Clay_String text, Clay_TextElementConfig *textConfig, bool versioned, uint32_t contentId, uint32_t contentVersion) {
     Clay_Context* context = Clay_GetCurrentContext();
+    if (Clay__MemoRecording(context)) {
+        Clay__MemoTextOp *op = (Clay__MemoTextOp *)Clay__RecordMemoOp(CLAY__MEMO_OP_TEXT, sizeof(Clay__MemoTextOp), &text);
+        if (op) {
+            *op = CLAY__INIT(Clay__MemoTextOp) { .config = *textConfig, .text = text, .contentId = contentId, .contentVersion = contentVersion, .versioned = versioned };
+        }
+    }
     if (context->layoutElements.length == context->layoutElements.capacity - 1 || context->booleanWarnings.maxElementsExceeded) {
         context->booleanWarnings.maxElementsExceeded = true;
         return;
     }
     Clay_LayoutElement *parentElement = Clay__GetOpenLayoutElement();
+    // Dynamic text is read from the stored copy from here on, so the caller's buffer only needs to outlive this call.
+    // Text with an unchanged caller version is found without reading its contents at all
+    uint32_t stringHandle = 0, stringVersion = 0, contentHash;
+    int32_t storedIndex = versioned ? Clay__FindVersionedString(contentId, contentVersion, text.length) : -1;
+    if (storedIndex >= 0) {
+        contentHash = context->storedStrings.internalArray[storedIndex].contentHash;
+    } else {
+        contentHash = Clay__HashStringContents(&text);
+        storedIndex = Clay__StoreString(text, contentHash, versioned, contentId, contentVersion);
+    }
+    if (storedIndex >= 0) {
+        Clay__StoredString *stored = &context->storedStrings.internalArray[storedIndex];
+        stringHandle = (uint32_t)storedIndex + 1;
+        stringVersion = stored->version;
+        text.chars = stored->chars;
+    }
 
     Clay_LayoutElement layoutElement = CLAY__DEFAULT_STRUCT;
     Clay_LayoutElement *textElement = Clay_LayoutElementArray_Add(&context->layoutElements, layoutElement);
@@ -1998,15 +2707,19 @@ void Clay__OpenTextElement(Clay_String text, Clay_TextElementConfig *textConfig)
     }
 
     Clay__int32_tArray_Add(&context->layoutElementChildrenBuffer, context->layoutElements.length - 1);
-    Clay__MeasureTextCacheItem *textMeasured = Clay__MeasureTextCached(&text, textConfig);
+    Clay__MeasureTextCacheItem *textMeasured = Clay__MeasureTextCached(&text, contentHash, textConfig);
     Clay_ElementId elementId = Clay__HashNumber(parentElement->childrenOrTextContent.children.length, parentElement->id);
     textElement->id = elementId.id;
+    // The measurement cache id already covers the text contents and the config properties that affect measurement
+    Clay__HashLayoutInput(elementId.id);
+    Clay__HashLayoutInput(textMeasured->id);
+    Clay__HashLayoutInput((uint32_t)textConfig->lineHeight | ((uint32_t)textConfig->wrapMode << 16) | ((uint32_t)textConfig->textAlignment << 24));
     Clay__AddHashMapItem(elementId, textElement, 0);
     Clay__StringArray_Add(&context->layoutElementIdStrings, elementId.stringId);
     Clay_Dimensions textDimensions = { .width = textMeasured->unwrappedDimensions.width, .height = textConfig->lineHeight > 0 ? (float)textConfig->lineHeight : textMeasured->unwrappedDimensions.height };
     textElement->dimensions = textDimensions;
     textElement->minDimensions = CLAY__INIT(Clay_Dimensions) { .width = textMeasured->minWidth, .height = textDimensions.height };
-    textElement->childrenOrTextContent.textElementData = Clay__TextElementDataArray_Add(&context->textElementData, CLAY__INIT(Clay__TextElementData) { .text = text, .preferredDimensions = textMeasured->unwrappedDimensions, .elementIndex = context->layoutElements.length - 1 });
+    textElement->childrenOrTextContent.textElementData = Clay__TextElementDataArray_Add(&context->textElementData, CLAY__INIT(Clay__TextElementData) { .text = text, .preferredDimensions = textMeasured->unwrappedDimensions, .elementIndex = context->layoutElements.length - 1, .contentHash = contentHash, .stringHandle = stringHandle, .stringVersion = stringVersion });
     textElement->elementConfigs = CLAY__INIT(Clay__ElementConfigArraySlice) {
             .length = 1,
             .internalArray = Clay__ElementConfigArray_Add(&context->elementConfigs, CLAY__INIT(Clay_ElementConfig) { .type = CLAY__ELEMENT_CONFIG_TYPE_TEXT, .config = { .textElementConfig = textConfig }})
@@ -2015,6 +2728,14 @@ void Clay__OpenTextElement(Clay_String text, Clay_TextElementConfig *textConfig)
     parentElement->childrenOrTextContent.children.length++;
 }
 
+void Clay__OpenTextElement(Clay_String text, Clay_TextElementConfig *textConfig) {
+    Clay__DeclareTextElement(text, textConfig, false, 0, 0);
+}
+
+void Clay__OpenTextElementWithVersion(Clay_String text, uint32_t contentId, uint32_t contentVersion, Clay_TextElementConfig *textConfig) {
+    Clay__DeclareTextElement(text, textConfig, true, contentId, contentVersion);
+}
+
 Clay_ElementId Clay__AttachId(Clay_ElementId elementId) {
     Clay_Context* context = Clay_GetCurrentContext();
     if (context->booleanWarnings.maxElementsExceeded) {
@@ -2028,8 +2749,131 @@ Clay_ElementId Clay__AttachId(Clay_ElementId elementId) {
     return elementId;
 }
 
+// The Clay_TransitionProperty flag that controls each transition channel
+static const uint8_t Clay__transitionChannelProperties[CLAY__TRANSITION_CHANNEL_COUNT] = {
+    CLAY_TRANSITION_PROPERTY_BACKGROUND_COLOR,
+    CLAY_TRANSITION_PROPERTY_BACKGROUND_COLOR,
+    CLAY_TRANSITION_PROPERTY_BACKGROUND_COLOR,
+    CLAY_TRANSITION_PROPERTY_BACKGROUND_COLOR,
+    CLAY_TRANSITION_PROPERTY_OPACITY,
+    CLAY_TRANSITION_PROPERTY_OFFSET,
+    CLAY_TRANSITION_PROPERTY_OFFSET,
+    CLAY_TRANSITION_PROPERTY_SIZE,
+    CLAY_TRANSITION_PROPERTY_SIZE,
+};
+
+float Clay__GetTransitionValue(int32_t transitionIndex, Clay__TransitionChannel channel) {
+    Clay__TransitionData *transitions = &Clay_GetCurrentContext()->transitions;
+    return transitions->current.internalArray[channel * transitions->elementIds.capacity + transitionIndex];
+}
+
+// Hashes every declared property of an element that can change sizing, positioning, or which render commands are generated.
+// Anything not hashed here is paint only, and can be updated by patching the previous frame's render commands.
+void Clay__HashGridTrack(Clay_GridTrack track) {
+    Clay__HashLayoutInput((uint32_t)track.type);
+    Clay__HashLayoutInputFloat(track.size.minMax.min); // Shares its bits with .fraction
+    Clay__HashLayoutInputFloat(track.size.minMax.max);
+}
+
+void Clay__HashElementLayoutInputs(Clay_LayoutElement *layoutElement, const Clay_ElementDeclaration *declaration) {
+    Clay_LayoutConfig *layoutConfig = layoutElement->layoutConfig;
+    Clay__HashLayoutInput(layoutElement->id);
+    Clay__HashLayoutInputFloat(layoutConfig->sizing.width.size.minMax.min);
+    Clay__HashLayoutInputFloat(layoutConfig->sizing.width.size.minMax.max);
+    Clay__HashLayoutInputFloat(layoutConfig->sizing.height.size.minMax.min);
+    Clay__HashLayoutInputFloat(layoutConfig->sizing.height.size.minMax.max);
+    Clay__HashLayoutInput((uint32_t)layoutConfig->sizing.width.type | ((uint32_t)layoutConfig->sizing.height.type << 8) | ((uint32_t)layoutConfig->layoutDirection << 16));
+    Clay__HashLayoutInput((uint32_t)layoutConfig->padding.left | ((uint32_t)layoutConfig->padding.right << 16));
+    Clay__HashLayoutInput((uint32_t)layoutConfig->padding.top | ((uint32_t)layoutConfig->padding.bottom << 16));
+    Clay__HashLayoutInput((uint32_t)layoutConfig->childGap | ((uint32_t)layoutConfig->childAlignment.x << 16) | ((uint32_t)layoutConfig->childAlignment.y << 24));
+    if (layoutConfig->layoutDirection == CLAY_GRID) {
+        Clay_GridLayout grid = layoutConfig->grid;
+        Clay__HashLayoutInput((uint32_t)grid.columnCount | ((uint32_t)grid.rowCount << 16));
+        Clay__HashLayoutInput((uint32_t)(grid.columns != CLAY__NULL) | ((uint32_t)(grid.rows != CLAY__NULL) << 1));
+        for (int32_t i = 0; grid.columns && i < grid.columnCount; ++i) {
+            Clay__HashGridTrack(grid.columns[i]);
+        }
+        for (int32_t i = 0; grid.rows && i < grid.rowCount; ++i) {
+            Clay__HashGridTrack(grid.rows[i]);
+        }
+    }
+
+    // The set of attached configs, and whether a background rectangle and borders between children will be drawn, decide which render commands exist
+    uint32_t renderedFeatures = 0;
+    for (int32_t i = 0; i < layoutElement->elementConfigs.length; ++i) {
+        renderedFeatures |= 1u << Clay__ElementConfigArraySlice_Get(&layoutElement->elementConfigs, i)->type;
+    }
+    renderedFeatures |= (uint32_t)(declaration->backgroundColor.a > 0) << 16;
+    renderedFeatures |= (uint32_t)(declaration->border.color.a > 0) << 17;
+    Clay__HashLayoutInput(renderedFeatures);
+    Clay__HashLayoutInput(declaration->border.width.betweenChildren);
+
+    if (declaration->aspectRatio.aspectRatio > 0) {
+        Clay__HashLayoutInputFloat(declaration->aspectRatio.aspectRatio);
+    }
+    if (declaration->floating.attachTo != CLAY_ATTACH_TO_NONE) {
+        Clay_FloatingElementConfig floating = declaration->floating;
+        Clay__HashLayoutInputFloat(floating.offset.x);
+        Clay__HashLayoutInputFloat(floating.offset.y);
+        Clay__HashLayoutInputFloat(floating.expand.width);
+        Clay__HashLayoutInputFloat(floating.expand.height);
+        Clay__HashLayoutInput(floating.parentId);
+        Clay__HashLayoutInput((uint32_t)floating.zIndex);
+        Clay__HashLayoutInput((uint32_t)floating.attachPoints.element | ((uint32_t)floating.attachPoints.parent << 8) | ((uint32_t)floating.attachTo << 16) | ((uint32_t)floating.clipTo << 24));
+    }
+    if (declaration->clip.horizontal | declaration->clip.vertical) {
+        Clay__HashLayoutInput((uint32_t)declaration->clip.horizontal | ((uint32_t)declaration->clip.vertical << 1));
+        Clay__HashLayoutInputFloat(declaration->clip.childOffset.x);
+        Clay__HashLayoutInputFloat(declaration->clip.childOffset.y);
+    }
+
+    Clay_TransitionElementConfig *transitionConfig = Clay__FindElementConfigWithType(layoutElement, CLAY__ELEMENT_CONFIG_TYPE_TRANSITION).transitionElementConfig;
+    if (transitionConfig) {
+        Clay_LayoutElementHashMapItem *hashMapItem = Clay__GetHashMapItem(layoutElement->id);
+        int32_t transitionIndex = hashMapItem != &Clay_LayoutElementHashMapItem_DEFAULT ? hashMapItem->transitionIndex : -1;
+        Clay__HashLayoutInput((uint32_t)transitionConfig->properties | ((uint32_t)(transitionIndex >= 0) << 8));
+        if (transitionIndex >= 0) {
+            // Transitioning colors are paint only, unless they cross the threshold of being fully transparent
+            if (transitionConfig->properties & (CLAY_TRANSITION_PROPERTY_BACKGROUND_COLOR | CLAY_TRANSITION_PROPERTY_OPACITY)) {
+                float alpha = (transitionConfig->properties & CLAY_TRANSITION_PROPERTY_BACKGROUND_COLOR) ? Clay__GetTransitionValue(transitionIndex, CLAY__TRANSITION_CHANNEL_COLOR_A) : declaration->backgroundColor.a;
+                if (transitionConfig->properties & CLAY_TRANSITION_PROPERTY_OPACITY) {
+                    alpha *= Clay__GetTransitionValue(transitionIndex, CLAY__TRANSITION_CHANNEL_OPACITY);
+                }
+                Clay__HashLayoutInput(alpha > 0);
+            }
+            if (transitionConfig->properties & CLAY_TRANSITION_PROPERTY_OFFSET) {
+                Clay__HashLayoutInputFloat(Clay__GetTransitionValue(transitionIndex, CLAY__TRANSITION_CHANNEL_OFFSET_X));
+                Clay__HashLayoutInputFloat(Clay__GetTransitionValue(transitionIndex, CLAY__TRANSITION_CHANNEL_OFFSET_Y));
+            }
+            if (transitionConfig->properties & CLAY_TRANSITION_PROPERTY_SIZE) {
+                Clay__HashLayoutInputFloat(Clay__GetTransitionValue(transitionIndex, CLAY__TRANSITION_CHANNEL_WIDTH));
+                Clay__HashLayoutInputFloat(Clay__GetTransitionValue(transitionIndex, CLAY__TRANSITION_CHANNEL_HEIGHT));
+            }
+        }
+    }
+}
+
 void Clay__ConfigureOpenElementPtr(const Clay_ElementDeclaration *declaration) {
     Clay_Context* context = Clay_GetCurrentContext();
+    if (Clay__MemoRecording(context)) {
+        Clay_String idString = declaration->id.stringId;
+        Clay_GridLayout grid = declaration->layout.grid;
+        int32_t columnCount = declaration->layout.layoutDirection == CLAY_GRID && grid.columns ? grid.columnCount : 0;
+        int32_t rowCount = declaration->layout.layoutDirection == CLAY_GRID && grid.rows ? grid.rowCount : 0;
+        Clay_ElementDeclaration *op = (Clay_ElementDeclaration *)Clay__RecordMemoOp(CLAY__MEMO_OP_CONFIGURE_ELEMENT, sizeof(Clay_ElementDeclaration) + (columnCount + rowCount) * sizeof(Clay_GridTrack), &idString);
+        if (op) {
+            *op = *declaration;
+            ((Clay__MemoOpHeader *)op - 1)->scrollOffsetQueried = context->memoScrollOffsetQueried;
+            Clay_GridTrack *tracks = (Clay_GridTrack *)(op + 1);
+            for (int32_t i = 0; i < columnCount; ++i) {
+                tracks[i] = grid.columns[i];
+            }
+            for (int32_t i = 0; i < rowCount; ++i) {
+                tracks[columnCount + i] = grid.rows[i];
+            }
+        }
+    }
+    context->memoScrollOffsetQueried = false;
     Clay_LayoutElement *openLayoutElement = Clay__GetOpenLayoutElement();
     openLayoutElement->layoutConfig = Clay__StoreLayoutConfig(declaration->layout);
     if ((declaration->layout.sizing.width.type == CLAY__SIZING_TYPE_PERCENT && declaration->layout.sizing.width.size.percent > 1) || (declaration->layout.sizing.height.type == CLAY__SIZING_TYPE_PERCENT && declaration->layout.sizing.height.size.percent > 1)) {
@@ -2043,7 +2887,9 @@ void Clay__ConfigureOpenElementPtr(const Clay_ElementDeclaration *declaration) {
 
     openLayoutElement->elementConfigs.internalArray = &context->elementConfigs.internalArray[context->elementConfigs.length];
     Clay_SharedElementConfig *sharedConfig = NULL;
-    if (declaration->backgroundColor.a > 0) {
+    bool hasTransition = declaration->transition.duration > 0 && declaration->transition.properties != CLAY_TRANSITION_PROPERTY_NONE;
+    // Elements that transition their background color need a shared config even while fully transparent, so the rectangle can fade in
+    if (declaration->backgroundColor.a > 0 || (hasTransition && (declaration->transition.properties & CLAY_TRANSITION_PROPERTY_BACKGROUND_COLOR))) {
         sharedConfig = Clay__StoreSharedElementConfig(CLAY__INIT(Clay_SharedElementConfig) { .backgroundColor = declaration->backgroundColor });
         Clay__AttachElementConfig(CLAY__INIT(Clay_ElementConfigUnion) { .sharedElementConfig = sharedConfig }, CLAY__ELEMENT_CONFIG_TYPE_SHARED);
     }
@@ -2070,6 +2916,9 @@ void Clay__ConfigureOpenElementPtr(const Clay_ElementDeclaration *declaration) {
         Clay__AttachElementConfig(CLAY__INIT(Clay_ElementConfigUnion) { .aspectRatioElementConfig = Clay__StoreAspectRatioElementConfig(declaration->aspectRatio) }, CLAY__ELEMENT_CONFIG_TYPE_ASPECT);
         Clay__int32_tArray_Add(&context->aspectRatioElementIndexes, context->layoutElements.length - 1);
     }
+    if (declaration->layout.layoutDirection == CLAY_GRID) {
+        Clay__int32_tArray_Add(&context->gridElementIndexes, context->layoutElements.length - 1);
+    }
     if (declaration->floating.attachTo != CLAY_ATTACH_TO_NONE) {
         Clay_FloatingElementConfig floatingConfig = declaration->floating;
         // This looks dodgy but because of the auto generated root element the depth of the tree will always be at least 2 here
@@ -2116,6 +2965,10 @@ void Clay__ConfigureOpenElementPtr(const Clay_ElementDeclaration *declaration) {
     if (declaration->custom.customData) {
         Clay__AttachElementConfig(CLAY__INIT(Clay_ElementConfigUnion) { .customElementConfig = Clay__StoreCustomElementConfig(declaration->custom) }, CLAY__ELEMENT_CONFIG_TYPE_CUSTOM);
     }
+    if (hasTransition) {
+        Clay__AttachElementConfig(CLAY__INIT(Clay_ElementConfigUnion) { .transitionElementConfig = Clay__StoreTransitionElementConfig(declaration->transition) }, CLAY__ELEMENT_CONFIG_TYPE_TRANSITION);
+        Clay__int32_tArray_Add(&context->transitionElementIndexes, context->layoutElements.length - 1);
+    }
 
     if (openLayoutElementId.id != 0) {
         Clay__AttachId(openLayoutElementId);
@@ -2146,12 +2999,126 @@ void Clay__ConfigureOpenElementPtr(const Clay_ElementDeclaration *declaration) {
     if (!Clay__MemCmp((char *)(&declaration->border.width), (char *)(&Clay__BorderWidth_DEFAULT), sizeof(Clay_BorderWidth))) {
         Clay__AttachElementConfig(CLAY__INIT(Clay_ElementConfigUnion) { .borderElementConfig = Clay__StoreBorderElementConfig(declaration->border) }, CLAY__ELEMENT_CONFIG_TYPE_BORDER);
     }
+    Clay__HashElementLayoutInputs(openLayoutElement, declaration);
 }
 
 void Clay__ConfigureOpenElement(const Clay_ElementDeclaration declaration) {
     Clay__ConfigureOpenElementPtr(&declaration);
 }
 
+void Clay__ReplayMemoOps(int32_t start, int32_t end) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    context->memoReplaying = true;
+    for (int32_t offset = start; offset < end;) {
+        Clay__MemoOpHeader *header = (Clay__MemoOpHeader *)(context->memoOps.internalArray + offset);
+        offset += header->size;
+        switch (header->type) {
+            case CLAY__MEMO_OP_OPEN_ELEMENT: Clay__OpenElement(); break;
+            case CLAY__MEMO_OP_CLOSE_ELEMENT: Clay__CloseElement(); break;
+            case CLAY__MEMO_OP_CONFIGURE_ELEMENT: {
+                Clay_ElementDeclaration declaration = *(Clay_ElementDeclaration *)(header + 1);
+                const Clay_GridTrack *tracks = (const Clay_GridTrack *)((Clay_ElementDeclaration *)(header + 1) + 1);
+                if (declaration.layout.layoutDirection == CLAY_GRID) {
+                    if (declaration.layout.grid.columns) {
+                        declaration.layout.grid.columns = tracks;
+                        tracks += declaration.layout.grid.columnCount;
+                    }
+                    if (declaration.layout.grid.rows) {
+                        declaration.layout.grid.rows = tracks;
+                        tracks += declaration.layout.grid.rowCount;
+                    }
+                }
+                if (header->hasInlineString) {
+                    declaration.id.stringId.chars = (const char *)tracks;
+                }
+                if (header->scrollOffsetQueried) {
+                    declaration.clip.childOffset = Clay_GetScrollOffset();
+                }
+                Clay__ConfigureOpenElementPtr(&declaration);
+                break;
+            }
+            case CLAY__MEMO_OP_TEXT: {
+                Clay__MemoTextOp *op = (Clay__MemoTextOp *)(header + 1);
+                Clay_String text = op->text;
+                if (header->hasInlineString) {
+                    text.chars = (const char *)(op + 1);
+                }
+                Clay__DeclareTextElement(text, Clay__StoreTextElementConfig(op->config), op->versioned, op->contentId, op->contentVersion);
+                break;
+            }
+            case CLAY__MEMO_OP_ON_HOVER: {
+                Clay__MemoOnHoverOp *op = (Clay__MemoOnHoverOp *)(header + 1);
+                Clay_OnHover(op->onHoverFunction, op->userData);
+                break;
+            }
+        }
+    }
+    context->memoReplaying = false;
+}
+
+// Returns true if the body of the CLAY_MEMO() block needs to run, or false if the previous frame's recording was replayed instead
+bool Clay__BeginMemo(Clay_ElementId key, uint32_t dependencyHash) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    if (context->booleanWarnings.maxElementsExceeded) {
+        return true;
+    }
+    int32_t entryIndex = context->memoEntriesHashMap.internalArray[key.id % context->memoEntriesHashMap.capacity];
+    while (entryIndex != -1) {
+        Clay__MemoEntry *previous = &context->previousMemoEntries.internalArray[entryIndex];
+        if (previous->id == key.id && previous->dependencyHash == dependencyHash) {
+            break;
+        }
+        entryIndex = previous->nextIndex;
+    }
+    if (entryIndex != -1) {
+        Clay__MemoEntry previous = context->previousMemoEntries.internalArray[entryIndex];
+        int32_t length = previous.end - previous.start;
+        if (context->memoOps.length + length <= context->memoOps.capacity && context->memoEntries.length < context->memoEntries.capacity) {
+            // The recording is position independent, so it is copied in bulk and becomes part of any enclosing recording as is
+            int32_t start = context->memoOps.length;
+            char *destination = context->memoOps.internalArray + start;
+            const char *source = context->previousMemoOps.internalArray + previous.start;
+            for (int32_t i = 0; i < length; ++i) {
+                destination[i] = source[i];
+            }
+            context->memoOps.length += length;
+            // Entries are stored in the order their blocks ended, so nested blocks are the ones directly before this one that start inside it.
+            // Carrying them over keeps them available for replay if this block's dependencies change next frame
+            int32_t firstNested = entryIndex;
+            while (firstNested > 0 && context->previousMemoEntries.internalArray[firstNested - 1].start >= previous.start) {
+                firstNested--;
+            }
+            for (int32_t i = firstNested; i < entryIndex && context->memoEntries.length < context->memoEntries.capacity - 1; ++i) {
+                Clay__MemoEntry nested = context->previousMemoEntries.internalArray[i];
+                nested.start += start - previous.start;
+                nested.end += start - previous.start;
+                Clay__MemoEntryArray_Add(&context->memoEntries, nested);
+            }
+            Clay__MemoEntryArray_Add(&context->memoEntries, CLAY__INIT(Clay__MemoEntry) { .id = key.id, .dependencyHash = dependencyHash, .start = start, .end = start + length });
+            Clay__ReplayMemoOps(start, start + length);
+            return false;
+        }
+    }
+    if (context->memoStack.length < context->memoStack.capacity) {
+        Clay__MemoEntryArray_Add(&context->memoStack, CLAY__INIT(Clay__MemoEntry) { .id = key.id, .dependencyHash = dependencyHash, .start = context->memoOps.length });
+    } else {
+        context->memoStack.internalArray[context->memoStack.length - 1].start = -1;
+    }
+    return true;
+}
+
+void Clay__EndMemo(void) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    if (context->memoStack.length == 0) {
+        return;
+    }
+    Clay__MemoEntry entry = context->memoStack.internalArray[--context->memoStack.length];
+    if (entry.start >= 0 && context->memoEntries.length < context->memoEntries.capacity) {
+        entry.end = context->memoOps.length;
+        Clay__MemoEntryArray_Add(&context->memoEntries, entry);
+    }
+}
+
 void Clay__InitializeEphemeralMemory(Clay_Context* context) {
     int32_t maxElementCount = context->maxElementCount;
     // Ephemeral Memory - reset every frame
@@ -2172,6 +3139,7 @@ void Clay__InitializeEphemeralMemory(Clay_Context* context) {
     context->customElementConfigs = Clay__CustomElementConfigArray_Allocate_Arena(maxElementCount, arena);
     context->borderElementConfigs = Clay__BorderElementConfigArray_Allocate_Arena(maxElementCount, arena);
     context->sharedElementConfigs = Clay__SharedElementConfigArray_Allocate_Arena(maxElementCount, arena);
+    context->transitionElementConfigs = Clay__TransitionElementConfigArray_Allocate_Arena(maxElementCount, arena);
 
     context->layoutElementIdStrings = Clay__StringArray_Allocate_Arena(maxElementCount, arena);
     context->wrappedTextLines = Clay__WrappedTextLineArray_Allocate_Arena(maxElementCount, arena);
@@ -2181,7 +3149,8 @@ void Clay__InitializeEphemeralMemory(Clay_Context* context) {
     context->openLayoutElementStack = Clay__int32_tArray_Allocate_Arena(maxElementCount, arena);
     context->textElementData = Clay__TextElementDataArray_Allocate_Arena(maxElementCount, arena);
     context->aspectRatioElementIndexes = Clay__int32_tArray_Allocate_Arena(maxElementCount, arena);
-    context->renderCommands = Clay_RenderCommandArray_Allocate_Arena(maxElementCount, arena);
+    context->transitionElementIndexes = Clay__int32_tArray_Allocate_Arena(maxElementCount, arena);
+    context->gridElementIndexes = Clay__int32_tArray_Allocate_Arena(maxElementCount, arena);
     context->treeNodeVisited = Clay__boolArray_Allocate_Arena(maxElementCount, arena);
     context->treeNodeVisited.length = context->treeNodeVisited.capacity; // This array is accessed directly rather than behaving as a list
     context->openClipElementStack = Clay__int32_tArray_Allocate_Arena(maxElementCount, arena);
@@ -2190,6 +3159,20 @@ void Clay__InitializeEphemeralMemory(Clay_Context* context) {
     context->dynamicStringData = Clay__charArray_Allocate_Arena(maxElementCount, arena);
 }
 
+void Clay__InitializeTransitionData(Clay__TransitionData *transitions, int32_t maxTransitionCount, Clay_Arena *arena) {
+    transitions->elementIds = Clay__uint32_tArray_Allocate_Arena(maxTransitionCount, arena);
+    transitions->generations = Clay__uint32_tArray_Allocate_Arena(maxTransitionCount, arena);
+    transitions->progress = Clay__floatArray_Allocate_Arena(maxTransitionCount, arena);
+    transitions->inverseDuration = Clay__floatArray_Allocate_Arena(maxTransitionCount, arena);
+    transitions->easingLinear = Clay__floatArray_Allocate_Arena(maxTransitionCount, arena);
+    transitions->easingQuadratic = Clay__floatArray_Allocate_Arena(maxTransitionCount, arena);
+    transitions->easingCubic = Clay__floatArray_Allocate_Arena(maxTransitionCount, arena);
+    transitions->eased = Clay__floatArray_Allocate_Arena(maxTransitionCount, arena);
+    transitions->from = Clay__floatArray_Allocate_Arena(maxTransitionCount * CLAY__TRANSITION_CHANNEL_COUNT, arena);
+    transitions->to = Clay__floatArray_Allocate_Arena(maxTransitionCount * CLAY__TRANSITION_CHANNEL_COUNT, arena);
+    transitions->current = Clay__floatArray_Allocate_Arena(maxTransitionCount * CLAY__TRANSITION_CHANNEL_COUNT, arena);
+}
+
 void Clay__InitializePersistentMemory(Clay_Context* context) {
     // Persistent memory - initialized once and not reset
     int32_t maxElementCount = context->maxElementCount;
@@ -2206,6 +3189,38 @@ void Clay__InitializePersistentMemory(Clay_Context* context) {
     context->measuredWords = Clay__MeasuredWordArray_Allocate_Arena(maxMeasureTextCacheWordCount, arena);
     context->pointerOverIds = Clay_ElementIdArray_Allocate_Arena(maxElementCount, arena);
     context->debugElementData = Clay__DebugElementDataArray_Allocate_Arena(maxElementCount, arena);
+    Clay__InitializeTransitionData(&context->transitions, context->maxTransitionCount, arena);
+    context->gridDatas = Clay__GridDataArray_Allocate_Arena(maxElementCount, arena);
+    // Grids have at most as many rows as children, so this only runs out if grids declare many more columns than children
+    context->gridTracks = Clay__GridTrackDataArray_Allocate_Arena(maxElementCount * 2, arena);
+    context->geometryIds = Clay__uint32_tArray_Allocate_Arena(maxElementCount, arena);
+    context->geometryX = Clay__floatArray_Allocate_Arena(maxElementCount, arena);
+    context->geometryY = Clay__floatArray_Allocate_Arena(maxElementCount, arena);
+    context->geometryWidths = Clay__floatArray_Allocate_Arena(maxElementCount, arena);
+    context->geometryHeights = Clay__floatArray_Allocate_Arena(maxElementCount, arena);
+    context->geometryParents = Clay__int32_tArray_Allocate_Arena(maxElementCount, arena);
+    context->geometrySubtreeEnds = Clay__int32_tArray_Allocate_Arena(maxElementCount, arena);
+    // Render commands are retained across frames so that paint only changes can be patched in place
+    context->renderCommands = Clay_RenderCommandArray_Allocate_Arena(maxElementCount, arena);
+    context->renderCommandSources = Clay__RenderCommandSourceArray_Allocate_Arena(maxElementCount, arena);
+    context->previousLayoutElementDimensions = Clay__DimensionsArray_Allocate_Arena(maxElementCount, arena);
+    context->renderCommandUpdates = Clay__int32_tArray_Allocate_Arena(maxElementCount, arena);
+    context->damageRecords = Clay__DamageRecordArray_Allocate_Arena(maxElementCount, arena);
+    context->previousDamageRecords = Clay__DamageRecordArray_Allocate_Arena(maxElementCount, arena);
+    context->damageRecordsHashMap = Clay__int32_tArray_Allocate_Arena(maxElementCount, arena);
+    context->memoOps = Clay__charArray_Allocate_Arena(context->maxMemoBytes, arena);
+    context->previousMemoOps = Clay__charArray_Allocate_Arena(context->maxMemoBytes, arena);
+    context->memoEntries = Clay__MemoEntryArray_Allocate_Arena(maxElementCount, arena);
+    context->previousMemoEntries = Clay__MemoEntryArray_Allocate_Arena(maxElementCount, arena);
+    context->memoEntriesHashMap = Clay__int32_tArray_Allocate_Arena(maxElementCount, arena);
+    context->memoStack = Clay__MemoEntryArray_Allocate_Arena(maxElementCount, arena);
+    context->stringStoreBytes = Clay__charArray_Allocate_Arena(context->maxStringStoreBytes, arena);
+    context->storedStrings = Clay__StoredStringArray_Allocate_Arena(maxElementCount, arena);
+    context->storedStringsFreeList = Clay__int32_tArray_Allocate_Arena(maxElementCount, arena);
+    context->storedStringsHashMap = Clay__int32_tArray_Allocate_Arena(maxElementCount, arena);
+    context->damageClipStack = Clay_DamageRectArray_Allocate_Arena(maxElementCount, arena);
+    // Every changed record can damage both its old and new position, and a custom command also damages its whole visible box up front
+    context->damageRects = Clay_DamageRectArray_Allocate_Arena(maxElementCount * 3 + 1, arena);
     context->arenaResetOffset = arena->nextAllocation;
 }
 
@@ -2216,23 +3231,327 @@ bool Clay__FloatEqual(float left, float right) {
     return subtracted < CLAY__EPSILON && subtracted > -CLAY__EPSILON;
 }
 
-void Clay__SizeContainersAlongAxis(bool xAxis) {
-    Clay_Context* context = Clay_GetCurrentContext();
-    Clay__int32_tArray bfsBuffer = context->layoutElementChildrenBuffer;
-    Clay__int32_tArray resizableContainerBuffer = context->openLayoutElementStack;
-    for (int32_t rootIndex = 0; rootIndex < context->layoutElementTreeRoots.length; ++rootIndex) {
-        bfsBuffer.length = 0;
-        Clay__LayoutElementTreeRoot *root = Clay__LayoutElementTreeRootArray_Get(&context->layoutElementTreeRoots, rootIndex);
-        Clay_LayoutElement *rootElement = Clay_LayoutElementArray_Get(&context->layoutElements, (int)root->layoutElementIndex);
-        Clay__int32_tArray_Add(&bfsBuffer, (int32_t)root->layoutElementIndex);
+// The value that size distribution operates on for an element. Compressing negates sizes and uses minimum sizes as limits,
+// so that shrinking the largest elements down towards their minimums is the same problem as growing the smallest up towards their maximums.
+float Clay__GetDistributionKey(int32_t elementIndex, bool xAxis, bool compress, bool limit) {
+    Clay_LayoutElement *element = Clay_LayoutElementArray_Get(&Clay_GetCurrentContext()->layoutElements, elementIndex);
+    float value;
+    if (!limit) {
+        value = xAxis ? element->dimensions.width : element->dimensions.height;
+    } else if (compress) {
+        value = xAxis ? element->minDimensions.width : element->minDimensions.height;
+    } else {
+        value = xAxis ? element->layoutConfig->sizing.width.size.minMax.max : element->layoutConfig->sizing.height.size.minMax.max;
+    }
+    return compress ? -value : value;
+}
 
-        // Size floating containers to their parents
-        if (Clay__ElementHasConfig(rootElement, CLAY__ELEMENT_CONFIG_TYPE_FLOATING)) {
-            Clay_FloatingElementConfig *floatingElementConfig = Clay__FindElementConfigWithType(rootElement, CLAY__ELEMENT_CONFIG_TYPE_FLOATING).floatingElementConfig;
-            Clay_LayoutElementHashMapItem *parentItem = Clay__GetHashMapItem(floatingElementConfig->parentId);
-            if (parentItem && parentItem != &Clay_LayoutElementHashMapItem_DEFAULT) {
-                Clay_LayoutElement *parentLayoutElement = parentItem->layoutElement;
-                switch (rootElement->layoutConfig->sizing.width.type) {
+void Clay__SiftDownByDistributionKey(int32_t *indexes, int32_t root, int32_t end, bool xAxis, bool compress, bool limit) {
+    while (root * 2 + 1 < end) {
+        int32_t child = root * 2 + 1;
+        if (child + 1 < end && Clay__GetDistributionKey(indexes[child + 1], xAxis, compress, limit) > Clay__GetDistributionKey(indexes[child], xAxis, compress, limit)) {
+            child++;
+        }
+        if (Clay__GetDistributionKey(indexes[child], xAxis, compress, limit) <= Clay__GetDistributionKey(indexes[root], xAxis, compress, limit)) {
+            return;
+        }
+        int32_t temp = indexes[root];
+        indexes[root] = indexes[child];
+        indexes[child] = temp;
+        root = child;
+    }
+}
+
+// In place heap sort of element indexes in ascending key order
+void Clay__SortByDistributionKey(Clay__int32_tArray *elements, bool xAxis, bool compress, bool limit) {
+    int32_t *indexes = elements->internalArray;
+    for (int32_t root = elements->length / 2 - 1; root >= 0; --root) {
+        Clay__SiftDownByDistributionKey(indexes, root, elements->length, xAxis, compress, limit);
+    }
+    for (int32_t end = elements->length - 1; end > 0; --end) {
+        int32_t temp = indexes[0];
+        indexes[0] = indexes[end];
+        indexes[end] = temp;
+        Clay__SiftDownByDistributionKey(indexes, 0, end, xAxis, compress, limit);
+    }
+}
+
+// Grows (or with compress, shrinks) elements by a total of amount along one axis by "water filling": the smallest elements are raised
+// together to a common level, elements join as the level reaches their size, and leave once they reach their limit.
+// Sweeping both sorted orders gives the level directly in O(n log n), rather than resolving one distinct size per pass over the children.
+void Clay__DistributeSizeAlongAxis(Clay__int32_tArray *elements, Clay__int32_tArray *limitOrder, bool xAxis, bool compress, float amount) {
+    int32_t count = elements->length;
+    Clay__SortByDistributionKey(elements, xAxis, compress, false);
+    limitOrder->length = 0;
+    for (int32_t i = 0; i < count; ++i) {
+        Clay__int32_tArray_Add(limitOrder, elements->internalArray[i]);
+    }
+    Clay__SortByDistributionKey(limitOrder, xAxis, compress, true);
+
+    float level = Clay__GetDistributionKey(elements->internalArray[0], xAxis, compress, false);
+    int32_t activeCount = 0;
+    int32_t nextStart = 0;
+    int32_t nextLimit = 0;
+    while (true) {
+        while (nextStart < count && Clay__GetDistributionKey(elements->internalArray[nextStart], xAxis, compress, false) <= level) {
+            float key = Clay__GetDistributionKey(elements->internalArray[nextStart], xAxis, compress, false);
+            float limit = Clay__GetDistributionKey(elements->internalArray[nextStart], xAxis, compress, true);
+            if (limit < key) {
+                // Already past its limit, e.g. smaller than its minimum size. It snaps to the limit as soon as it's reached, which adds to the amount
+                amount += key - limit;
+            } else {
+                activeCount++;
+            }
+            nextStart++;
+        }
+        // Elements that joined leave once the level reaches their limit, which can't happen before they joined
+        while (nextLimit < count && Clay__GetDistributionKey(limitOrder->internalArray[nextLimit], xAxis, compress, true) <= level) {
+            int32_t elementIndex = limitOrder->internalArray[nextLimit];
+            if (Clay__GetDistributionKey(elementIndex, xAxis, compress, true) >= Clay__GetDistributionKey(elementIndex, xAxis, compress, false)) {
+                activeCount--;
+            }
+            nextLimit++;
+        }
+        float nextLevel = CLAY__MAXFLOAT;
+        if (nextStart < count) {
+            nextLevel = Clay__GetDistributionKey(elements->internalArray[nextStart], xAxis, compress, false);
+        }
+        if (nextLimit < count) {
+            nextLevel = CLAY__MIN(nextLevel, Clay__GetDistributionKey(limitOrder->internalArray[nextLimit], xAxis, compress, true));
+        }
+        if (activeCount == 0) {
+            if (nextStart == count) {
+                break; // Every element has reached its limit
+            }
+            level = nextLevel;
+            continue;
+        }
+        float amountToNextLevel = (nextLevel - level) * (float)activeCount;
+        if (amount <= amountToNextLevel) {
+            level += amount / (float)activeCount;
+            break;
+        }
+        amount -= amountToNextLevel;
+        level = nextLevel;
+    }
+
+    for (int32_t i = 0; i < count; ++i) {
+        int32_t elementIndex = elements->internalArray[i];
+        float key = Clay__GetDistributionKey(elementIndex, xAxis, compress, false);
+        float limit = Clay__GetDistributionKey(elementIndex, xAxis, compress, true);
+        if (key < level || (limit < key && key <= level)) {
+            float newKey = CLAY__MIN(level, limit);
+            Clay_LayoutElement *element = Clay_LayoutElementArray_Get(&Clay_GetCurrentContext()->layoutElements, elementIndex);
+            *(xAxis ? &element->dimensions.width : &element->dimensions.height) = compress ? -newKey : newKey;
+        }
+    }
+}
+
+// Sizes each unsettled track as weight * level clamped to [lower, upper], choosing the level so that the tracks sum to totalSize.
+// When clamping leaves the tracks over or under the total, the tracks clamped in that direction are settled at their limit and the rest are solved again.
+void Clay__SolveGridTracks(Clay__GridTrackData *tracks, int32_t trackCount, float totalSize) {
+    for (int32_t iteration = 0; iteration <= trackCount; ++iteration) {
+        float remainingSize = totalSize;
+        float totalWeight = 0;
+        for (int32_t i = 0; i < trackCount; ++i) {
+            if (tracks[i].weight > 0) {
+                totalWeight += tracks[i].weight;
+            } else {
+                remainingSize -= tracks[i].size;
+            }
+        }
+        if (totalWeight <= 0) {
+            return;
+        }
+        float level = remainingSize / totalWeight;
+        float violation = 0;
+        for (int32_t i = 0; i < trackCount; ++i) {
+            if (tracks[i].weight > 0) {
+                float target = tracks[i].weight * level;
+                tracks[i].size = CLAY__MIN(CLAY__MAX(target, tracks[i].lower), tracks[i].upper);
+                violation += tracks[i].size - target;
+            }
+        }
+        if (Clay__FloatEqual(violation, 0)) {
+            return;
+        }
+        for (int32_t i = 0; i < trackCount; ++i) {
+            float target = tracks[i].weight * level;
+            if (tracks[i].weight > 0 && (violation > 0 ? target < tracks[i].lower : target > tracks[i].upper)) {
+                tracks[i].weight = 0;
+            }
+        }
+    }
+}
+
+// Reserves track storage for every grid declared this frame. It's kept until the next layout so that cells can be queried while declaring.
+void Clay__InitializeGridData(void) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    context->gridDatas.length = 0;
+    context->gridTracks.length = 0;
+    for (int32_t i = 0; i < context->gridElementIndexes.length; ++i) {
+        Clay_LayoutElement *gridElement = Clay_LayoutElementArray_Get(&context->layoutElements, Clay__int32_tArray_GetValue(&context->gridElementIndexes, i));
+        Clay_LayoutElementHashMapItem *hashMapItem = Clay__GetHashMapItem(gridElement->id);
+        if (hashMapItem == &Clay_LayoutElementHashMapItem_DEFAULT) {
+            continue;
+        }
+        int32_t columnCount = Clay__GetGridColumnCount(&gridElement->layoutConfig->grid);
+        int32_t rowCount = (gridElement->childrenOrTextContent.children.length + columnCount - 1) / columnCount;
+        if (context->gridTracks.length + columnCount + rowCount > context->gridTracks.capacity) {
+            hashMapItem->gridIndex = -1;
+            context->errorHandler.errorHandlerFunction(CLAY__INIT(Clay_ErrorData) {
+                    .errorType = CLAY_ERROR_TYPE_ELEMENTS_CAPACITY_EXCEEDED,
+                    .errorText = CLAY_STRING("Clay ran out of capacity while sizing grid columns and rows. Try declaring fewer empty grid columns, or increase the limit with Clay_SetMaxElementCount()."),
+                    .userData = context->errorHandler.userData });
+            continue;
+        }
+        hashMapItem->gridIndex = context->gridDatas.length;
+        Clay__GridDataArray_Add(&context->gridDatas, CLAY__INIT(Clay__GridData) {
+            .elementId = gridElement->id,
+            .columnCount = columnCount,
+            .rowCount = rowCount,
+            .tracksStart = context->gridTracks.length,
+            .childGap = (float)gridElement->layoutConfig->childGap,
+        });
+        context->gridTracks.length += columnCount + rowCount;
+    }
+}
+
+// Solves the sizes of a grid's columns, or of its rows if xAxis is false, then sizes its children to fit their cells
+void Clay__SizeGridAlongAxis(Clay_LayoutElement *gridElement, bool xAxis) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    Clay__GridData *gridData = Clay__GetGridData(gridElement->id);
+    if (!gridData) {
+        return;
+    }
+    Clay_LayoutConfig *layoutConfig = gridElement->layoutConfig;
+    int32_t childCount = gridElement->childrenOrTextContent.children.length;
+    int32_t trackCount = xAxis ? gridData->columnCount : gridData->rowCount;
+    Clay__GridTrackData *tracks = Clay__GridTrackDataArray_Get(&context->gridTracks, gridData->tracksStart + (xAxis ? 0 : gridData->columnCount));
+    float padding = (float)(xAxis ? (layoutConfig->padding.left + layoutConfig->padding.right) : (layoutConfig->padding.top + layoutConfig->padding.bottom));
+    float innerSize = (xAxis ? gridElement->dimensions.width : gridElement->dimensions.height) - padding - (float)(CLAY__MAX(trackCount - 1, 0) * layoutConfig->childGap);
+
+    // Wrap each track to its largest child, with lower holding the largest minimum size in case the tracks need to be compressed
+    for (int32_t trackIndex = 0; trackIndex < trackCount; ++trackIndex) {
+        tracks[trackIndex] = CLAY__INIT(Clay__GridTrackData) CLAY__DEFAULT_STRUCT;
+    }
+    for (int32_t i = 0; i < childCount; ++i) {
+        Clay_LayoutElement *child = Clay_LayoutElementArray_Get(&context->layoutElements, gridElement->childrenOrTextContent.children.elements[i]);
+        // Percentage children are sized relative to their cell, so they don't contribute to its size
+        if ((xAxis ? child->layoutConfig->sizing.width.type : child->layoutConfig->sizing.height.type) == CLAY__SIZING_TYPE_PERCENT) {
+            continue;
+        }
+        Clay__GridTrackData *track = &tracks[xAxis ? i % gridData->columnCount : i / gridData->columnCount];
+        track->size = CLAY__MAX(track->size, xAxis ? child->dimensions.width : child->dimensions.height);
+        track->lower = CLAY__MAX(track->lower, xAxis ? child->minDimensions.width : child->minDimensions.height);
+    }
+    float contentSize = 0;
+    for (int32_t trackIndex = 0; trackIndex < trackCount; ++trackIndex) {
+        Clay_GridTrack track = Clay__GetGridTrack(&layoutConfig->grid, xAxis, trackIndex);
+        float minSize = Clay__GetGridTrackMin(track);
+        float maxSize = Clay__GetGridTrackMax(track);
+        tracks[trackIndex].size = CLAY__MIN(CLAY__MAX(tracks[trackIndex].size, minSize), maxSize);
+        tracks[trackIndex].lower = CLAY__MIN(CLAY__MAX(tracks[trackIndex].lower, minSize), maxSize);
+        contentSize += tracks[trackIndex].size;
+    }
+
+    float sizeToDistribute = innerSize - contentSize;
+    // The content is too small, GROW and FRACTION tracks share the left over space
+    if (sizeToDistribute > CLAY__EPSILON) {
+        for (int32_t trackIndex = 0; trackIndex < trackCount; ++trackIndex) {
+            Clay_GridTrack track = Clay__GetGridTrack(&layoutConfig->grid, xAxis, trackIndex);
+            Clay__GridTrackData *trackData = &tracks[trackIndex];
+            trackData->lower = trackData->size;
+            trackData->upper = Clay__GetGridTrackMax(track);
+            trackData->weight = track.type == CLAY__GRID_TRACK_TYPE_GROW ? 1 : track.type == CLAY__GRID_TRACK_TYPE_FRACTION ? CLAY__MAX(track.size.fraction, 0) : 0;
+        }
+        Clay__SolveGridTracks(tracks, trackCount, innerSize);
+    // The content is too large, compress the largest tracks towards their minimums, unless the grid clips its content on this axis
+    } else if (sizeToDistribute < -CLAY__EPSILON) {
+        Clay_ClipElementConfig *clipElementConfig = Clay__FindElementConfigWithType(gridElement, CLAY__ELEMENT_CONFIG_TYPE_CLIP).clipElementConfig;
+        if (!clipElementConfig || !(xAxis ? clipElementConfig->horizontal : clipElementConfig->vertical)) {
+            for (int32_t trackIndex = 0; trackIndex < trackCount; ++trackIndex) {
+                Clay__GridTrackData *trackData = &tracks[trackIndex];
+                trackData->upper = trackData->size;
+                trackData->weight = Clay__GetGridTrack(&layoutConfig->grid, xAxis, trackIndex).type == CLAY__GRID_TRACK_TYPE_FIXED ? 0 : 1;
+            }
+            Clay__SolveGridTracks(tracks, trackCount, innerSize);
+        }
+    }
+
+    // Cell positions are the prefix sums of the track sizes
+    float offset = 0;
+    for (int32_t trackIndex = 0; trackIndex < trackCount; ++trackIndex) {
+        tracks[trackIndex].offset = offset;
+        offset += tracks[trackIndex].size + (float)layoutConfig->childGap;
+    }
+
+    for (int32_t i = 0; i < childCount; ++i) {
+        Clay_LayoutElement *child = Clay_LayoutElementArray_Get(&context->layoutElements, gridElement->childrenOrTextContent.children.elements[i]);
+        Clay_SizingAxis childSizing = xAxis ? child->layoutConfig->sizing.width : child->layoutConfig->sizing.height;
+        float *childSize = xAxis ? &child->dimensions.width : &child->dimensions.height;
+        float minSize = xAxis ? child->minDimensions.width : child->minDimensions.height;
+        float cellSize = tracks[xAxis ? i % gridData->columnCount : i / gridData->columnCount].size;
+        switch (childSizing.type) {
+            case CLAY__SIZING_TYPE_GROW: {
+                *childSize = CLAY__MAX(minSize, CLAY__MIN(cellSize, childSizing.size.minMax.max));
+                break;
+            }
+            case CLAY__SIZING_TYPE_PERCENT: {
+                *childSize = cellSize * childSizing.size.percent;
+                Clay__UpdateAspectRatioBox(child);
+                break;
+            }
+            case CLAY__SIZING_TYPE_FIT: {
+                // Children that can wrap or compress shrink to their cell, the same as they would inside a compressed parent
+                Clay_TextElementConfig *textConfig = Clay__FindElementConfigWithType(child, CLAY__ELEMENT_CONFIG_TYPE_TEXT).textElementConfig;
+                if (!textConfig || textConfig->wrapMode == CLAY_TEXT_WRAP_WORDS) {
+                    *childSize = CLAY__MAX(minSize, CLAY__MIN(*childSize, cellSize));
+                }
+                break;
+            }
+            default: break;
+        }
+    }
+}
+
+// Returns the screen position of a grid's child, aligned within its cell
+Clay_Vector2 Clay__GetGridChildPosition(Clay__GridData *gridData, int32_t childIndex, Clay_Dimensions childDimensions, Clay_ChildAlignment childAlignment) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    Clay__GridTrackData *column = Clay__GridTrackDataArray_Get(&context->gridTracks, gridData->tracksStart + childIndex % gridData->columnCount);
+    Clay__GridTrackData *row = Clay__GridTrackDataArray_Get(&context->gridTracks, gridData->tracksStart + gridData->columnCount + childIndex / gridData->columnCount);
+    Clay_Vector2 position = { gridData->origin.x + column->offset, gridData->origin.y + row->offset };
+    switch (childAlignment.x) {
+        case CLAY_ALIGN_X_LEFT: break;
+        case CLAY_ALIGN_X_CENTER: position.x += (column->size - childDimensions.width) / 2; break;
+        case CLAY_ALIGN_X_RIGHT: position.x += column->size - childDimensions.width; break;
+    }
+    switch (childAlignment.y) {
+        case CLAY_ALIGN_Y_TOP: break;
+        case CLAY_ALIGN_Y_CENTER: position.y += (row->size - childDimensions.height) / 2; break;
+        case CLAY_ALIGN_Y_BOTTOM: position.y += row->size - childDimensions.height; break;
+    }
+    return position;
+}
+
+void Clay__SizeContainersAlongAxis(bool xAxis) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    Clay__int32_tArray bfsBuffer = context->layoutElementChildrenBuffer;
+    Clay__int32_tArray resizableContainerBuffer = context->openLayoutElementStack;
+    Clay__int32_tArray limitOrderBuffer = context->reusableElementIndexBuffer;
+    for (int32_t rootIndex = 0; rootIndex < context->layoutElementTreeRoots.length; ++rootIndex) {
+        bfsBuffer.length = 0;
+        Clay__LayoutElementTreeRoot *root = Clay__LayoutElementTreeRootArray_Get(&context->layoutElementTreeRoots, rootIndex);
+        Clay_LayoutElement *rootElement = Clay_LayoutElementArray_Get(&context->layoutElements, (int)root->layoutElementIndex);
+        Clay__int32_tArray_Add(&bfsBuffer, (int32_t)root->layoutElementIndex);
+
+        // Size floating containers to their parents
+        if (Clay__ElementHasConfig(rootElement, CLAY__ELEMENT_CONFIG_TYPE_FLOATING)) {
+            Clay_FloatingElementConfig *floatingElementConfig = Clay__FindElementConfigWithType(rootElement, CLAY__ELEMENT_CONFIG_TYPE_FLOATING).floatingElementConfig;
+            Clay_LayoutElementHashMapItem *parentItem = Clay__GetHashMapItem(floatingElementConfig->parentId);
+            if (parentItem && parentItem != &Clay_LayoutElementHashMapItem_DEFAULT) {
+                Clay_LayoutElement *parentLayoutElement = parentItem->layoutElement;
+                switch (rootElement->layoutConfig->sizing.width.type) {
                     case CLAY__SIZING_TYPE_GROW: {
                         rootElement->dimensions.width = parentLayoutElement->dimensions.width;
                         break;
@@ -2268,6 +3587,17 @@ void Clay__SizeContainersAlongAxis(bool xAxis) {
             int32_t parentIndex = Clay__int32_tArray_GetValue(&bfsBuffer, i);
             Clay_LayoutElement *parent = Clay_LayoutElementArray_Get(&context->layoutElements, parentIndex);
             Clay_LayoutConfig *parentStyleConfig = parent->layoutConfig;
+            if (parentStyleConfig->layoutDirection == CLAY_GRID) {
+                for (int32_t childOffset = 0; childOffset < parent->childrenOrTextContent.children.length; childOffset++) {
+                    int32_t childElementIndex = parent->childrenOrTextContent.children.elements[childOffset];
+                    Clay_LayoutElement *childElement = Clay_LayoutElementArray_Get(&context->layoutElements, childElementIndex);
+                    if (!Clay__ElementHasConfig(childElement, CLAY__ELEMENT_CONFIG_TYPE_TEXT) && childElement->childrenOrTextContent.children.length > 0) {
+                        Clay__int32_tArray_Add(&bfsBuffer, childElementIndex);
+                    }
+                }
+                Clay__SizeGridAlongAxis(parent, xAxis);
+                continue;
+            }
             int32_t growContainerCount = 0;
             float parentSize = xAxis ? parent->dimensions.width : parent->dimensions.height;
             float parentPadding = (float)(xAxis ? (parent->layoutConfig->padding.left + parent->layoutConfig->padding.right) : (parent->layoutConfig->padding.top + parent->layoutConfig->padding.bottom));
@@ -2334,41 +3664,8 @@ void Clay__SizeContainersAlongAxis(bool xAxis) {
                             continue;
                         }
                     }
-                    // Scrolling containers preferentially compress before others
-                    while (sizeToDistribute < -CLAY__EPSILON && resizableContainerBuffer.length > 0) {
-                        float largest = 0;
-                        float secondLargest = 0;
-                        float widthToAdd = sizeToDistribute;
-                        for (int childIndex = 0; childIndex < resizableContainerBuffer.length; childIndex++) {
-                            Clay_LayoutElement *child = Clay_LayoutElementArray_Get(&context->layoutElements, Clay__int32_tArray_GetValue(&resizableContainerBuffer, childIndex));
-                            float childSize = xAxis ? child->dimensions.width : child->dimensions.height;
-                            if (Clay__FloatEqual(childSize, largest)) { continue; }
-                            if (childSize > largest) {
-                                secondLargest = largest;
-                                largest = childSize;
-                            }
-                            if (childSize < largest) {
-                                secondLargest = CLAY__MAX(secondLargest, childSize);
-                                widthToAdd = secondLargest - largest;
-                            }
-                        }
-
-                        widthToAdd = CLAY__MAX(widthToAdd, sizeToDistribute / resizableContainerBuffer.length);
-
-                        for (int childIndex = 0; childIndex < resizableContainerBuffer.length; childIndex++) {
-                            Clay_LayoutElement *child = Clay_LayoutElementArray_Get(&context->layoutElements, Clay__int32_tArray_GetValue(&resizableContainerBuffer, childIndex));
-                            float *childSize = xAxis ? &child->dimensions.width : &child->dimensions.height;
-                            float minSize = xAxis ? child->minDimensions.width : child->minDimensions.height;
-                            float previousWidth = *childSize;
-                            if (Clay__FloatEqual(*childSize, largest)) {
-                                *childSize += widthToAdd;
-                                if (*childSize <= minSize) {
-                                    *childSize = minSize;
-                                    Clay__int32_tArray_RemoveSwapback(&resizableContainerBuffer, childIndex--);
-                                }
-                                sizeToDistribute -= (*childSize - previousWidth);
-                            }
-                        }
+                    if (sizeToDistribute < -CLAY__EPSILON && resizableContainerBuffer.length > 0) {
+                        Clay__DistributeSizeAlongAxis(&resizableContainerBuffer, &limitOrderBuffer, xAxis, true, -sizeToDistribute);
                     }
                 // The content is too small, allow SIZING_GROW containers to expand
                 } else if (sizeToDistribute > 0 && growContainerCount > 0) {
@@ -2379,40 +3676,8 @@ void Clay__SizeContainersAlongAxis(bool xAxis) {
                             Clay__int32_tArray_RemoveSwapback(&resizableContainerBuffer, childIndex--);
                         }
                     }
-                    while (sizeToDistribute > CLAY__EPSILON && resizableContainerBuffer.length > 0) {
-                        float smallest = CLAY__MAXFLOAT;
-                        float secondSmallest = CLAY__MAXFLOAT;
-                        float widthToAdd = sizeToDistribute;
-                        for (int childIndex = 0; childIndex < resizableContainerBuffer.length; childIndex++) {
-                            Clay_LayoutElement *child = Clay_LayoutElementArray_Get(&context->layoutElements, Clay__int32_tArray_GetValue(&resizableContainerBuffer, childIndex));
-                            float childSize = xAxis ? child->dimensions.width : child->dimensions.height;
-                            if (Clay__FloatEqual(childSize, smallest)) { continue; }
-                            if (childSize < smallest) {
-                                secondSmallest = smallest;
-                                smallest = childSize;
-                            }
-                            if (childSize > smallest) {
-                                secondSmallest = CLAY__MIN(secondSmallest, childSize);
-                                widthToAdd = secondSmallest - smallest;
-                            }
-                        }
-
-                        widthToAdd = CLAY__MIN(widthToAdd, sizeToDistribute / resizableContainerBuffer.length);
-
-                        for (int childIndex = 0; childIndex < resizableContainerBuffer.length; childIndex++) {
-                            Clay_LayoutElement *child = Clay_LayoutElementArray_Get(&context->layoutElements, Clay__int32_tArray_GetValue(&resizableContainerBuffer, childIndex));
-                            float *childSize = xAxis ? &child->dimensions.width : &child->dimensions.height;
-                            float maxSize = xAxis ? child->layoutConfig->sizing.width.size.minMax.max : child->layoutConfig->sizing.height.size.minMax.max;
-                            float previousWidth = *childSize;
-                            if (Clay__FloatEqual(*childSize, smallest)) {
-                                *childSize += widthToAdd;
-                                if (*childSize >= maxSize) {
-                                    *childSize = maxSize;
-                                    Clay__int32_tArray_RemoveSwapback(&resizableContainerBuffer, childIndex--);
-                                }
-                                sizeToDistribute -= (*childSize - previousWidth);
-                            }
-                        }
+                    if (sizeToDistribute > CLAY__EPSILON && resizableContainerBuffer.length > 0) {
+                        Clay__DistributeSizeAlongAxis(&resizableContainerBuffer, &limitOrderBuffer, xAxis, false, sizeToDistribute);
                     }
                 }
             // Sizing along the non layout axis ("off axis")
@@ -2499,8 +3764,492 @@ bool Clay__ElementIsOffscreen(Clay_BoundingBox *boundingBox) {
            (boundingBox->y + boundingBox->height < 0);
 }
 
+// Retargets the retained transition state of an element with this frame's declared values, creating it if necessary.
+// Returns the index of the element's transition state, or -1 if it couldn't be stored.
+int32_t Clay__UpdateElementTransition(Clay_LayoutElementHashMapItem *hashMapItem, Clay_TransitionElementConfig *transitionConfig, Clay_Color backgroundColor, Clay_Dimensions dimensions) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    Clay__TransitionData *transitions = &context->transitions;
+    if (hashMapItem == &Clay_LayoutElementHashMapItem_DEFAULT) {
+        return -1;
+    }
+    int32_t capacity = transitions->elementIds.capacity;
+    float targets[CLAY__TRANSITION_CHANNEL_COUNT] = { backgroundColor.r, backgroundColor.g, backgroundColor.b, backgroundColor.a, transitionConfig->opacity, transitionConfig->offset.x, transitionConfig->offset.y, dimensions.width, dimensions.height };
+    int32_t transitionIndex = hashMapItem->transitionIndex;
+    if (transitionIndex < 0) {
+        if (transitions->elementIds.length == capacity) {
+            context->errorHandler.errorHandlerFunction(CLAY__INIT(Clay_ErrorData) {
+                    .errorType = CLAY_ERROR_TYPE_ELEMENTS_CAPACITY_EXCEEDED,
+                    .errorText = CLAY_STRING("Clay ran out of capacity while retaining element transitions. Try using Clay_SetMaxTransitionCount() with a higher value."),
+                    .userData = context->errorHandler.userData });
+            return -1;
+        }
+        // The first time an element is seen it starts at its target, there is nothing to animate from
+        transitionIndex = transitions->elementIds.length;
+        Clay__uint32_tArray_Add(&transitions->elementIds, hashMapItem->elementId.id);
+        hashMapItem->transitionIndex = transitionIndex;
+        for (int32_t channel = 0; channel < CLAY__TRANSITION_CHANNEL_COUNT; ++channel) {
+            int32_t valueIndex = channel * capacity + transitionIndex;
+            transitions->from.internalArray[valueIndex] = targets[channel];
+            transitions->to.internalArray[valueIndex] = targets[channel];
+            transitions->current.internalArray[valueIndex] = targets[channel];
+        }
+        transitions->progress.internalArray[transitionIndex] = 1;
+        transitions->eased.internalArray[transitionIndex] = 1;
+    } else {
+        bool targetChanged = false;
+        for (int32_t channel = 0; channel < CLAY__TRANSITION_CHANNEL_COUNT; ++channel) {
+            int32_t valueIndex = channel * capacity + transitionIndex;
+            if (!(transitionConfig->properties & Clay__transitionChannelProperties[channel])) {
+                // Channels that aren't animated always snap to their target
+                transitions->from.internalArray[valueIndex] = targets[channel];
+                transitions->to.internalArray[valueIndex] = targets[channel];
+                transitions->current.internalArray[valueIndex] = targets[channel];
+            } else if (!Clay__FloatEqual(transitions->to.internalArray[valueIndex], targets[channel])) {
+                targetChanged = true;
+            }
+        }
+        if (targetChanged) {
+            // Restart from wherever the previous transition had got to, so that interrupted transitions don't jump
+            for (int32_t channel = 0; channel < CLAY__TRANSITION_CHANNEL_COUNT; ++channel) {
+                int32_t valueIndex = channel * capacity + transitionIndex;
+                transitions->from.internalArray[valueIndex] = transitions->current.internalArray[valueIndex];
+                transitions->to.internalArray[valueIndex] = targets[channel];
+            }
+            transitions->progress.internalArray[transitionIndex] = 0;
+            transitions->eased.internalArray[transitionIndex] = 0;
+        }
+    }
+    transitions->generations.internalArray[transitionIndex] = context->generation;
+    transitions->inverseDuration.internalArray[transitionIndex] = 1 / transitionConfig->duration;
+    // Easing curves are stored as polynomial coefficients, eased = t * (linear + t * (quadratic + t * cubic)), so they can all be evaluated in a single branch free loop
+    float linear = 1, quadratic = 0, cubic = 0;
+    switch (transitionConfig->easing) {
+        case CLAY_EASING_EASE_IN: linear = 0; quadratic = 0; cubic = 1; break;
+        case CLAY_EASING_EASE_OUT: linear = 3; quadratic = -3; cubic = 1; break;
+        case CLAY_EASING_EASE_IN_OUT: linear = 0; quadratic = 3; cubic = -2; break;
+        default: break;
+    }
+    transitions->easingLinear.internalArray[transitionIndex] = linear;
+    transitions->easingQuadratic.internalArray[transitionIndex] = quadratic;
+    transitions->easingCubic.internalArray[transitionIndex] = cubic;
+    return transitionIndex;
+}
+
+int32_t Clay__GetElementTransitionIndex(Clay_LayoutElement *layoutElement) {
+    if (!Clay__ElementHasConfig(layoutElement, CLAY__ELEMENT_CONFIG_TYPE_TRANSITION)) {
+        return -1;
+    }
+    Clay_LayoutElementHashMapItem *hashMapItem = Clay__GetHashMapItem(layoutElement->id);
+    return hashMapItem != &Clay_LayoutElementHashMapItem_DEFAULT ? hashMapItem->transitionIndex : -1;
+}
+
+// Returns the shared config that an element should be painted with this frame, with any background color or opacity transitions applied
+Clay_SharedElementConfig Clay__GetSharedPaintConfig(Clay_LayoutElement *layoutElement, int32_t transitionIndex) {
+    Clay_SharedElementConfig *sharedConfig = Clay__FindElementConfigWithType(layoutElement, CLAY__ELEMENT_CONFIG_TYPE_SHARED).sharedElementConfig;
+    Clay_SharedElementConfig paintConfig = sharedConfig ? *sharedConfig : Clay_SharedElementConfig_DEFAULT;
+    Clay_TransitionElementConfig *transitionConfig = Clay__FindElementConfigWithType(layoutElement, CLAY__ELEMENT_CONFIG_TYPE_TRANSITION).transitionElementConfig;
+    if (transitionConfig && transitionIndex >= 0) {
+        if (transitionConfig->properties & CLAY_TRANSITION_PROPERTY_BACKGROUND_COLOR) {
+            paintConfig.backgroundColor = CLAY__INIT(Clay_Color) {
+                Clay__GetTransitionValue(transitionIndex, CLAY__TRANSITION_CHANNEL_COLOR_R),
+                Clay__GetTransitionValue(transitionIndex, CLAY__TRANSITION_CHANNEL_COLOR_G),
+                Clay__GetTransitionValue(transitionIndex, CLAY__TRANSITION_CHANNEL_COLOR_B),
+                Clay__GetTransitionValue(transitionIndex, CLAY__TRANSITION_CHANNEL_COLOR_A),
+            };
+        }
+        if (transitionConfig->properties & CLAY_TRANSITION_PROPERTY_OPACITY) {
+            paintConfig.backgroundColor.a *= Clay__GetTransitionValue(transitionIndex, CLAY__TRANSITION_CHANNEL_OPACITY);
+        }
+    }
+    return paintConfig;
+}
+
+Clay_Color Clay__GetBorderPaintColor(Clay_LayoutElement *layoutElement, Clay_BorderElementConfig *borderConfig, int32_t transitionIndex) {
+    Clay_Color color = borderConfig->color;
+    Clay_TransitionElementConfig *transitionConfig = Clay__FindElementConfigWithType(layoutElement, CLAY__ELEMENT_CONFIG_TYPE_TRANSITION).transitionElementConfig;
+    if (transitionConfig && transitionIndex >= 0 && (transitionConfig->properties & CLAY_TRANSITION_PROPERTY_OPACITY)) {
+        color.a *= Clay__GetTransitionValue(transitionIndex, CLAY__TRANSITION_CHANNEL_OPACITY);
+    }
+    return color;
+}
+
+void Clay__AddElementRenderCommand(Clay_RenderCommand renderCommand, int32_t layoutElementIndex, Clay__ElementConfigType configType, int32_t textOffset) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    int32_t previousLength = context->renderCommands.length;
+    Clay__AddRenderCommand(renderCommand);
+    if (context->renderCommands.length > previousLength) {
+        Clay__RenderCommandSourceArray_Add(&context->renderCommandSources, CLAY__INIT(Clay__RenderCommandSource) { .layoutElementIndex = layoutElementIndex, .textOffset = textOffset, .configType = configType });
+    }
+}
+
+// Called instead of Clay__CalculateFinalLayout when nothing that affects layout has changed since the previous frame.
+// The previous render commands are kept and only their paint properties are re-read from this frame's declarations.
+void Clay__UpdatePaintOnlyRenderCommands(void) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    // Sizing is skipped, so carry the previous frame's final dimensions over for scroll containers and element queries
+    for (int32_t i = 0; i < context->layoutElements.length; ++i) {
+        context->layoutElements.internalArray[i].dimensions = context->previousLayoutElementDimensions.internalArray[i];
+    }
+    for (int32_t i = 0; i < context->transitionElementIndexes.length; ++i) {
+        Clay_LayoutElement *layoutElement = Clay_LayoutElementArray_Get(&context->layoutElements, Clay__int32_tArray_GetValue(&context->transitionElementIndexes, i));
+        Clay_SharedElementConfig *declaredSharedConfig = Clay__FindElementConfigWithType(layoutElement, CLAY__ELEMENT_CONFIG_TYPE_SHARED).sharedElementConfig;
+        Clay_Color declaredBackgroundColor = declaredSharedConfig ? declaredSharedConfig->backgroundColor : CLAY__INIT(Clay_Color) CLAY__DEFAULT_STRUCT;
+        Clay__UpdateElementTransition(Clay__GetHashMapItem(layoutElement->id), Clay__FindElementConfigWithType(layoutElement, CLAY__ELEMENT_CONFIG_TYPE_TRANSITION).transitionElementConfig, declaredBackgroundColor, layoutElement->dimensions);
+    }
+
+    for (int32_t i = 0; i < context->renderCommands.length; ++i) {
+        Clay__RenderCommandSource *source = Clay__RenderCommandSourceArray_Get(&context->renderCommandSources, i);
+        Clay_RenderCommand *renderCommand = Clay_RenderCommandArray_Get(&context->renderCommands, i);
+        Clay_LayoutElement *layoutElement = Clay_LayoutElementArray_Get(&context->layoutElements, source->layoutElementIndex);
+        Clay_RenderCommand updated = *renderCommand;
+        int32_t transitionIndex = Clay__GetElementTransitionIndex(layoutElement);
+        switch (source->configType) {
+            case CLAY__ELEMENT_CONFIG_TYPE_SHARED: {
+                Clay_SharedElementConfig sharedConfig = Clay__GetSharedPaintConfig(layoutElement, transitionIndex);
+                updated.renderData.rectangle.backgroundColor = sharedConfig.backgroundColor;
+                updated.renderData.rectangle.cornerRadius = sharedConfig.cornerRadius;
+                updated.userData = sharedConfig.userData;
+                break;
+            }
+            case CLAY__ELEMENT_CONFIG_TYPE_IMAGE: {
+                Clay_SharedElementConfig sharedConfig = Clay__GetSharedPaintConfig(layoutElement, transitionIndex);
+                updated.renderData.image.backgroundColor = sharedConfig.backgroundColor;
+                updated.renderData.image.cornerRadius = sharedConfig.cornerRadius;
+                Clay_ImageElementConfig *imageConfig = Clay__FindElementConfigWithType(layoutElement, CLAY__ELEMENT_CONFIG_TYPE_IMAGE).imageElementConfig;
+                updated.renderData.image.imageData = imageConfig->imageData;
+                updated.renderData.image.imageVersion = imageConfig->imageVersion;
+                updated.userData = sharedConfig.userData;
+                break;
+            }
+            case CLAY__ELEMENT_CONFIG_TYPE_CUSTOM: {
+                Clay_SharedElementConfig sharedConfig = Clay__GetSharedPaintConfig(layoutElement, transitionIndex);
+                updated.renderData.custom.backgroundColor = sharedConfig.backgroundColor;
+                updated.renderData.custom.cornerRadius = sharedConfig.cornerRadius;
+                updated.renderData.custom.customData = Clay__FindElementConfigWithType(layoutElement, CLAY__ELEMENT_CONFIG_TYPE_CUSTOM).customElementConfig->customData;
+                updated.userData = sharedConfig.userData;
+                break;
+            }
+            case CLAY__ELEMENT_CONFIG_TYPE_TEXT: {
+                Clay_TextElementConfig *textConfig = Clay__FindElementConfigWithType(layoutElement, CLAY__ELEMENT_CONFIG_TYPE_TEXT).textElementConfig;
+                // The contents are unchanged, but may now live at a different address
+                Clay__TextElementData *textElementData = layoutElement->childrenOrTextContent.textElementData;
+                updated.renderData.text.stringContents.chars = textElementData->text.chars + source->textOffset;
+                updated.renderData.text.stringContents.baseChars = textElementData->text.chars;
+                updated.renderData.text.stringHandle = textElementData->stringHandle;
+                updated.renderData.text.stringVersion = textElementData->stringVersion;
+                updated.renderData.text.textColor = textConfig->textColor;
+                updated.userData = textConfig->userData;
+                break;
+            }
+            case CLAY__ELEMENT_CONFIG_TYPE_BORDER: {
+                Clay_SharedElementConfig *sharedConfig = Clay__ElementHasConfig(layoutElement, CLAY__ELEMENT_CONFIG_TYPE_SHARED) ? Clay__FindElementConfigWithType(layoutElement, CLAY__ELEMENT_CONFIG_TYPE_SHARED).sharedElementConfig : &Clay_SharedElementConfig_DEFAULT;
+                Clay_BorderElementConfig *borderConfig = Clay__FindElementConfigWithType(layoutElement, CLAY__ELEMENT_CONFIG_TYPE_BORDER).borderElementConfig;
+                Clay_Color borderColor = Clay__GetBorderPaintColor(layoutElement, borderConfig, transitionIndex);
+                if (renderCommand->commandType == CLAY_RENDER_COMMAND_TYPE_BORDER) {
+                    updated.renderData.border.color = borderColor;
+                    updated.renderData.border.cornerRadius = sharedConfig->cornerRadius;
+                    updated.renderData.border.width = borderConfig->width;
+                } else { // Borders between children
+                    updated.renderData.rectangle.backgroundColor = borderColor;
+                }
+                updated.userData = sharedConfig->userData;
+                break;
+            }
+            default: continue;
+        }
+        if (!Clay__MemCmp((char *)&updated, (char *)renderCommand, sizeof(Clay_RenderCommand))) {
+            *renderCommand = updated;
+            Clay__int32_tArray_Add(&context->renderCommandUpdates, i);
+        }
+    }
+}
+
+#define CLAY__MAX_DAMAGE_RECTS 8
+#define CLAY__MAX_DAMAGE_RECTS_TO_MERGE 64
+
+float Clay__Floor(float value) {
+    float truncated = (float)(int64_t)value;
+    return truncated > value ? truncated - 1 : truncated;
+}
+
+float Clay__Ceil(float value) {
+    return -Clay__Floor(-value);
+}
+
+Clay_BoundingBox Clay__IntersectBoundingBoxes(Clay_BoundingBox a, Clay_BoundingBox b) {
+    float left = CLAY__MAX(a.x, b.x);
+    float top = CLAY__MAX(a.y, b.y);
+    float right = CLAY__MIN(a.x + a.width, b.x + b.width);
+    float bottom = CLAY__MIN(a.y + a.height, b.y + b.height);
+    return CLAY__INIT(Clay_BoundingBox) { left, top, CLAY__MAX(right - left, 0), CLAY__MAX(bottom - top, 0) };
+}
+
+Clay_BoundingBox Clay__UnionBoundingBoxes(Clay_BoundingBox a, Clay_BoundingBox b) {
+    float left = CLAY__MIN(a.x, b.x);
+    float top = CLAY__MIN(a.y, b.y);
+    float right = CLAY__MAX(a.x + a.width, b.x + b.width);
+    float bottom = CLAY__MAX(a.y + a.height, b.y + b.height);
+    return CLAY__INIT(Clay_BoundingBox) { left, top, right - left, bottom - top };
+}
+
+bool Clay__BoundingBoxesEqual(Clay_BoundingBox a, Clay_BoundingBox b) {
+    return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+}
+
+uint64_t Clay__HashPaintValue(uint64_t hash, uint64_t value) {
+    return (hash ^ value) * 1099511628211ULL;
+}
+
+uint64_t Clay__HashPaintFloat(uint64_t hash, float value) {
+    union { float asFloat; uint32_t asInt; } bits;
+    bits.asFloat = value;
+    return Clay__HashPaintValue(hash, bits.asInt);
+}
+
+uint64_t Clay__HashPaintColor(uint64_t hash, Clay_Color color) {
+    hash = Clay__HashPaintFloat(hash, color.r);
+    hash = Clay__HashPaintFloat(hash, color.g);
+    hash = Clay__HashPaintFloat(hash, color.b);
+    return Clay__HashPaintFloat(hash, color.a);
+}
+
+uint64_t Clay__HashPaintCornerRadius(uint64_t hash, Clay_CornerRadius cornerRadius) {
+    hash = Clay__HashPaintFloat(hash, cornerRadius.topLeft);
+    hash = Clay__HashPaintFloat(hash, cornerRadius.topRight);
+    hash = Clay__HashPaintFloat(hash, cornerRadius.bottomLeft);
+    return Clay__HashPaintFloat(hash, cornerRadius.bottomRight);
+}
+
+// Hashes everything about a render command that affects its pixels, other than its position and clipping.
+// Fields are hashed one at a time, as hashing whole structs would include their padding bytes.
+uint32_t Clay__HashRenderCommandPaint(Clay_RenderCommand *renderCommand) {
+    Clay_RenderData *renderData = &renderCommand->renderData;
+    uint64_t hash = 14695981039346656037ULL;
+    switch (renderCommand->commandType) {
+        case CLAY_RENDER_COMMAND_TYPE_RECTANGLE: {
+            hash = Clay__HashPaintColor(hash, renderData->rectangle.backgroundColor);
+            hash = Clay__HashPaintCornerRadius(hash, renderData->rectangle.cornerRadius);
+            break;
+        }
+        case CLAY_RENDER_COMMAND_TYPE_BORDER: {
+            Clay_BorderWidth width = renderData->border.width;
+            hash = Clay__HashPaintColor(hash, renderData->border.color);
+            hash = Clay__HashPaintCornerRadius(hash, renderData->border.cornerRadius);
+            hash = Clay__HashPaintValue(hash, (uint64_t)width.left | (uint64_t)width.right << 16 | (uint64_t)width.top << 32 | (uint64_t)width.bottom << 48);
+            hash = Clay__HashPaintValue(hash, width.betweenChildren);
+            break;
+        }
+        case CLAY_RENDER_COMMAND_TYPE_IMAGE: {
+            // The pixels behind imageData can change without it moving, which imageVersion tells apart
+            hash = Clay__HashPaintColor(hash, renderData->image.backgroundColor);
+            hash = Clay__HashPaintCornerRadius(hash, renderData->image.cornerRadius);
+            hash = Clay__HashPaintValue(hash, (uint64_t)(uintptr_t)renderData->image.imageData);
+            hash = Clay__HashPaintValue(hash, renderData->image.imageVersion);
+            break;
+        }
+        case CLAY_RENDER_COMMAND_TYPE_TEXT: {
+            // Dynamic strings can change contents without changing address, or move without changing contents.
+            // Stored strings have a version that identifies their contents, so only text that couldn't be stored needs hashing
+            Clay_TextRenderData *text = &renderData->text;
+            if (text->stringVersion != 0) {
+                hash = Clay__HashPaintValue(hash, text->stringVersion);
+                hash = Clay__HashPaintValue(hash, (uint64_t)(text->stringContents.chars - text->stringContents.baseChars));
+            } else {
+                hash = Clay__HashPaintValue(hash, Clay__HashData((const uint8_t *)text->stringContents.chars, text->stringContents.length));
+            }
+            hash = Clay__HashPaintValue(hash, (uint32_t)text->stringContents.length);
+            hash = Clay__HashPaintColor(hash, text->textColor);
+            hash = Clay__HashPaintValue(hash, (uint64_t)text->fontId | (uint64_t)text->fontSize << 16 | (uint64_t)text->letterSpacing << 32 | (uint64_t)text->lineHeight << 48);
+            break;
+        }
+        default: hash = 0; break;
+    }
+    hash = Clay__HashPaintValue(hash, (uint64_t)(uintptr_t)renderCommand->userData);
+    return (uint32_t)(hash ^ (hash >> 32));
+}
+
+// Rounds the box outwards to whole pixels, clamped to the screen, and adds it to the damage rects
+void Clay__AddDamageRect(Clay_BoundingBox boundingBox) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    float left = Clay__Floor(CLAY__MAX(boundingBox.x, 0));
+    float top = Clay__Floor(CLAY__MAX(boundingBox.y, 0));
+    float right = Clay__Ceil(CLAY__MIN(boundingBox.x + boundingBox.width, context->layoutDimensions.width));
+    float bottom = Clay__Ceil(CLAY__MIN(boundingBox.y + boundingBox.height, context->layoutDimensions.height));
+    if (right <= left || bottom <= top) {
+        return;
+    }
+    Clay_DamageRectArray_Add(&context->damageRects, CLAY__INIT(Clay_BoundingBox) { left, top, right - left, bottom - top });
+}
+
+// Greedily merges damage rects whenever their union covers no more area than the two rects separately,
+// which also merges any rects that overlap heavily. Then merges the cheapest pairs until at most CLAY__MAX_DAMAGE_RECTS remain.
+void Clay__MergeDamageRects(void) {
+    Clay_DamageRectArray *damageRects = &Clay_GetCurrentContext()->damageRects;
+    if (damageRects->length > CLAY__MAX_DAMAGE_RECTS_TO_MERGE) {
+        // Past this point pairwise merging gets expensive, and almost everything has changed anyway
+        Clay_BoundingBox combined = damageRects->internalArray[0];
+        for (int32_t i = 1; i < damageRects->length; ++i) {
+            combined = Clay__UnionBoundingBoxes(combined, damageRects->internalArray[i]);
+        }
+        damageRects->internalArray[0] = combined;
+        damageRects->length = 1;
+        return;
+    }
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (int32_t i = 0; i < damageRects->length; ++i) {
+            for (int32_t j = i + 1; j < damageRects->length; ++j) {
+                Clay_BoundingBox a = damageRects->internalArray[i];
+                Clay_BoundingBox b = damageRects->internalArray[j];
+                Clay_BoundingBox combined = Clay__UnionBoundingBoxes(a, b);
+                if (combined.width * combined.height <= a.width * a.height + b.width * b.height) {
+                    damageRects->internalArray[i] = combined;
+                    Clay_DamageRectArray_RemoveSwapback(damageRects, j);
+                    merged = true;
+                    j = i;
+                }
+            }
+        }
+    }
+    while (damageRects->length > CLAY__MAX_DAMAGE_RECTS) {
+        int32_t bestA = 0, bestB = 1;
+        float bestCost = CLAY__MAXFLOAT;
+        for (int32_t i = 0; i < damageRects->length; ++i) {
+            for (int32_t j = i + 1; j < damageRects->length; ++j) {
+                Clay_BoundingBox a = damageRects->internalArray[i];
+                Clay_BoundingBox b = damageRects->internalArray[j];
+                Clay_BoundingBox combined = Clay__UnionBoundingBoxes(a, b);
+                float cost = combined.width * combined.height - a.width * a.height - b.width * b.height;
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestA = i;
+                    bestB = j;
+                }
+            }
+        }
+        damageRects->internalArray[bestA] = Clay__UnionBoundingBoxes(damageRects->internalArray[bestA], damageRects->internalArray[bestB]);
+        Clay_DamageRectArray_RemoveSwapback(damageRects, bestB);
+    }
+}
+
+// Compares the visible footprint of this frame's render commands against the previous frame's, and collects the regions that changed.
+// Records are matched by id and command type, so elements that are added, removed, moved, repainted or reordered damage both their old and new positions.
+void Clay__CalculateDamageRects(void) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    Clay__DamageRecordArray previousRecords = context->damageRecords;
+    context->damageRecords = context->previousDamageRecords;
+    context->previousDamageRecords = previousRecords;
+    Clay__DamageRecordArray *records = &context->damageRecords;
+    records->length = 0;
+    context->damageRects.length = 0;
+    context->damageClipStack.length = 0;
+
+    Clay_BoundingBox screen = { 0, 0, context->layoutDimensions.width, context->layoutDimensions.height };
+    Clay_DamageRectArray_Add(&context->damageClipStack, screen);
+    for (int32_t i = 0; i < context->renderCommands.length; ++i) {
+        Clay_RenderCommand *renderCommand = Clay_RenderCommandArray_Get(&context->renderCommands, i);
+        Clay_BoundingBox clip = *Clay_DamageRectArray_Get(&context->damageClipStack, context->damageClipStack.length - 1);
+        switch (renderCommand->commandType) {
+            case CLAY_RENDER_COMMAND_TYPE_SCISSOR_START: {
+                Clay_BoundingBox scissor = clip;
+                if (renderCommand->renderData.clip.horizontal) {
+                    scissor.x = renderCommand->boundingBox.x;
+                    scissor.width = renderCommand->boundingBox.width;
+                }
+                if (renderCommand->renderData.clip.vertical) {
+                    scissor.y = renderCommand->boundingBox.y;
+                    scissor.height = renderCommand->boundingBox.height;
+                }
+                Clay_DamageRectArray_Add(&context->damageClipStack, Clay__IntersectBoundingBoxes(clip, scissor));
+                continue;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_SCISSOR_END: {
+                if (context->damageClipStack.length > 1) {
+                    context->damageClipStack.length--;
+                }
+                continue;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_NONE: continue;
+            default: break;
+        }
+        Clay_BoundingBox visibleBoundingBox = Clay__IntersectBoundingBoxes(renderCommand->boundingBox, clip);
+        if (visibleBoundingBox.width <= 0 || visibleBoundingBox.height <= 0) {
+            continue;
+        }
+        if (renderCommand->commandType == CLAY_RENDER_COMMAND_TYPE_CUSTOM) {
+            Clay__AddDamageRect(visibleBoundingBox);
+        }
+        Clay__DamageRecordArray_Add(records, CLAY__INIT(Clay__DamageRecord) {
+            .key = renderCommand->id * 8 + renderCommand->commandType,
+            .paintHash = Clay__HashRenderCommandPaint(renderCommand),
+            .boundingBox = renderCommand->boundingBox,
+            .visibleBoundingBox = visibleBoundingBox,
+            .nextIndex = -1,
+        });
+    }
+
+    if (context->layoutDimensions.width != context->previousDamageLayoutDimensions.width || context->layoutDimensions.height != context->previousDamageLayoutDimensions.height) {
+        context->previousDamageLayoutDimensions = context->layoutDimensions;
+        context->damageRects.length = 0;
+        Clay__AddDamageRect(screen);
+        return;
+    }
+
+    // Bucket the previous records by key, inserting in reverse so that each bucket is in draw order
+    Clay__int32_tArray *hashMap = &context->damageRecordsHashMap;
+    for (int32_t i = 0; i < previousRecords.length; ++i) {
+        hashMap->internalArray[previousRecords.internalArray[i].key % hashMap->capacity] = -1;
+    }
+    for (int32_t i = previousRecords.length - 1; i >= 0; --i) {
+        Clay__DamageRecord *previous = &previousRecords.internalArray[i];
+        int32_t *bucket = &hashMap->internalArray[previous->key % hashMap->capacity];
+        previous->nextIndex = *bucket;
+        previous->matched = false;
+        *bucket = i;
+    }
+
+    // Matched records that appear in a different relative order have changed z order, and may now draw over or under their neighbours
+    int32_t highestMatchedIndex = -1;
+    for (int32_t i = 0; i < records->length; ++i) {
+        Clay__DamageRecord *current = &records->internalArray[i];
+        Clay__DamageRecord *previous = NULL;
+        int32_t previousIndex = previousRecords.length > 0 ? hashMap->internalArray[current->key % hashMap->capacity] : -1;
+        while (previousIndex != -1) {
+            Clay__DamageRecord *candidate = &previousRecords.internalArray[previousIndex];
+            if (candidate->key == current->key && !candidate->matched) {
+                previous = candidate;
+                break;
+            }
+            previousIndex = candidate->nextIndex;
+        }
+        if (!previous) {
+            Clay__AddDamageRect(current->visibleBoundingBox);
+            continue;
+        }
+        previous->matched = true;
+        if (previous->paintHash != current->paintHash
+            || !Clay__BoundingBoxesEqual(previous->boundingBox, current->boundingBox)
+            || !Clay__BoundingBoxesEqual(previous->visibleBoundingBox, current->visibleBoundingBox)
+            || previousIndex < highestMatchedIndex) {
+            Clay__AddDamageRect(previous->visibleBoundingBox);
+            Clay__AddDamageRect(current->visibleBoundingBox);
+        }
+        highestMatchedIndex = CLAY__MAX(highestMatchedIndex, previousIndex);
+    }
+    for (int32_t i = 0; i < previousRecords.length; ++i) {
+        if (!previousRecords.internalArray[i].matched) {
+            Clay__AddDamageRect(previousRecords.internalArray[i].visibleBoundingBox);
+        }
+    }
+    Clay__MergeDamageRects();
+}
+
 void Clay__CalculateFinalLayout(void) {
     Clay_Context* context = Clay_GetCurrentContext();
+    Clay__InitializeGridData();
+    context->geometryIds.length = 0;
+
     // Calculate sizing along the X axis
     Clay__SizeContainersAlongAxis(true);
 
@@ -2510,7 +4259,7 @@ void Clay__CalculateFinalLayout(void) {
         textElementData->wrappedLines = CLAY__INIT(Clay__WrappedTextLineArraySlice) { .length = 0, .internalArray = &context->wrappedTextLines.internalArray[context->wrappedTextLines.length] };
         Clay_LayoutElement *containerElement = Clay_LayoutElementArray_Get(&context->layoutElements, (int)textElementData->elementIndex);
         Clay_TextElementConfig *textConfig = Clay__FindElementConfigWithType(containerElement, CLAY__ELEMENT_CONFIG_TYPE_TEXT).textElementConfig;
-        Clay__MeasureTextCacheItem *measureTextCacheItem = Clay__MeasureTextCached(&textElementData->text, textConfig);
+        Clay__MeasureTextCacheItem *measureTextCacheItem = Clay__MeasureTextCached(&textElementData->text, textElementData->contentHash, textConfig);
         float lineWidth = 0;
         float lineHeight = textConfig->lineHeight > 0 ? (float)textConfig->lineHeight : textElementData->preferredDimensions.height;
         int32_t lineLengthChars = 0;
@@ -2612,6 +4361,9 @@ void Clay__CalculateFinalLayout(void) {
             }
             contentHeight += (float)(CLAY__MAX(currentElement->childrenOrTextContent.children.length - 1, 0) * layoutConfig->childGap);
             currentElement->dimensions.height = CLAY__MIN(CLAY__MAX(contentHeight, layoutConfig->sizing.height.size.minMax.min), layoutConfig->sizing.height.size.minMax.max);
+        } else if (layoutConfig->layoutDirection == CLAY_GRID) {
+            float contentHeight = (float)(layoutConfig->padding.top + layoutConfig->padding.bottom) + Clay__GetGridContentSize(currentElement, false, false);
+            currentElement->dimensions.height = CLAY__MIN(CLAY__MAX(contentHeight, layoutConfig->sizing.height.size.minMax.min), layoutConfig->sizing.height.size.minMax.max);
         }
     }
 
@@ -2725,7 +4477,7 @@ void Clay__CalculateFinalLayout(void) {
                 });
             }
         }
-        Clay__LayoutElementTreeNodeArray_Add(&dfsBuffer, CLAY__INIT(Clay__LayoutElementTreeNode) { .layoutElement = rootElement, .position = rootPosition, .nextChildOffset = { .x = (float)rootElement->layoutConfig->padding.left, .y = (float)rootElement->layoutConfig->padding.top } });
+        Clay__LayoutElementTreeNodeArray_Add(&dfsBuffer, CLAY__INIT(Clay__LayoutElementTreeNode) { .layoutElement = rootElement, .position = rootPosition, .nextChildOffset = { .x = (float)rootElement->layoutConfig->padding.left, .y = (float)rootElement->layoutConfig->padding.top }, .parentGeometryIndex = -1 });
 
         context->treeNodeVisited.internalArray[0] = false;
         while (dfsBuffer.length > 0) {
@@ -2739,6 +4491,28 @@ void Clay__CalculateFinalLayout(void) {
                 context->treeNodeVisited.internalArray[dfsBuffer.length - 1] = true;
 
                 Clay_BoundingBox currentElementBoundingBox = { currentElementTreeNode->position.x, currentElementTreeNode->position.y, currentElement->dimensions.width, currentElement->dimensions.height };
+                int32_t currentElementIndex = (int32_t)(currentElement - context->layoutElements.internalArray);
+                Clay_TransitionElementConfig *transitionConfig = Clay__FindElementConfigWithType(currentElement, CLAY__ELEMENT_CONFIG_TYPE_TRANSITION).transitionElementConfig;
+                int32_t transitionIndex = -1;
+                if (transitionConfig) {
+                    Clay_SharedElementConfig *declaredSharedConfig = Clay__FindElementConfigWithType(currentElement, CLAY__ELEMENT_CONFIG_TYPE_SHARED).sharedElementConfig;
+                    Clay_Color declaredBackgroundColor = declaredSharedConfig ? declaredSharedConfig->backgroundColor : CLAY__INIT(Clay_Color) CLAY__DEFAULT_STRUCT;
+                    transitionIndex = Clay__UpdateElementTransition(Clay__GetHashMapItem(currentElement->id), transitionConfig, declaredBackgroundColor, currentElement->dimensions);
+                }
+                if (transitionIndex >= 0) {
+                    // Offsets move the element and all of its children, since children are positioned relative to the tree node
+                    if (transitionConfig->properties & CLAY_TRANSITION_PROPERTY_OFFSET) {
+                        Clay_Vector2 offset = { Clay__GetTransitionValue(transitionIndex, CLAY__TRANSITION_CHANNEL_OFFSET_X), Clay__GetTransitionValue(transitionIndex, CLAY__TRANSITION_CHANNEL_OFFSET_Y) };
+                        currentElementTreeNode->position.x += offset.x;
+                        currentElementTreeNode->position.y += offset.y;
+                        currentElementBoundingBox.x += offset.x;
+                        currentElementBoundingBox.y += offset.y;
+                    }
+                    if (transitionConfig->properties & CLAY_TRANSITION_PROPERTY_SIZE) {
+                        currentElementBoundingBox.width = Clay__GetTransitionValue(transitionIndex, CLAY__TRANSITION_CHANNEL_WIDTH);
+                        currentElementBoundingBox.height = Clay__GetTransitionValue(transitionIndex, CLAY__TRANSITION_CHANNEL_HEIGHT);
+                    }
+                }
                 if (Clay__ElementHasConfig(currentElement, CLAY__ELEMENT_CONFIG_TYPE_FLOATING)) {
                     Clay_FloatingElementConfig *floatingElementConfig = Clay__FindElementConfigWithType(currentElement, CLAY__ELEMENT_CONFIG_TYPE_FLOATING).floatingElementConfig;
                     Clay_Dimensions expand = floatingElementConfig->expand;
@@ -2768,13 +4542,25 @@ void Clay__CalculateFinalLayout(void) {
                     }
                 }
 
+                // Every element is visited exactly once on the way down, so the geometry arrays can't overflow
+                int32_t geometryIndex = context->geometryIds.length;
+                currentElementTreeNode->geometryIndex = geometryIndex;
+                Clay__uint32_tArray_Add(&context->geometryIds, currentElement->id);
+                context->geometryX.internalArray[geometryIndex] = currentElementBoundingBox.x;
+                context->geometryY.internalArray[geometryIndex] = currentElementBoundingBox.y;
+                context->geometryWidths.internalArray[geometryIndex] = currentElementBoundingBox.width;
+                context->geometryHeights.internalArray[geometryIndex] = currentElementBoundingBox.height;
+                context->geometryParents.internalArray[geometryIndex] = currentElementTreeNode->parentGeometryIndex;
+
                 Clay_LayoutElementHashMapItem *hashMapItem = Clay__GetHashMapItem(currentElement->id);
                 if (hashMapItem) {
                     hashMapItem->boundingBox = currentElementBoundingBox;
+                    hashMapItem->geometryIndex = geometryIndex;
                     if (hashMapItem->idAlias) {
                         Clay_LayoutElementHashMapItem *hashMapItemAlias = Clay__GetHashMapItem(hashMapItem->idAlias);
                         if (hashMapItemAlias) {
                             hashMapItemAlias->boundingBox = currentElementBoundingBox;
+                            hashMapItemAlias->geometryIndex = geometryIndex;
                         }
                     }
                 }
@@ -2798,16 +4584,10 @@ void Clay__CalculateFinalLayout(void) {
                     sortMax--;
                 }
 
-                bool emitRectangle = false;
                 // Create the render commands for this element
-                Clay_SharedElementConfig *sharedConfig = Clay__FindElementConfigWithType(currentElement, CLAY__ELEMENT_CONFIG_TYPE_SHARED).sharedElementConfig;
-                if (sharedConfig && sharedConfig->backgroundColor.a > 0) {
-                   emitRectangle = true;
-                }
-                else if (!sharedConfig) {
-                    emitRectangle = false;
-                    sharedConfig = &Clay_SharedElementConfig_DEFAULT;
-                }
+                Clay_SharedElementConfig sharedPaintConfig = Clay__GetSharedPaintConfig(currentElement, transitionIndex);
+                Clay_SharedElementConfig *sharedConfig = &sharedPaintConfig;
+                bool emitRectangle = Clay__ElementHasConfig(currentElement, CLAY__ELEMENT_CONFIG_TYPE_SHARED) && sharedConfig->backgroundColor.a > 0;
                 for (int32_t elementConfigIndex = 0; elementConfigIndex < currentElement->elementConfigs.length; ++elementConfigIndex) {
                     Clay_ElementConfig *elementConfig = Clay__ElementConfigArraySlice_Get(&currentElement->elementConfigs, sortedConfigIndexes[elementConfigIndex]);
                     Clay_RenderCommand renderCommand = {
@@ -2823,6 +4603,7 @@ void Clay__CalculateFinalLayout(void) {
                         case CLAY__ELEMENT_CONFIG_TYPE_ASPECT:
                         case CLAY__ELEMENT_CONFIG_TYPE_FLOATING:
                         case CLAY__ELEMENT_CONFIG_TYPE_SHARED:
+                        case CLAY__ELEMENT_CONFIG_TYPE_TRANSITION:
                         case CLAY__ELEMENT_CONFIG_TYPE_BORDER: {
                             shouldRender = false;
                             break;
@@ -2844,6 +4625,7 @@ void Clay__CalculateFinalLayout(void) {
                                     .backgroundColor = sharedConfig->backgroundColor,
                                     .cornerRadius = sharedConfig->cornerRadius,
                                     .imageData = elementConfig->config.imageElementConfig->imageData,
+                                    .imageVersion = elementConfig->config.imageElementConfig->imageVersion,
                                }
                             };
                             emitRectangle = false;
@@ -2873,7 +4655,7 @@ void Clay__CalculateFinalLayout(void) {
                                 if (textElementConfig->textAlignment == CLAY_TEXT_ALIGN_CENTER) {
                                     offset /= 2;
                                 }
-                                Clay__AddRenderCommand(CLAY__INIT(Clay_RenderCommand) {
+                                Clay__AddElementRenderCommand(CLAY__INIT(Clay_RenderCommand) {
                                     .boundingBox = { currentElementBoundingBox.x + offset, currentElementBoundingBox.y + yPosition, wrappedLine->dimensions.width, wrappedLine->dimensions.height },
                                     .renderData = { .text = {
                                         .stringContents = CLAY__INIT(Clay_StringSlice) { .length = wrappedLine->line.length, .chars = wrappedLine->line.chars, .baseChars = currentElement->childrenOrTextContent.textElementData->text.chars },
@@ -2882,12 +4664,14 @@ void Clay__CalculateFinalLayout(void) {
                                         .fontSize = textElementConfig->fontSize,
                                         .letterSpacing = textElementConfig->letterSpacing,
                                         .lineHeight = textElementConfig->lineHeight,
+                                        .stringHandle = currentElement->childrenOrTextContent.textElementData->stringHandle,
+                                        .stringVersion = currentElement->childrenOrTextContent.textElementData->stringVersion,
                                     }},
                                     .userData = textElementConfig->userData,
                                     .id = Clay__HashNumber(lineIndex, currentElement->id).id,
                                     .zIndex = root->zIndex,
                                     .commandType = CLAY_RENDER_COMMAND_TYPE_TEXT,
-                                });
+                                }, currentElementIndex, CLAY__ELEMENT_CONFIG_TYPE_TEXT, (int32_t)(wrappedLine->line.chars - currentElement->childrenOrTextContent.textElementData->text.chars));
                                 yPosition += finalLineHeight;
 
                                 if (!context->disableCulling && (currentElementBoundingBox.y + yPosition > context->layoutDimensions.height)) {
@@ -2911,7 +4695,7 @@ void Clay__CalculateFinalLayout(void) {
                         default: break;
                     }
                     if (shouldRender) {
-                        Clay__AddRenderCommand(renderCommand);
+                        Clay__AddElementRenderCommand(renderCommand, currentElementIndex, elementConfig->type, 0);
                     }
                     if (offscreen) {
                         // NOTE: You may be tempted to try an early return / continue if an element is off screen. Why bother calculating layout for its children, right?
@@ -2921,7 +4705,7 @@ void Clay__CalculateFinalLayout(void) {
                 }
 
                 if (emitRectangle) {
-                    Clay__AddRenderCommand(CLAY__INIT(Clay_RenderCommand) {
+                    Clay__AddElementRenderCommand(CLAY__INIT(Clay_RenderCommand) {
                         .boundingBox = currentElementBoundingBox,
                         .renderData = { .rectangle = {
                                 .backgroundColor = sharedConfig->backgroundColor,
@@ -2931,7 +4715,7 @@ void Clay__CalculateFinalLayout(void) {
                         .id = currentElement->id,
                         .zIndex = root->zIndex,
                         .commandType = CLAY_RENDER_COMMAND_TYPE_RECTANGLE,
-                    });
+                    }, currentElementIndex, CLAY__ELEMENT_CONFIG_TYPE_SHARED, 0);
                 }
 
                 // Setup initial on-axis alignment
@@ -2952,6 +4736,34 @@ void Clay__CalculateFinalLayout(void) {
                         }
                         currentElementTreeNode->nextChildOffset.x += extraSpace;
                         extraSpace = CLAY__MAX(0, extraSpace);
+                    } else if (layoutConfig->layoutDirection == CLAY_GRID) {
+                        Clay__GridData *gridData = Clay__GetGridData(currentElement->id);
+                        if (gridData && gridData->rowCount > 0) {
+                            Clay__GridTrackData *lastColumn = Clay__GridTrackDataArray_Get(&context->gridTracks, gridData->tracksStart + gridData->columnCount - 1);
+                            Clay__GridTrackData *lastRow = Clay__GridTrackDataArray_Get(&context->gridTracks, gridData->tracksStart + gridData->columnCount + gridData->rowCount - 1);
+                            contentSize = CLAY__INIT(Clay_Dimensions) { lastColumn->offset + lastColumn->size, lastRow->offset + lastRow->size };
+                        }
+                        // The grid as a whole is aligned within the element, and each child within its cell
+                        float extraWidth = currentElement->dimensions.width - (float)(layoutConfig->padding.left + layoutConfig->padding.right) - contentSize.width;
+                        float extraHeight = currentElement->dimensions.height - (float)(layoutConfig->padding.top + layoutConfig->padding.bottom) - contentSize.height;
+                        switch (layoutConfig->childAlignment.x) {
+                            case CLAY_ALIGN_X_LEFT: extraWidth = 0; break;
+                            case CLAY_ALIGN_X_CENTER: extraWidth /= 2; break;
+                            default: break;
+                        }
+                        switch (layoutConfig->childAlignment.y) {
+                            case CLAY_ALIGN_Y_TOP: extraHeight = 0; break;
+                            case CLAY_ALIGN_Y_CENTER: extraHeight /= 2; break;
+                            default: break;
+                        }
+                        currentElementTreeNode->nextChildOffset.x += CLAY__MAX(0, extraWidth);
+                        currentElementTreeNode->nextChildOffset.y += CLAY__MAX(0, extraHeight);
+                        if (gridData) {
+                            gridData->origin = CLAY__INIT(Clay_Vector2) {
+                                currentElementTreeNode->position.x + currentElementTreeNode->nextChildOffset.x + scrollOffset.x,
+                                currentElementTreeNode->position.y + currentElementTreeNode->nextChildOffset.y + scrollOffset.y,
+                            };
+                        }
                     } else {
                         for (int32_t i = 0; i < currentElement->childrenOrTextContent.children.length; ++i) {
                             Clay_LayoutElement *childElement = Clay_LayoutElementArray_Get(&context->layoutElements, currentElement->childrenOrTextContent.children.elements[i]);
@@ -2976,6 +4788,7 @@ void Clay__CalculateFinalLayout(void) {
             }
             else {
                 // DFS is returning upwards backwards
+                context->geometrySubtreeEnds.internalArray[currentElementTreeNode->geometryIndex] = context->geometryIds.length;
                 bool closeClipElement = false;
                 Clay_ClipElementConfig *clipConfig = Clay__FindElementConfigWithType(currentElement, CLAY__ELEMENT_CONFIG_TYPE_CLIP).clipElementConfig;
                 if (clipConfig) {
@@ -2998,12 +4811,14 @@ void Clay__CalculateFinalLayout(void) {
 
                     // Culling - Don't bother to generate render commands for rectangles entirely outside the screen - this won't stop their children from being rendered if they overflow
                     if (!Clay__ElementIsOffscreen(&currentElementBoundingBox)) {
+                        int32_t currentElementIndex = (int32_t)(currentElement - context->layoutElements.internalArray);
                         Clay_SharedElementConfig *sharedConfig = Clay__ElementHasConfig(currentElement, CLAY__ELEMENT_CONFIG_TYPE_SHARED) ? Clay__FindElementConfigWithType(currentElement, CLAY__ELEMENT_CONFIG_TYPE_SHARED).sharedElementConfig : &Clay_SharedElementConfig_DEFAULT;
                         Clay_BorderElementConfig *borderConfig = Clay__FindElementConfigWithType(currentElement, CLAY__ELEMENT_CONFIG_TYPE_BORDER).borderElementConfig;
+                        Clay_Color borderColor = Clay__GetBorderPaintColor(currentElement, borderConfig, Clay__GetElementTransitionIndex(currentElement));
                         Clay_RenderCommand renderCommand = {
                                 .boundingBox = currentElementBoundingBox,
                                 .renderData = { .border = {
-                                    .color = borderConfig->color,
+                                    .color = borderColor,
                                     .cornerRadius = sharedConfig->cornerRadius,
                                     .width = borderConfig->width
                                 }},
@@ -3011,7 +4826,8 @@ void Clay__CalculateFinalLayout(void) {
                                 .id = Clay__HashNumber(currentElement->id, currentElement->childrenOrTextContent.children.length).id,
                                 .commandType = CLAY_RENDER_COMMAND_TYPE_BORDER,
                         };
-                        Clay__AddRenderCommand(renderCommand);
+                        Clay__AddElementRenderCommand(renderCommand, currentElementIndex, CLAY__ELEMENT_CONFIG_TYPE_BORDER, 0);
+                        // Decided by the declared color rather than the painted one, so that fading borders keep the same set of render commands
                         if (borderConfig->width.betweenChildren > 0 && borderConfig->color.a > 0) {
                             float halfGap = layoutConfig->childGap / 2;
                             Clay_Vector2 borderOffset = { (float)layoutConfig->padding.left - halfGap, (float)layoutConfig->padding.top - halfGap };
@@ -3019,31 +4835,54 @@ void Clay__CalculateFinalLayout(void) {
                                 for (int32_t i = 0; i < currentElement->childrenOrTextContent.children.length; ++i) {
                                     Clay_LayoutElement *childElement = Clay_LayoutElementArray_Get(&context->layoutElements, currentElement->childrenOrTextContent.children.elements[i]);
                                     if (i > 0) {
-                                        Clay__AddRenderCommand(CLAY__INIT(Clay_RenderCommand) {
+                                        Clay__AddElementRenderCommand(CLAY__INIT(Clay_RenderCommand) {
                                             .boundingBox = { currentElementBoundingBox.x + borderOffset.x + scrollOffset.x, currentElementBoundingBox.y + scrollOffset.y, (float)borderConfig->width.betweenChildren, currentElement->dimensions.height },
                                             .renderData = { .rectangle = {
-                                                .backgroundColor = borderConfig->color,
+                                                .backgroundColor = borderColor,
                                             } },
                                             .userData = sharedConfig->userData,
                                             .id = Clay__HashNumber(currentElement->id, currentElement->childrenOrTextContent.children.length + 1 + i).id,
                                             .commandType = CLAY_RENDER_COMMAND_TYPE_RECTANGLE,
-                                        });
+                                        }, currentElementIndex, CLAY__ELEMENT_CONFIG_TYPE_BORDER, 0);
                                     }
                                     borderOffset.x += (childElement->dimensions.width + (float)layoutConfig->childGap);
                                 }
+                            } else if (layoutConfig->layoutDirection == CLAY_GRID) {
+                                Clay__GridData *gridData = Clay__GetGridData(currentElement->id);
+                                int32_t trackCount = gridData ? gridData->columnCount + gridData->rowCount : 0;
+                                // Borders go between tracks, so neither the first column nor the first row gets one
+                                for (int32_t i = 1; i < trackCount; ++i) {
+                                    if (i == gridData->columnCount) {
+                                        continue;
+                                    }
+                                    Clay__GridTrackData *track = Clay__GridTrackDataArray_Get(&context->gridTracks, gridData->tracksStart + i);
+                                    bool column = i < gridData->columnCount;
+                                    Clay_BoundingBox borderBox = column
+                                        ? CLAY__INIT(Clay_BoundingBox) { gridData->origin.x + track->offset - halfGap, currentElementBoundingBox.y + scrollOffset.y, (float)borderConfig->width.betweenChildren, currentElement->dimensions.height }
+                                        : CLAY__INIT(Clay_BoundingBox) { currentElementBoundingBox.x + scrollOffset.x, gridData->origin.y + track->offset - halfGap, currentElement->dimensions.width, (float)borderConfig->width.betweenChildren };
+                                    Clay__AddElementRenderCommand(CLAY__INIT(Clay_RenderCommand) {
+                                        .boundingBox = borderBox,
+                                        .renderData = { .rectangle = {
+                                            .backgroundColor = borderColor,
+                                        } },
+                                        .userData = sharedConfig->userData,
+                                        .id = Clay__HashNumber(currentElement->id, currentElement->childrenOrTextContent.children.length + 1 + i).id,
+                                        .commandType = CLAY_RENDER_COMMAND_TYPE_RECTANGLE,
+                                    }, currentElementIndex, CLAY__ELEMENT_CONFIG_TYPE_BORDER, 0);
+                                }
                             } else {
                                 for (int32_t i = 0; i < currentElement->childrenOrTextContent.children.length; ++i) {
                                     Clay_LayoutElement *childElement = Clay_LayoutElementArray_Get(&context->layoutElements, currentElement->childrenOrTextContent.children.elements[i]);
                                     if (i > 0) {
-                                        Clay__AddRenderCommand(CLAY__INIT(Clay_RenderCommand) {
+                                        Clay__AddElementRenderCommand(CLAY__INIT(Clay_RenderCommand) {
                                             .boundingBox = { currentElementBoundingBox.x + scrollOffset.x, currentElementBoundingBox.y + borderOffset.y + scrollOffset.y, currentElement->dimensions.width, (float)borderConfig->width.betweenChildren },
                                             .renderData = { .rectangle = {
-                                                    .backgroundColor = borderConfig->color,
+                                                    .backgroundColor = borderColor,
                                             } },
                                             .userData = sharedConfig->userData,
                                             .id = Clay__HashNumber(currentElement->id, currentElement->childrenOrTextContent.children.length + 1 + i).id,
                                             .commandType = CLAY_RENDER_COMMAND_TYPE_RECTANGLE,
-                                        });
+                                        }, currentElementIndex, CLAY__ELEMENT_CONFIG_TYPE_BORDER, 0);
                                     }
                                     borderOffset.y += (childElement->dimensions.height + (float)layoutConfig->childGap);
                                 }
@@ -3053,10 +4892,10 @@ void Clay__CalculateFinalLayout(void) {
                 }
                 // This exists because the scissor needs to end _after_ borders between elements
                 if (closeClipElement) {
-                    Clay__AddRenderCommand(CLAY__INIT(Clay_RenderCommand) {
+                    Clay__AddElementRenderCommand(CLAY__INIT(Clay_RenderCommand) {
                         .id = Clay__HashNumber(currentElement->id, rootElement->childrenOrTextContent.children.length + 11).id,
                         .commandType = CLAY_RENDER_COMMAND_TYPE_SCISSOR_END,
-                    });
+                    }, (int32_t)(currentElement - context->layoutElements.internalArray), CLAY__ELEMENT_CONFIG_TYPE_CLIP, 0);
                 }
 
                 dfsBuffer.length--;
@@ -3065,6 +4904,7 @@ void Clay__CalculateFinalLayout(void) {
 
             // Add children to the DFS buffer
             if (!Clay__ElementHasConfig(currentElement, CLAY__ELEMENT_CONFIG_TYPE_TEXT)) {
+                Clay__GridData *gridData = layoutConfig->layoutDirection == CLAY_GRID ? Clay__GetGridData(currentElement->id) : CLAY__NULL;
                 dfsBuffer.length += currentElement->childrenOrTextContent.children.length;
                 for (int32_t i = 0; i < currentElement->childrenOrTextContent.children.length; ++i) {
                     Clay_LayoutElement *childElement = Clay_LayoutElementArray_Get(&context->layoutElements, currentElement->childrenOrTextContent.children.elements[i]);
@@ -3077,7 +4917,7 @@ void Clay__CalculateFinalLayout(void) {
                             case CLAY_ALIGN_Y_CENTER: currentElementTreeNode->nextChildOffset.y += whiteSpaceAroundChild / 2; break;
                             case CLAY_ALIGN_Y_BOTTOM: currentElementTreeNode->nextChildOffset.y += whiteSpaceAroundChild; break;
                         }
-                    } else {
+                    } else if (layoutConfig->layoutDirection == CLAY_TOP_TO_BOTTOM) {
                         currentElementTreeNode->nextChildOffset.x = currentElement->layoutConfig->padding.left;
                         float whiteSpaceAroundChild = currentElement->dimensions.width - (float)(layoutConfig->padding.left + layoutConfig->padding.right) - childElement->dimensions.width;
                         switch (layoutConfig->childAlignment.x) {
@@ -3091,6 +4931,10 @@ void Clay__CalculateFinalLayout(void) {
                         currentElementTreeNode->position.x + currentElementTreeNode->nextChildOffset.x + scrollOffset.x,
                         currentElementTreeNode->position.y + currentElementTreeNode->nextChildOffset.y + scrollOffset.y,
                     };
+                    if (gridData) {
+                        // Grid cells are positioned directly from the track prefix sums rather than by accumulating offsets
+                        childPosition = Clay__GetGridChildPosition(gridData, i, childElement->dimensions, layoutConfig->childAlignment);
+                    }
 
                     // DFS buffer elements need to be added in reverse because stack traversal happens backwards
                     uint32_t newNodeIndex = dfsBuffer.length - 1 - i;
@@ -3098,13 +4942,14 @@ void Clay__CalculateFinalLayout(void) {
                         .layoutElement = childElement,
                         .position = { childPosition.x, childPosition.y },
                         .nextChildOffset = { .x = (float)childElement->layoutConfig->padding.left, .y = (float)childElement->layoutConfig->padding.top },
+                        .parentGeometryIndex = currentElementTreeNode->geometryIndex,
                     };
                     context->treeNodeVisited.internalArray[newNodeIndex] = false;
 
                     // Update parent offsets
                     if (layoutConfig->layoutDirection == CLAY_LEFT_TO_RIGHT) {
                         currentElementTreeNode->nextChildOffset.x += childElement->dimensions.width + (float)layoutConfig->childGap;
-                    } else {
+                    } else if (layoutConfig->layoutDirection == CLAY_TOP_TO_BOTTOM) {
                         currentElementTreeNode->nextChildOffset.y += childElement->dimensions.height + (float)layoutConfig->childGap;
                     }
                 }
@@ -3149,6 +4994,7 @@ Clay__DebugElementConfigTypeLabelConfig Clay__DebugGetElementConfigTypeLabel(Cla
         case CLAY__ELEMENT_CONFIG_TYPE_CLIP: return CLAY__INIT(Clay__DebugElementConfigTypeLabelConfig) {CLAY_STRING("Scroll"), {242, 196, 90, 255} };
         case CLAY__ELEMENT_CONFIG_TYPE_BORDER: return CLAY__INIT(Clay__DebugElementConfigTypeLabelConfig) {CLAY_STRING("Border"), {108, 91, 123, 255} };
         case CLAY__ELEMENT_CONFIG_TYPE_CUSTOM: return CLAY__INIT(Clay__DebugElementConfigTypeLabelConfig) { CLAY_STRING("Custom"), {11,72,107,255} };
+        case CLAY__ELEMENT_CONFIG_TYPE_TRANSITION: return CLAY__INIT(Clay__DebugElementConfigTypeLabelConfig) { CLAY_STRING("Transition"), {199,244,100,255} };
         default: break;
     }
     return CLAY__INIT(Clay__DebugElementConfigTypeLabelConfig) { CLAY_STRING("Error"), {0,0,0,255} };
@@ -3524,7 +5370,7 @@ void Clay__RenderDebugView(void) {
                     // .layoutDirection
                     CLAY_TEXT(CLAY_STRING("Layout Direction"), infoTitleConfig);
                     Clay_LayoutConfig *layoutConfig = selectedItem->layoutElement->layoutConfig;
-                    CLAY_TEXT(layoutConfig->layoutDirection == CLAY_TOP_TO_BOTTOM ? CLAY_STRING("TOP_TO_BOTTOM") : CLAY_STRING("LEFT_TO_RIGHT"), infoTextConfig);
+                    CLAY_TEXT(layoutConfig->layoutDirection == CLAY_GRID ? CLAY_STRING("GRID") : layoutConfig->layoutDirection == CLAY_TOP_TO_BOTTOM ? CLAY_STRING("TOP_TO_BOTTOM") : CLAY_STRING("LEFT_TO_RIGHT"), infoTextConfig);
                     // .sizing
                     CLAY_TEXT(CLAY_STRING("Sizing"), infoTitleConfig);
                     CLAY({ .layout = { .layoutDirection = CLAY_LEFT_TO_RIGHT } }) {
@@ -3900,6 +5746,9 @@ uint32_t Clay_MinMemorySize(void) {
     Clay_Context fakeContext = {
         .maxElementCount = Clay__defaultMaxElementCount,
         .maxMeasureTextCacheWordCount = Clay__defaultMaxMeasureTextWordCacheCount,
+        .maxTransitionCount = Clay__defaultMaxTransitionCount,
+        .maxMemoBytes = Clay__defaultMaxMemoBytes,
+        .maxStringStoreBytes = Clay__defaultMaxStringStoreBytes,
         .internalArena = {
             .capacity = SIZE_MAX,
             .memory = NULL,
@@ -3909,6 +5758,9 @@ uint32_t Clay_MinMemorySize(void) {
     if (currentContext) {
         fakeContext.maxElementCount = currentContext->maxElementCount;
         fakeContext.maxMeasureTextCacheWordCount = currentContext->maxMeasureTextCacheWordCount;
+        fakeContext.maxTransitionCount = currentContext->maxTransitionCount;
+        fakeContext.maxMemoBytes = currentContext->maxMemoBytes;
+        fakeContext.maxStringStoreBytes = currentContext->maxStringStoreBytes;
     }
     // Reserve space in the arena for the context, important for calculating min memory size correctly
     Clay__Context_Allocate_Arena(&fakeContext.internalArena);
@@ -3931,6 +5783,7 @@ void Clay_SetMeasureTextFunction(Clay_Dimensions (*measureTextFunction)(Clay_Str
     Clay_Context* context = Clay_GetCurrentContext();
     Clay__MeasureText = measureTextFunction;
     context->measureTextUserData = userData;
+    context->previousLayoutHash = 0;
 }
 void Clay_SetQueryScrollOffsetFunction(Clay_Vector2 (*queryScrollOffsetFunction)(uint32_t elementId, void *userData), void *userData) {
     Clay_Context* context = Clay_GetCurrentContext();
@@ -4032,6 +5885,9 @@ Clay_Context* Clay_Initialize(Clay_Arena arena, Clay_Dimensions layoutDimensions
     *context = CLAY__INIT(Clay_Context) {
         .maxElementCount = oldContext ? oldContext->maxElementCount : Clay__defaultMaxElementCount,
         .maxMeasureTextCacheWordCount = oldContext ? oldContext->maxMeasureTextCacheWordCount : Clay__defaultMaxMeasureTextWordCacheCount,
+        .maxTransitionCount = oldContext ? oldContext->maxTransitionCount : Clay__defaultMaxTransitionCount,
+        .maxMemoBytes = oldContext ? oldContext->maxMemoBytes : Clay__defaultMaxMemoBytes,
+        .maxStringStoreBytes = oldContext ? oldContext->maxStringStoreBytes : Clay__defaultMaxStringStoreBytes,
         .errorHandler = errorHandler.errorHandlerFunction ? errorHandler : CLAY__INIT(Clay_ErrorHandler) { Clay__ErrorHandlerFunctionDefault, 0 },
         .layoutDimensions = layoutDimensions,
         .internalArena = arena,
@@ -4042,6 +5898,12 @@ Clay_Context* Clay_Initialize(Clay_Arena arena, Clay_Dimensions layoutDimensions
     for (int32_t i = 0; i < context->layoutElementsHashMap.capacity; ++i) {
         context->layoutElementsHashMap.internalArray[i] = -1;
     }
+    for (int32_t i = 0; i < context->memoEntriesHashMap.capacity; ++i) {
+        context->memoEntriesHashMap.internalArray[i] = -1;
+    }
+    for (int32_t i = 0; i < context->storedStringsHashMap.capacity; ++i) {
+        context->storedStringsHashMap.internalArray[i] = -1;
+    }
     for (int32_t i = 0; i < context->measureTextHashMap.capacity; ++i) {
         context->measureTextHashMap.internalArray[i] = 0;
     }
@@ -4063,6 +5925,9 @@ void Clay_SetCurrentContext(Clay_Context* context) {
 CLAY_WASM_EXPORT("Clay_GetScrollOffset")
 Clay_Vector2 Clay_GetScrollOffset(void) {
     Clay_Context* context = Clay_GetCurrentContext();
+    if (Clay__MemoRecording(context)) {
+        context->memoScrollOffsetQueried = true;
+    }
     if (context->booleanWarnings.maxElementsExceeded) {
         return CLAY__INIT(Clay_Vector2) CLAY__DEFAULT_STRUCT;
     }
@@ -4080,6 +5945,96 @@ Clay_Vector2 Clay_GetScrollOffset(void) {
     return CLAY__INIT(Clay_Vector2) CLAY__DEFAULT_STRUCT;
 }
 
+#define CLAY__SCROLL_FRICTION 3.0776f // Exponential velocity decay rate per second, equivalent to the previous 0.95 per frame at 60hz
+#define CLAY__SCROLL_STOP_VELOCITY 6.0f // Pixels per second, below which momentum stops
+#define CLAY__SCROLL_FLING_VELOCITY_SCALE 2.4f // Fling velocity relative to the average drag velocity
+#define CLAY__SCROLL_SPRING_FREQUENCY 12.0f // Natural frequency of the critically damped overscroll spring, in radians per second
+
+// e^x without libm: range reduction to x = n * ln(2) + r with |r| <= ln(2) / 2, then a degree 7 polynomial
+float Clay__Exp(float x) {
+    if (x < -87.0f) return 0;
+    if (x > 88.0f) return CLAY__MAXFLOAT;
+    float n = Clay__Floor(x * 1.44269504f + 0.5f);
+    float r = x - n * 0.693147181f;
+    float result = 1 + r * (1 + r * (1.0f / 2 + r * (1.0f / 6 + r * (1.0f / 24 + r * (1.0f / 120 + r * (1.0f / 720 + r * (1.0f / 5040)))))));
+    union { float asFloat; uint32_t asInt; } scale;
+    scale.asInt = (uint32_t)((int32_t)n + 127) << 23;
+    return result * scale.asFloat;
+}
+
+// ln(x) for x > 0 without libm: x = m * 2^e with m in [1, 2), then the atanh series for ln(m)
+float Clay__Log(float x) {
+    union { float asFloat; uint32_t asInt; } bits;
+    bits.asFloat = x;
+    int32_t exponent = (int32_t)((bits.asInt >> 23) & 0xFF) - 127;
+    bits.asInt = (bits.asInt & 0x007FFFFF) | 0x3F800000;
+    float s = (bits.asFloat - 1) / (bits.asFloat + 1);
+    float s2 = s * s;
+    float logMantissa = 2 * s * (1 + s2 * (1.0f / 3 + s2 * (1.0f / 5 + s2 * (1.0f / 7 + s2 * (1.0f / 9)))));
+    return logMantissa + (float)exponent * 0.693147181f;
+}
+
+// Evaluates a scroll motion at the given elapsed time, between minBound and a maximum bound of zero. Returns false once the motion has come to rest.
+// A fling follows p(t) = p0 + v0 / k * (1 - e^(-kt)). If it would pass a bound, the time it gets there is solved for directly,
+// and it continues from the bound as a critically damped spring x(t) = (x0 + (v0 + w * x0) * t) * e^(-wt), starting with the velocity it hit the bound with.
+bool Clay__EvaluateScrollMotion(Clay__ScrollMotion *motion, float time, float minBound, float *position) {
+    float springStart, springVelocity, bound, springTime;
+    if (motion->type == CLAY__SCROLL_MOTION_FLING) {
+        float velocity = motion->startVelocity;
+        float speed = velocity < 0 ? -velocity : velocity;
+        float stopTime = speed > CLAY__SCROLL_STOP_VELOCITY ? Clay__Log(speed / CLAY__SCROLL_STOP_VELOCITY) / CLAY__SCROLL_FRICTION : 0;
+        bound = velocity < 0 ? minBound : 0;
+        // The fraction of the velocity left when the bound is reached. The motion only approaches p0 + v0 / k, so it can be out of reach
+        float remaining = velocity == 0 ? 0 : 1 - (bound - motion->startPosition) * CLAY__SCROLL_FRICTION / velocity;
+        float boundTime = remaining <= 0 ? CLAY__MAXFLOAT : (remaining >= 1 ? 0 : -Clay__Log(remaining) / CLAY__SCROLL_FRICTION);
+        if (boundTime >= stopTime || time < boundTime) {
+            float t = CLAY__MIN(time, stopTime);
+            *position = motion->startPosition + velocity / CLAY__SCROLL_FRICTION * (1 - Clay__Exp(-CLAY__SCROLL_FRICTION * t));
+            return time < stopTime;
+        }
+        springStart = 0;
+        springVelocity = velocity * CLAY__MIN(remaining, 1);
+        springTime = time - boundTime;
+    } else {
+        bound = motion->bound;
+        springStart = motion->startPosition - bound;
+        springVelocity = motion->startVelocity;
+        springTime = time;
+    }
+    float w = CLAY__SCROLL_SPRING_FREQUENCY;
+    float decay = Clay__Exp(-w * springTime);
+    float b = springVelocity + w * springStart;
+    float offset = (springStart + b * springTime) * decay;
+    float velocity = (springVelocity - w * b * springTime) * decay;
+    if (offset > -0.5f && offset < 0.5f && velocity > -CLAY__SCROLL_STOP_VELOCITY && velocity < CLAY__SCROLL_STOP_VELOCITY) {
+        *position = bound;
+        return false;
+    }
+    *position = bound + offset;
+    return true;
+}
+
+// Advances the motion along one axis and returns the new scroll position
+float Clay__UpdateScrollMotion(Clay__ScrollMotion *motion, float position, float minBound, float deltaTime) {
+    // A position set from outside, e.g. through Clay_GetScrollContainerData(), takes precedence over momentum
+    if (motion->type != CLAY__SCROLL_MOTION_NONE && motion->position != position) {
+        motion->type = CLAY__SCROLL_MOTION_NONE;
+    }
+    if (motion->type == CLAY__SCROLL_MOTION_NONE) {
+        // Spring back into range, for example after the content shrank
+        if (position <= 0 && position >= minBound) {
+            return position;
+        }
+        *motion = CLAY__INIT(Clay__ScrollMotion) { .startPosition = position, .bound = position > 0 ? 0 : minBound, .type = CLAY__SCROLL_MOTION_SPRING };
+    }
+    motion->elapsed += deltaTime;
+    if (!Clay__EvaluateScrollMotion(motion, motion->elapsed, minBound, &position)) {
+        motion->type = CLAY__SCROLL_MOTION_NONE;
+    }
+    motion->position = position;
+    return position;
+}
+
 CLAY_WASM_EXPORT("Clay_UpdateScrollContainers")
 void Clay_UpdateScrollContainers(bool enableDragScrolling, Clay_Vector2 scrollDelta, float deltaTime) {
     Clay_Context* context = Clay_GetCurrentContext();
@@ -4101,15 +6056,19 @@ void Clay_UpdateScrollContainers(bool enableDragScrolling, Clay_Vector2 scrollDe
             continue;
         }
 
+        float minScrollX = -CLAY__MAX(scrollData->contentSize.width - scrollData->layoutElement->dimensions.width, 0);
+        float minScrollY = -CLAY__MAX(scrollData->contentSize.height - scrollData->layoutElement->dimensions.height, 0);
         // Touch / click is released
         if (!isPointerActive && scrollData->pointerScrollActive) {
+            // Fling with the average velocity of the drag. A release in the same frame as the press counts as one frame at 60hz
+            float dragTime = CLAY__MAX(scrollData->momentumTime, 1.0f / 60.0f);
             float xDiff = scrollData->scrollPosition.x - scrollData->scrollOrigin.x;
             if (xDiff < -10 || xDiff > 10) {
-                scrollData->scrollMomentum.x = (scrollData->scrollPosition.x - scrollData->scrollOrigin.x) / (scrollData->momentumTime * 25);
+                scrollData->motionX = CLAY__INIT(Clay__ScrollMotion) { .startPosition = scrollData->scrollPosition.x, .startVelocity = xDiff / dragTime * CLAY__SCROLL_FLING_VELOCITY_SCALE, .position = scrollData->scrollPosition.x, .type = CLAY__SCROLL_MOTION_FLING };
             }
             float yDiff = scrollData->scrollPosition.y - scrollData->scrollOrigin.y;
             if (yDiff < -10 || yDiff > 10) {
-                scrollData->scrollMomentum.y = (scrollData->scrollPosition.y - scrollData->scrollOrigin.y) / (scrollData->momentumTime * 25);
+                scrollData->motionY = CLAY__INIT(Clay__ScrollMotion) { .startPosition = scrollData->scrollPosition.y, .startVelocity = yDiff / dragTime * CLAY__SCROLL_FLING_VELOCITY_SCALE, .position = scrollData->scrollPosition.y, .type = CLAY__SCROLL_MOTION_FLING };
             }
             scrollData->pointerScrollActive = false;
 
@@ -4119,20 +6078,12 @@ void Clay_UpdateScrollContainers(bool enableDragScrolling, Clay_Vector2 scrollDe
         }
 
         // Apply existing momentum
-        scrollData->scrollPosition.x += scrollData->scrollMomentum.x;
-        scrollData->scrollMomentum.x *= 0.95f;
-        bool scrollOccurred = scrollDelta.x != 0 || scrollDelta.y != 0;
-        if ((scrollData->scrollMomentum.x > -0.1f && scrollData->scrollMomentum.x < 0.1f) || scrollOccurred) {
-            scrollData->scrollMomentum.x = 0;
-        }
-        scrollData->scrollPosition.x = CLAY__MIN(CLAY__MAX(scrollData->scrollPosition.x, -(CLAY__MAX(scrollData->contentSize.width - scrollData->layoutElement->dimensions.width, 0))), 0);
-
-        scrollData->scrollPosition.y += scrollData->scrollMomentum.y;
-        scrollData->scrollMomentum.y *= 0.95f;
-        if ((scrollData->scrollMomentum.y > -0.1f && scrollData->scrollMomentum.y < 0.1f) || scrollOccurred) {
-            scrollData->scrollMomentum.y = 0;
+        if (scrollDelta.x != 0 || scrollDelta.y != 0) {
+            scrollData->motionX.type = CLAY__SCROLL_MOTION_NONE;
+            scrollData->motionY.type = CLAY__SCROLL_MOTION_NONE;
         }
-        scrollData->scrollPosition.y = CLAY__MIN(CLAY__MAX(scrollData->scrollPosition.y, -(CLAY__MAX(scrollData->contentSize.height - scrollData->layoutElement->dimensions.height, 0))), 0);
+        scrollData->scrollPosition.x = Clay__UpdateScrollMotion(&scrollData->motionX, scrollData->scrollPosition.x, minScrollX, deltaTime);
+        scrollData->scrollPosition.y = Clay__UpdateScrollMotion(&scrollData->motionY, scrollData->scrollPosition.y, minScrollY, deltaTime);
 
         for (int32_t j = 0; j < context->pointerOverIds.length; ++j) { // TODO n & m are small here but this being n*m gives me the creeps
             if (scrollData->layoutElement->id == Clay_ElementIdArray_Get(&context->pointerOverIds, j)->id) {
@@ -4156,7 +6107,8 @@ void Clay_UpdateScrollContainers(bool enableDragScrolling, Clay_Vector2 scrollDe
         }
         // Handle click / touch scroll
         if (isPointerActive) {
-            highestPriorityScrollData->scrollMomentum = CLAY__INIT(Clay_Vector2)CLAY__DEFAULT_STRUCT;
+            highestPriorityScrollData->motionX.type = CLAY__SCROLL_MOTION_NONE;
+            highestPriorityScrollData->motionY.type = CLAY__SCROLL_MOTION_NONE;
             if (!highestPriorityScrollData->pointerScrollActive) {
                 highestPriorityScrollData->pointerOrigin = context->pointerInfo.position;
                 highestPriorityScrollData->scrollOrigin = highestPriorityScrollData->scrollPosition;
@@ -4184,22 +6136,154 @@ void Clay_UpdateScrollContainers(bool enableDragScrolling, Clay_Vector2 scrollDe
                 }
             }
         }
-        // Clamp any changes to scroll position to the maximum size of the contents
-        if (canScrollVertically) {
+        // Clamp any changes to scroll position to the maximum size of the contents. Momentum is left to spring back from overscroll on its own.
+        bool inputOccurred = isPointerActive || scrollDelta.x != 0 || scrollDelta.y != 0;
+        if (canScrollVertically && inputOccurred) {
             highestPriorityScrollData->scrollPosition.y = CLAY__MAX(CLAY__MIN(highestPriorityScrollData->scrollPosition.y, 0), -(highestPriorityScrollData->contentSize.height - scrollElement->dimensions.height));
         }
-        if (canScrollHorizontally) {
+        if (canScrollHorizontally && inputOccurred) {
             highestPriorityScrollData->scrollPosition.x = CLAY__MAX(CLAY__MIN(highestPriorityScrollData->scrollPosition.x, 0), -(highestPriorityScrollData->contentSize.width - scrollElement->dimensions.width));
         }
     }
 }
 
+CLAY_WASM_EXPORT("Clay_PredictScrollPosition")
+Clay_Vector2 Clay_PredictScrollPosition(Clay_ElementId id, float timeAhead) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    for (int32_t i = 0; i < context->scrollContainerDatas.length; ++i) {
+        Clay__ScrollContainerDataInternal *scrollData = Clay__ScrollContainerDataInternalArray_Get(&context->scrollContainerDatas, i);
+        if (scrollData->elementId != id.id) {
+            continue;
+        }
+        Clay_Vector2 position = scrollData->scrollPosition;
+        if (scrollData->motionX.type != CLAY__SCROLL_MOTION_NONE && scrollData->motionX.position == position.x) {
+            float minScrollX = -CLAY__MAX(scrollData->contentSize.width - scrollData->layoutElement->dimensions.width, 0);
+            Clay__EvaluateScrollMotion(&scrollData->motionX, scrollData->motionX.elapsed + timeAhead, minScrollX, &position.x);
+        }
+        if (scrollData->motionY.type != CLAY__SCROLL_MOTION_NONE && scrollData->motionY.position == position.y) {
+            float minScrollY = -CLAY__MAX(scrollData->contentSize.height - scrollData->layoutElement->dimensions.height, 0);
+            Clay__EvaluateScrollMotion(&scrollData->motionY, scrollData->motionY.elapsed + timeAhead, minScrollY, &position.y);
+        }
+        return position;
+    }
+    return CLAY__INIT(Clay_Vector2) CLAY__DEFAULT_STRUCT;
+}
+
+CLAY_WASM_EXPORT("Clay_ScrollAnimationsActive")
+bool Clay_ScrollAnimationsActive(void) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    for (int32_t i = 0; i < context->scrollContainerDatas.length; ++i) {
+        Clay__ScrollContainerDataInternal *scrollData = Clay__ScrollContainerDataInternalArray_Get(&context->scrollContainerDatas, i);
+        if (scrollData->motionX.type != CLAY__SCROLL_MOTION_NONE || scrollData->motionY.type != CLAY__SCROLL_MOTION_NONE) {
+            return true;
+        }
+    }
+    return false;
+}
+
+CLAY_WASM_EXPORT("Clay_UpdateTransitions")
+void Clay_UpdateTransitions(float deltaTime) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    Clay__TransitionData *transitions = &context->transitions;
+    int32_t capacity = transitions->elementIds.capacity;
+    // Release the state of elements that weren't declared during the last layout
+    for (int32_t i = 0; i < transitions->elementIds.length; ++i) {
+        if (transitions->generations.internalArray[i] >= context->generation) {
+            continue;
+        }
+        Clay_LayoutElementHashMapItem *removedItem = Clay__GetHashMapItem(transitions->elementIds.internalArray[i]);
+        if (removedItem != &Clay_LayoutElementHashMapItem_DEFAULT) {
+            removedItem->transitionIndex = -1;
+        }
+        int32_t lastIndex = transitions->elementIds.length - 1;
+        if (i < lastIndex) {
+            Clay_LayoutElementHashMapItem *movedItem = Clay__GetHashMapItem(transitions->elementIds.internalArray[lastIndex]);
+            if (movedItem != &Clay_LayoutElementHashMapItem_DEFAULT) {
+                movedItem->transitionIndex = i;
+            }
+            transitions->generations.internalArray[i] = transitions->generations.internalArray[lastIndex];
+            transitions->progress.internalArray[i] = transitions->progress.internalArray[lastIndex];
+            transitions->inverseDuration.internalArray[i] = transitions->inverseDuration.internalArray[lastIndex];
+            transitions->easingLinear.internalArray[i] = transitions->easingLinear.internalArray[lastIndex];
+            transitions->easingQuadratic.internalArray[i] = transitions->easingQuadratic.internalArray[lastIndex];
+            transitions->easingCubic.internalArray[i] = transitions->easingCubic.internalArray[lastIndex];
+            for (int32_t channel = 0; channel < CLAY__TRANSITION_CHANNEL_COUNT; ++channel) {
+                transitions->from.internalArray[channel * capacity + i] = transitions->from.internalArray[channel * capacity + lastIndex];
+                transitions->to.internalArray[channel * capacity + i] = transitions->to.internalArray[channel * capacity + lastIndex];
+                transitions->current.internalArray[channel * capacity + i] = transitions->current.internalArray[channel * capacity + lastIndex];
+            }
+        }
+        Clay__uint32_tArray_RemoveSwapback(&transitions->elementIds, i);
+        i--;
+    }
+
+    // Advance all transitions in flat passes over the parallel arrays, with no per element branching beyond the clamp
+    int32_t count = transitions->elementIds.length;
+    float *progress = transitions->progress.internalArray;
+    float *inverseDuration = transitions->inverseDuration.internalArray;
+    float *eased = transitions->eased.internalArray;
+    for (int32_t i = 0; i < count; ++i) {
+        float nextProgress = progress[i] + deltaTime * inverseDuration[i];
+        progress[i] = nextProgress < 1 ? nextProgress : 1;
+    }
+    float *linear = transitions->easingLinear.internalArray;
+    float *quadratic = transitions->easingQuadratic.internalArray;
+    float *cubic = transitions->easingCubic.internalArray;
+    for (int32_t i = 0; i < count; ++i) {
+        float t = progress[i];
+        eased[i] = t * (linear[i] + t * (quadratic[i] + t * cubic[i]));
+    }
+    for (int32_t channel = 0; channel < CLAY__TRANSITION_CHANNEL_COUNT; ++channel) {
+        float *from = transitions->from.internalArray + channel * capacity;
+        float *to = transitions->to.internalArray + channel * capacity;
+        float *current = transitions->current.internalArray + channel * capacity;
+        for (int32_t i = 0; i < count; ++i) {
+            current[i] = from[i] + (to[i] - from[i]) * eased[i];
+        }
+    }
+}
+
+CLAY_WASM_EXPORT("Clay_TransitionsActive")
+bool Clay_TransitionsActive(void) {
+    Clay__TransitionData *transitions = &Clay_GetCurrentContext()->transitions;
+    for (int32_t i = 0; i < transitions->elementIds.length; ++i) {
+        if (transitions->progress.internalArray[i] < 1) {
+            return true;
+        }
+    }
+    return false;
+}
+
 CLAY_WASM_EXPORT("Clay_BeginLayout")
 void Clay_BeginLayout(void) {
     Clay_Context* context = Clay_GetCurrentContext();
     Clay__InitializeEphemeralMemory(context);
     context->generation++;
     context->dynamicElementIndex = 0;
+    context->layoutHash = 2166136261u;
+    Clay__UpdateStringStore(context);
+    // The recordings made last frame become the ones available for replay
+    Clay__charArray previousMemoOps = context->previousMemoOps;
+    context->previousMemoOps = context->memoOps;
+    context->memoOps = previousMemoOps;
+    context->memoOps.length = 0;
+    Clay__int32_tArray *memoHashMap = &context->memoEntriesHashMap;
+    for (int32_t i = 0; i < context->previousMemoEntries.length; ++i) {
+        memoHashMap->internalArray[context->previousMemoEntries.internalArray[i].id % memoHashMap->capacity] = -1;
+    }
+    Clay__MemoEntryArray previousMemoEntries = context->previousMemoEntries;
+    context->previousMemoEntries = context->memoEntries;
+    context->memoEntries = previousMemoEntries;
+    context->memoEntries.length = 0;
+    context->memoStack.length = 0;
+    context->memoScrollOffsetQueried = false;
+    for (int32_t i = context->previousMemoEntries.length - 1; i >= 0; --i) {
+        Clay__MemoEntry *entry = &context->previousMemoEntries.internalArray[i];
+        int32_t *bucket = &memoHashMap->internalArray[entry->id % memoHashMap->capacity];
+        entry->nextIndex = *bucket;
+        *bucket = i;
+    }
+    Clay__HashLayoutInput((uint32_t)context->disableCulling | ((uint32_t)context->externalScrollHandlingEnabled << 1) | ((uint32_t)context->debugModeEnabled << 2));
     // Set up the root container that covers the entire window
     Clay_Dimensions rootDimensions = {context->layoutDimensions.width, context->layoutDimensions.height};
     if (context->debugModeEnabled) {
@@ -4225,7 +6309,23 @@ Clay_RenderCommandArray Clay_EndLayout(void) {
         Clay__RenderDebugView();
         context->warningsEnabled = true;
     }
+    context->renderCommandUpdates.length = 0;
+    context->layoutChanged = true;
+    // Floating roots are positioned from their parents' boxes as of the last full layout, which can lag a frame behind, so a change in those boxes must lay out again
+    for (int32_t i = 0; i < context->layoutElementTreeRoots.length; ++i) {
+        Clay__LayoutElementTreeRoot *root = Clay__LayoutElementTreeRootArray_Get(&context->layoutElementTreeRoots, i);
+        if (root->parentId) {
+            Clay_BoundingBox parentBoundingBox = Clay__GetHashMapItem(root->parentId)->boundingBox;
+            Clay__HashLayoutInputFloat(parentBoundingBox.x);
+            Clay__HashLayoutInputFloat(parentBoundingBox.y);
+            Clay__HashLayoutInputFloat(parentBoundingBox.width);
+            Clay__HashLayoutInputFloat(parentBoundingBox.height);
+        }
+    }
     if (context->booleanWarnings.maxElementsExceeded) {
+        context->renderCommands.length = 0;
+        context->renderCommandSources.length = 0;
+        context->previousLayoutHash = 0;
         Clay_String message;
         if (!elementsExceededBeforeDebugView) {
             message = CLAY_STRING("Clay Error: Layout elements exceeded Clay__maxElementCount after adding the debug-view to the layout.");
@@ -4237,12 +6337,37 @@ Clay_RenderCommandArray Clay_EndLayout(void) {
             .renderData = { .text = { .stringContents = CLAY__INIT(Clay_StringSlice) { .length = message.length, .chars = message.chars, .baseChars = message.chars }, .textColor = {255, 0, 0, 255}, .fontSize = 16 } },
             .commandType = CLAY_RENDER_COMMAND_TYPE_TEXT
         });
+    } else if (!context->debugModeEnabled && context->previousLayoutHash != 0 && context->layoutHash == context->previousLayoutHash) {
+        context->layoutChanged = false;
+        Clay__UpdatePaintOnlyRenderCommands();
     } else {
+        context->renderCommands.length = 0;
+        context->renderCommandSources.length = 0;
         Clay__CalculateFinalLayout();
+        for (int32_t i = 0; i < context->layoutElements.length; ++i) {
+            context->previousLayoutElementDimensions.internalArray[i] = context->layoutElements.internalArray[i].dimensions;
+        }
+        context->previousLayoutHash = context->debugModeEnabled || context->booleanWarnings.maxRenderCommandsExceeded ? 0 : context->layoutHash;
     }
+    Clay__CalculateDamageRects();
     return context->renderCommands;
 }
 
+CLAY_WASM_EXPORT("Clay_GetRenderCommandUpdates")
+Clay_RenderCommandUpdates Clay_GetRenderCommandUpdates(void) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    return CLAY__INIT(Clay_RenderCommandUpdates) {
+        .layoutChanged = context->layoutChanged,
+        .length = context->renderCommandUpdates.length,
+        .indexes = context->renderCommandUpdates.internalArray,
+    };
+}
+
+CLAY_WASM_EXPORT("Clay_GetDamageRects")
+Clay_DamageRectArray Clay_GetDamageRects(void) {
+    return Clay_GetCurrentContext()->damageRects;
+}
+
 CLAY_WASM_EXPORT("Clay_GetElementId")
 Clay_ElementId Clay_GetElementId(Clay_String idString) {
     return Clay__HashString(idString, 0, 0);
@@ -4276,6 +6401,12 @@ void Clay_OnHover(void (*onHoverFunction)(Clay_ElementId elementId, Clay_Pointer
     if (context->booleanWarnings.maxElementsExceeded) {
         return;
     }
+    if (Clay__MemoRecording(context)) {
+        Clay__MemoOnHoverOp *op = (Clay__MemoOnHoverOp *)Clay__RecordMemoOp(CLAY__MEMO_OP_ON_HOVER, sizeof(Clay__MemoOnHoverOp), CLAY__NULL);
+        if (op) {
+            *op = CLAY__INIT(Clay__MemoOnHoverOp) { .onHoverFunction = onHoverFunction, .userData = userData };
+        }
+    }
     Clay_LayoutElement *openLayoutElement = Clay__GetOpenLayoutElement();
     if (openLayoutElement->id == 0) {
         Clay__GenerateIdForAnonymousElement(openLayoutElement);
@@ -4337,6 +6468,79 @@ Clay_ElementData Clay_GetElementData(Clay_ElementId id){
     };
 }
 
+Clay_GeometryArray Clay__GetGeometryRange(int32_t start, int32_t end) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    return CLAY__INIT(Clay_GeometryArray) {
+        .length = end - start,
+        .offset = start,
+        .ids = context->geometryIds.internalArray + start,
+        .x = context->geometryX.internalArray + start,
+        .y = context->geometryY.internalArray + start,
+        .width = context->geometryWidths.internalArray + start,
+        .height = context->geometryHeights.internalArray + start,
+        .parents = context->geometryParents.internalArray + start,
+        .subtreeEnds = context->geometrySubtreeEnds.internalArray + start,
+    };
+}
+
+int32_t Clay__GetGeometryIndex(uint32_t id) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    Clay_LayoutElementHashMapItem *hashMapItem = Clay__GetHashMapItem(id);
+    int32_t index = hashMapItem->geometryIndex;
+    if (hashMapItem == &Clay_LayoutElementHashMapItem_DEFAULT || index < 0 || index >= context->geometryIds.length) {
+        return -1;
+    }
+    // The index is stale if a different element was laid out there by a later layout
+    uint32_t geometryId = context->geometryIds.internalArray[index];
+    if (geometryId != id && Clay__GetHashMapItem(geometryId)->idAlias != id) {
+        return -1;
+    }
+    return index;
+}
+
+CLAY_WASM_EXPORT("Clay_GetGeometry")
+Clay_GeometryArray Clay_GetGeometry(void) {
+    return Clay__GetGeometryRange(0, Clay_GetCurrentContext()->geometryIds.length);
+}
+
+CLAY_WASM_EXPORT("Clay_GetSubtreeGeometry")
+Clay_GeometryArray Clay_GetSubtreeGeometry(Clay_ElementId id) {
+    int32_t index = Clay__GetGeometryIndex(id.id);
+    if (index < 0) {
+        return CLAY__INIT(Clay_GeometryArray) CLAY__DEFAULT_STRUCT;
+    }
+    return Clay__GetGeometryRange(index, Clay_GetCurrentContext()->geometrySubtreeEnds.internalArray[index]);
+}
+
+CLAY_WASM_EXPORT("Clay_GetGeometryIndexes")
+int32_t Clay_GetGeometryIndexes(const Clay_ElementId *ids, int32_t count, int32_t *indexes) {
+    int32_t found = 0;
+    for (int32_t i = 0; i < count; ++i) {
+        indexes[i] = Clay__GetGeometryIndex(ids[i].id);
+        found += indexes[i] >= 0;
+    }
+    return found;
+}
+
+CLAY_WASM_EXPORT("Clay_GetGridCellData")
+Clay_ElementData Clay_GetGridCellData(Clay_ElementId gridId, int32_t row, int32_t column) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    Clay__GridData *gridData = Clay__GetGridData(gridId.id);
+    if (!gridData || gridData->rowCount == 0 || row < 0 || column < 0 || column >= gridData->columnCount) {
+        return CLAY__INIT(Clay_ElementData) CLAY__DEFAULT_STRUCT;
+    }
+    Clay__GridTrackData *columnTrack = Clay__GridTrackDataArray_Get(&context->gridTracks, gridData->tracksStart + column);
+    Clay__GridTrackData *rowTrack = Clay__GridTrackDataArray_Get(&context->gridTracks, gridData->tracksStart + gridData->columnCount + CLAY__MIN(row, gridData->rowCount - 1));
+    float rowOffset = rowTrack->offset;
+    if (row >= gridData->rowCount) {
+        rowOffset += (float)(row - gridData->rowCount + 1) * (rowTrack->size + gridData->childGap);
+    }
+    return CLAY__INIT(Clay_ElementData) {
+        .boundingBox = { gridData->origin.x + columnTrack->offset, gridData->origin.y + rowOffset, columnTrack->size, rowTrack->size },
+        .found = true
+    };
+}
+
 CLAY_WASM_EXPORT("Clay_SetDebugModeEnabled")
 void Clay_SetDebugModeEnabled(bool enabled) {
     Clay_Context* context = Clay_GetCurrentContext();
@@ -4394,6 +6598,54 @@ void Clay_SetMaxMeasureTextCacheWordCount(int32_t maxMeasureTextCacheWordCount)
     }
 }
 
+CLAY_WASM_EXPORT("Clay_GetMaxTransitionCount")
+int32_t Clay_GetMaxTransitionCount(void) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    return context->maxTransitionCount;
+}
+
+CLAY_WASM_EXPORT("Clay_SetMaxTransitionCount")
+void Clay_SetMaxTransitionCount(int32_t maxTransitionCount) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    if (context) {
+        context->maxTransitionCount = maxTransitionCount;
+    } else {
+        Clay__defaultMaxTransitionCount = maxTransitionCount;
+    }
+}
+
+CLAY_WASM_EXPORT("Clay_GetMaxMemoBytes")
+int32_t Clay_GetMaxMemoBytes(void) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    return context->maxMemoBytes;
+}
+
+CLAY_WASM_EXPORT("Clay_SetMaxMemoBytes")
+void Clay_SetMaxMemoBytes(int32_t maxMemoBytes) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    if (context) {
+        context->maxMemoBytes = maxMemoBytes;
+    } else {
+        Clay__defaultMaxMemoBytes = maxMemoBytes;
+    }
+}
+
+CLAY_WASM_EXPORT("Clay_GetMaxStringStoreBytes")
+int32_t Clay_GetMaxStringStoreBytes(void) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    return context->maxStringStoreBytes;
+}
+
+CLAY_WASM_EXPORT("Clay_SetMaxStringStoreBytes")
+void Clay_SetMaxStringStoreBytes(int32_t maxStringStoreBytes) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    if (context) {
+        context->maxStringStoreBytes = maxStringStoreBytes;
+    } else {
+        Clay__defaultMaxStringStoreBytes = maxStringStoreBytes;
+    }
+}
+
 CLAY_WASM_EXPORT("Clay_ResetMeasureTextCache")
 void Clay_ResetMeasureTextCache(void) {
     Clay_Context* context = Clay_GetCurrentContext();
@@ -4407,6 +6659,7 @@ void Clay_ResetMeasureTextCache(void) {
         context->measureTextHashMap.internalArray[i] = 0;
     }
     context->measureTextHashMapInternal.length = 1; // Reserve the 0 value to mean "no next element"
+    context->previousLayoutHash = 0; // Text may measure differently, so the next layout can't reuse the previous one
 }
 
 #endif // CLAY_IMPLEMENTATION
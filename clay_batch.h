@@ -0,0 +1,340 @@
+/*
+    Instanced draw batches for Clay render commands.
+
+    Converts a Clay_RenderCommandArray into a small number of batches, each a contiguous range of instances in
+    structure of arrays form: rects, colors, corner radii, border widths and clip indexes. This suits GPU backends
+    that draw every batch as a single instanced draw call, reading each attribute array as its own vertex buffer.
+    The output is plain arrays without any GPU API dependencies, so batching can be tested and benchmarked headlessly.
+
+    NOTE: In order to use this library you must define the following macro in exactly one file,
+    _after_ including clay.h and _before_ including this file:
+
+    #define CLAY_BATCH_IMPLEMENTATION
+    #include "clay_batch.h"
+
+    Usage:
+
+    Clay_Batches batches = { 0 }; // Keep it across frames to reuse its memory
+    Clay_Batch_Build(&batches, renderCommands, (Clay_BatchConfig) { 0 });
+    // Upload batches.rects, batches.colors, ... in one go, then for every batch:
+    //     bind batches.batches[i].resource, set the scissor to batches.clipRects[batches.batches[i].clipIndex],
+    //     draw batches.batches[i].instanceCount instances starting at batches.batches[i].instanceStart
+    Clay_Batch_Free(&batches);
+
+    Commands are grouped by their command type, zIndex, scissor state and resource (image, font or custom data).
+    A command joins an earlier batch with the same key if it doesn't overlap anything drawn by the batches in between,
+    so drawing the batches in order looks the same as drawing the commands in order. Commands are never moved across
+    zIndex changes, and commands entirely outside their scissor rect are culled.
+
+    TEXT and CUSTOM instances only describe the box and color of each command. The renderer looks up the rest through
+    .commandIndexes, e.g. to lay out the glyphs of each string into its own glyph instances.
+*/
+
+#ifndef CLAY_BATCH_H
+#define CLAY_BATCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum {
+    CLAY_BATCH_TYPE_RECTANGLE,
+    CLAY_BATCH_TYPE_BORDER,
+    CLAY_BATCH_TYPE_TEXT,
+    CLAY_BATCH_TYPE_IMAGE,
+    CLAY_BATCH_TYPE_CUSTOM,
+} Clay_BatchType;
+
+// A range of instances that can be drawn with a single draw call.
+typedef struct Clay_Batch {
+    Clay_BatchType type;
+    int16_t zIndex;
+    // Text batches share a font
+    uint16_t fontId;
+    // The scissor rect shared by every instance, an index into Clay_Batches.clipRects. Zero when clipping per instance.
+    int32_t clipIndex;
+    // The .imageData of image batches or the .customData of custom batches, shared by every instance. NULL for other types.
+    void *resource;
+    int32_t instanceStart;
+    int32_t instanceCount;
+} Clay_Batch;
+
+typedef struct Clay_BatchConfig {
+    // How many batches back a command can be moved to join a batch with the same key. Defaults to 8.
+    int32_t lookback;
+    // Don't split batches at scissor changes, for renderers that clip in the shader using .clipIndexes.
+    bool clipPerInstance;
+} Clay_BatchConfig;
+
+// The batches for a single Clay_RenderCommandArray. Zero initialize it and keep it across frames to reuse its memory.
+typedef struct Clay_Batches {
+    Clay_Batch *batches;
+    int32_t batchCount;
+    int32_t instanceCount;
+    // Instance attributes, instanceCount entries each. Attributes with four components are stored as consecutive floats.
+    float *rects; // x, y, width, height
+    float *colors; // r, g, b, a, conventionally 0-255 like Clay_Color
+    float *cornerRadii; // topLeft, topRight, bottomLeft, bottomRight
+    float *borderWidths; // left, right, top, bottom, zero for everything but borders
+    int32_t *clipIndexes; // Indexes into .clipRects
+    int32_t *commandIndexes; // The index of the render command that produced each instance
+    // Nested scissor rects are already intersected. Index zero is an unbounded rect, used outside of any scissor.
+    Clay_BoundingBox *clipRects;
+    int32_t clipCount;
+    // Internal
+    int32_t capacity;
+    int32_t *commandBatches;
+    int32_t *commandClips;
+    Clay_BoundingBox *batchBounds;
+} Clay_Batches;
+
+// Rebuilds the batches for the given render commands. Returns false if memory couldn't be allocated, in which case there are no batches.
+bool Clay_Batch_Build(Clay_Batches *batches, Clay_RenderCommandArray renderCommands, Clay_BatchConfig config);
+// Frees the memory held by the batches.
+void Clay_Batch_Free(Clay_Batches *batches);
+
+#endif // CLAY_BATCH_H
+
+#ifdef CLAY_BATCH_IMPLEMENTATION
+#undef CLAY_BATCH_IMPLEMENTATION
+
+#include <stdlib.h>
+#include <float.h>
+
+#define CLAY__BATCH_DEFAULT_LOOKBACK 8
+#define CLAY__BATCH_MAX_CLIP_DEPTH 64
+
+static bool Clay__BatchGrow(void **memory, int32_t capacity, size_t elementSize) {
+    void *grown = realloc(*memory, (size_t)capacity * elementSize);
+    if (!grown) return false;
+    *memory = grown;
+    return true;
+}
+
+static bool Clay__BatchReserve(Clay_Batches *batches, int32_t commandCount) {
+    // Every command produces at most one batch, one instance and one clip rect, plus the unbounded clip rect
+    int32_t required = commandCount + 1;
+    if (required <= batches->capacity) return true;
+    int32_t capacity = CLAY__MAX(required, batches->capacity * 2);
+    // Arrays grown before a failure are simply grown again on the next attempt
+    if (!Clay__BatchGrow((void **)&batches->batches, capacity, sizeof(Clay_Batch))
+        || !Clay__BatchGrow((void **)&batches->rects, capacity, sizeof(float) * 4)
+        || !Clay__BatchGrow((void **)&batches->colors, capacity, sizeof(float) * 4)
+        || !Clay__BatchGrow((void **)&batches->cornerRadii, capacity, sizeof(float) * 4)
+        || !Clay__BatchGrow((void **)&batches->borderWidths, capacity, sizeof(float) * 4)
+        || !Clay__BatchGrow((void **)&batches->clipIndexes, capacity, sizeof(int32_t))
+        || !Clay__BatchGrow((void **)&batches->commandIndexes, capacity, sizeof(int32_t))
+        || !Clay__BatchGrow((void **)&batches->clipRects, capacity, sizeof(Clay_BoundingBox))
+        || !Clay__BatchGrow((void **)&batches->commandBatches, capacity, sizeof(int32_t))
+        || !Clay__BatchGrow((void **)&batches->commandClips, capacity, sizeof(int32_t))
+        || !Clay__BatchGrow((void **)&batches->batchBounds, capacity, sizeof(Clay_BoundingBox))) {
+        return false;
+    }
+    batches->capacity = capacity;
+    return true;
+}
+
+static inline bool Clay__BatchOverlaps(Clay_BoundingBox a, Clay_BoundingBox b) {
+    return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+static inline Clay_BoundingBox Clay__BatchIntersect(Clay_BoundingBox a, Clay_BoundingBox b) {
+    float x0 = CLAY__MAX(a.x, b.x), y0 = CLAY__MAX(a.y, b.y);
+    float x1 = CLAY__MIN(a.x + a.width, b.x + b.width), y1 = CLAY__MIN(a.y + a.height, b.y + b.height);
+    return CLAY__INIT(Clay_BoundingBox) { x0, y0, CLAY__MAX(x1 - x0, 0), CLAY__MAX(y1 - y0, 0) };
+}
+
+static inline Clay_BoundingBox Clay__BatchUnion(Clay_BoundingBox a, Clay_BoundingBox b) {
+    float x0 = CLAY__MIN(a.x, b.x), y0 = CLAY__MIN(a.y, b.y);
+    float x1 = CLAY__MAX(a.x + a.width, b.x + b.width), y1 = CLAY__MAX(a.y + a.height, b.y + b.height);
+    return CLAY__INIT(Clay_BoundingBox) { x0, y0, x1 - x0, y1 - y0 };
+}
+
+// Assigns every drawable command to a batch, in a single scalar pass over the commands
+static void Clay__BatchAssign(Clay_Batches *batches, Clay_RenderCommandArray renderCommands, Clay_BatchConfig config) {
+    int32_t lookback = config.lookback > 0 ? config.lookback : CLAY__BATCH_DEFAULT_LOOKBACK;
+    int32_t clipStack[CLAY__BATCH_MAX_CLIP_DEPTH];
+    int32_t clipDepth = 0;
+    // Scissors nested deeper than the stack keep their parent's clip, and are counted so that their ends don't pop it
+    int32_t droppedClipDepth = 0;
+    clipStack[0] = 0;
+    batches->clipRects[0] = CLAY__INIT(Clay_BoundingBox) { -FLT_MAX / 4, -FLT_MAX / 4, FLT_MAX / 2, FLT_MAX / 2 };
+    batches->clipCount = 1;
+    batches->batchCount = 0;
+    for (int32_t i = 0; i < renderCommands.length; ++i) {
+        Clay_RenderCommand *renderCommand = &renderCommands.internalArray[i];
+        Clay_BoundingBox box = renderCommand->boundingBox;
+        batches->commandBatches[i] = -1;
+        Clay_BatchType type;
+        Clay_Batch key = { .zIndex = renderCommand->zIndex };
+        switch (renderCommand->commandType) {
+            case CLAY_RENDER_COMMAND_TYPE_SCISSOR_START: {
+                Clay_BoundingBox parent = batches->clipRects[clipStack[clipDepth]];
+                Clay_BoundingBox scissor = parent;
+                // Clip elements only clip along the axes they were configured to
+                if (renderCommand->renderData.clip.horizontal) { scissor.x = box.x; scissor.width = box.width; }
+                if (renderCommand->renderData.clip.vertical) { scissor.y = box.y; scissor.height = box.height; }
+                if (clipDepth < CLAY__BATCH_MAX_CLIP_DEPTH - 1) {
+                    batches->clipRects[batches->clipCount] = Clay__BatchIntersect(parent, scissor);
+                    clipStack[++clipDepth] = batches->clipCount++;
+                } else {
+                    droppedClipDepth++;
+                }
+                continue;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_SCISSOR_END: {
+                if (droppedClipDepth > 0) {
+                    droppedClipDepth--;
+                } else if (clipDepth > 0) {
+                    clipDepth--;
+                }
+                continue;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_RECTANGLE: type = CLAY_BATCH_TYPE_RECTANGLE; break;
+            case CLAY_RENDER_COMMAND_TYPE_BORDER: type = CLAY_BATCH_TYPE_BORDER; break;
+            case CLAY_RENDER_COMMAND_TYPE_TEXT: {
+                type = CLAY_BATCH_TYPE_TEXT;
+                key.fontId = renderCommand->renderData.text.fontId;
+                // Glyphs can overflow the measured line, so text is given some slack when checking for overlaps
+                float slack = renderCommand->renderData.text.fontSize;
+                box = CLAY__INIT(Clay_BoundingBox) { box.x - slack, box.y - slack, box.width + slack * 2, box.height + slack * 2 };
+                break;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_IMAGE: {
+                type = CLAY_BATCH_TYPE_IMAGE;
+                key.resource = renderCommand->renderData.image.imageData;
+                break;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_CUSTOM: {
+                type = CLAY_BATCH_TYPE_CUSTOM;
+                key.resource = renderCommand->renderData.custom.customData;
+                break;
+            }
+            default: continue;
+        }
+        int32_t clipIndex = clipStack[clipDepth];
+        Clay_BoundingBox visible = Clay__BatchIntersect(box, batches->clipRects[clipIndex]);
+        if (visible.width <= 0 || visible.height <= 0) continue;
+        key.type = type;
+        key.clipIndex = config.clipPerInstance ? 0 : clipIndex;
+
+        // Walk back through the recent batches for one with the same key. Every batch walked past is drawn after the
+        // one found, so the command can only move back past batches it doesn't overlap.
+        int32_t target = -1;
+        for (int32_t j = batches->batchCount - 1; j >= 0 && j >= batches->batchCount - lookback; --j) {
+            Clay_Batch *batch = &batches->batches[j];
+            if (batch->zIndex != key.zIndex) break;
+            if (batch->type == key.type && batch->clipIndex == key.clipIndex && batch->resource == key.resource && batch->fontId == key.fontId) {
+                target = j;
+                break;
+            }
+            if (Clay__BatchOverlaps(batches->batchBounds[j], visible)) break;
+        }
+        if (target == -1) {
+            target = batches->batchCount++;
+            batches->batches[target] = key;
+            batches->batchBounds[target] = visible;
+        } else {
+            batches->batchBounds[target] = Clay__BatchUnion(batches->batchBounds[target], visible);
+        }
+        batches->batches[target].instanceCount++;
+        batches->commandBatches[i] = target;
+        batches->commandClips[i] = clipIndex;
+    }
+}
+
+// Copies the attributes of a batch's instances. Each loop is over a single batch type and attribute, so the loops are
+// branch free and write their arrays sequentially.
+static void Clay__BatchFillInstances(Clay_Batches *batches, Clay_RenderCommandArray renderCommands, Clay_Batch *batch) {
+    int32_t start = batch->instanceStart, end = batch->instanceStart + batch->instanceCount;
+    const int32_t *commandIndexes = batches->commandIndexes;
+    Clay_RenderCommand *commands = renderCommands.internalArray;
+    float *rects = batches->rects, *colors = batches->colors, *cornerRadii = batches->cornerRadii, *borderWidths = batches->borderWidths;
+    for (int32_t i = start; i < end; ++i) {
+        Clay_BoundingBox box = commands[commandIndexes[i]].boundingBox;
+        rects[i * 4 + 0] = box.x;
+        rects[i * 4 + 1] = box.y;
+        rects[i * 4 + 2] = box.width;
+        rects[i * 4 + 3] = box.height;
+    }
+    for (int32_t i = start; i < end; ++i) {
+        Clay_RenderData *data = &commands[commandIndexes[i]].renderData;
+        // Every type but text starts with its color, and only borders have widths
+        Clay_Color color = batch->type == CLAY_BATCH_TYPE_TEXT ? data->text.textColor : data->rectangle.backgroundColor;
+        colors[i * 4 + 0] = color.r;
+        colors[i * 4 + 1] = color.g;
+        colors[i * 4 + 2] = color.b;
+        colors[i * 4 + 3] = color.a;
+    }
+    if (batch->type == CLAY_BATCH_TYPE_TEXT) {
+        for (int32_t i = start * 4; i < end * 4; ++i) {
+            cornerRadii[i] = 0;
+        }
+    } else {
+        for (int32_t i = start; i < end; ++i) {
+            Clay_CornerRadius radius = commands[commandIndexes[i]].renderData.rectangle.cornerRadius;
+            cornerRadii[i * 4 + 0] = radius.topLeft;
+            cornerRadii[i * 4 + 1] = radius.topRight;
+            cornerRadii[i * 4 + 2] = radius.bottomLeft;
+            cornerRadii[i * 4 + 3] = radius.bottomRight;
+        }
+    }
+    if (batch->type == CLAY_BATCH_TYPE_BORDER) {
+        for (int32_t i = start; i < end; ++i) {
+            Clay_BorderWidth width = commands[commandIndexes[i]].renderData.border.width;
+            borderWidths[i * 4 + 0] = width.left;
+            borderWidths[i * 4 + 1] = width.right;
+            borderWidths[i * 4 + 2] = width.top;
+            borderWidths[i * 4 + 3] = width.bottom;
+        }
+    } else {
+        for (int32_t i = start * 4; i < end * 4; ++i) {
+            borderWidths[i] = 0;
+        }
+    }
+}
+
+bool Clay_Batch_Build(Clay_Batches *batches, Clay_RenderCommandArray renderCommands, Clay_BatchConfig config) {
+    batches->batchCount = 0;
+    batches->instanceCount = 0;
+    batches->clipCount = 0;
+    if (!Clay__BatchReserve(batches, renderCommands.length)) return false;
+    Clay__BatchAssign(batches, renderCommands, config);
+
+    // Lay the batches out one after another, then scatter the commands into their batch's range in command order
+    int32_t instanceCount = 0;
+    for (int32_t i = 0; i < batches->batchCount; ++i) {
+        batches->batches[i].instanceStart = instanceCount;
+        instanceCount += batches->batches[i].instanceCount;
+        batches->batches[i].instanceCount = 0;
+    }
+    batches->instanceCount = instanceCount;
+    for (int32_t i = 0; i < renderCommands.length; ++i) {
+        int32_t batchIndex = batches->commandBatches[i];
+        if (batchIndex < 0) continue;
+        Clay_Batch *batch = &batches->batches[batchIndex];
+        int32_t instance = batch->instanceStart + batch->instanceCount++;
+        batches->commandIndexes[instance] = i;
+        batches->clipIndexes[instance] = batches->commandClips[i];
+    }
+    for (int32_t i = 0; i < batches->batchCount; ++i) {
+        Clay__BatchFillInstances(batches, renderCommands, &batches->batches[i]);
+    }
+    return true;
+}
+
+void Clay_Batch_Free(Clay_Batches *batches) {
+    free(batches->batches);
+    free(batches->rects);
+    free(batches->colors);
+    free(batches->cornerRadii);
+    free(batches->borderWidths);
+    free(batches->clipIndexes);
+    free(batches->commandIndexes);
+    free(batches->clipRects);
+    free(batches->commandBatches);
+    free(batches->commandClips);
+    free(batches->batchBounds);
+    *batches = CLAY__INIT(Clay_Batches) CLAY__DEFAULT_STRUCT;
+}
+
+#endif // CLAY_BATCH_IMPLEMENTATION
@@ -0,0 +1,855 @@
+/*
+    Asynchronous image loading and caching for Clay image elements.
+
+    Images are requested by key while declaring a layout, and decoded on a pool of worker threads. Each image is
+    downsampled while it decodes to the size it is displayed at, so full resolution bitmaps are never kept. Decoded
+    images are kept in a cache with a byte budget, and the least recently requested images are evicted first.
+
+    NOTE: In order to use this library you must define the following macro in exactly one file,
+    _after_ including clay.h and _before_ including this file:
+
+    #define CLAY_IMAGE_IMPLEMENTATION
+    #include "clay_image.h"
+
+    Usage:
+
+    // Once per frame, before declaring the layout
+    bool imagesChanged = Clay_Image_Update(cache);
+
+    // While declaring. The size of the element's previous layout, in pixels, is the size the image is decoded at
+    Clay_BoundingBox box = Clay_GetElementData(CLAY_ID("Avatar")).boundingBox;
+    Clay_Image *avatar = Clay_Image_Request(cache, CLAY_STRING("avatar.qoi"), (Clay_Dimensions) { box.width * scale, box.height * scale });
+    CLAY({ .id = CLAY_ID("Avatar"), .aspectRatio = { Clay_Image_GetAspectRatio(avatar, 1) }, .image = { avatar, avatar->version } }) {}
+
+    Renderers receive the Clay_Image as the image command's .imageData. Until .state is CLAY_IMAGE_STATE_READY there
+    are no pixels, and a placeholder should be drawn instead. Clay_Image_Update() returns true when any image's pixels
+    changed, since that doesn't necessarily change the layout. Passing .version as the element's .imageVersion lets
+    Clay_GetDamageRects() repaint the image when its pixels change.
+
+    QOI and binary PPM / PGM (P6 / P5) images are decoded out of the box. Other formats can be supported by setting
+    .decodeFunction, for example to use the platform's image decoders.
+
+    Keys are file paths by default. Set .loadFunction to load images from anywhere else.
+
+    Define CLAY_IMAGE_NO_THREADS to build without pthreads, in which case images are decoded during Clay_Image_Update().
+*/
+
+#ifndef CLAY_IMAGE_H
+#define CLAY_IMAGE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef enum {
+    // Waiting to be decoded, without any pixels yet. Lay out and draw a placeholder.
+    CLAY_IMAGE_STATE_LOADING,
+    // .pixels holds the decoded image.
+    CLAY_IMAGE_STATE_READY,
+    // The image couldn't be loaded or decoded.
+    CLAY_IMAGE_STATE_FAILED,
+} Clay_ImageState;
+
+// A requested image. The pointer returned by Clay_Image_Request() stays valid until an update in which it wasn't requested since the previous update.
+typedef struct Clay_Image {
+    Clay_ImageState state;
+    // The size of .pixels, which is downsampled from the source image to cover the largest requested size
+    int32_t width;
+    int32_t height;
+    // The full size of the source image, known once the image is ready
+    int32_t sourceWidth;
+    int32_t sourceHeight;
+    // width * height pixels, stored as bytes in R, G, B, A order with premultiplied alpha and tightly packed rows
+    const uint8_t *pixels;
+    // Changes whenever .pixels changes, and is unique across the cache, so renderers can tell when to upload the image again. Zero until the image is ready.
+    uint32_t version;
+    // Free for the renderer to attach a texture to. Passed to .releaseRendererData when the pixels are replaced or evicted.
+    void *rendererData;
+} Clay_Image;
+
+// The encoded bytes of an image, as loaded by a Clay_ImageCacheConfig.loadFunction
+typedef struct Clay_ImageBytes {
+    const uint8_t *data;
+    size_t length;
+    void *handle; // Passed back to .releaseBytesFunction, e.g. the object that owns .data
+} Clay_ImageBytes;
+
+// Decoded pixels returned by a Clay_ImageCacheConfig.decodeFunction
+typedef struct Clay_ImageDecodedPixels {
+    uint8_t *pixels; // Allocated with malloc(), in the same layout as Clay_Image.pixels. The cache takes ownership.
+    int32_t width;
+    int32_t height;
+    int32_t sourceWidth;
+    int32_t sourceHeight;
+} Clay_ImageDecodedPixels;
+
+typedef struct Clay_ImageCacheConfig {
+    // The number of bytes of decoded pixels to keep. Images requested since the previous update are never evicted, so this can be exceeded while they're on screen.
+    // Defaults to 64MiB.
+    size_t byteBudget;
+    // Defaults to 2.
+    int32_t workerCount;
+    // Loads the encoded bytes of an image on a worker thread, returning false if it can't be loaded.
+    // Defaults to reading the file at the path given by the key.
+    bool (*loadFunction)(Clay_String key, Clay_ImageBytes *bytes, void *userData);
+    // Releases bytes returned by .loadFunction. Defaults to free(bytes.handle).
+    void (*releaseBytesFunction)(Clay_ImageBytes bytes, void *userData);
+    // Decodes formats that aren't built in, on a worker thread. Returning pixels larger than targetWidth x targetHeight is fine,
+    // they'll be downsampled. A target size of zero means the full size. Returns false if the format isn't supported.
+    bool (*decodeFunction)(Clay_ImageBytes bytes, int32_t targetWidth, int32_t targetHeight, Clay_ImageDecodedPixels *pixels, void *userData);
+    // Called on the thread calling Clay_Image_Update() when an image's .rendererData is about to be discarded.
+    void (*releaseRendererData)(Clay_Image *image, void *userData);
+    void *userData;
+} Clay_ImageCacheConfig;
+
+typedef struct Clay_ImageCache Clay_ImageCache;
+
+// Creates a cache and starts its worker threads. Returns NULL if memory couldn't be allocated.
+Clay_ImageCache *Clay_Image_CreateCache(Clay_ImageCacheConfig config);
+// Stops the worker threads, and frees the cache and every image in it.
+void Clay_Image_DestroyCache(Clay_ImageCache *cache);
+// Publishes images that finished decoding, cancels decodes of images that weren't requested since the previous update,
+// and evicts the least recently requested images while over the byte budget. Call once per frame, before declaring the layout.
+// Returns true if any image's pixels changed.
+bool Clay_Image_Update(Clay_ImageCache *cache);
+// Returns the image for a key, starting to decode it if needed. targetSize is the size in pixels that the image will be
+// displayed at. Images are decoded at the smallest size that covers it, and decoded again if a larger size is requested later.
+// A zero targetSize requests the full size. The key is copied.
+Clay_Image *Clay_Image_Request(Clay_ImageCache *cache, Clay_String key, Clay_Dimensions targetSize);
+// Returns the width divided by height of a ready image, or fallback while it's loading, for use with .aspectRatio.
+float Clay_Image_GetAspectRatio(const Clay_Image *image, float fallback);
+// Returns the number of bytes of decoded pixels currently held by the cache.
+size_t Clay_Image_GetCachedBytes(const Clay_ImageCache *cache);
+// Gets the size that an image of sourceWidth x sourceHeight is decoded at for a target size: the smallest size with the
+// source's aspect ratio that covers the target, without upsampling. A custom .decodeFunction can use it to decode straight to that size.
+void Clay_Image_GetDecodeSize(int32_t sourceWidth, int32_t sourceHeight, int32_t targetWidth, int32_t targetHeight, int32_t *width, int32_t *height);
+
+#endif // CLAY_IMAGE_H
+
+#ifdef CLAY_IMAGE_IMPLEMENTATION
+#undef CLAY_IMAGE_IMPLEMENTATION
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#ifndef CLAY_IMAGE_NO_THREADS
+#include <pthread.h>
+#endif
+
+#define CLAY__IMAGE_DEFAULT_BYTE_BUDGET (64 * 1024 * 1024)
+#define CLAY__IMAGE_DEFAULT_WORKER_COUNT 2
+#define CLAY__IMAGE_MAX_PIXELS 400000000
+// Bookkeeping for an entry is charged against the byte budget too, so that failed and cancelled images are eventually evicted
+#define CLAY__IMAGE_ENTRY_OVERHEAD 256
+
+// A decode running on a worker. Workers only touch jobs, never entries, so that entries belong to the calling thread.
+typedef struct Clay__ImageJob {
+    struct Clay__ImageJob *next;
+    struct Clay__ImageEntry *entry;
+    char *key;
+    int32_t keyLength;
+    int32_t targetWidth;
+    int32_t targetHeight;
+    // Results
+    bool failed;
+    Clay_ImageDecodedPixels result;
+} Clay__ImageJob;
+
+typedef struct Clay__ImageEntry {
+    Clay_Image image;
+    struct Clay__ImageEntry *hashNext;
+    struct Clay__ImageEntry *lruPrevious; // Towards the most recently requested
+    struct Clay__ImageEntry *lruNext;
+    Clay__ImageJob *job; // The pending decode, if any
+    char *key;
+    int32_t keyLength;
+    uint32_t hash;
+    uint64_t requestedUpdate; // The value of updateCount when the image was last requested
+    // The largest size requested since the image was last decoded
+    int32_t targetWidth;
+    int32_t targetHeight;
+} Clay__ImageEntry;
+
+struct Clay_ImageCache {
+    Clay_ImageCacheConfig config;
+    Clay__ImageEntry **buckets;
+    int32_t bucketCount;
+    int32_t entryCount;
+    Clay__ImageEntry *lruFirst; // Most recently requested
+    Clay__ImageEntry *lruLast;
+    size_t cachedBytes;
+    uint32_t nextVersion;
+    uint64_t updateCount;
+    // Shared with the workers, guarded by .mutex
+    Clay__ImageJob *queue; // Newest first, so that the images requested most recently are decoded first
+    Clay__ImageJob *completed;
+    bool stopping;
+#ifndef CLAY_IMAGE_NO_THREADS
+    pthread_t *workers;
+    int32_t workerCount;
+    pthread_mutex_t mutex;
+    pthread_cond_t jobAvailable;
+#endif
+};
+
+// Loading -----------------------------------------
+
+static bool Clay__ImageLoadFile(Clay_String key, Clay_ImageBytes *bytes, void *userData) {
+    (void)userData;
+    char *path = (char *)malloc((size_t)key.length + 1);
+    if (!path) return false;
+    memcpy(path, key.chars, (size_t)key.length);
+    path[key.length] = 0;
+    FILE *file = fopen(path, "rb");
+    free(path);
+    if (!file) return false;
+    uint8_t *data = NULL;
+    size_t length = 0;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        long size = ftell(file);
+        if (size > 0 && fseek(file, 0, SEEK_SET) == 0) {
+            data = (uint8_t *)malloc((size_t)size);
+            length = data ? fread(data, 1, (size_t)size, file) : 0;
+        }
+    }
+    fclose(file);
+    if (!data || length == 0) {
+        free(data);
+        return false;
+    }
+    *bytes = (Clay_ImageBytes) { .data = data, .length = length, .handle = data };
+    return true;
+}
+
+static void Clay__ImageReleaseFile(Clay_ImageBytes bytes, void *userData) {
+    (void)userData;
+    free(bytes.handle);
+}
+
+// Downsampling ------------------------------------
+
+// Box filters rows of source pixels into the destination as they're decoded, so that only a single source row is held.
+// Each source pixel falls into exactly one destination pixel, and every destination pixel averages the source pixels that fall into it.
+typedef struct {
+    int32_t sourceWidth;
+    int32_t sourceHeight;
+    int32_t width;
+    int32_t height;
+    bool premultiplied; // Whether source rows already have premultiplied alpha
+    uint8_t *pixels;
+    uint64_t *sums; // Four channels for every destination column of the current destination row
+    int32_t *columnCounts; // The number of source columns falling into each destination column
+    int32_t destinationRow;
+    int32_t rowCount; // Source rows accumulated into the current destination row
+} Clay__ImageResampler;
+
+static bool Clay__ImageResamplerBegin(Clay__ImageResampler *resampler, int32_t sourceWidth, int32_t sourceHeight, int32_t targetWidth, int32_t targetHeight, bool premultiplied) {
+    *resampler = (Clay__ImageResampler) { .sourceWidth = sourceWidth, .sourceHeight = sourceHeight, .premultiplied = premultiplied };
+    Clay_Image_GetDecodeSize(sourceWidth, sourceHeight, targetWidth, targetHeight, &resampler->width, &resampler->height);
+    resampler->pixels = (uint8_t *)malloc((size_t)resampler->width * (size_t)resampler->height * 4);
+    resampler->sums = (uint64_t *)calloc((size_t)resampler->width * 4, sizeof(uint64_t));
+    resampler->columnCounts = (int32_t *)calloc((size_t)resampler->width, sizeof(int32_t));
+    if (!resampler->pixels || !resampler->sums || !resampler->columnCounts) {
+        free(resampler->pixels);
+        free(resampler->sums);
+        free(resampler->columnCounts);
+        resampler->pixels = NULL;
+        return false;
+    }
+    for (int32_t x = 0; x < sourceWidth; ++x) {
+        resampler->columnCounts[(int64_t)x * resampler->width / sourceWidth]++;
+    }
+    return true;
+}
+
+static void Clay__ImageResamplerFlush(Clay__ImageResampler *resampler) {
+    if (resampler->rowCount == 0) return;
+    uint8_t *row = resampler->pixels + (size_t)resampler->destinationRow * (size_t)resampler->width * 4;
+    for (int32_t x = 0; x < resampler->width; ++x) {
+        uint64_t count = (uint64_t)resampler->columnCounts[x] * (uint64_t)resampler->rowCount;
+        for (int32_t channel = 0; channel < 4; ++channel) {
+            row[x * 4 + channel] = (uint8_t)((resampler->sums[x * 4 + channel] + count / 2) / count);
+            resampler->sums[x * 4 + channel] = 0;
+        }
+    }
+    resampler->rowCount = 0;
+}
+
+// Adds a row of sourceWidth RGBA pixels. Rows must be added in order from the top.
+static void Clay__ImageResamplerAddRow(Clay__ImageResampler *resampler, int32_t sourceRow, const uint8_t *pixels) {
+    int32_t destinationRow = (int32_t)((int64_t)sourceRow * resampler->height / resampler->sourceHeight);
+    if (destinationRow != resampler->destinationRow) {
+        Clay__ImageResamplerFlush(resampler);
+        resampler->destinationRow = destinationRow;
+    }
+    // Averaging premultiplied colors keeps transparent pixels from bleeding their color into their neighbours
+    uint64_t *sums = resampler->sums;
+    for (int32_t x = 0; x < resampler->sourceWidth; ++x) {
+        const uint8_t *pixel = pixels + x * 4;
+        uint64_t *sum = sums + ((int64_t)x * resampler->width / resampler->sourceWidth) * 4;
+        uint32_t alpha = pixel[3];
+        if (resampler->premultiplied || alpha == 255) {
+            sum[0] += pixel[0];
+            sum[1] += pixel[1];
+            sum[2] += pixel[2];
+        } else {
+            sum[0] += (pixel[0] * alpha + 127) / 255;
+            sum[1] += (pixel[1] * alpha + 127) / 255;
+            sum[2] += (pixel[2] * alpha + 127) / 255;
+        }
+        sum[3] += alpha;
+    }
+    resampler->rowCount++;
+}
+
+static void Clay__ImageResamplerEnd(Clay__ImageResampler *resampler, Clay_ImageDecodedPixels *result) {
+    Clay__ImageResamplerFlush(resampler);
+    free(resampler->sums);
+    free(resampler->columnCounts);
+    *result = (Clay_ImageDecodedPixels) {
+        .pixels = resampler->pixels,
+        .width = resampler->width,
+        .height = resampler->height,
+        .sourceWidth = resampler->sourceWidth,
+        .sourceHeight = resampler->sourceHeight,
+    };
+}
+
+static void Clay__ImageResamplerAbort(Clay__ImageResampler *resampler) {
+    free(resampler->pixels);
+    free(resampler->sums);
+    free(resampler->columnCounts);
+}
+
+// Decoding ----------------------------------------
+
+static bool Clay__ImageValidSize(uint32_t width, uint32_t height) {
+    return width > 0 && height > 0 && (uint64_t)width * height <= CLAY__IMAGE_MAX_PIXELS;
+}
+
+// https://qoiformat.org/qoi-specification.pdf
+static bool Clay__ImageDecodeQOI(Clay_ImageBytes bytes, int32_t targetWidth, int32_t targetHeight, Clay_ImageDecodedPixels *result) {
+    const uint8_t *data = bytes.data;
+    size_t length = bytes.length;
+    if (length < 14 + 8 || memcmp(data, "qoif", 4) != 0) return false;
+    uint32_t width = ((uint32_t)data[4] << 24) | ((uint32_t)data[5] << 16) | ((uint32_t)data[6] << 8) | data[7];
+    uint32_t height = ((uint32_t)data[8] << 24) | ((uint32_t)data[9] << 16) | ((uint32_t)data[10] << 8) | data[11];
+    if (!Clay__ImageValidSize(width, height)) return false;
+
+    Clay__ImageResampler resampler;
+    uint8_t *row = (uint8_t *)malloc((size_t)width * 4);
+    if (!row || !Clay__ImageResamplerBegin(&resampler, (int32_t)width, (int32_t)height, targetWidth, targetHeight, false)) {
+        free(row);
+        return false;
+    }
+    uint8_t index[64 * 4] = { 0 };
+    uint8_t pixel[4] = { 0, 0, 0, 255 };
+    size_t offset = 14;
+    size_t end = length - 8; // The stream ends with 7 zero bytes and a one
+    int32_t run = 0;
+    bool failed = false;
+    for (uint32_t y = 0; y < height && !failed; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            if (run > 0) {
+                run--;
+            } else if (offset < end) {
+                uint8_t op = data[offset++];
+                if (op == 0xFE) {
+                    if (offset + 3 > end) { failed = true; break; }
+                    pixel[0] = data[offset]; pixel[1] = data[offset + 1]; pixel[2] = data[offset + 2];
+                    offset += 3;
+                } else if (op == 0xFF) {
+                    if (offset + 4 > end) { failed = true; break; }
+                    memcpy(pixel, data + offset, 4);
+                    offset += 4;
+                } else if ((op & 0xC0) == 0x00) {
+                    memcpy(pixel, index + (op & 0x3F) * 4, 4);
+                } else if ((op & 0xC0) == 0x40) {
+                    pixel[0] += ((op >> 4) & 0x03) - 2;
+                    pixel[1] += ((op >> 2) & 0x03) - 2;
+                    pixel[2] += (op & 0x03) - 2;
+                } else if ((op & 0xC0) == 0x80) {
+                    if (offset + 1 > end) { failed = true; break; }
+                    uint8_t next = data[offset++];
+                    int32_t greenDelta = (op & 0x3F) - 32;
+                    pixel[0] += greenDelta - 8 + ((next >> 4) & 0x0F);
+                    pixel[1] += greenDelta;
+                    pixel[2] += greenDelta - 8 + (next & 0x0F);
+                } else {
+                    run = op & 0x3F;
+                }
+                memcpy(index + ((pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + pixel[3] * 11) % 64) * 4, pixel, 4);
+            } else {
+                failed = true;
+                break;
+            }
+            memcpy(row + x * 4, pixel, 4);
+        }
+        if (!failed) {
+            Clay__ImageResamplerAddRow(&resampler, (int32_t)y, row);
+        }
+    }
+    free(row);
+    if (failed) {
+        Clay__ImageResamplerAbort(&resampler);
+        return false;
+    }
+    Clay__ImageResamplerEnd(&resampler, result);
+    return true;
+}
+
+static bool Clay__ImageReadPNMNumber(const uint8_t *data, size_t length, size_t *offset, uint32_t *value) {
+    // Skip whitespace and comments
+    while (*offset < length) {
+        uint8_t c = data[*offset];
+        if (c == '#') {
+            while (*offset < length && data[*offset] != '\n') (*offset)++;
+        } else if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            (*offset)++;
+        } else {
+            break;
+        }
+    }
+    uint64_t result = 0;
+    size_t start = *offset;
+    while (*offset < length && data[*offset] >= '0' && data[*offset] <= '9' && result <= 0xFFFFFFFF) {
+        result = result * 10 + (data[(*offset)++] - '0');
+    }
+    *value = (uint32_t)result;
+    return *offset > start && result <= 0xFFFFFFFF;
+}
+
+// Binary PPM (P6) and PGM (P5), with 8 or 16 bits per sample
+static bool Clay__ImageDecodePNM(Clay_ImageBytes bytes, int32_t targetWidth, int32_t targetHeight, Clay_ImageDecodedPixels *result) {
+    const uint8_t *data = bytes.data;
+    size_t length = bytes.length;
+    if (length < 3 || data[0] != 'P' || (data[1] != '5' && data[1] != '6')) return false;
+    uint32_t channels = data[1] == '6' ? 3 : 1;
+    size_t offset = 2;
+    uint32_t width, height, maxValue;
+    if (!Clay__ImageReadPNMNumber(data, length, &offset, &width)
+        || !Clay__ImageReadPNMNumber(data, length, &offset, &height)
+        || !Clay__ImageReadPNMNumber(data, length, &offset, &maxValue)) {
+        return false;
+    }
+    offset++; // A single whitespace character separates the header from the samples
+    if (!Clay__ImageValidSize(width, height) || maxValue == 0 || maxValue > 65535) return false;
+    uint32_t sampleSize = maxValue < 256 ? 1 : 2;
+    size_t rowSize = (size_t)width * channels * sampleSize;
+    if (offset > length || (length - offset) / rowSize < height) return false;
+
+    Clay__ImageResampler resampler;
+    uint8_t *row = (uint8_t *)malloc((size_t)width * 4);
+    if (!row || !Clay__ImageResamplerBegin(&resampler, (int32_t)width, (int32_t)height, targetWidth, targetHeight, true)) {
+        free(row);
+        return false;
+    }
+    for (uint32_t y = 0; y < height; ++y) {
+        const uint8_t *samples = data + offset + y * rowSize;
+        for (uint32_t x = 0; x < width; ++x) {
+            for (uint32_t channel = 0; channel < 3; ++channel) {
+                const uint8_t *sample = samples + (x * channels + (channels == 3 ? channel : 0)) * sampleSize;
+                uint32_t value = sampleSize == 1 ? sample[0] : ((uint32_t)sample[0] << 8) | sample[1];
+                row[x * 4 + channel] = (uint8_t)(value >= maxValue ? 255 : (value * 255 + maxValue / 2) / maxValue);
+            }
+            row[x * 4 + 3] = 255;
+        }
+        Clay__ImageResamplerAddRow(&resampler, (int32_t)y, row);
+    }
+    free(row);
+    Clay__ImageResamplerEnd(&resampler, result);
+    return true;
+}
+
+// Downsamples pixels returned by a custom decoder that are larger than needed
+static bool Clay__ImageDownsampleDecoded(Clay_ImageDecodedPixels *pixels, int32_t targetWidth, int32_t targetHeight) {
+    int32_t width, height;
+    Clay_Image_GetDecodeSize(pixels->width, pixels->height, targetWidth, targetHeight, &width, &height);
+    if (width == pixels->width && height == pixels->height) return true;
+    Clay__ImageResampler resampler;
+    if (!Clay__ImageResamplerBegin(&resampler, pixels->width, pixels->height, targetWidth, targetHeight, true)) return false;
+    for (int32_t y = 0; y < pixels->height; ++y) {
+        Clay__ImageResamplerAddRow(&resampler, y, pixels->pixels + (size_t)y * (size_t)pixels->width * 4);
+    }
+    int32_t sourceWidth = pixels->sourceWidth, sourceHeight = pixels->sourceHeight;
+    free(pixels->pixels);
+    Clay__ImageResamplerEnd(&resampler, pixels);
+    pixels->sourceWidth = sourceWidth;
+    pixels->sourceHeight = sourceHeight;
+    return true;
+}
+
+static void Clay__ImageRunJob(Clay_ImageCache *cache, Clay__ImageJob *job) {
+    Clay_ImageCacheConfig *config = &cache->config;
+    Clay_ImageBytes bytes = { 0 };
+    job->failed = true;
+    if (!config->loadFunction((Clay_String) { .length = job->keyLength, .chars = job->key }, &bytes, config->userData)) {
+        return;
+    }
+    if (Clay__ImageDecodeQOI(bytes, job->targetWidth, job->targetHeight, &job->result)
+        || Clay__ImageDecodePNM(bytes, job->targetWidth, job->targetHeight, &job->result)) {
+        job->failed = false;
+    } else if (config->decodeFunction && config->decodeFunction(bytes, job->targetWidth, job->targetHeight, &job->result, config->userData)) {
+        if (job->result.sourceWidth == 0) {
+            job->result.sourceWidth = job->result.width;
+            job->result.sourceHeight = job->result.height;
+        }
+        job->failed = !Clay__ImageDownsampleDecoded(&job->result, job->targetWidth, job->targetHeight);
+    }
+    config->releaseBytesFunction(bytes, config->userData);
+}
+
+// Worker pool -------------------------------------
+
+#ifndef CLAY_IMAGE_NO_THREADS
+static void *Clay__ImageWorker(void *argument) {
+    Clay_ImageCache *cache = (Clay_ImageCache *)argument;
+    pthread_mutex_lock(&cache->mutex);
+    while (true) {
+        while (!cache->queue && !cache->stopping) {
+            pthread_cond_wait(&cache->jobAvailable, &cache->mutex);
+        }
+        if (cache->stopping) break;
+        Clay__ImageJob *job = cache->queue;
+        cache->queue = job->next;
+        pthread_mutex_unlock(&cache->mutex);
+        Clay__ImageRunJob(cache, job);
+        pthread_mutex_lock(&cache->mutex);
+        job->next = cache->completed;
+        cache->completed = job;
+    }
+    pthread_mutex_unlock(&cache->mutex);
+    return NULL;
+}
+#endif
+
+static void Clay__ImageLock(Clay_ImageCache *cache) {
+#ifndef CLAY_IMAGE_NO_THREADS
+    pthread_mutex_lock(&cache->mutex);
+#else
+    (void)cache;
+#endif
+}
+
+static void Clay__ImageUnlock(Clay_ImageCache *cache) {
+#ifndef CLAY_IMAGE_NO_THREADS
+    pthread_mutex_unlock(&cache->mutex);
+#else
+    (void)cache;
+#endif
+}
+
+static void Clay__ImageFreeJob(Clay__ImageJob *job) {
+    free(job->result.pixels);
+    free(job->key);
+    free(job);
+}
+
+static void Clay__ImageQueueJob(Clay_ImageCache *cache, Clay__ImageEntry *entry) {
+    Clay__ImageJob *job = (Clay__ImageJob *)calloc(1, sizeof(Clay__ImageJob));
+    char *key = (char *)malloc((size_t)entry->keyLength + 1);
+    if (!job || !key) {
+        free(job);
+        free(key);
+        return;
+    }
+    memcpy(key, entry->key, (size_t)entry->keyLength);
+    key[entry->keyLength] = 0;
+    *job = (Clay__ImageJob) { .entry = entry, .key = key, .keyLength = entry->keyLength, .targetWidth = entry->targetWidth, .targetHeight = entry->targetHeight };
+    entry->job = job;
+    Clay__ImageLock(cache);
+    job->next = cache->queue;
+    cache->queue = job;
+#ifndef CLAY_IMAGE_NO_THREADS
+    pthread_cond_signal(&cache->jobAvailable);
+#endif
+    Clay__ImageUnlock(cache);
+}
+
+// Cache -------------------------------------------
+
+static uint32_t Clay__ImageHashKey(const char *chars, int32_t length) {
+    uint32_t hash = 2166136261u;
+    for (int32_t i = 0; i < length; ++i) {
+        hash = (hash ^ (uint8_t)chars[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static size_t Clay__ImageEntryBytes(Clay__ImageEntry *entry) {
+    return CLAY__IMAGE_ENTRY_OVERHEAD + (size_t)entry->keyLength + (entry->image.pixels ? (size_t)entry->image.width * (size_t)entry->image.height * 4 : 0);
+}
+
+static void Clay__ImageUnlinkLRU(Clay_ImageCache *cache, Clay__ImageEntry *entry) {
+    if (entry->lruPrevious) entry->lruPrevious->lruNext = entry->lruNext; else cache->lruFirst = entry->lruNext;
+    if (entry->lruNext) entry->lruNext->lruPrevious = entry->lruPrevious; else cache->lruLast = entry->lruPrevious;
+    entry->lruPrevious = entry->lruNext = NULL;
+}
+
+static void Clay__ImageLinkLRUFirst(Clay_ImageCache *cache, Clay__ImageEntry *entry) {
+    entry->lruNext = cache->lruFirst;
+    if (cache->lruFirst) cache->lruFirst->lruPrevious = entry; else cache->lruLast = entry;
+    cache->lruFirst = entry;
+}
+
+static void Clay__ImageReleasePixels(Clay_ImageCache *cache, Clay__ImageEntry *entry) {
+    if (entry->image.rendererData && cache->config.releaseRendererData) {
+        cache->config.releaseRendererData(&entry->image, cache->config.userData);
+    }
+    entry->image.rendererData = NULL;
+    free((void *)entry->image.pixels);
+    entry->image.pixels = NULL;
+}
+
+static void Clay__ImageEvict(Clay_ImageCache *cache, Clay__ImageEntry *entry) {
+    Clay__ImageEntry **link = &cache->buckets[entry->hash & (uint32_t)(cache->bucketCount - 1)];
+    while (*link != entry) link = &(*link)->hashNext;
+    *link = entry->hashNext;
+    Clay__ImageUnlinkLRU(cache, entry);
+    cache->cachedBytes -= Clay__ImageEntryBytes(entry);
+    cache->entryCount--;
+    Clay__ImageReleasePixels(cache, entry);
+    free(entry->key);
+    free(entry);
+}
+
+static bool Clay__ImageGrowBuckets(Clay_ImageCache *cache) {
+    int32_t bucketCount = cache->bucketCount ? cache->bucketCount * 2 : 256;
+    Clay__ImageEntry **buckets = (Clay__ImageEntry **)calloc((size_t)bucketCount, sizeof(Clay__ImageEntry *));
+    if (!buckets) return false;
+    for (int32_t i = 0; i < cache->bucketCount; ++i) {
+        Clay__ImageEntry *entry = cache->buckets[i];
+        while (entry) {
+            Clay__ImageEntry *next = entry->hashNext;
+            Clay__ImageEntry **bucket = &buckets[entry->hash & (uint32_t)(bucketCount - 1)];
+            entry->hashNext = *bucket;
+            *bucket = entry;
+            entry = next;
+        }
+    }
+    free(cache->buckets);
+    cache->buckets = buckets;
+    cache->bucketCount = bucketCount;
+    return true;
+}
+
+Clay_ImageCache *Clay_Image_CreateCache(Clay_ImageCacheConfig config) {
+    Clay_ImageCache *cache = (Clay_ImageCache *)calloc(1, sizeof(Clay_ImageCache));
+    if (!cache) return NULL;
+    if (config.byteBudget == 0) config.byteBudget = CLAY__IMAGE_DEFAULT_BYTE_BUDGET;
+    if (config.workerCount <= 0) config.workerCount = CLAY__IMAGE_DEFAULT_WORKER_COUNT;
+    if (!config.loadFunction) config.loadFunction = Clay__ImageLoadFile;
+    if (!config.releaseBytesFunction) config.releaseBytesFunction = Clay__ImageReleaseFile;
+    cache->config = config;
+    if (!Clay__ImageGrowBuckets(cache)) {
+        free(cache);
+        return NULL;
+    }
+#ifndef CLAY_IMAGE_NO_THREADS
+    pthread_mutex_init(&cache->mutex, NULL);
+    pthread_cond_init(&cache->jobAvailable, NULL);
+    cache->workers = (pthread_t *)calloc((size_t)config.workerCount, sizeof(pthread_t));
+    for (int32_t i = 0; cache->workers && i < config.workerCount; ++i) {
+        if (pthread_create(&cache->workers[i], NULL, Clay__ImageWorker, cache) != 0) break;
+        cache->workerCount++;
+    }
+    if (cache->workerCount == 0) {
+        Clay_Image_DestroyCache(cache);
+        return NULL;
+    }
+#endif
+    return cache;
+}
+
+void Clay_Image_DestroyCache(Clay_ImageCache *cache) {
+    if (!cache) return;
+#ifndef CLAY_IMAGE_NO_THREADS
+    pthread_mutex_lock(&cache->mutex);
+    cache->stopping = true;
+    pthread_cond_broadcast(&cache->jobAvailable);
+    pthread_mutex_unlock(&cache->mutex);
+    for (int32_t i = 0; i < cache->workerCount; ++i) {
+        pthread_join(cache->workers[i], NULL);
+    }
+    free(cache->workers);
+    pthread_cond_destroy(&cache->jobAvailable);
+    pthread_mutex_destroy(&cache->mutex);
+#endif
+    Clay__ImageJob *lists[2] = { cache->queue, cache->completed };
+    for (int32_t i = 0; i < 2; ++i) {
+        while (lists[i]) {
+            Clay__ImageJob *next = lists[i]->next;
+            Clay__ImageFreeJob(lists[i]);
+            lists[i] = next;
+        }
+    }
+    while (cache->lruFirst) {
+        Clay__ImageEvict(cache, cache->lruFirst);
+    }
+    free(cache->buckets);
+    free(cache);
+}
+
+bool Clay_Image_Update(Clay_ImageCache *cache) {
+    Clay__ImageJob *completed;
+    Clay__ImageJob *cancelled = NULL;
+    Clay__ImageLock(cache);
+    // Images that scrolled out of view before a worker got to them aren't worth decoding anymore
+    Clay__ImageJob **link = &cache->queue;
+    while (*link) {
+        Clay__ImageJob *job = *link;
+        if (job->entry->requestedUpdate != cache->updateCount) {
+            *link = job->next;
+            job->next = cancelled;
+            cancelled = job;
+        } else {
+            link = &job->next;
+        }
+    }
+#ifdef CLAY_IMAGE_NO_THREADS
+    while (cache->queue) {
+        Clay__ImageJob *job = cache->queue;
+        cache->queue = job->next;
+        Clay__ImageRunJob(cache, job);
+        job->next = cache->completed;
+        cache->completed = job;
+    }
+#endif
+    completed = cache->completed;
+    cache->completed = NULL;
+    Clay__ImageUnlock(cache);
+
+    while (cancelled) {
+        Clay__ImageJob *next = cancelled->next;
+        cancelled->entry->job = NULL;
+        Clay__ImageFreeJob(cancelled);
+        cancelled = next;
+    }
+
+    bool changed = false;
+    while (completed) {
+        Clay__ImageJob *next = completed->next;
+        Clay__ImageEntry *entry = completed->entry;
+        entry->job = NULL;
+        if (completed->failed) {
+            // Keep showing a smaller version if a larger decode fails
+            if (!entry->image.pixels) {
+                entry->image.state = CLAY_IMAGE_STATE_FAILED;
+            }
+        } else {
+            cache->cachedBytes -= Clay__ImageEntryBytes(entry);
+            Clay__ImageReleasePixels(cache, entry);
+            entry->image.pixels = completed->result.pixels;
+            entry->image.width = completed->result.width;
+            entry->image.height = completed->result.height;
+            entry->image.sourceWidth = completed->result.sourceWidth;
+            entry->image.sourceHeight = completed->result.sourceHeight;
+            entry->image.state = CLAY_IMAGE_STATE_READY;
+            entry->image.version = ++cache->nextVersion;
+            cache->cachedBytes += Clay__ImageEntryBytes(entry);
+            completed->result.pixels = NULL;
+            changed = true;
+        }
+        Clay__ImageFreeJob(completed);
+        completed = next;
+    }
+
+    // The list is ordered by request, so once an image requested since the previous update is reached, so are all the ones before it.
+    // Images still being decoded are skipped, and evicted on a later update.
+    Clay__ImageEntry *entry = cache->lruLast;
+    while (cache->cachedBytes > cache->config.byteBudget && entry && entry->requestedUpdate != cache->updateCount) {
+        Clay__ImageEntry *previous = entry->lruPrevious;
+        if (!entry->job) {
+            Clay__ImageEvict(cache, entry);
+        }
+        entry = previous;
+    }
+    cache->updateCount++;
+    return changed;
+}
+
+Clay_Image *Clay_Image_Request(Clay_ImageCache *cache, Clay_String key, Clay_Dimensions targetSize) {
+    uint32_t hash = Clay__ImageHashKey(key.chars, key.length);
+    Clay__ImageEntry *entry = cache->buckets[hash & (uint32_t)(cache->bucketCount - 1)];
+    while (entry && !(entry->hash == hash && entry->keyLength == key.length && memcmp(entry->key, key.chars, (size_t)key.length) == 0)) {
+        entry = entry->hashNext;
+    }
+    if (!entry) {
+        if (cache->entryCount >= cache->bucketCount && !Clay__ImageGrowBuckets(cache)) return NULL;
+        entry = (Clay__ImageEntry *)calloc(1, sizeof(Clay__ImageEntry));
+        char *keyCopy = (char *)malloc((size_t)key.length + 1);
+        if (!entry || !keyCopy) {
+            free(entry);
+            free(keyCopy);
+            return NULL;
+        }
+        memcpy(keyCopy, key.chars, (size_t)key.length);
+        keyCopy[key.length] = 0;
+        entry->key = keyCopy;
+        entry->keyLength = key.length;
+        entry->hash = hash;
+        Clay__ImageEntry **bucket = &cache->buckets[hash & (uint32_t)(cache->bucketCount - 1)];
+        entry->hashNext = *bucket;
+        *bucket = entry;
+        Clay__ImageLinkLRUFirst(cache, entry);
+        cache->entryCount++;
+        cache->cachedBytes += Clay__ImageEntryBytes(entry);
+    } else if (cache->lruFirst != entry) {
+        Clay__ImageUnlinkLRU(cache, entry);
+        Clay__ImageLinkLRUFirst(cache, entry);
+    }
+    entry->requestedUpdate = cache->updateCount;
+
+    int32_t targetWidth = targetSize.width > 0 && targetSize.height > 0 ? (int32_t)(targetSize.width + 0.999f) : 0;
+    int32_t targetHeight = targetSize.width > 0 && targetSize.height > 0 ? (int32_t)(targetSize.height + 0.999f) : 0;
+    Clay_Image *image = &entry->image;
+    if (image->state == CLAY_IMAGE_STATE_FAILED || entry->job) {
+        return image;
+    }
+    if (image->state == CLAY_IMAGE_STATE_READY) {
+        // Already decoded at full size, or large enough to cover the target
+        bool fullSize = image->width == image->sourceWidth && image->height == image->sourceHeight;
+        bool covered = targetWidth > 0 && image->width >= (targetWidth < image->sourceWidth ? targetWidth : image->sourceWidth)
+            && image->height >= (targetHeight < image->sourceHeight ? targetHeight : image->sourceHeight);
+        if (fullSize || covered) {
+            return image;
+        }
+    }
+    entry->targetWidth = targetWidth;
+    entry->targetHeight = targetHeight;
+    Clay__ImageQueueJob(cache, entry);
+    return image;
+}
+
+float Clay_Image_GetAspectRatio(const Clay_Image *image, float fallback) {
+    if (!image || image->state != CLAY_IMAGE_STATE_READY || image->sourceHeight == 0) {
+        return fallback;
+    }
+    return (float)image->sourceWidth / (float)image->sourceHeight;
+}
+
+size_t Clay_Image_GetCachedBytes(const Clay_ImageCache *cache) {
+    return cache->cachedBytes;
+}
+
+void Clay_Image_GetDecodeSize(int32_t sourceWidth, int32_t sourceHeight, int32_t targetWidth, int32_t targetHeight, int32_t *width, int32_t *height) {
+    double scale = 1;
+    if (targetWidth > 0 && targetHeight > 0) {
+        double scaleX = (double)targetWidth / sourceWidth;
+        double scaleY = (double)targetHeight / sourceHeight;
+        scale = scaleX > scaleY ? scaleX : scaleY;
+    }
+    if (scale >= 1) {
+        *width = sourceWidth;
+        *height = sourceHeight;
+        return;
+    }
+    *width = (int32_t)(sourceWidth * scale + 0.999);
+    *height = (int32_t)(sourceHeight * scale + 0.999);
+    if (*width < 1) *width = 1;
+    if (*height < 1) *height = 1;
+    if (*width > sourceWidth) *width = sourceWidth;
+    if (*height > sourceHeight) *height = sourceHeight;
+}
+
+#endif // CLAY_IMAGE_IMPLEMENTATION
@@ -0,0 +1,139 @@
+/*
+    Test for clay_image.h, driving the load, decode and release pipeline with a custom loader.
+
+    cc -std=c99 -O2 -pthread -o clay_image_test clay_image_test.c -lm && ./clay_image_test
+
+    Images are served from memory by key. The first cache leaves .releaseBytesFunction unset, so the loaded bytes go
+    to the default free(bytes.handle). The second counts its releases, and decodes a format of its own through
+    .decodeFunction at a larger size than requested, which the cache then downsamples.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CLAY_IMPLEMENTATION
+#include "clay.h"
+#define CLAY_IMAGE_IMPLEMENTATION
+#include "clay_image.h"
+
+// A 4 x 2 binary PPM, red on the left half and blue on the right
+static const char testPPMHeader[] = "P6\n4 2\n255\n";
+// The custom format: the magic bytes followed by the color of every pixel of an 8 x 4 image
+static const char testCustomMagic[] = "SOLID";
+static const uint8_t testCustomColor[4] = { 10, 20, 30, 255 };
+
+static int32_t testLoads, testReleases;
+
+static bool TestKeyEquals(Clay_String key, const char *name) {
+    return key.length == (int32_t)strlen(name) && memcmp(key.chars, name, (size_t)key.length) == 0;
+}
+
+static bool TestLoad(Clay_String key, Clay_ImageBytes *bytes, void *userData) {
+    (void)userData;
+    size_t length;
+    uint8_t *data;
+    if (TestKeyEquals(key, "ppm")) {
+        length = sizeof(testPPMHeader) - 1 + 4 * 2 * 3;
+        data = (uint8_t *)malloc(length);
+        if (!data) return false;
+        memcpy(data, testPPMHeader, sizeof(testPPMHeader) - 1);
+        for (int32_t i = 0; i < 8; ++i) {
+            uint8_t *pixel = data + sizeof(testPPMHeader) - 1 + i * 3;
+            bool left = i % 4 < 2;
+            pixel[0] = left ? 255 : 0;
+            pixel[1] = 0;
+            pixel[2] = left ? 0 : 255;
+        }
+    } else if (TestKeyEquals(key, "custom")) {
+        length = sizeof(testCustomMagic) - 1;
+        data = (uint8_t *)malloc(length);
+        if (!data) return false;
+        memcpy(data, testCustomMagic, length);
+    } else {
+        return false;
+    }
+    __atomic_add_fetch(&testLoads, 1, __ATOMIC_RELAXED);
+    *bytes = (Clay_ImageBytes) { .data = data, .length = length, .handle = data };
+    return true;
+}
+
+static void TestRelease(Clay_ImageBytes bytes, void *userData) {
+    (void)userData;
+    __atomic_add_fetch(&testReleases, 1, __ATOMIC_RELAXED);
+    free(bytes.handle);
+}
+
+static bool TestDecode(Clay_ImageBytes bytes, int32_t targetWidth, int32_t targetHeight, Clay_ImageDecodedPixels *pixels, void *userData) {
+    (void)targetWidth; (void)targetHeight; (void)userData;
+    if (bytes.length != sizeof(testCustomMagic) - 1 || memcmp(bytes.data, testCustomMagic, bytes.length) != 0) return false;
+    // Always the full size, which leaves the downsampling to the cache
+    uint8_t *data = (uint8_t *)malloc(8 * 4 * 4);
+    if (!data) return false;
+    for (int32_t i = 0; i < 8 * 4; ++i) memcpy(data + i * 4, testCustomColor, 4);
+    *pixels = (Clay_ImageDecodedPixels) { data, 8, 4, 0, 0 };
+    return true;
+}
+
+// Requests the image every frame, as a layout would, until it's no longer loading
+static Clay_Image *TestWait(Clay_ImageCache *cache, const char *key, Clay_Dimensions targetSize) {
+    Clay_String keyString = { .length = (int32_t)strlen(key), .chars = key };
+    Clay_Image *image = Clay_Image_Request(cache, keyString, targetSize);
+    for (int32_t frame = 0; frame < 5000 && image->state == CLAY_IMAGE_STATE_LOADING; ++frame) {
+        struct timespec delay = { 0, 1000000 };
+        nanosleep(&delay, NULL);
+        Clay_Image_Update(cache);
+        image = Clay_Image_Request(cache, keyString, targetSize);
+    }
+    return image;
+}
+
+static int TestPixel(const char *what, const Clay_Image *image, int32_t x, int32_t y, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+    const uint8_t *pixel = image->pixels + ((size_t)y * (size_t)image->width + (size_t)x) * 4;
+    if (pixel[0] == r && pixel[1] == g && pixel[2] == b && pixel[3] == a) return 0;
+    printf("FAIL %s: pixel %d,%d is %d %d %d %d, expected %d %d %d %d\n", what, x, y, pixel[0], pixel[1], pixel[2], pixel[3], r, g, b, a);
+    return 1;
+}
+
+int main(void) {
+    int failures = 0;
+
+    // Default release function with a custom loader
+    Clay_ImageCache *cache = Clay_Image_CreateCache((Clay_ImageCacheConfig) { .loadFunction = TestLoad });
+    Clay_Image *image = TestWait(cache, "ppm", (Clay_Dimensions) { 0, 0 });
+    if (image->state != CLAY_IMAGE_STATE_READY || image->width != 4 || image->height != 2 || image->version == 0) {
+        printf("FAIL ppm: state %d, %dx%d, version %u\n", image->state, image->width, image->height, image->version);
+        failures++;
+    } else {
+        failures += TestPixel("ppm left half", image, 1, 1, 255, 0, 0, 255);
+        failures += TestPixel("ppm right half", image, 2, 0, 0, 0, 255, 255);
+    }
+    Clay_Image_DestroyCache(cache);
+
+    // Custom release and decode functions
+    testLoads = testReleases = 0;
+    cache = Clay_Image_CreateCache((Clay_ImageCacheConfig) { .loadFunction = TestLoad, .releaseBytesFunction = TestRelease, .decodeFunction = TestDecode });
+    image = TestWait(cache, "custom", (Clay_Dimensions) { 4, 2 });
+    if (image->state != CLAY_IMAGE_STATE_READY || image->width != 4 || image->height != 2 || image->sourceWidth != 8 || image->sourceHeight != 4) {
+        printf("FAIL custom: state %d, %dx%d from %dx%d\n", image->state, image->width, image->height, image->sourceWidth, image->sourceHeight);
+        failures++;
+    } else {
+        failures += TestPixel("custom downsampled", image, 3, 1, testCustomColor[0], testCustomColor[1], testCustomColor[2], testCustomColor[3]);
+    }
+    image = TestWait(cache, "missing", (Clay_Dimensions) { 4, 4 });
+    if (image->state != CLAY_IMAGE_STATE_FAILED) {
+        printf("FAIL missing: state %d\n", image->state);
+        failures++;
+    }
+    Clay_Image_DestroyCache(cache);
+    // Every successful load is released once, and failed loads have nothing to release
+    if (testLoads != 1 || testReleases != testLoads) {
+        printf("FAIL custom: %d loads and %d releases\n", testLoads, testReleases);
+        failures++;
+    }
+
+    printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}
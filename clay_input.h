@@ -0,0 +1,247 @@
+/*
+    Lock-free pointer input queue for Clay.
+
+    A single producer / single consumer ring buffer of timestamped pointer events. The platform's input callbacks push
+    events as they arrive, and the layout loop drains them once per frame into the state of every pointer and into
+    Clay_SetPointerState(). The producer and consumer may run on different threads, e.g. a UI thread receiving touches
+    and a layout thread, without any locks.
+
+    NOTE: In order to use this library you must define the following macro in exactly one file,
+    _after_ including clay.h and _before_ including this file:
+
+    #define CLAY_INPUT_IMPLEMENTATION
+    #include "clay_input.h"
+
+    Usage:
+
+    static Clay_InputQueue inputQueue; // Zero initialized
+
+    // Producer thread, for every touch or mouse event
+    Clay_Input_Push(&inputQueue, (Clay_PointerEvent) { CLAY_POINTER_EVENT_DOWN, touchId, position, timestamp });
+
+    // Consumer thread, once per frame before Clay_BeginLayout()
+    Clay_Input_Update(&inputQueue);
+
+    Consecutive moves of the same pointer are coalesced, so only the latest position of each pointer is applied. Clay
+    tracks a single pointer, the primary pointer, which is the first one pressed. Clay_Input_Update() applies at most one
+    press or release of the primary pointer per frame, and leaves later ones queued for the next frame, so that a press
+    and release within the same frame is still seen as a tap. Every tracked pointer is available in .pointers, e.g. for
+    gestures with multiple touches.
+
+    Touch pointers should push CLAY_POINTER_EVENT_LEAVE after they are lifted, so that elements stop being hovered.
+*/
+
+#ifndef CLAY_INPUT_H
+#define CLAY_INPUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// The number of events the queue can hold, must be a power of two.
+#ifndef CLAY_INPUT_QUEUE_CAPACITY
+#define CLAY_INPUT_QUEUE_CAPACITY 256
+#endif
+
+#ifndef CLAY_INPUT_MAX_POINTERS
+#define CLAY_INPUT_MAX_POINTERS 10
+#endif
+
+typedef enum {
+    // The pointer moved, whether pressed or not
+    CLAY_POINTER_EVENT_MOVE,
+    CLAY_POINTER_EVENT_DOWN,
+    CLAY_POINTER_EVENT_UP,
+    // The press was interrupted, e.g. by the system taking over the touch. The pointer stops being tracked without a release over any element.
+    CLAY_POINTER_EVENT_CANCEL,
+    // The pointer is gone, e.g. a lifted touch or a mouse leaving the window. The pointer stops being tracked.
+    CLAY_POINTER_EVENT_LEAVE,
+} Clay_PointerEventType;
+
+typedef struct Clay_PointerEvent {
+    Clay_PointerEventType type;
+    // Identifies the pointer, e.g. a touch, across its events
+    uint32_t pointerId;
+    Clay_Vector2 position;
+    // In seconds, from any clock that increases monotonically
+    double timestamp;
+} Clay_PointerEvent;
+
+// The state of a pointer, as of the events drained so far.
+typedef struct Clay_InputPointer {
+    uint32_t pointerId;
+    Clay_Vector2 position;
+    bool down;
+    double timestamp; // Of the pointer's latest event
+} Clay_InputPointer;
+
+// Zero initialize before use. Only one thread may push, and only one thread may pop or update.
+typedef struct Clay_InputQueue {
+    // Written by the producer
+    uint32_t head;
+    uint32_t cachedTail; // The consumer's .tail as last seen by the producer
+    uint32_t droppedCount; // Events pushed while the queue was full
+    uint8_t producerPadding[64]; // Keeps the producer's and consumer's fields on separate cache lines
+    // Written by the consumer
+    uint32_t tail;
+    uint32_t cachedHead;
+    uint8_t consumerPadding[64];
+    Clay_PointerEvent events[CLAY_INPUT_QUEUE_CAPACITY];
+    // Pointer state, updated by Clay_Input_Update() on the consumer thread
+    Clay_InputPointer pointers[CLAY_INPUT_MAX_POINTERS];
+    int32_t pointerCount;
+    bool hasPrimary;
+    int32_t primaryIndex; // The index in .pointers of the pointer passed to Clay
+} Clay_InputQueue;
+
+// Adds an event to the queue. Call only from the producer thread. Returns false if the queue is full, in which case the event is dropped.
+bool Clay_Input_Push(Clay_InputQueue *queue, Clay_PointerEvent event);
+// Removes the next event from the queue, skipping moves that are superseded by a later move of the same pointer.
+// Call only from the consumer thread. Returns false if the queue is empty.
+bool Clay_Input_Pop(Clay_InputQueue *queue, Clay_PointerEvent *event);
+// Drains the queue into .pointers, and passes the primary pointer to Clay_SetPointerState(). Call only from the consumer thread,
+// once per frame before Clay_BeginLayout(). Returns the number of events applied.
+int32_t Clay_Input_Update(Clay_InputQueue *queue);
+
+#endif // CLAY_INPUT_H
+
+#ifdef CLAY_INPUT_IMPLEMENTATION
+#undef CLAY_INPUT_IMPLEMENTATION
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+// Aligned 32 bit loads and stores are atomic on the platforms MSVC targets, the barriers only keep the compiler from reordering
+static inline uint32_t Clay__InputLoadAcquire(const uint32_t *value) { uint32_t result = *(volatile const uint32_t *)value; _ReadWriteBarrier(); return result; }
+static inline void Clay__InputStoreRelease(uint32_t *value, uint32_t newValue) { _ReadWriteBarrier(); *(volatile uint32_t *)value = newValue; }
+#else
+static inline uint32_t Clay__InputLoadAcquire(const uint32_t *value) { return __atomic_load_n(value, __ATOMIC_ACQUIRE); }
+static inline void Clay__InputStoreRelease(uint32_t *value, uint32_t newValue) { __atomic_store_n(value, newValue, __ATOMIC_RELEASE); }
+#endif
+
+#define CLAY__INPUT_MASK (CLAY_INPUT_QUEUE_CAPACITY - 1)
+// How far ahead a move looks for a later move of the same pointer that supersedes it
+#define CLAY__INPUT_COALESCE_WINDOW (CLAY_INPUT_MAX_POINTERS * 2)
+
+// Queue -------------------------------------------
+
+bool Clay_Input_Push(Clay_InputQueue *queue, Clay_PointerEvent event) {
+    uint32_t head = queue->head;
+    if (head - queue->cachedTail >= CLAY_INPUT_QUEUE_CAPACITY) {
+        queue->cachedTail = Clay__InputLoadAcquire(&queue->tail);
+        if (head - queue->cachedTail >= CLAY_INPUT_QUEUE_CAPACITY) {
+            queue->droppedCount++;
+            return false;
+        }
+    }
+    queue->events[head & CLAY__INPUT_MASK] = event;
+    Clay__InputStoreRelease(&queue->head, head + 1);
+    return true;
+}
+
+// Returns the next event without removing it, and the tail to commit to remove it
+static bool Clay__InputPeek(Clay_InputQueue *queue, Clay_PointerEvent *event, uint32_t *nextTail) {
+    uint32_t tail = queue->tail;
+    if (tail == queue->cachedHead) {
+        queue->cachedHead = Clay__InputLoadAcquire(&queue->head);
+        if (tail == queue->cachedHead) return false;
+    }
+    uint32_t head = queue->cachedHead;
+    *event = queue->events[tail & CLAY__INPUT_MASK];
+    tail++;
+    // A move is redundant if the same pointer moves again before anything else happens to it. Other pointers'
+    // events in between are independent of it, so touches moving together still coalesce.
+    while (event->type == CLAY_POINTER_EVENT_MOVE) {
+        bool superseded = false;
+        for (uint32_t i = tail; i != head && i - tail < CLAY__INPUT_COALESCE_WINDOW; ++i) {
+            Clay_PointerEvent *later = &queue->events[i & CLAY__INPUT_MASK];
+            if (later->pointerId != event->pointerId) continue;
+            superseded = later->type == CLAY_POINTER_EVENT_MOVE;
+            break;
+        }
+        if (!superseded || tail == head) break;
+        *event = queue->events[tail & CLAY__INPUT_MASK];
+        tail++;
+    }
+    *nextTail = tail;
+    return true;
+}
+
+bool Clay_Input_Pop(Clay_InputQueue *queue, Clay_PointerEvent *event) {
+    uint32_t nextTail;
+    if (!Clay__InputPeek(queue, event, &nextTail)) return false;
+    Clay__InputStoreRelease(&queue->tail, nextTail);
+    return true;
+}
+
+// Pointers ----------------------------------------
+
+static int32_t Clay__InputFindPointer(Clay_InputQueue *queue, uint32_t pointerId) {
+    for (int32_t i = 0; i < queue->pointerCount; ++i) {
+        if (queue->pointers[i].pointerId == pointerId) return i;
+    }
+    return -1;
+}
+
+static void Clay__InputApplyEvent(Clay_InputQueue *queue, Clay_PointerEvent *event) {
+    int32_t index = Clay__InputFindPointer(queue, event->pointerId);
+    if (event->type == CLAY_POINTER_EVENT_CANCEL || event->type == CLAY_POINTER_EVENT_LEAVE) {
+        if (index < 0) return;
+        if (queue->hasPrimary && queue->primaryIndex == index) {
+            queue->hasPrimary = false;
+        }
+        queue->pointers[index] = queue->pointers[--queue->pointerCount];
+        if (queue->hasPrimary && queue->primaryIndex == queue->pointerCount) {
+            queue->primaryIndex = index;
+        }
+        return;
+    }
+    if (index < 0) {
+        if (queue->pointerCount == CLAY_INPUT_MAX_POINTERS) return;
+        index = queue->pointerCount++;
+        queue->pointers[index] = (Clay_InputPointer) { .pointerId = event->pointerId };
+    }
+    Clay_InputPointer *pointer = &queue->pointers[index];
+    pointer->position = event->position;
+    pointer->timestamp = event->timestamp;
+    if (event->type == CLAY_POINTER_EVENT_DOWN) {
+        pointer->down = true;
+    } else if (event->type == CLAY_POINTER_EVENT_UP) {
+        pointer->down = false;
+    }
+    // The primary pointer only changes while it isn't pressed, so a second touch can't steal a press
+    if (!queue->hasPrimary || (!queue->pointers[queue->primaryIndex].down && (event->type == CLAY_POINTER_EVENT_DOWN || queue->primaryIndex == index))) {
+        queue->hasPrimary = true;
+        queue->primaryIndex = index;
+    }
+}
+
+int32_t Clay_Input_Update(Clay_InputQueue *queue) {
+    int32_t applied = 0;
+    bool primaryChanged = false;
+    Clay_PointerEvent event;
+    uint32_t nextTail;
+    while (Clay__InputPeek(queue, &event, &nextTail)) {
+        if (event.type != CLAY_POINTER_EVENT_MOVE) {
+            int32_t index = Clay__InputFindPointer(queue, event.pointerId);
+            bool isPrimary = queue->hasPrimary && index == queue->primaryIndex;
+            bool becomesPrimary = event.type == CLAY_POINTER_EVENT_DOWN && (!queue->hasPrimary || !queue->pointers[queue->primaryIndex].down);
+            if (isPrimary || becomesPrimary) {
+                // Clay only sees the pointer state once per frame, so the next press or release waits for the next frame
+                if (primaryChanged) break;
+                primaryChanged = true;
+            }
+        }
+        Clay__InputStoreRelease(&queue->tail, nextTail);
+        Clay__InputApplyEvent(queue, &event);
+        applied++;
+    }
+    if (queue->hasPrimary) {
+        Clay_InputPointer *primary = &queue->pointers[queue->primaryIndex];
+        Clay_SetPointerState(primary->position, primary->down);
+    } else {
+        // Off screen, so that nothing is hovered
+        Clay_SetPointerState(CLAY__INIT(Clay_Vector2) { -1, -1 }, false);
+    }
+    return applied;
+}
+
+#endif // CLAY_INPUT_IMPLEMENTATION
@@ -0,0 +1,173 @@
+/*
+    Stress test for clay_input.h, with the producer and consumer on separate threads.
+
+    Build and run on Linux, optionally under ThreadSanitizer:
+
+    cc -std=c99 -O2 -pthread -o clay_input_test clay_input_test.c -lm && ./clay_input_test
+    cc -std=c99 -O1 -g -fsanitize=thread -pthread -o clay_input_test clay_input_test.c -lm && ./clay_input_test
+
+    The producer pushes moves, presses and releases of several pointers, each event numbered in its pointer's
+    sequence. The first run pops every event and checks that each pointer's events arrive in order and that every
+    press and release arrives, moves being the only events that may be coalesced away. The second run drains the
+    queue with Clay_Input_Update() as a layout loop would, and checks that Clay sees every press and release of the
+    primary pointer in its own frame.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CLAY_IMPLEMENTATION
+#include "clay.h"
+#define CLAY_INPUT_IMPLEMENTATION
+#include "clay_input.h"
+
+#define TEST_POINTER_COUNT 4
+#define TEST_EVENTS_PER_POINTER 200000
+// A pointer presses every PRESS_PERIOD events, and releases halfway between
+#define TEST_PRESS_PERIOD 16
+
+typedef struct {
+    Clay_InputQueue *queue;
+    int32_t pointerCount;
+    // Pointers other than the first only move, so the first one stays primary
+    bool onlyFirstPresses;
+    uint32_t done;
+} TestProducer;
+
+static Clay_PointerEventType TestEventType(int32_t pointer, int32_t sequence, bool onlyFirstPresses) {
+    if (onlyFirstPresses && pointer > 0) return CLAY_POINTER_EVENT_MOVE;
+    if (sequence % TEST_PRESS_PERIOD == 0) return CLAY_POINTER_EVENT_DOWN;
+    if (sequence % TEST_PRESS_PERIOD == TEST_PRESS_PERIOD / 2) return CLAY_POINTER_EVENT_UP;
+    return CLAY_POINTER_EVENT_MOVE;
+}
+
+static void *TestProduce(void *userData) {
+    TestProducer *producer = userData;
+    for (int32_t sequence = 0; sequence < TEST_EVENTS_PER_POINTER; ++sequence) {
+        for (int32_t pointer = 0; pointer < producer->pointerCount; ++pointer) {
+            Clay_PointerEvent event = {
+                TestEventType(pointer, sequence, producer->onlyFirstPresses),
+                (uint32_t)pointer,
+                { (float)sequence, (float)pointer },
+                (double)sequence,
+            };
+            // A full queue drops the event, so push it again once the consumer catches up
+            while (!Clay_Input_Push(producer->queue, event)) {
+                sched_yield();
+            }
+        }
+    }
+    __atomic_store_n(&producer->done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static int TestPop(void) {
+    static Clay_InputQueue queue;
+    TestProducer producer = { .queue = &queue, .pointerCount = TEST_POINTER_COUNT };
+    pthread_t thread;
+    pthread_create(&thread, NULL, TestProduce, &producer);
+
+    int32_t lastSequence[TEST_POINTER_COUNT];
+    int32_t presses[TEST_POINTER_COUNT] = {0}, releases[TEST_POINTER_COUNT] = {0};
+    int32_t popped = 0, failures = 0;
+    for (int32_t i = 0; i < TEST_POINTER_COUNT; ++i) lastSequence[i] = -1;
+    for (;;) {
+        // Read the flag before popping, so an empty queue after it was set means the producer is finished
+        bool done = __atomic_load_n(&producer.done, __ATOMIC_ACQUIRE);
+        Clay_PointerEvent event;
+        if (!Clay_Input_Pop(&queue, &event)) {
+            if (done) break;
+            sched_yield();
+            continue;
+        }
+        popped++;
+        int32_t pointer = (int32_t)event.pointerId;
+        int32_t sequence = (int32_t)event.position.x;
+        if (pointer >= TEST_POINTER_COUNT || event.position.y != (float)pointer || sequence <= lastSequence[pointer]) {
+            if (failures++ < 10) printf("FAIL pop: pointer %d event %d after %d\n", pointer, sequence, pointer < TEST_POINTER_COUNT ? lastSequence[pointer] : -1);
+            continue;
+        }
+        // Only moves may be skipped
+        for (int32_t skipped = lastSequence[pointer] + 1; skipped < sequence; ++skipped) {
+            if (TestEventType(pointer, skipped, false) != CLAY_POINTER_EVENT_MOVE && failures++ < 10) {
+                printf("FAIL pop: pointer %d lost event %d\n", pointer, skipped);
+            }
+        }
+        if (event.type != TestEventType(pointer, sequence, false) && failures++ < 10) {
+            printf("FAIL pop: pointer %d event %d has type %d\n", pointer, sequence, event.type);
+        }
+        presses[pointer] += event.type == CLAY_POINTER_EVENT_DOWN;
+        releases[pointer] += event.type == CLAY_POINTER_EVENT_UP;
+        lastSequence[pointer] = sequence;
+    }
+    pthread_join(thread, NULL);
+
+    int32_t expected = TEST_EVENTS_PER_POINTER / TEST_PRESS_PERIOD;
+    for (int32_t i = 0; i < TEST_POINTER_COUNT; ++i) {
+        if (presses[i] != expected || releases[i] != expected || lastSequence[i] != TEST_EVENTS_PER_POINTER - 1) {
+            printf("FAIL pop: pointer %d had %d presses and %d releases of %d, last event %d\n", i, presses[i], releases[i], expected, lastSequence[i]);
+            failures++;
+        }
+    }
+    printf("pop: %d of %d events, %d coalesced\n", popped, TEST_POINTER_COUNT * TEST_EVENTS_PER_POINTER, TEST_POINTER_COUNT * TEST_EVENTS_PER_POINTER - popped);
+    return failures;
+}
+
+static int TestUpdate(void) {
+    uint32_t memorySize = Clay_MinMemorySize();
+    void *memory = malloc(memorySize);
+    Clay_Initialize(Clay_CreateArenaWithCapacityAndMemory(memorySize, memory), (Clay_Dimensions) { 100, 100 }, (Clay_ErrorHandler) {0});
+    // Settle the pointer into the released state, so the first press is seen as one
+    Clay_SetPointerState((Clay_Vector2) { -1, -1 }, false);
+    Clay_SetPointerState((Clay_Vector2) { -1, -1 }, false);
+
+    static Clay_InputQueue queue;
+    TestProducer producer = { .queue = &queue, .pointerCount = TEST_POINTER_COUNT, .onlyFirstPresses = true };
+    pthread_t thread;
+    pthread_create(&thread, NULL, TestProduce, &producer);
+
+    int32_t presses = 0, releases = 0, frames = 0, failures = 0;
+    bool down = false;
+    for (;;) {
+        bool done = __atomic_load_n(&producer.done, __ATOMIC_ACQUIRE);
+        int32_t applied = Clay_Input_Update(&queue);
+        frames++;
+        Clay_PointerDataInteractionState state = Clay_GetCurrentContext()->pointerInfo.state;
+        if (state == CLAY_POINTER_DATA_PRESSED_THIS_FRAME) {
+            if (down && failures++ < 10) printf("FAIL update: pressed twice in frame %d\n", frames);
+            down = true;
+            presses++;
+        } else if (state == CLAY_POINTER_DATA_RELEASED_THIS_FRAME) {
+            if (!down && failures++ < 10) printf("FAIL update: released twice in frame %d\n", frames);
+            down = false;
+            releases++;
+        }
+        if (applied == 0) {
+            if (done) break;
+            sched_yield();
+        }
+    }
+    pthread_join(thread, NULL);
+
+    int32_t expected = TEST_EVENTS_PER_POINTER / TEST_PRESS_PERIOD;
+    if (presses != expected || releases != expected) {
+        printf("FAIL update: %d presses and %d releases of %d\n", presses, releases, expected);
+        failures++;
+    }
+    if (queue.pointerCount != TEST_POINTER_COUNT || !queue.hasPrimary || queue.pointers[queue.primaryIndex].pointerId != 0) {
+        printf("FAIL update: %d pointers tracked, primary %d\n", queue.pointerCount, queue.hasPrimary ? (int)queue.pointers[queue.primaryIndex].pointerId : -1);
+        failures++;
+    }
+    printf("update: %d presses and releases over %d frames\n", presses + releases, frames);
+    free(memory);
+    return failures;
+}
+
+int main(void) {
+    int failures = TestPop() + TestUpdate();
+    printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,190 @@
+/*
+    Regression test for Clay__DistributeSizeAlongAxis(), comparing it with the loop it replaced.
+
+    cc -std=c99 -O2 -o clay_layout_test clay_layout_test.c -lm && ./clay_layout_test
+
+    Each case is the set of resizable children of one parent, as the layout passes it in: random sizes with frequent
+    ties, minimum sizes, maximum sizes and an amount to grow or compress by. The old loop resolved one distinct size
+    per pass over the children, so the two can differ by no more than CLAY__EPSILON for each of its passes.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CLAY_IMPLEMENTATION
+#include "clay.h"
+
+#define TEST_CASES 20000
+#define TEST_MAX_CHILDREN 24
+
+static uint32_t testRandomState = 1;
+
+static uint32_t TestRandom(uint32_t range) {
+    testRandomState = testRandomState * 1103515245u + 12345u;
+    return (testRandomState >> 16) % range;
+}
+
+// The loop that Clay__SizeContainersAlongAxis() ran before water filling, kept as the reference. Returns the number of passes it made.
+static int32_t TestDistributeReference(Clay__int32_tArray *elements, bool xAxis, bool compress, float amount) {
+    Clay_Context *context = Clay_GetCurrentContext();
+    Clay__int32_tArray resizableContainerBuffer = *elements;
+    int32_t passes = 0;
+    if (compress) {
+        float sizeToDistribute = -amount;
+        while (sizeToDistribute < -CLAY__EPSILON && resizableContainerBuffer.length > 0) {
+            passes++;
+            float largest = 0;
+            float secondLargest = 0;
+            float widthToAdd = sizeToDistribute;
+            for (int childIndex = 0; childIndex < resizableContainerBuffer.length; childIndex++) {
+                Clay_LayoutElement *child = Clay_LayoutElementArray_Get(&context->layoutElements, Clay__int32_tArray_GetValue(&resizableContainerBuffer, childIndex));
+                float childSize = xAxis ? child->dimensions.width : child->dimensions.height;
+                if (Clay__FloatEqual(childSize, largest)) { continue; }
+                if (childSize > largest) {
+                    secondLargest = largest;
+                    largest = childSize;
+                }
+                if (childSize < largest) {
+                    secondLargest = CLAY__MAX(secondLargest, childSize);
+                    widthToAdd = secondLargest - largest;
+                }
+            }
+
+            widthToAdd = CLAY__MAX(widthToAdd, sizeToDistribute / resizableContainerBuffer.length);
+
+            for (int childIndex = 0; childIndex < resizableContainerBuffer.length; childIndex++) {
+                Clay_LayoutElement *child = Clay_LayoutElementArray_Get(&context->layoutElements, Clay__int32_tArray_GetValue(&resizableContainerBuffer, childIndex));
+                float *childSize = xAxis ? &child->dimensions.width : &child->dimensions.height;
+                float minSize = xAxis ? child->minDimensions.width : child->minDimensions.height;
+                float previousWidth = *childSize;
+                if (Clay__FloatEqual(*childSize, largest)) {
+                    *childSize += widthToAdd;
+                    if (*childSize <= minSize) {
+                        *childSize = minSize;
+                        Clay__int32_tArray_RemoveSwapback(&resizableContainerBuffer, childIndex--);
+                    }
+                    sizeToDistribute -= (*childSize - previousWidth);
+                }
+            }
+        }
+    } else {
+        float sizeToDistribute = amount;
+        while (sizeToDistribute > CLAY__EPSILON && resizableContainerBuffer.length > 0) {
+            passes++;
+            float smallest = CLAY__MAXFLOAT;
+            float secondSmallest = CLAY__MAXFLOAT;
+            float widthToAdd = sizeToDistribute;
+            for (int childIndex = 0; childIndex < resizableContainerBuffer.length; childIndex++) {
+                Clay_LayoutElement *child = Clay_LayoutElementArray_Get(&context->layoutElements, Clay__int32_tArray_GetValue(&resizableContainerBuffer, childIndex));
+                float childSize = xAxis ? child->dimensions.width : child->dimensions.height;
+                if (Clay__FloatEqual(childSize, smallest)) { continue; }
+                if (childSize < smallest) {
+                    secondSmallest = smallest;
+                    smallest = childSize;
+                }
+                if (childSize > smallest) {
+                    secondSmallest = CLAY__MIN(secondSmallest, childSize);
+                    widthToAdd = secondSmallest - smallest;
+                }
+            }
+
+            widthToAdd = CLAY__MIN(widthToAdd, sizeToDistribute / resizableContainerBuffer.length);
+
+            for (int childIndex = 0; childIndex < resizableContainerBuffer.length; childIndex++) {
+                Clay_LayoutElement *child = Clay_LayoutElementArray_Get(&context->layoutElements, Clay__int32_tArray_GetValue(&resizableContainerBuffer, childIndex));
+                float *childSize = xAxis ? &child->dimensions.width : &child->dimensions.height;
+                float maxSize = xAxis ? child->layoutConfig->sizing.width.size.minMax.max : child->layoutConfig->sizing.height.size.minMax.max;
+                float previousWidth = *childSize;
+                if (Clay__FloatEqual(*childSize, smallest)) {
+                    *childSize += widthToAdd;
+                    if (*childSize >= maxSize) {
+                        *childSize = maxSize;
+                        Clay__int32_tArray_RemoveSwapback(&resizableContainerBuffer, childIndex--);
+                    }
+                    sizeToDistribute -= (*childSize - previousWidth);
+                }
+            }
+        }
+    }
+    return passes;
+}
+
+// Sizes are often drawn from a few values, so that several children start out tied
+static float TestRandomSize(void) {
+    static const float common[] = { 0, 12, 40, 40.5f, 100 };
+    if (TestRandom(3) == 0) return common[TestRandom(5)];
+    return (float)TestRandom(30000) / 100.0f;
+}
+
+int main(void) {
+    uint32_t memorySize = Clay_MinMemorySize();
+    void *memory = malloc(memorySize);
+    Clay_Initialize(Clay_CreateArenaWithCapacityAndMemory(memorySize, memory), (Clay_Dimensions) { 1000, 1000 }, (Clay_ErrorHandler) {0});
+    Clay_Context *context = Clay_GetCurrentContext();
+
+    static Clay_LayoutConfig configs[TEST_MAX_CHILDREN];
+    static Clay_LayoutElement initial[TEST_MAX_CHILDREN];
+    static float expected[TEST_MAX_CHILDREN];
+    int32_t indexStorage[TEST_MAX_CHILDREN], limitStorage[TEST_MAX_CHILDREN];
+    float largestDifference = 0;
+    int failures = 0;
+
+    for (int testCase = 0; testCase < TEST_CASES; ++testCase) {
+        bool xAxis = TestRandom(2);
+        bool compress = TestRandom(2);
+        int32_t count = 1 + (int32_t)TestRandom(TEST_MAX_CHILDREN);
+        float total = 0, room = 0;
+        for (int32_t i = 0; i < count; ++i) {
+            float size = TestRandomSize();
+            float minSize = TestRandom(3) == 0 ? 0 : size * (float)TestRandom(101) / 100.0f;
+            float maxSize = TestRandom(2) ? CLAY__MAXFLOAT : size + TestRandomSize();
+            configs[i] = (Clay_LayoutConfig) {0};
+            Clay_SizingAxis sizing = CLAY_SIZING_GROW(minSize, maxSize);
+            if (xAxis) configs[i].sizing.width = sizing; else configs[i].sizing.height = sizing;
+            initial[i] = (Clay_LayoutElement) { .layoutConfig = &configs[i] };
+            initial[i].dimensions = xAxis ? (Clay_Dimensions) { size, 0 } : (Clay_Dimensions) { 0, size };
+            initial[i].minDimensions = xAxis ? (Clay_Dimensions) { minSize, 0 } : (Clay_Dimensions) { 0, minSize };
+            total += size;
+            room += compress ? size - minSize : (maxSize == CLAY__MAXFLOAT ? 1000 : maxSize - size);
+        }
+        // Sometimes more than the children can take, so that every one of them reaches its limit
+        float amount = (compress ? CLAY__MIN(total, room * 1.2f) : room * 1.2f) * (float)TestRandom(1001) / 1000.0f;
+        if (amount <= CLAY__EPSILON) continue;
+
+        Clay__int32_tArray elements = { .capacity = count, .internalArray = indexStorage };
+        Clay__int32_tArray limitOrder = { .capacity = count, .internalArray = limitStorage };
+        context->layoutElements.length = 0;
+        for (int32_t i = 0; i < count; ++i) Clay_LayoutElementArray_Add(&context->layoutElements, initial[i]);
+        // Both remove and reorder the indexes as they go
+        for (int32_t i = 0; i < count; ++i) indexStorage[i] = i;
+        elements.length = count;
+        // Each pass of the old loop treats sizes within CLAY__EPSILON as equal, and stops with less than CLAY__EPSILON left over,
+        // so its result can drift from the exact one by at most CLAY__EPSILON per pass
+        float tolerance = CLAY__EPSILON * (float)TestDistributeReference(&elements, xAxis, compress, amount);
+        for (int32_t i = 0; i < count; ++i) {
+            Clay_Dimensions dimensions = context->layoutElements.internalArray[i].dimensions;
+            expected[i] = xAxis ? dimensions.width : dimensions.height;
+        }
+
+        context->layoutElements.length = 0;
+        for (int32_t i = 0; i < count; ++i) Clay_LayoutElementArray_Add(&context->layoutElements, initial[i]);
+        for (int32_t i = 0; i < count; ++i) indexStorage[i] = i;
+        elements.length = count;
+        Clay__DistributeSizeAlongAxis(&elements, &limitOrder, xAxis, compress, amount);
+        for (int32_t i = 0; i < count; ++i) {
+            Clay_Dimensions dimensions = context->layoutElements.internalArray[i].dimensions;
+            float difference = (xAxis ? dimensions.width : dimensions.height) - expected[i];
+            difference = difference < 0 ? -difference : difference;
+            largestDifference = CLAY__MAX(largestDifference, difference);
+            if (difference > tolerance && failures++ < 10) {
+                printf("FAIL case %d: %s %.3f over %d children, child %d is %.3f, expected %.3f\n", testCase, compress ? "compressing" : "growing",
+                    amount, count, i, xAxis ? dimensions.width : dimensions.height, expected[i]);
+            }
+        }
+    }
+
+    printf("%d cases, largest difference %.4fpx\n", TEST_CASES, largestDifference);
+    printf(failures ? "FAILED\n" : "OK\n");
+    free(memory);
+    return failures ? 1 : 0;
+}
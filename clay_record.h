@@ -0,0 +1,641 @@
+/*
+    Compact binary recording of Clay render command streams.
+
+    Captures Clay_RenderCommandArrays, including the text they reference, into a versioned byte stream that can be
+    written to disk and replayed later, e.g. for profiling renderers or damage tracking on a desktop machine with frames
+    captured on a device.
+
+    NOTE: In order to use this library you must define the following macro in exactly one file,
+    _after_ including clay.h and _before_ including this file:
+
+    #define CLAY_RECORD_IMPLEMENTATION
+    #include "clay_record.h"
+
+    Format (version 2, all fixed width integers are little endian):
+
+    Recording:  "CLYR" magic | u16 version | u16 reserved | frame*
+    Frame:      u32 byte length of the rest of the frame | varint command count | varint string count
+                | u32 string offsets[string count + 1] | string bytes | command*
+    Command:    u8 command type, with bit 7 set if userData follows | u32 id | zigzag varint zIndex delta
+                | x, y, width, height as numbers delta coded against the previous command | payload | [varint userData]
+    Number:     varint (zigzag(integer delta) << 1) when both the value and the previous value are integers, otherwise
+                varint 1 followed by the raw 32 bit float
+    Text:       varint string index | varint line offset | varint line length | color | varint fontId | varint fontSize
+                | varint letterSpacing | varint lineHeight | varint stringHandle | varint stringVersion
+    Image:      color | corner radius | varint imageData | varint imageVersion
+
+    Version 2 added the line offset, stringHandle and stringVersion to text and imageVersion to images. Readers only
+    accept their own version.
+    Strings are deduplicated into a table per frame, so that every frame can be decoded on its own. The lines of wrapped
+    text share one string, running from their baseChars, so replayed lines keep the offsets that renderers compare to
+    tell whether a line of stored text changed.
+    Pointers (imageData, customData and userData) can't be meaningfully serialized, and are recorded as their numeric value.
+    They still identify the same resource across frames of a single recording.
+
+    The reader decodes straight from the recording bytes, which can be a memory mapped file, without any allocations.
+    Decoded text commands point into the recording's string table.
+*/
+
+#ifndef CLAY_RECORD_H
+#define CLAY_RECORD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define CLAY_RECORD_VERSION 2
+
+typedef struct Clay_RecordWriter Clay_RecordWriter;
+
+// Iterates over the frames of a recording. The recording must stay alive while the reader and anything decoded from it are in use.
+typedef struct Clay_RecordReader {
+    const uint8_t *data;
+    size_t length;
+    size_t offset;
+    uint16_t version;
+    // Set if the recording is truncated or malformed. Reading stops at the first error.
+    bool error;
+} Clay_RecordReader;
+
+// A single recorded frame, pointing directly into the recording.
+typedef struct Clay_RecordFrame {
+    const uint8_t *data;
+    size_t length;
+    int32_t commandCount;
+    int32_t stringCount;
+    const uint8_t *stringOffsets;
+    const uint8_t *stringBytes;
+    size_t commandsOffset; // The offset of the first command from .data
+} Clay_RecordFrame;
+
+// Decodes the commands of a frame one at a time.
+typedef struct Clay_RecordCommandIterator {
+    const Clay_RecordFrame *frame;
+    size_t offset;
+    int32_t remaining;
+    float previousBoundingBox[4];
+    int16_t previousZIndex;
+    // Set if the frame is malformed. Iteration stops at the first error.
+    bool error;
+} Clay_RecordCommandIterator;
+
+// Creates a writer with an empty recording.
+Clay_RecordWriter *Clay_Record_CreateWriter(void);
+// Frees the writer and its recording.
+void Clay_Record_DestroyWriter(Clay_RecordWriter *writer);
+// Appends a frame to the recording. Returns false if memory couldn't be allocated, in which case the recording is unchanged.
+bool Clay_Record_WriteFrame(Clay_RecordWriter *writer, Clay_RenderCommandArray renderCommands);
+// Returns the recording so far, including the header. The pointer is invalidated by the next call to Clay_Record_WriteFrame().
+const uint8_t *Clay_Record_GetData(Clay_RecordWriter *writer, size_t *length);
+
+// Validates the header of a recording and prepares to read its frames. Returns false if the data isn't a supported recording.
+bool Clay_Record_OpenReader(Clay_RecordReader *reader, const void *data, size_t length);
+// Reads the next frame. Returns false at the end of the recording, or if the frame is malformed.
+bool Clay_Record_NextFrame(Clay_RecordReader *reader, Clay_RecordFrame *frame);
+// Returns an iterator over the commands of a frame.
+Clay_RecordCommandIterator Clay_Record_IterateCommands(const Clay_RecordFrame *frame);
+// Decodes the next command into *renderCommand. Returns false once all commands have been read, or if the command is malformed.
+bool Clay_Record_NextCommand(Clay_RecordCommandIterator *iterator, Clay_RenderCommand *renderCommand);
+
+#endif // CLAY_RECORD_H
+
+#ifdef CLAY_RECORD_IMPLEMENTATION
+#undef CLAY_RECORD_IMPLEMENTATION
+
+#include <stdlib.h>
+#include <string.h>
+
+#define CLAY__RECORD_HAS_USER_DATA 0x80
+#define CLAY__RECORD_FRAME_HEADER_SIZE 4
+#define CLAY__RECORD_FILE_HEADER_SIZE 8
+
+static const uint8_t Clay__recordMagic[4] = { 'C', 'L', 'Y', 'R' };
+
+struct Clay_RecordWriter {
+    uint8_t *data;
+    size_t length;
+    size_t capacity;
+    bool failed; // Set when an allocation fails part way through a frame
+    // Per frame string deduplication, an open addressing table of indexes into .strings
+    Clay_StringSlice *strings;
+    int32_t stringCount;
+    int32_t stringCapacity;
+    int32_t *stringTable;
+    int32_t stringTableCapacity;
+};
+
+// Writing -----------------------------------------
+
+static bool Clay__RecordReserve(Clay_RecordWriter *writer, size_t additional) {
+    if (writer->failed) return false;
+    if (writer->length + additional <= writer->capacity) return true;
+    size_t newCapacity = writer->capacity ? writer->capacity * 2 : 4096;
+    while (newCapacity < writer->length + additional) newCapacity *= 2;
+    uint8_t *grown = (uint8_t *)realloc(writer->data, newCapacity);
+    if (!grown) {
+        writer->failed = true;
+        return false;
+    }
+    writer->data = grown;
+    writer->capacity = newCapacity;
+    return true;
+}
+
+static void Clay__RecordWriteBytes(Clay_RecordWriter *writer, const void *bytes, size_t length) {
+    if (length == 0 || !Clay__RecordReserve(writer, length)) return;
+    memcpy(writer->data + writer->length, bytes, length);
+    writer->length += length;
+}
+
+static void Clay__RecordWriteU8(Clay_RecordWriter *writer, uint8_t value) {
+    Clay__RecordWriteBytes(writer, &value, 1);
+}
+
+static void Clay__RecordStoreU32(uint8_t *destination, uint32_t value) {
+    destination[0] = (uint8_t)value;
+    destination[1] = (uint8_t)(value >> 8);
+    destination[2] = (uint8_t)(value >> 16);
+    destination[3] = (uint8_t)(value >> 24);
+}
+
+static void Clay__RecordWriteU32(Clay_RecordWriter *writer, uint32_t value) {
+    uint8_t bytes[4];
+    Clay__RecordStoreU32(bytes, value);
+    Clay__RecordWriteBytes(writer, bytes, 4);
+}
+
+static void Clay__RecordWriteVarint(Clay_RecordWriter *writer, uint64_t value) {
+    uint8_t bytes[10];
+    int32_t length = 0;
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        bytes[length++] = byte | (value ? 0x80 : 0);
+    } while (value);
+    Clay__RecordWriteBytes(writer, bytes, (size_t)length);
+}
+
+static inline uint64_t Clay__RecordZigzag(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static inline int64_t Clay__RecordUnzigzag(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+// Layout values are almost always whole pixels, so they are coded as small integer deltas, falling back to raw floats
+static inline bool Clay__RecordIsSmallInteger(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, 4);
+    // Negative zero has to stay a raw float to round trip exactly
+    return value >= -16777216.0f && value <= 16777216.0f && (float)(int32_t)value == value && bits != 0x80000000u;
+}
+
+static void Clay__RecordWriteNumber(Clay_RecordWriter *writer, float value, float previous) {
+    if (Clay__RecordIsSmallInteger(value) && Clay__RecordIsSmallInteger(previous)) {
+        Clay__RecordWriteVarint(writer, Clay__RecordZigzag((int64_t)(int32_t)value - (int32_t)previous) << 1);
+    } else {
+        uint32_t bits;
+        memcpy(&bits, &value, 4);
+        Clay__RecordWriteVarint(writer, 1);
+        Clay__RecordWriteU32(writer, bits);
+    }
+}
+
+static void Clay__RecordWriteColor(Clay_RecordWriter *writer, Clay_Color color) {
+    Clay__RecordWriteNumber(writer, color.r, 0);
+    Clay__RecordWriteNumber(writer, color.g, 0);
+    Clay__RecordWriteNumber(writer, color.b, 0);
+    Clay__RecordWriteNumber(writer, color.a, 0);
+}
+
+static void Clay__RecordWriteCornerRadius(Clay_RecordWriter *writer, Clay_CornerRadius cornerRadius) {
+    Clay__RecordWriteNumber(writer, cornerRadius.topLeft, 0);
+    Clay__RecordWriteNumber(writer, cornerRadius.topRight, 0);
+    Clay__RecordWriteNumber(writer, cornerRadius.bottomLeft, 0);
+    Clay__RecordWriteNumber(writer, cornerRadius.bottomRight, 0);
+}
+
+static uint32_t Clay__RecordHashString(const char *chars, int32_t length) {
+    uint32_t hash = 2166136261u;
+    for (int32_t i = 0; i < length; ++i) {
+        hash = (hash ^ (uint8_t)chars[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static bool Clay__RecordGrowStringTable(Clay_RecordWriter *writer) {
+    int32_t newCapacity = writer->stringTableCapacity ? writer->stringTableCapacity * 2 : 256;
+    int32_t *table = (int32_t *)malloc((size_t)newCapacity * sizeof(int32_t));
+    if (!table) return false;
+    for (int32_t i = 0; i < newCapacity; ++i) table[i] = -1;
+    for (int32_t i = 0; i < writer->stringCount; ++i) {
+        uint32_t slot = Clay__RecordHashString(writer->strings[i].chars, writer->strings[i].length) & (uint32_t)(newCapacity - 1);
+        while (table[slot] != -1) slot = (slot + 1) & (uint32_t)(newCapacity - 1);
+        table[slot] = i;
+    }
+    free(writer->stringTable);
+    writer->stringTable = table;
+    writer->stringTableCapacity = newCapacity;
+    return true;
+}
+
+// Returns the index of the string in this frame's string table, adding it if it hasn't been seen yet, or -1 on allocation failure
+static int32_t Clay__RecordInternString(Clay_RecordWriter *writer, Clay_StringSlice string) {
+    if (writer->stringTableCapacity == 0 && !Clay__RecordGrowStringTable(writer)) return -1;
+    uint32_t hash = Clay__RecordHashString(string.chars, string.length);
+    uint32_t mask = (uint32_t)(writer->stringTableCapacity - 1);
+    uint32_t slot = hash & mask;
+    while (writer->stringTable[slot] != -1) {
+        Clay_StringSlice *existing = &writer->strings[writer->stringTable[slot]];
+        if (existing->length == string.length && (string.length == 0 || memcmp(existing->chars, string.chars, (size_t)string.length) == 0)) {
+            return writer->stringTable[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+    // Keep the table at most half full
+    if ((writer->stringCount + 1) * 2 > writer->stringTableCapacity) {
+        if (!Clay__RecordGrowStringTable(writer)) return -1;
+        mask = (uint32_t)(writer->stringTableCapacity - 1);
+        slot = hash & mask;
+        while (writer->stringTable[slot] != -1) slot = (slot + 1) & mask;
+    }
+    if (writer->stringCount == writer->stringCapacity) {
+        int32_t newCapacity = writer->stringCapacity ? writer->stringCapacity * 2 : 128;
+        Clay_StringSlice *strings = (Clay_StringSlice *)realloc(writer->strings, (size_t)newCapacity * sizeof(Clay_StringSlice));
+        if (!strings) return -1;
+        writer->strings = strings;
+        writer->stringCapacity = newCapacity;
+    }
+    writer->strings[writer->stringCount] = string;
+    writer->stringTable[slot] = writer->stringCount;
+    return writer->stringCount++;
+}
+
+static inline const char *Clay__RecordTextBase(Clay_StringSlice line) {
+    return line.baseChars && line.baseChars <= line.chars ? line.baseChars : line.chars;
+}
+
+// Each line of wrapped text is its own command, slicing the same text from baseChars. Returns the text from baseChars to
+// the end of the last line of the run of text commands starting at first, so that every line can be recorded as an
+// offset into it and keeps its position relative to baseChars when replayed.
+static Clay_StringSlice Clay__RecordTextSpan(Clay_RenderCommandArray renderCommands, int32_t first) {
+    Clay_StringSlice line = renderCommands.internalArray[first].renderData.text.stringContents;
+    const char *base = Clay__RecordTextBase(line);
+    const char *end = line.chars + line.length;
+    for (int32_t i = first + 1; i < renderCommands.length; ++i) {
+        Clay_RenderCommand *next = &renderCommands.internalArray[i];
+        if (next->commandType != CLAY_RENDER_COMMAND_TYPE_TEXT || Clay__RecordTextBase(next->renderData.text.stringContents) != base) break;
+        line = next->renderData.text.stringContents;
+        if (line.chars + line.length > end) end = line.chars + line.length;
+    }
+    return CLAY__INIT(Clay_StringSlice) { .length = (int32_t)(end - base), .chars = base, .baseChars = base };
+}
+
+static inline bool Clay__RecordStartsTextRun(Clay_RenderCommandArray renderCommands, int32_t index) {
+    if (index == 0 || renderCommands.internalArray[index - 1].commandType != CLAY_RENDER_COMMAND_TYPE_TEXT) return true;
+    return Clay__RecordTextBase(renderCommands.internalArray[index - 1].renderData.text.stringContents)
+        != Clay__RecordTextBase(renderCommands.internalArray[index].renderData.text.stringContents);
+}
+
+Clay_RecordWriter *Clay_Record_CreateWriter(void) {
+    Clay_RecordWriter *writer = (Clay_RecordWriter *)calloc(1, sizeof(Clay_RecordWriter));
+    if (!writer) return NULL;
+    Clay__RecordWriteBytes(writer, Clay__recordMagic, 4);
+    uint8_t version[4] = { CLAY_RECORD_VERSION & 0xFF, CLAY_RECORD_VERSION >> 8, 0, 0 };
+    Clay__RecordWriteBytes(writer, version, 4);
+    if (writer->failed) {
+        Clay_Record_DestroyWriter(writer);
+        return NULL;
+    }
+    return writer;
+}
+
+void Clay_Record_DestroyWriter(Clay_RecordWriter *writer) {
+    if (!writer) return;
+    free(writer->data);
+    free(writer->strings);
+    free(writer->stringTable);
+    free(writer);
+}
+
+bool Clay_Record_WriteFrame(Clay_RecordWriter *writer, Clay_RenderCommandArray renderCommands) {
+    size_t frameStart = writer->length;
+    writer->failed = false;
+
+    // Collect the frame's distinct strings first, so that the table can precede the commands
+    writer->stringCount = 0;
+    for (int32_t i = 0; i < writer->stringTableCapacity; ++i) writer->stringTable[i] = -1;
+    for (int32_t i = 0; i < renderCommands.length; ++i) {
+        Clay_RenderCommand *renderCommand = &renderCommands.internalArray[i];
+        if (renderCommand->commandType == CLAY_RENDER_COMMAND_TYPE_TEXT && Clay__RecordStartsTextRun(renderCommands, i)
+            && Clay__RecordInternString(writer, Clay__RecordTextSpan(renderCommands, i)) < 0) {
+            return false;
+        }
+    }
+
+    Clay__RecordWriteU32(writer, 0); // Patched once the frame length is known
+    Clay__RecordWriteVarint(writer, (uint64_t)renderCommands.length);
+    Clay__RecordWriteVarint(writer, (uint64_t)writer->stringCount);
+    uint32_t stringOffset = 0;
+    for (int32_t i = 0; i < writer->stringCount; ++i) {
+        Clay__RecordWriteU32(writer, stringOffset);
+        stringOffset += (uint32_t)writer->strings[i].length;
+    }
+    Clay__RecordWriteU32(writer, stringOffset);
+    for (int32_t i = 0; i < writer->stringCount; ++i) {
+        Clay__RecordWriteBytes(writer, writer->strings[i].chars, (size_t)writer->strings[i].length);
+    }
+
+    float previousBoundingBox[4] = { 0 };
+    int16_t previousZIndex = 0;
+    int32_t textSpanIndex = 0;
+    for (int32_t i = 0; i < renderCommands.length; ++i) {
+        Clay_RenderCommand *renderCommand = &renderCommands.internalArray[i];
+        Clay_RenderData *renderData = &renderCommand->renderData;
+        Clay__RecordWriteU8(writer, (uint8_t)renderCommand->commandType | (renderCommand->userData ? CLAY__RECORD_HAS_USER_DATA : 0));
+        Clay__RecordWriteU32(writer, renderCommand->id);
+        Clay__RecordWriteVarint(writer, Clay__RecordZigzag((int64_t)renderCommand->zIndex - previousZIndex));
+        previousZIndex = renderCommand->zIndex;
+        float boundingBox[4] = { renderCommand->boundingBox.x, renderCommand->boundingBox.y, renderCommand->boundingBox.width, renderCommand->boundingBox.height };
+        for (int32_t j = 0; j < 4; ++j) {
+            Clay__RecordWriteNumber(writer, boundingBox[j], previousBoundingBox[j]);
+            previousBoundingBox[j] = boundingBox[j];
+        }
+        switch (renderCommand->commandType) {
+            case CLAY_RENDER_COMMAND_TYPE_RECTANGLE: {
+                Clay__RecordWriteColor(writer, renderData->rectangle.backgroundColor);
+                Clay__RecordWriteCornerRadius(writer, renderData->rectangle.cornerRadius);
+                break;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_BORDER: {
+                Clay__RecordWriteColor(writer, renderData->border.color);
+                Clay__RecordWriteCornerRadius(writer, renderData->border.cornerRadius);
+                Clay__RecordWriteVarint(writer, renderData->border.width.left);
+                Clay__RecordWriteVarint(writer, renderData->border.width.right);
+                Clay__RecordWriteVarint(writer, renderData->border.width.top);
+                Clay__RecordWriteVarint(writer, renderData->border.width.bottom);
+                Clay__RecordWriteVarint(writer, renderData->border.width.betweenChildren);
+                break;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_TEXT: {
+                // Already interned above, so this only looks the span up
+                if (Clay__RecordStartsTextRun(renderCommands, i)) textSpanIndex = Clay__RecordInternString(writer, Clay__RecordTextSpan(renderCommands, i));
+                Clay_StringSlice line = renderData->text.stringContents;
+                Clay__RecordWriteVarint(writer, (uint64_t)textSpanIndex);
+                Clay__RecordWriteVarint(writer, (uint64_t)(line.chars - Clay__RecordTextBase(line)));
+                Clay__RecordWriteVarint(writer, (uint64_t)line.length);
+                Clay__RecordWriteColor(writer, renderData->text.textColor);
+                Clay__RecordWriteVarint(writer, renderData->text.fontId);
+                Clay__RecordWriteVarint(writer, renderData->text.fontSize);
+                Clay__RecordWriteVarint(writer, renderData->text.letterSpacing);
+                Clay__RecordWriteVarint(writer, renderData->text.lineHeight);
+                Clay__RecordWriteVarint(writer, renderData->text.stringHandle);
+                Clay__RecordWriteVarint(writer, renderData->text.stringVersion);
+                break;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_IMAGE: {
+                Clay__RecordWriteColor(writer, renderData->image.backgroundColor);
+                Clay__RecordWriteCornerRadius(writer, renderData->image.cornerRadius);
+                Clay__RecordWriteVarint(writer, (uint64_t)(uintptr_t)renderData->image.imageData);
+                Clay__RecordWriteVarint(writer, renderData->image.imageVersion);
+                break;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_CUSTOM: {
+                Clay__RecordWriteColor(writer, renderData->custom.backgroundColor);
+                Clay__RecordWriteCornerRadius(writer, renderData->custom.cornerRadius);
+                Clay__RecordWriteVarint(writer, (uint64_t)(uintptr_t)renderData->custom.customData);
+                break;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_SCISSOR_START:
+            case CLAY_RENDER_COMMAND_TYPE_SCISSOR_END: {
+                Clay__RecordWriteU8(writer, (uint8_t)(renderData->clip.horizontal | (renderData->clip.vertical << 1)));
+                break;
+            }
+            default: break;
+        }
+        if (renderCommand->userData) {
+            Clay__RecordWriteVarint(writer, (uint64_t)(uintptr_t)renderCommand->userData);
+        }
+    }
+
+    if (writer->failed || writer->length - frameStart - CLAY__RECORD_FRAME_HEADER_SIZE > UINT32_MAX) {
+        writer->length = frameStart;
+        writer->failed = false;
+        return false;
+    }
+    Clay__RecordStoreU32(writer->data + frameStart, (uint32_t)(writer->length - frameStart - CLAY__RECORD_FRAME_HEADER_SIZE));
+    return true;
+}
+
+const uint8_t *Clay_Record_GetData(Clay_RecordWriter *writer, size_t *length) {
+    *length = writer->length;
+    return writer->data;
+}
+
+// Reading -----------------------------------------
+
+static inline uint32_t Clay__RecordLoadU32(const uint8_t *source) {
+    return (uint32_t)source[0] | ((uint32_t)source[1] << 8) | ((uint32_t)source[2] << 16) | ((uint32_t)source[3] << 24);
+}
+
+static bool Clay__RecordReadVarint(const uint8_t *data, size_t length, size_t *offset, uint64_t *value) {
+    uint64_t result = 0;
+    for (int32_t shift = 0; shift < 64; shift += 7) {
+        if (*offset >= length) return false;
+        uint8_t byte = data[(*offset)++];
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Clay_Record_OpenReader(Clay_RecordReader *reader, const void *data, size_t length) {
+    *reader = CLAY__INIT(Clay_RecordReader) { .data = (const uint8_t *)data, .length = length, .offset = CLAY__RECORD_FILE_HEADER_SIZE };
+    if (length < CLAY__RECORD_FILE_HEADER_SIZE || memcmp(data, Clay__recordMagic, 4) != 0) {
+        reader->error = true;
+        return false;
+    }
+    reader->version = (uint16_t)(reader->data[4] | (reader->data[5] << 8));
+    if (reader->version != CLAY_RECORD_VERSION) {
+        reader->error = true;
+        return false;
+    }
+    return true;
+}
+
+bool Clay_Record_NextFrame(Clay_RecordReader *reader, Clay_RecordFrame *frame) {
+    if (reader->error || reader->offset == reader->length) return false;
+    if (reader->length - reader->offset < CLAY__RECORD_FRAME_HEADER_SIZE) {
+        reader->error = true;
+        return false;
+    }
+    size_t frameLength = Clay__RecordLoadU32(reader->data + reader->offset);
+    if (frameLength > reader->length - reader->offset - CLAY__RECORD_FRAME_HEADER_SIZE) {
+        reader->error = true;
+        return false;
+    }
+    *frame = CLAY__INIT(Clay_RecordFrame) { .data = reader->data + reader->offset + CLAY__RECORD_FRAME_HEADER_SIZE, .length = frameLength };
+    reader->offset += CLAY__RECORD_FRAME_HEADER_SIZE + frameLength;
+
+    size_t offset = 0;
+    uint64_t commandCount, stringCount;
+    if (!Clay__RecordReadVarint(frame->data, frame->length, &offset, &commandCount)
+        || !Clay__RecordReadVarint(frame->data, frame->length, &offset, &stringCount)
+        || commandCount > INT32_MAX || stringCount >= (frame->length - offset) / 4) {
+        reader->error = true;
+        return false;
+    }
+    frame->commandCount = (int32_t)commandCount;
+    frame->stringCount = (int32_t)stringCount;
+    frame->stringOffsets = frame->data + offset;
+    offset += (size_t)(stringCount + 1) * 4;
+    frame->stringBytes = frame->data + offset;
+    size_t stringBytesLength = Clay__RecordLoadU32(frame->stringOffsets + stringCount * 4);
+    if (stringBytesLength > frame->length - offset) {
+        reader->error = true;
+        return false;
+    }
+    frame->commandsOffset = offset + stringBytesLength;
+    return true;
+}
+
+Clay_RecordCommandIterator Clay_Record_IterateCommands(const Clay_RecordFrame *frame) {
+    return CLAY__INIT(Clay_RecordCommandIterator) { .frame = frame, .offset = frame->commandsOffset, .remaining = frame->commandCount };
+}
+
+static bool Clay__RecordReadNumber(Clay_RecordCommandIterator *iterator, float previous, float *value) {
+    const Clay_RecordFrame *frame = iterator->frame;
+    uint64_t tag;
+    if (!Clay__RecordReadVarint(frame->data, frame->length, &iterator->offset, &tag)) return false;
+    if (tag & 1) {
+        if (tag != 1 || frame->length - iterator->offset < 4) return false;
+        uint32_t bits = Clay__RecordLoadU32(frame->data + iterator->offset);
+        iterator->offset += 4;
+        memcpy(value, &bits, 4);
+    } else {
+        *value = (float)((int32_t)previous + Clay__RecordUnzigzag(tag >> 1));
+    }
+    return true;
+}
+
+static bool Clay__RecordReadColor(Clay_RecordCommandIterator *iterator, Clay_Color *color) {
+    return Clay__RecordReadNumber(iterator, 0, &color->r) && Clay__RecordReadNumber(iterator, 0, &color->g)
+        && Clay__RecordReadNumber(iterator, 0, &color->b) && Clay__RecordReadNumber(iterator, 0, &color->a);
+}
+
+static bool Clay__RecordReadCornerRadius(Clay_RecordCommandIterator *iterator, Clay_CornerRadius *cornerRadius) {
+    return Clay__RecordReadNumber(iterator, 0, &cornerRadius->topLeft) && Clay__RecordReadNumber(iterator, 0, &cornerRadius->topRight)
+        && Clay__RecordReadNumber(iterator, 0, &cornerRadius->bottomLeft) && Clay__RecordReadNumber(iterator, 0, &cornerRadius->bottomRight);
+}
+
+static bool Clay__RecordReadUint16(Clay_RecordCommandIterator *iterator, uint16_t *value) {
+    uint64_t result;
+    if (!Clay__RecordReadVarint(iterator->frame->data, iterator->frame->length, &iterator->offset, &result) || result > UINT16_MAX) return false;
+    *value = (uint16_t)result;
+    return true;
+}
+
+static bool Clay__RecordReadUint32(Clay_RecordCommandIterator *iterator, uint32_t *value) {
+    uint64_t result;
+    if (!Clay__RecordReadVarint(iterator->frame->data, iterator->frame->length, &iterator->offset, &result) || result > UINT32_MAX) return false;
+    *value = (uint32_t)result;
+    return true;
+}
+
+static bool Clay__RecordReadPointer(Clay_RecordCommandIterator *iterator, void **value) {
+    uint64_t result;
+    if (!Clay__RecordReadVarint(iterator->frame->data, iterator->frame->length, &iterator->offset, &result)) return false;
+    *value = (void *)(uintptr_t)result;
+    return true;
+}
+
+static bool Clay__RecordDecodeCommand(Clay_RecordCommandIterator *iterator, Clay_RenderCommand *renderCommand) {
+    const Clay_RecordFrame *frame = iterator->frame;
+    *renderCommand = CLAY__INIT(Clay_RenderCommand) { 0 };
+    if (frame->length - iterator->offset < 5) return false;
+    uint8_t type = frame->data[iterator->offset];
+    renderCommand->commandType = (Clay_RenderCommandType)(type & ~CLAY__RECORD_HAS_USER_DATA);
+    renderCommand->id = Clay__RecordLoadU32(frame->data + iterator->offset + 1);
+    iterator->offset += 5;
+    uint64_t zIndexDelta;
+    if (!Clay__RecordReadVarint(frame->data, frame->length, &iterator->offset, &zIndexDelta)) return false;
+    renderCommand->zIndex = (int16_t)(iterator->previousZIndex + Clay__RecordUnzigzag(zIndexDelta));
+    iterator->previousZIndex = renderCommand->zIndex;
+    float *boundingBox[4] = { &renderCommand->boundingBox.x, &renderCommand->boundingBox.y, &renderCommand->boundingBox.width, &renderCommand->boundingBox.height };
+    for (int32_t i = 0; i < 4; ++i) {
+        if (!Clay__RecordReadNumber(iterator, iterator->previousBoundingBox[i], boundingBox[i])) return false;
+        iterator->previousBoundingBox[i] = *boundingBox[i];
+    }
+    Clay_RenderData *renderData = &renderCommand->renderData;
+    switch (renderCommand->commandType) {
+        case CLAY_RENDER_COMMAND_TYPE_RECTANGLE: {
+            if (!Clay__RecordReadColor(iterator, &renderData->rectangle.backgroundColor) || !Clay__RecordReadCornerRadius(iterator, &renderData->rectangle.cornerRadius)) return false;
+            break;
+        }
+        case CLAY_RENDER_COMMAND_TYPE_BORDER: {
+            Clay_BorderWidth *width = &renderData->border.width;
+            if (!Clay__RecordReadColor(iterator, &renderData->border.color) || !Clay__RecordReadCornerRadius(iterator, &renderData->border.cornerRadius)
+                || !Clay__RecordReadUint16(iterator, &width->left) || !Clay__RecordReadUint16(iterator, &width->right)
+                || !Clay__RecordReadUint16(iterator, &width->top) || !Clay__RecordReadUint16(iterator, &width->bottom)
+                || !Clay__RecordReadUint16(iterator, &width->betweenChildren)) return false;
+            break;
+        }
+        case CLAY_RENDER_COMMAND_TYPE_TEXT: {
+            uint64_t stringIndex, lineOffset, lineLength;
+            if (!Clay__RecordReadVarint(frame->data, frame->length, &iterator->offset, &stringIndex) || stringIndex >= (uint64_t)frame->stringCount
+                || !Clay__RecordReadVarint(frame->data, frame->length, &iterator->offset, &lineOffset)
+                || !Clay__RecordReadVarint(frame->data, frame->length, &iterator->offset, &lineLength)) return false;
+            uint32_t start = Clay__RecordLoadU32(frame->stringOffsets + stringIndex * 4);
+            uint32_t end = Clay__RecordLoadU32(frame->stringOffsets + stringIndex * 4 + 4);
+            if (start > end || end > frame->commandsOffset - (size_t)(frame->stringBytes - frame->data) || end - start > INT32_MAX) return false;
+            if (lineOffset > end - start || lineLength > end - start - lineOffset) return false;
+            const char *baseChars = (const char *)frame->stringBytes + start;
+            renderData->text.stringContents = CLAY__INIT(Clay_StringSlice) { .length = (int32_t)lineLength, .chars = baseChars + lineOffset, .baseChars = baseChars };
+            if (!Clay__RecordReadColor(iterator, &renderData->text.textColor) || !Clay__RecordReadUint16(iterator, &renderData->text.fontId)
+                || !Clay__RecordReadUint16(iterator, &renderData->text.fontSize) || !Clay__RecordReadUint16(iterator, &renderData->text.letterSpacing)
+                || !Clay__RecordReadUint16(iterator, &renderData->text.lineHeight) || !Clay__RecordReadUint32(iterator, &renderData->text.stringHandle)
+                || !Clay__RecordReadUint32(iterator, &renderData->text.stringVersion)) return false;
+            break;
+        }
+        case CLAY_RENDER_COMMAND_TYPE_IMAGE: {
+            if (!Clay__RecordReadColor(iterator, &renderData->image.backgroundColor) || !Clay__RecordReadCornerRadius(iterator, &renderData->image.cornerRadius)
+                || !Clay__RecordReadPointer(iterator, &renderData->image.imageData) || !Clay__RecordReadUint32(iterator, &renderData->image.imageVersion)) return false;
+            break;
+        }
+        case CLAY_RENDER_COMMAND_TYPE_CUSTOM: {
+            if (!Clay__RecordReadColor(iterator, &renderData->custom.backgroundColor) || !Clay__RecordReadCornerRadius(iterator, &renderData->custom.cornerRadius)
+                || !Clay__RecordReadPointer(iterator, &renderData->custom.customData)) return false;
+            break;
+        }
+        case CLAY_RENDER_COMMAND_TYPE_SCISSOR_START:
+        case CLAY_RENDER_COMMAND_TYPE_SCISSOR_END: {
+            if (iterator->offset >= frame->length) return false;
+            uint8_t flags = frame->data[iterator->offset++];
+            renderData->clip.horizontal = flags & 1;
+            renderData->clip.vertical = (flags >> 1) & 1;
+            break;
+        }
+        case CLAY_RENDER_COMMAND_TYPE_NONE: break;
+        default: return false;
+    }
+    if (type & CLAY__RECORD_HAS_USER_DATA) {
+        return Clay__RecordReadPointer(iterator, &renderCommand->userData);
+    }
+    return true;
+}
+
+bool Clay_Record_NextCommand(Clay_RecordCommandIterator *iterator, Clay_RenderCommand *renderCommand) {
+    if (iterator->error || iterator->remaining <= 0) return false;
+    if (!Clay__RecordDecodeCommand(iterator, renderCommand)) {
+        iterator->error = true;
+        return false;
+    }
+    iterator->remaining--;
+    return true;
+}
+
+#endif // CLAY_RECORD_IMPLEMENTATION
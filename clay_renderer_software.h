@@ -0,0 +1,734 @@
+/*
+    Portable software renderer for Clay render commands.
+
+    Rasterizes a Clay_RenderCommandArray into a 32 bit RGBA framebuffer on the CPU, without any platform
+    dependencies beyond pthreads. Intended as a reference renderer for pixel tests and benchmarks on machines
+    without a GPU or windowing system.
+
+    NOTE: In order to use this renderer you must define the following macro in exactly one file,
+    _after_ including clay.h and _before_ including this file:
+
+    #define CLAY_RENDERER_SOFTWARE_IMPLEMENTATION
+    #include "clay_renderer_software.h"
+
+    Supported render commands:
+    - RECTANGLE, with per corner radii
+    - BORDER, with per side widths and per corner radii
+    - SCISSOR_START / SCISSOR_END, arbitrarily nested
+    - TEXT, using glyph coverage bitmaps supplied by Clay_Software_SetGlyphFunction()
+    - IMAGE, if .imageData points to a Clay_SoftwareImage
+    CUSTOM render commands are ignored.
+
+    The framebuffer is split into square tiles, commands are binned into the tiles they overlap, and tiles are
+    rasterized in parallel on a persistent thread pool. Solid spans are filled with SSE2 / NEON kernels, and only
+    pixels on anti-aliased edges are shaded individually.
+
+    Define CLAY_SOFTWARE_NO_THREADS to build without pthreads, in which case all tiles are rasterized on the
+    calling thread.
+*/
+
+#ifndef CLAY_RENDERER_SOFTWARE_H
+#define CLAY_RENDERER_SOFTWARE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Pixels are stored as bytes in R, G, B, A order, i.e. (a << 24) | (b << 16) | (g << 8) | r on little endian machines.
+typedef struct Clay_SoftwareFramebuffer {
+    uint32_t *pixels;
+    int32_t width;
+    int32_t height;
+    int32_t stride; // The distance between the start of each row, in pixels
+} Clay_SoftwareFramebuffer;
+
+// An 8 bit coverage bitmap for a single glyph, usually a rectangle inside a larger atlas.
+typedef struct Clay_SoftwareGlyph {
+    const uint8_t *coverage; // May be NULL for glyphs without visible pixels, such as spaces
+    int32_t stride; // The distance between the start of each row of .coverage, in bytes
+    int32_t width;
+    int32_t height;
+    int32_t offsetX; // The offset of the bitmap's top left corner from the pen position, which starts at the top left of the line
+    int32_t offsetY;
+    float advance; // The horizontal distance to move the pen after drawing this glyph
+} Clay_SoftwareGlyph;
+
+// Looks up the glyph for a unicode codepoint at the given font and size. Returns false if the glyph doesn't exist.
+// Note: this is called concurrently from multiple threads, and should only read from a prebuilt atlas.
+typedef bool (*Clay_SoftwareGlyphFunction)(uint32_t codepoint, uint16_t fontId, uint16_t fontSize, Clay_SoftwareGlyph *glyph, void *userData);
+
+// IMAGE render commands are drawn if their .imageData points to one of these. Pixels use the same format as the framebuffer.
+typedef struct Clay_SoftwareImage {
+    const uint32_t *pixels;
+    int32_t width;
+    int32_t height;
+    int32_t stride; // In pixels
+} Clay_SoftwareImage;
+
+typedef struct Clay_SoftwareRenderer Clay_SoftwareRenderer;
+
+// Creates a renderer with its own pool of threadCount - 1 worker threads. The calling thread also rasterizes tiles.
+// A threadCount of 0 or 1 rasterizes everything on the calling thread.
+Clay_SoftwareRenderer *Clay_Software_CreateRenderer(int32_t threadCount);
+// Stops the renderer's worker threads and frees all memory owned by the renderer.
+void Clay_Software_DestroyRenderer(Clay_SoftwareRenderer *renderer);
+// Sets the function used to look up glyphs for TEXT render commands. Without one, text is not drawn.
+void Clay_Software_SetGlyphFunction(Clay_SoftwareRenderer *renderer, Clay_SoftwareGlyphFunction glyphFunction, void *userData);
+// Clears the framebuffer to clearColor and draws every render command into it. Blocks until rendering is complete.
+void Clay_Software_Render(Clay_SoftwareRenderer *renderer, Clay_SoftwareFramebuffer framebuffer, Clay_RenderCommandArray renderCommands, Clay_Color clearColor);
+// A text measurement function for Clay_SetMeasureTextFunction() that uses the renderer's glyph function,
+// so that layout and rendering agree exactly. Pass the renderer as the userData argument.
+Clay_Dimensions Clay_Software_MeasureText(Clay_StringSlice text, Clay_TextElementConfig *config, void *userData);
+
+#endif // CLAY_RENDERER_SOFTWARE_H
+
+#ifdef CLAY_RENDERER_SOFTWARE_IMPLEMENTATION
+#undef CLAY_RENDERER_SOFTWARE_IMPLEMENTATION
+
+#include <stdlib.h>
+#include <math.h>
+#ifndef CLAY_SOFTWARE_NO_THREADS
+#include <pthread.h>
+#endif
+
+#if !defined(CLAY_DISABLE_SIMD) && (defined(__x86_64__) || defined(_M_X64) || defined(_M_AMD64))
+#include <emmintrin.h>
+#define CLAY__SOFTWARE_SSE2
+#elif !defined(CLAY_DISABLE_SIMD) && defined(__aarch64__)
+#include <arm_neon.h>
+#define CLAY__SOFTWARE_NEON
+#endif
+
+#define CLAY__SOFTWARE_TILE_SIZE 64
+
+typedef struct {
+    int32_t x0, y0, x1, y1; // Half open pixel bounds
+} Clay__SoftwareRect;
+
+typedef struct {
+    Clay_RenderCommand *renderCommand;
+    Clay__SoftwareRect clip; // Intersection of the active scissor rects and the framebuffer
+    Clay__SoftwareRect bounds; // Pixels the command can touch, already clipped
+} Clay__SoftwareCommand;
+
+// A rounded rectangle in pixel space. Radii are already clamped to fit inside the rectangle.
+typedef struct {
+    float left, top, right, bottom;
+    float topLeft, topRight, bottomLeft, bottomRight;
+} Clay__SoftwareShape;
+
+struct Clay_SoftwareRenderer {
+    Clay_SoftwareGlyphFunction glyphFunction;
+    void *glyphUserData;
+    // Per frame state, read by all threads while rendering
+    Clay_SoftwareFramebuffer framebuffer;
+    uint32_t clearPixel;
+    Clay__SoftwareCommand *commands;
+    int32_t commandCapacity;
+    int32_t tilesX;
+    int32_t tilesY;
+    int32_t *tileCommandOffsets; // tileCount + 1 entries, the commands for tile i are tileCommands[offsets[i]..offsets[i + 1]]
+    int32_t tileCapacity;
+    int32_t *tileCommands;
+    int32_t tileCommandCapacity;
+    // Thread pool
+    int32_t threadCount;
+#ifndef CLAY_SOFTWARE_NO_THREADS
+    pthread_t *threads;
+    pthread_mutex_t mutex;
+    pthread_cond_t workAvailable;
+    pthread_cond_t workFinished;
+    uint32_t jobGeneration;
+    int32_t nextTile;
+    int32_t busyWorkers;
+    bool shuttingDown;
+#endif
+};
+
+static inline int32_t Clay__SoftwareMinInt(int32_t a, int32_t b) { return a < b ? a : b; }
+static inline int32_t Clay__SoftwareMaxInt(int32_t a, int32_t b) { return a > b ? a : b; }
+static inline float Clay__SoftwareClamp01(float value) { return value < 0 ? 0 : (value > 1 ? 1 : value); }
+
+static Clay__SoftwareRect Clay__SoftwareIntersect(Clay__SoftwareRect a, Clay__SoftwareRect b) {
+    Clay__SoftwareRect result = { Clay__SoftwareMaxInt(a.x0, b.x0), Clay__SoftwareMaxInt(a.y0, b.y0), Clay__SoftwareMinInt(a.x1, b.x1), Clay__SoftwareMinInt(a.y1, b.y1) };
+    if (result.x1 < result.x0) result.x1 = result.x0;
+    if (result.y1 < result.y0) result.y1 = result.y0;
+    return result;
+}
+
+static inline bool Clay__SoftwareRectIsEmpty(Clay__SoftwareRect rect) {
+    return rect.x0 >= rect.x1 || rect.y0 >= rect.y1;
+}
+
+// Rounds outwards, so that the rect contains every pixel the bounding box partially covers
+static Clay__SoftwareRect Clay__SoftwareRectFromBoundingBox(Clay_BoundingBox boundingBox) {
+    Clay__SoftwareRect result = { (int32_t)floorf(boundingBox.x), (int32_t)floorf(boundingBox.y), (int32_t)ceilf(boundingBox.x + boundingBox.width), (int32_t)ceilf(boundingBox.y + boundingBox.height) };
+    return result;
+}
+
+static inline uint8_t Clay__SoftwareColorChannel(float value) {
+    return (uint8_t)(value <= 0 ? 0 : (value >= 255 ? 255 : value + 0.5f));
+}
+
+// Span kernels -----------------------------------------
+
+// Divides a 16 bit product of two 8 bit values by 255, rounding to nearest.
+static inline uint32_t Clay__SoftwareDiv255(uint32_t value) {
+    value += 128;
+    return (value + (value >> 8)) >> 8;
+}
+
+static inline void Clay__SoftwareBlendPixel(uint32_t *destination, uint8_t r, uint8_t g, uint8_t b, uint32_t alpha) {
+    if (alpha == 0) return;
+    if (alpha == 255) {
+        *destination = (uint32_t)r | ((uint32_t)g << 8) | ((uint32_t)b << 16) | 0xFF000000u;
+        return;
+    }
+    uint32_t pixel = *destination;
+    uint32_t inverse = 255 - alpha;
+    uint32_t outR = Clay__SoftwareDiv255(r * alpha + (pixel & 0xFF) * inverse);
+    uint32_t outG = Clay__SoftwareDiv255(g * alpha + ((pixel >> 8) & 0xFF) * inverse);
+    uint32_t outB = Clay__SoftwareDiv255(b * alpha + ((pixel >> 16) & 0xFF) * inverse);
+    uint32_t outA = Clay__SoftwareDiv255(255 * alpha + (pixel >> 24) * inverse);
+    *destination = outR | (outG << 8) | (outB << 16) | (outA << 24);
+}
+
+// Writes an opaque pixel value to count consecutive pixels.
+static void Clay__SoftwareFillSpan(uint32_t *destination, int32_t count, uint32_t pixel) {
+    int32_t i = 0;
+#if defined(CLAY__SOFTWARE_SSE2)
+    __m128i pixels = _mm_set1_epi32((int)pixel);
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128((__m128i *)(destination + i), pixels);
+    }
+#elif defined(CLAY__SOFTWARE_NEON)
+    uint32x4_t pixels = vdupq_n_u32(pixel);
+    for (; i + 4 <= count; i += 4) {
+        vst1q_u32(destination + i, pixels);
+    }
+#endif
+    for (; i < count; ++i) {
+        destination[i] = pixel;
+    }
+}
+
+// Blends a single color with constant alpha over count consecutive pixels.
+static void Clay__SoftwareBlendSpan(uint32_t *destination, int32_t count, uint8_t r, uint8_t g, uint8_t b, uint32_t alpha) {
+    if (alpha == 0) return;
+    if (alpha == 255) {
+        Clay__SoftwareFillSpan(destination, count, (uint32_t)r | ((uint32_t)g << 8) | ((uint32_t)b << 16) | 0xFF000000u);
+        return;
+    }
+    int32_t i = 0;
+    uint32_t inverse = 255 - alpha;
+#if defined(CLAY__SOFTWARE_SSE2)
+    // Source times alpha for two pixels, as 16 bit lanes. The source alpha channel is 255 so that alpha accumulates.
+    __m128i source = _mm_setr_epi16((short)(r * alpha), (short)(g * alpha), (short)(b * alpha), (short)(255 * alpha), (short)(r * alpha), (short)(g * alpha), (short)(b * alpha), (short)(255 * alpha));
+    __m128i inverseAlpha = _mm_set1_epi16((short)inverse);
+    __m128i rounding = _mm_set1_epi16(128);
+    __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4) {
+        __m128i pixels = _mm_loadu_si128((__m128i *)(destination + i));
+        __m128i low = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(pixels, zero), inverseAlpha), source), rounding);
+        __m128i high = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(pixels, zero), inverseAlpha), source), rounding);
+        low = _mm_srli_epi16(_mm_add_epi16(low, _mm_srli_epi16(low, 8)), 8);
+        high = _mm_srli_epi16(_mm_add_epi16(high, _mm_srli_epi16(high, 8)), 8);
+        _mm_storeu_si128((__m128i *)(destination + i), _mm_packus_epi16(low, high));
+    }
+#elif defined(CLAY__SOFTWARE_NEON)
+    uint8_t sourceLanes[16] = { r, g, b, 255, r, g, b, 255, r, g, b, 255, r, g, b, 255 };
+    uint8x16_t sourcePixels = vld1q_u8(sourceLanes);
+    uint8x8_t alphaLanes = vdup_n_u8((uint8_t)alpha);
+    uint8x8_t inverseLanes = vdup_n_u8((uint8_t)inverse);
+    uint16x8_t sourceLow = vmull_u8(vget_low_u8(sourcePixels), alphaLanes);
+    uint16x8_t sourceHigh = vmull_u8(vget_high_u8(sourcePixels), alphaLanes);
+    for (; i + 4 <= count; i += 4) {
+        uint8x16_t pixels = vld1q_u8((uint8_t *)(destination + i));
+        uint16x8_t low = vmlal_u8(sourceLow, vget_low_u8(pixels), inverseLanes);
+        uint16x8_t high = vmlal_u8(sourceHigh, vget_high_u8(pixels), inverseLanes);
+        // (x + ((x + 128) >> 8) + 128) >> 8, an exact division by 255
+        uint8x8_t lowResult = vraddhn_u16(low, vrshrq_n_u16(low, 8));
+        uint8x8_t highResult = vraddhn_u16(high, vrshrq_n_u16(high, 8));
+        vst1q_u8((uint8_t *)(destination + i), vcombine_u8(lowResult, highResult));
+    }
+#endif
+    for (; i < count; ++i) {
+        Clay__SoftwareBlendPixel(destination + i, r, g, b, alpha);
+    }
+}
+
+// Shape coverage -----------------------------------------
+
+static Clay__SoftwareShape Clay__SoftwareShapeFromBoundingBox(Clay_BoundingBox boundingBox, Clay_CornerRadius cornerRadius) {
+    float maxRadius = (boundingBox.width < boundingBox.height ? boundingBox.width : boundingBox.height) / 2;
+    if (maxRadius < 0) maxRadius = 0;
+    Clay__SoftwareShape shape = {
+        boundingBox.x, boundingBox.y, boundingBox.x + boundingBox.width, boundingBox.y + boundingBox.height,
+        CLAY__MIN(CLAY__MAX(cornerRadius.topLeft, 0), maxRadius),
+        CLAY__MIN(CLAY__MAX(cornerRadius.topRight, 0), maxRadius),
+        CLAY__MIN(CLAY__MAX(cornerRadius.bottomLeft, 0), maxRadius),
+        CLAY__MIN(CLAY__MAX(cornerRadius.bottomRight, 0), maxRadius),
+    };
+    return shape;
+}
+
+static inline float Clay__SoftwareCornerCoverage(float x, float y, float centerX, float centerY, float radius) {
+    float dx = x - centerX;
+    float dy = y - centerY;
+    return Clay__SoftwareClamp01(radius - sqrtf(dx * dx + dy * dy) + 0.5f);
+}
+
+// Approximate coverage of the pixel whose top left corner is (x, y) by the shape.
+static float Clay__SoftwareShapeCoverage(const Clay__SoftwareShape *shape, int32_t x, int32_t y) {
+    float px = (float)x, py = (float)y;
+    float coverageX = Clay__SoftwareClamp01(CLAY__MIN(px + 1, shape->right) - CLAY__MAX(px, shape->left));
+    float coverageY = Clay__SoftwareClamp01(CLAY__MIN(py + 1, shape->bottom) - CLAY__MAX(py, shape->top));
+    float coverage = coverageX * coverageY;
+    if (coverage <= 0) return 0;
+    float centerX = px + 0.5f, centerY = py + 0.5f;
+    if (centerX < shape->left + shape->topLeft && centerY < shape->top + shape->topLeft) {
+        coverage = CLAY__MIN(coverage, Clay__SoftwareCornerCoverage(centerX, centerY, shape->left + shape->topLeft, shape->top + shape->topLeft, shape->topLeft));
+    } else if (centerX > shape->right - shape->topRight && centerY < shape->top + shape->topRight) {
+        coverage = CLAY__MIN(coverage, Clay__SoftwareCornerCoverage(centerX, centerY, shape->right - shape->topRight, shape->top + shape->topRight, shape->topRight));
+    } else if (centerX < shape->left + shape->bottomLeft && centerY > shape->bottom - shape->bottomLeft) {
+        coverage = CLAY__MIN(coverage, Clay__SoftwareCornerCoverage(centerX, centerY, shape->left + shape->bottomLeft, shape->bottom - shape->bottomLeft, shape->bottomLeft));
+    } else if (centerX > shape->right - shape->bottomRight && centerY > shape->bottom - shape->bottomRight) {
+        coverage = CLAY__MIN(coverage, Clay__SoftwareCornerCoverage(centerX, centerY, shape->right - shape->bottomRight, shape->bottom - shape->bottomRight, shape->bottomRight));
+    }
+    return coverage;
+}
+
+// The range of pixels in row y that are guaranteed to be fully covered by the shape. Empty if x1 <= x0.
+static void Clay__SoftwareShapeSolidRange(const Clay__SoftwareShape *shape, int32_t y, int32_t *x0, int32_t *x1) {
+    float rowTop = (float)y, rowBottom = (float)(y + 1);
+    if (rowTop < shape->top || rowBottom > shape->bottom) {
+        *x0 = 0; *x1 = 0;
+        return;
+    }
+    float left = shape->left, right = shape->right;
+    if (rowTop < shape->top + shape->topLeft) left = CLAY__MAX(left, shape->left + shape->topLeft);
+    if (rowBottom > shape->bottom - shape->bottomLeft) left = CLAY__MAX(left, shape->left + shape->bottomLeft);
+    if (rowTop < shape->top + shape->topRight) right = CLAY__MIN(right, shape->right - shape->topRight);
+    if (rowBottom > shape->bottom - shape->bottomRight) right = CLAY__MIN(right, shape->right - shape->bottomRight);
+    *x0 = (int32_t)ceilf(left);
+    *x1 = (int32_t)floorf(right);
+}
+
+// The range of pixels in row y that the shape may partially cover. Empty if x1 <= x0.
+static void Clay__SoftwareShapeTouchedRange(const Clay__SoftwareShape *shape, int32_t y, int32_t *x0, int32_t *x1) {
+    if ((float)(y + 1) <= shape->top || (float)y >= shape->bottom) {
+        *x0 = 0; *x1 = 0;
+        return;
+    }
+    *x0 = (int32_t)floorf(shape->left);
+    *x1 = (int32_t)ceilf(shape->right);
+}
+
+// Fills the shape minus an optional hole (for borders), clipped to the clip rect.
+// Each row is split into solid spans filled by the SIMD kernels, holes that are skipped, and anti-aliased edges shaded per pixel.
+static void Clay__SoftwareRasterizeShape(Clay_SoftwareFramebuffer *framebuffer, Clay__SoftwareRect clip, const Clay__SoftwareShape *outer, const Clay__SoftwareShape *inner, Clay_Color color) {
+    uint8_t r = Clay__SoftwareColorChannel(color.r), g = Clay__SoftwareColorChannel(color.g), b = Clay__SoftwareColorChannel(color.b);
+    uint32_t alpha = Clay__SoftwareColorChannel(color.a);
+    if (alpha == 0) return;
+    Clay__SoftwareRect bounds = Clay__SoftwareIntersect(clip, Clay__SoftwareRectFromBoundingBox(CLAY__INIT(Clay_BoundingBox) { outer->left, outer->top, outer->right - outer->left, outer->bottom - outer->top }));
+    for (int32_t y = bounds.y0; y < bounds.y1; ++y) {
+        uint32_t *row = framebuffer->pixels + (size_t)y * framebuffer->stride;
+        int32_t solidStart, solidEnd, holeTouchedStart = 0, holeTouchedEnd = 0, holeStart = 0, holeEnd = 0;
+        Clay__SoftwareShapeSolidRange(outer, y, &solidStart, &solidEnd);
+        if (inner) {
+            Clay__SoftwareShapeTouchedRange(inner, y, &holeTouchedStart, &holeTouchedEnd);
+            Clay__SoftwareShapeSolidRange(inner, y, &holeStart, &holeEnd);
+            if (holeEnd <= holeStart) { holeStart = 0; holeEnd = 0; }
+        }
+        int32_t x = bounds.x0;
+        while (x < bounds.x1) {
+            int32_t end;
+            bool perPixel;
+            if (holeEnd > holeStart && x >= holeStart && x < holeEnd) {
+                x = holeEnd;
+                continue;
+            }
+            if (x >= solidStart && x < solidEnd) {
+                if (holeTouchedEnd > holeTouchedStart && x >= holeTouchedStart && x < holeTouchedEnd) {
+                    // Inner edge of a border
+                    end = (holeEnd > holeStart && x < holeStart) ? holeStart : holeTouchedEnd;
+                    perPixel = true;
+                } else {
+                    end = solidEnd;
+                    if (holeTouchedEnd > holeTouchedStart && x < holeTouchedStart) end = CLAY__MIN(end, holeTouchedStart);
+                    perPixel = false;
+                }
+            } else {
+                end = x < solidStart ? solidStart : bounds.x1;
+                if (holeTouchedEnd > holeTouchedStart && x < holeTouchedStart) end = CLAY__MIN(end, holeTouchedStart);
+                if (holeEnd > holeStart && x < holeStart) end = CLAY__MIN(end, holeStart);
+                perPixel = true;
+            }
+            end = CLAY__MIN(CLAY__MAX(end, x + 1), bounds.x1);
+            if (perPixel) {
+                for (; x < end; ++x) {
+                    float coverage = Clay__SoftwareShapeCoverage(outer, x, y);
+                    if (inner && coverage > 0) coverage *= 1 - Clay__SoftwareShapeCoverage(inner, x, y);
+                    Clay__SoftwareBlendPixel(row + x, r, g, b, (uint32_t)(alpha * coverage + 0.5f));
+                }
+            } else {
+                Clay__SoftwareBlendSpan(row + x, end - x, r, g, b, alpha);
+                x = end;
+            }
+        }
+    }
+}
+
+static void Clay__SoftwareDrawBorder(Clay_SoftwareFramebuffer *framebuffer, Clay__SoftwareRect clip, Clay_RenderCommand *renderCommand) {
+    Clay_BorderRenderData *border = &renderCommand->renderData.border;
+    Clay_BoundingBox box = renderCommand->boundingBox;
+    Clay__SoftwareShape outer = Clay__SoftwareShapeFromBoundingBox(box, border->cornerRadius);
+    Clay_BoundingBox innerBox = { box.x + border->width.left, box.y + border->width.top, box.width - border->width.left - border->width.right, box.height - border->width.top - border->width.bottom };
+    if (innerBox.width <= 0 || innerBox.height <= 0) {
+        Clay__SoftwareRasterizeShape(framebuffer, clip, &outer, NULL, border->color);
+        return;
+    }
+    Clay_CornerRadius innerRadius = {
+        CLAY__MAX(outer.topLeft - CLAY__MAX(border->width.left, border->width.top), 0),
+        CLAY__MAX(outer.topRight - CLAY__MAX(border->width.right, border->width.top), 0),
+        CLAY__MAX(outer.bottomLeft - CLAY__MAX(border->width.left, border->width.bottom), 0),
+        CLAY__MAX(outer.bottomRight - CLAY__MAX(border->width.right, border->width.bottom), 0),
+    };
+    Clay__SoftwareShape inner = Clay__SoftwareShapeFromBoundingBox(innerBox, innerRadius);
+    Clay__SoftwareRasterizeShape(framebuffer, clip, &outer, &inner, border->color);
+}
+
+static void Clay__SoftwareDrawImage(Clay_SoftwareFramebuffer *framebuffer, Clay__SoftwareRect clip, Clay_RenderCommand *renderCommand) {
+    Clay_SoftwareImage *image = (Clay_SoftwareImage *)renderCommand->renderData.image.imageData;
+    Clay_BoundingBox box = renderCommand->boundingBox;
+    if (!image || !image->pixels || image->width <= 0 || image->height <= 0 || box.width <= 0 || box.height <= 0) return;
+    Clay__SoftwareShape shape = Clay__SoftwareShapeFromBoundingBox(box, renderCommand->renderData.image.cornerRadius);
+    Clay__SoftwareRect bounds = Clay__SoftwareIntersect(clip, Clay__SoftwareRectFromBoundingBox(box));
+    float scaleX = (float)image->width / box.width;
+    float scaleY = (float)image->height / box.height;
+    for (int32_t y = bounds.y0; y < bounds.y1; ++y) {
+        uint32_t *row = framebuffer->pixels + (size_t)y * framebuffer->stride;
+        int32_t sourceY = Clay__SoftwareMinInt(Clay__SoftwareMaxInt((int32_t)(((float)y + 0.5f - box.y) * scaleY), 0), image->height - 1);
+        const uint32_t *sourceRow = image->pixels + (size_t)sourceY * image->stride;
+        for (int32_t x = bounds.x0; x < bounds.x1; ++x) {
+            int32_t sourceX = Clay__SoftwareMinInt(Clay__SoftwareMaxInt((int32_t)(((float)x + 0.5f - box.x) * scaleX), 0), image->width - 1);
+            uint32_t source = sourceRow[sourceX];
+            float coverage = Clay__SoftwareShapeCoverage(&shape, x, y);
+            Clay__SoftwareBlendPixel(row + x, (uint8_t)source, (uint8_t)(source >> 8), (uint8_t)(source >> 16), (uint32_t)((source >> 24) * coverage + 0.5f));
+        }
+    }
+}
+
+// Decodes one UTF-8 codepoint, advancing *index. Invalid bytes decode as U+FFFD.
+static uint32_t Clay__SoftwareDecodeUtf8(const char *chars, int32_t length, int32_t *index) {
+    const uint8_t *bytes = (const uint8_t *)chars;
+    uint32_t first = bytes[(*index)++];
+    int32_t continuationBytes;
+    uint32_t codepoint;
+    if (first < 0x80) return first;
+    else if ((first & 0xE0) == 0xC0) { continuationBytes = 1; codepoint = first & 0x1F; }
+    else if ((first & 0xF0) == 0xE0) { continuationBytes = 2; codepoint = first & 0x0F; }
+    else if ((first & 0xF8) == 0xF0) { continuationBytes = 3; codepoint = first & 0x07; }
+    else return 0xFFFD;
+    for (int32_t i = 0; i < continuationBytes; ++i) {
+        if (*index >= length || (bytes[*index] & 0xC0) != 0x80) return 0xFFFD;
+        codepoint = (codepoint << 6) | (bytes[(*index)++] & 0x3F);
+    }
+    return codepoint;
+}
+
+static void Clay__SoftwareDrawText(Clay_SoftwareRenderer *renderer, Clay__SoftwareRect clip, Clay_RenderCommand *renderCommand) {
+    if (!renderer->glyphFunction) return;
+    Clay_TextRenderData *text = &renderCommand->renderData.text;
+    Clay_SoftwareFramebuffer *framebuffer = &renderer->framebuffer;
+    uint8_t r = Clay__SoftwareColorChannel(text->textColor.r), g = Clay__SoftwareColorChannel(text->textColor.g), b = Clay__SoftwareColorChannel(text->textColor.b);
+    uint32_t alpha = Clay__SoftwareColorChannel(text->textColor.a);
+    if (alpha == 0) return;
+    float penX = renderCommand->boundingBox.x;
+    int32_t penY = (int32_t)floorf(renderCommand->boundingBox.y + 0.5f);
+    int32_t index = 0;
+    while (index < text->stringContents.length) {
+        // Glyphs entirely right of the clip rect can't be visible, and the pen only moves right
+        if (penX >= (float)clip.x1) break;
+        uint32_t codepoint = Clay__SoftwareDecodeUtf8(text->stringContents.chars, text->stringContents.length, &index);
+        Clay_SoftwareGlyph glyph = { 0 };
+        if (!renderer->glyphFunction(codepoint, text->fontId, text->fontSize, &glyph, renderer->glyphUserData)) continue;
+        if (glyph.coverage) {
+            int32_t glyphX = (int32_t)floorf(penX + 0.5f) + glyph.offsetX;
+            int32_t glyphY = penY + glyph.offsetY;
+            Clay__SoftwareRect glyphBounds = Clay__SoftwareIntersect(clip, CLAY__INIT(Clay__SoftwareRect) { glyphX, glyphY, glyphX + glyph.width, glyphY + glyph.height });
+            for (int32_t y = glyphBounds.y0; y < glyphBounds.y1; ++y) {
+                uint32_t *row = framebuffer->pixels + (size_t)y * framebuffer->stride;
+                const uint8_t *coverageRow = glyph.coverage + (size_t)(y - glyphY) * glyph.stride - glyphX;
+                for (int32_t x = glyphBounds.x0; x < glyphBounds.x1; ++x) {
+                    uint32_t coverage = coverageRow[x];
+                    if (coverage) {
+                        Clay__SoftwareBlendPixel(row + x, r, g, b, Clay__SoftwareDiv255(coverage * alpha));
+                    }
+                }
+            }
+        }
+        penX += glyph.advance + text->letterSpacing;
+    }
+}
+
+// Tiles -----------------------------------------
+
+static void Clay__SoftwareRenderTile(Clay_SoftwareRenderer *renderer, int32_t tileIndex) {
+    Clay_SoftwareFramebuffer *framebuffer = &renderer->framebuffer;
+    int32_t tileX = (tileIndex % renderer->tilesX) * CLAY__SOFTWARE_TILE_SIZE;
+    int32_t tileY = (tileIndex / renderer->tilesX) * CLAY__SOFTWARE_TILE_SIZE;
+    Clay__SoftwareRect tile = { tileX, tileY, Clay__SoftwareMinInt(tileX + CLAY__SOFTWARE_TILE_SIZE, framebuffer->width), Clay__SoftwareMinInt(tileY + CLAY__SOFTWARE_TILE_SIZE, framebuffer->height) };
+    for (int32_t y = tile.y0; y < tile.y1; ++y) {
+        Clay__SoftwareFillSpan(framebuffer->pixels + (size_t)y * framebuffer->stride + tile.x0, tile.x1 - tile.x0, renderer->clearPixel);
+    }
+    for (int32_t i = renderer->tileCommandOffsets[tileIndex]; i < renderer->tileCommandOffsets[tileIndex + 1]; ++i) {
+        Clay__SoftwareCommand *command = &renderer->commands[renderer->tileCommands[i]];
+        Clay_RenderCommand *renderCommand = command->renderCommand;
+        Clay__SoftwareRect clip = Clay__SoftwareIntersect(command->clip, tile);
+        switch (renderCommand->commandType) {
+            case CLAY_RENDER_COMMAND_TYPE_RECTANGLE: {
+                Clay__SoftwareShape shape = Clay__SoftwareShapeFromBoundingBox(renderCommand->boundingBox, renderCommand->renderData.rectangle.cornerRadius);
+                Clay__SoftwareRasterizeShape(framebuffer, clip, &shape, NULL, renderCommand->renderData.rectangle.backgroundColor);
+                break;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_BORDER: Clay__SoftwareDrawBorder(framebuffer, clip, renderCommand); break;
+            case CLAY_RENDER_COMMAND_TYPE_IMAGE: Clay__SoftwareDrawImage(framebuffer, clip, renderCommand); break;
+            case CLAY_RENDER_COMMAND_TYPE_TEXT: Clay__SoftwareDrawText(renderer, clip, renderCommand); break;
+            default: break;
+        }
+    }
+}
+
+static void *Clay__SoftwareGrow(void *memory, int32_t *capacity, int32_t required, size_t elementSize) {
+    if (required <= *capacity) return memory;
+    int32_t newCapacity = CLAY__MAX(required, *capacity * 2);
+    void *grown = realloc(memory, (size_t)newCapacity * elementSize);
+    if (!grown) return NULL;
+    *capacity = newCapacity;
+    return grown;
+}
+
+// Resolves the clip rect of every drawable command and bins the commands into the tiles they overlap.
+static bool Clay__SoftwarePrepareFrame(Clay_SoftwareRenderer *renderer, Clay_RenderCommandArray renderCommands) {
+    Clay_SoftwareFramebuffer *framebuffer = &renderer->framebuffer;
+    Clay__SoftwareRect screen = { 0, 0, framebuffer->width, framebuffer->height };
+    renderer->tilesX = (framebuffer->width + CLAY__SOFTWARE_TILE_SIZE - 1) / CLAY__SOFTWARE_TILE_SIZE;
+    renderer->tilesY = (framebuffer->height + CLAY__SOFTWARE_TILE_SIZE - 1) / CLAY__SOFTWARE_TILE_SIZE;
+    int32_t tileCount = renderer->tilesX * renderer->tilesY;
+
+    Clay__SoftwareCommand *commands = (Clay__SoftwareCommand *)Clay__SoftwareGrow(renderer->commands, &renderer->commandCapacity, renderCommands.length, sizeof(Clay__SoftwareCommand));
+    int32_t *offsets = (int32_t *)Clay__SoftwareGrow(renderer->tileCommandOffsets, &renderer->tileCapacity, tileCount + 1, sizeof(int32_t));
+    if (!commands || !offsets) return false;
+    renderer->commands = commands;
+    renderer->tileCommandOffsets = offsets;
+
+    // Clip stack, the bottom entry is the whole framebuffer
+    Clay__SoftwareRect clipStack[64];
+    int32_t clipDepth = 0;
+    clipStack[0] = screen;
+    int32_t commandCount = 0;
+    for (int32_t i = 0; i <= tileCount; ++i) offsets[i] = 0;
+    for (int32_t i = 0; i < renderCommands.length; ++i) {
+        Clay_RenderCommand *renderCommand = &renderCommands.internalArray[i];
+        Clay__SoftwareRect bounds = Clay__SoftwareRectFromBoundingBox(renderCommand->boundingBox);
+        switch (renderCommand->commandType) {
+            case CLAY_RENDER_COMMAND_TYPE_SCISSOR_START: {
+                Clay__SoftwareRect parent = clipStack[clipDepth];
+                Clay__SoftwareRect scissor = parent;
+                // Clip elements only clip along the axes they were configured to
+                if (renderCommand->renderData.clip.horizontal) { scissor.x0 = bounds.x0; scissor.x1 = bounds.x1; }
+                if (renderCommand->renderData.clip.vertical) { scissor.y0 = bounds.y0; scissor.y1 = bounds.y1; }
+                if (clipDepth < (int32_t)(sizeof(clipStack) / sizeof(clipStack[0])) - 1) {
+                    clipStack[++clipDepth] = Clay__SoftwareIntersect(parent, scissor);
+                }
+                continue;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_SCISSOR_END: {
+                if (clipDepth > 0) clipDepth--;
+                continue;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_RECTANGLE:
+            case CLAY_RENDER_COMMAND_TYPE_BORDER:
+            case CLAY_RENDER_COMMAND_TYPE_IMAGE:
+            case CLAY_RENDER_COMMAND_TYPE_TEXT: break;
+            default: continue;
+        }
+        Clay__SoftwareRect clip = clipStack[clipDepth];
+        // Text can overflow its measured box slightly depending on the glyph bitmaps, so it is only clipped by the scissor rect
+        if (renderCommand->commandType != CLAY_RENDER_COMMAND_TYPE_TEXT) {
+            bounds = Clay__SoftwareIntersect(bounds, clip);
+        } else {
+            bounds = Clay__SoftwareIntersect(CLAY__INIT(Clay__SoftwareRect) { bounds.x0, bounds.y0 - renderCommand->renderData.text.fontSize, screen.x1, bounds.y1 + renderCommand->renderData.text.fontSize }, clip);
+        }
+        if (Clay__SoftwareRectIsEmpty(bounds)) continue;
+        commands[commandCount] = CLAY__INIT(Clay__SoftwareCommand) { .renderCommand = renderCommand, .clip = clip, .bounds = bounds };
+        for (int32_t ty = bounds.y0 / CLAY__SOFTWARE_TILE_SIZE; ty <= (bounds.y1 - 1) / CLAY__SOFTWARE_TILE_SIZE; ++ty) {
+            for (int32_t tx = bounds.x0 / CLAY__SOFTWARE_TILE_SIZE; tx <= (bounds.x1 - 1) / CLAY__SOFTWARE_TILE_SIZE; ++tx) {
+                offsets[ty * renderer->tilesX + tx + 1]++;
+            }
+        }
+        commandCount++;
+    }
+
+    for (int32_t i = 0; i < tileCount; ++i) offsets[i + 1] += offsets[i];
+    int32_t *tileCommands = (int32_t *)Clay__SoftwareGrow(renderer->tileCommands, &renderer->tileCommandCapacity, CLAY__MAX(offsets[tileCount], 1), sizeof(int32_t));
+    if (!tileCommands) return false;
+    renderer->tileCommands = tileCommands;
+    // Fill each tile's list in command order, using the start offsets as write cursors and then shifting them back
+    for (int32_t i = 0; i < commandCount; ++i) {
+        Clay__SoftwareRect bounds = commands[i].bounds;
+        for (int32_t ty = bounds.y0 / CLAY__SOFTWARE_TILE_SIZE; ty <= (bounds.y1 - 1) / CLAY__SOFTWARE_TILE_SIZE; ++ty) {
+            for (int32_t tx = bounds.x0 / CLAY__SOFTWARE_TILE_SIZE; tx <= (bounds.x1 - 1) / CLAY__SOFTWARE_TILE_SIZE; ++tx) {
+                tileCommands[offsets[ty * renderer->tilesX + tx]++] = i;
+            }
+        }
+    }
+    for (int32_t i = tileCount; i > 0; --i) offsets[i] = offsets[i - 1];
+    offsets[0] = 0;
+    return true;
+}
+
+// Thread pool -----------------------------------------
+
+#ifndef CLAY_SOFTWARE_NO_THREADS
+static int32_t Clay__SoftwareTakeTile(Clay_SoftwareRenderer *renderer) {
+    pthread_mutex_lock(&renderer->mutex);
+    int32_t tile = renderer->nextTile < renderer->tilesX * renderer->tilesY ? renderer->nextTile++ : -1;
+    pthread_mutex_unlock(&renderer->mutex);
+    return tile;
+}
+
+static void *Clay__SoftwareWorker(void *userData) {
+    Clay_SoftwareRenderer *renderer = (Clay_SoftwareRenderer *)userData;
+    uint32_t seenGeneration = 0;
+    for (;;) {
+        pthread_mutex_lock(&renderer->mutex);
+        while (!renderer->shuttingDown && renderer->jobGeneration == seenGeneration) {
+            pthread_cond_wait(&renderer->workAvailable, &renderer->mutex);
+        }
+        if (renderer->shuttingDown) {
+            pthread_mutex_unlock(&renderer->mutex);
+            return NULL;
+        }
+        seenGeneration = renderer->jobGeneration;
+        pthread_mutex_unlock(&renderer->mutex);
+
+        for (int32_t tile = Clay__SoftwareTakeTile(renderer); tile >= 0; tile = Clay__SoftwareTakeTile(renderer)) {
+            Clay__SoftwareRenderTile(renderer, tile);
+        }
+
+        pthread_mutex_lock(&renderer->mutex);
+        if (--renderer->busyWorkers == 0) {
+            pthread_cond_signal(&renderer->workFinished);
+        }
+        pthread_mutex_unlock(&renderer->mutex);
+    }
+}
+#endif
+
+// Public API -----------------------------------------
+
+Clay_SoftwareRenderer *Clay_Software_CreateRenderer(int32_t threadCount) {
+    Clay_SoftwareRenderer *renderer = (Clay_SoftwareRenderer *)calloc(1, sizeof(Clay_SoftwareRenderer));
+    if (!renderer) return NULL;
+    renderer->threadCount = 1;
+#ifndef CLAY_SOFTWARE_NO_THREADS
+    if (threadCount > 1) {
+        renderer->threads = (pthread_t *)calloc((size_t)threadCount - 1, sizeof(pthread_t));
+        if (renderer->threads) {
+            pthread_mutex_init(&renderer->mutex, NULL);
+            pthread_cond_init(&renderer->workAvailable, NULL);
+            pthread_cond_init(&renderer->workFinished, NULL);
+            for (int32_t i = 0; i < threadCount - 1; ++i) {
+                if (pthread_create(&renderer->threads[i], NULL, Clay__SoftwareWorker, renderer) != 0) break;
+                renderer->threadCount++;
+            }
+        }
+    }
+#else
+    (void)threadCount;
+#endif
+    return renderer;
+}
+
+void Clay_Software_DestroyRenderer(Clay_SoftwareRenderer *renderer) {
+    if (!renderer) return;
+#ifndef CLAY_SOFTWARE_NO_THREADS
+    if (renderer->threads) {
+        pthread_mutex_lock(&renderer->mutex);
+        renderer->shuttingDown = true;
+        pthread_cond_broadcast(&renderer->workAvailable);
+        pthread_mutex_unlock(&renderer->mutex);
+        for (int32_t i = 0; i < renderer->threadCount - 1; ++i) {
+            pthread_join(renderer->threads[i], NULL);
+        }
+        pthread_cond_destroy(&renderer->workFinished);
+        pthread_cond_destroy(&renderer->workAvailable);
+        pthread_mutex_destroy(&renderer->mutex);
+        free(renderer->threads);
+    }
+#endif
+    free(renderer->commands);
+    free(renderer->tileCommandOffsets);
+    free(renderer->tileCommands);
+    free(renderer);
+}
+
+void Clay_Software_SetGlyphFunction(Clay_SoftwareRenderer *renderer, Clay_SoftwareGlyphFunction glyphFunction, void *userData) {
+    renderer->glyphFunction = glyphFunction;
+    renderer->glyphUserData = userData;
+}
+
+void Clay_Software_Render(Clay_SoftwareRenderer *renderer, Clay_SoftwareFramebuffer framebuffer, Clay_RenderCommandArray renderCommands, Clay_Color clearColor) {
+    if (!renderer || !framebuffer.pixels || framebuffer.width <= 0 || framebuffer.height <= 0) return;
+    renderer->framebuffer = framebuffer;
+    renderer->clearPixel = (uint32_t)Clay__SoftwareColorChannel(clearColor.r) | ((uint32_t)Clay__SoftwareColorChannel(clearColor.g) << 8) | ((uint32_t)Clay__SoftwareColorChannel(clearColor.b) << 16) | ((uint32_t)Clay__SoftwareColorChannel(clearColor.a) << 24);
+    if (!Clay__SoftwarePrepareFrame(renderer, renderCommands)) return;
+    int32_t tileCount = renderer->tilesX * renderer->tilesY;
+#ifndef CLAY_SOFTWARE_NO_THREADS
+    if (renderer->threadCount > 1) {
+        pthread_mutex_lock(&renderer->mutex);
+        renderer->nextTile = 0;
+        renderer->busyWorkers = renderer->threadCount - 1;
+        renderer->jobGeneration++;
+        pthread_cond_broadcast(&renderer->workAvailable);
+        pthread_mutex_unlock(&renderer->mutex);
+
+        for (int32_t tile = Clay__SoftwareTakeTile(renderer); tile >= 0; tile = Clay__SoftwareTakeTile(renderer)) {
+            Clay__SoftwareRenderTile(renderer, tile);
+        }
+
+        pthread_mutex_lock(&renderer->mutex);
+        while (renderer->busyWorkers > 0) {
+            pthread_cond_wait(&renderer->workFinished, &renderer->mutex);
+        }
+        pthread_mutex_unlock(&renderer->mutex);
+        return;
+    }
+#endif
+    for (int32_t tile = 0; tile < tileCount; ++tile) {
+        Clay__SoftwareRenderTile(renderer, tile);
+    }
+}
+
+Clay_Dimensions Clay_Software_MeasureText(Clay_StringSlice text, Clay_TextElementConfig *config, void *userData) {
+    Clay_SoftwareRenderer *renderer = (Clay_SoftwareRenderer *)userData;
+    Clay_Dimensions dimensions = { 0, (float)config->fontSize };
+    if (!renderer || !renderer->glyphFunction) return dimensions;
+    int32_t index = 0;
+    int32_t glyphCount = 0;
+    while (index < text.length) {
+        uint32_t codepoint = Clay__SoftwareDecodeUtf8(text.chars, text.length, &index);
+        Clay_SoftwareGlyph glyph = { 0 };
+        if (renderer->glyphFunction(codepoint, config->fontId, config->fontSize, &glyph, renderer->glyphUserData)) {
+            dimensions.width += glyph.advance;
+            glyphCount++;
+        }
+    }
+    if (glyphCount > 1) {
+        dimensions.width += (float)(config->letterSpacing * (glyphCount - 1));
+    }
+    return dimensions;
+}
+
+#endif // CLAY_RENDERER_SOFTWARE_IMPLEMENTATION
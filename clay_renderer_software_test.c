@@ -0,0 +1,149 @@
+/*
+    Golden pixel test for clay_renderer_software.h.
+
+    cc -std=c99 -O2 -pthread -o clay_renderer_software_test clay_renderer_software_test.c -lm && ./clay_renderer_software_test
+
+    Lays out a small scene with rounded rectangles, borders, a translucent fill, nested clipping, text and an image,
+    renders it on one thread and on a pool of threads, and checks that both framebuffers are identical and that
+    chosen pixels have their known values. The framebuffer size isn't a multiple of the tile size, and its stride is
+    wider than its width, so partial tiles and row padding are covered too.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CLAY_IMPLEMENTATION
+#include "clay.h"
+#define CLAY_RENDERER_SOFTWARE_IMPLEMENTATION
+#include "clay_renderer_software.h"
+
+#define TEST_WIDTH 301
+#define TEST_HEIGHT 203
+#define TEST_STRIDE 320
+#define TEST_THREADS 4
+// Written to the row padding beforehand, which the renderer must leave alone
+#define TEST_PADDING_PIXEL 0xDEADBEEFu
+
+// Pixels are written as (a << 24) | (b << 16) | (g << 8) | r
+#define TEST_PIXEL(r, g, b, a) ((uint32_t)(r) | ((uint32_t)(g) << 8) | ((uint32_t)(b) << 16) | ((uint32_t)(a) << 24))
+#define TEST_BACKGROUND TEST_PIXEL(40, 40, 40, 255)
+
+typedef struct {
+    int32_t x, y;
+    uint32_t pixel;
+    const char *what;
+} TestProbe;
+
+static const TestProbe testProbes[] = {
+    { 60, 60, TEST_PIXEL(255, 0, 0, 255), "rounded rectangle interior" },
+    { 60, 10, TEST_PIXEL(255, 0, 0, 255), "rounded rectangle top edge" },
+    { 10, 10, TEST_BACKGROUND, "outside the rounded corner" },
+    { 15, 16, TEST_PIXEL(188, 12, 12, 255), "anti-aliased rounded corner" },
+    { 200, 5, TEST_BACKGROUND, "root padding" },
+    { 170, 60, TEST_PIXEL(20, 148, 20, 255), "half transparent fill over the background" },
+    { 121, 60, TEST_PIXEL(0, 0, 255, 255), "left border" },
+    { 123, 60, TEST_PIXEL(0, 0, 255, 255), "inner edge of the left border" },
+    { 124, 60, TEST_PIXEL(20, 148, 20, 255), "just inside the left border" },
+    { 170, 108, TEST_PIXEL(0, 0, 255, 255), "bottom border" },
+    { 260, 40, TEST_PIXEL(255, 255, 0, 255), "clipped child inside its clip" },
+    { 260, 80, TEST_BACKGROUND, "clipped child below its clip" },
+    { 295, 40, TEST_BACKGROUND, "clipped child right of its clip" },
+    { 12, 125, TEST_PIXEL(255, 255, 255, 255), "solid glyph coverage" },
+    { 12, 129, TEST_PIXEL(148, 148, 148, 255), "half glyph coverage" },
+    { 28, 125, TEST_BACKGROUND, "space between glyphs" },
+    { 36, 125, TEST_PIXEL(255, 255, 255, 255), "glyph after the space" },
+    { 62, 130, TEST_PIXEL(255, 0, 0, 255), "image top left texel" },
+    { 82, 130, TEST_PIXEL(0, 255, 0, 255), "image top right texel" },
+    { 62, 150, TEST_PIXEL(0, 0, 255, 255), "image bottom left texel" },
+    { 82, 150, TEST_PIXEL(255, 255, 255, 255), "image bottom right texel" },
+    { 300, 202, TEST_BACKGROUND, "last pixel, in a partial tile" },
+};
+
+// Every glyph is a 6 by 10 box, solid apart from its bottom two rows which are half covered. Spaces have no bitmap.
+static uint8_t testGlyphCoverage[6 * 10];
+
+static bool TestGlyph(uint32_t codepoint, uint16_t fontId, uint16_t fontSize, Clay_SoftwareGlyph *glyph, void *userData) {
+    (void)fontId; (void)fontSize; (void)userData;
+    *glyph = (Clay_SoftwareGlyph) { codepoint == ' ' ? NULL : testGlyphCoverage, 6, 6, 10, 0, 0, 8 };
+    return true;
+}
+
+static const uint32_t testImagePixels[] = {
+    TEST_PIXEL(255, 0, 0, 255), TEST_PIXEL(0, 255, 0, 255),
+    TEST_PIXEL(0, 0, 255, 255), TEST_PIXEL(255, 255, 255, 255),
+};
+static Clay_SoftwareImage testImage = { testImagePixels, 2, 2, 2 };
+
+static Clay_RenderCommandArray TestLayout(void) {
+    Clay_BeginLayout();
+    CLAY({ .layout = { .sizing = { CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0) }, .padding = CLAY_PADDING_ALL(10), .childGap = 10, .layoutDirection = CLAY_TOP_TO_BOTTOM }, .backgroundColor = { 40, 40, 40, 255 } }) {
+        CLAY({ .layout = { .childGap = 10 } }) {
+            CLAY({ .layout = { .sizing = { CLAY_SIZING_FIXED(100), CLAY_SIZING_FIXED(100) } }, .backgroundColor = { 255, 0, 0, 255 }, .cornerRadius = CLAY_CORNER_RADIUS(20) }) {}
+            CLAY({ .layout = { .sizing = { CLAY_SIZING_FIXED(100), CLAY_SIZING_FIXED(100) } }, .backgroundColor = { 0, 255, 0, 128 }, .border = { .color = { 0, 0, 255, 255 }, .width = CLAY_BORDER_OUTSIDE(4) } }) {}
+            CLAY({ .layout = { .sizing = { CLAY_SIZING_FIXED(60), CLAY_SIZING_FIXED(60) } }, .clip = { .horizontal = true, .vertical = true } }) {
+                CLAY({ .layout = { .sizing = { CLAY_SIZING_FIXED(200), CLAY_SIZING_FIXED(200) } }, .backgroundColor = { 255, 255, 0, 255 } }) {}
+            }
+        }
+        CLAY({ .layout = { .childGap = 10 } }) {
+            CLAY_TEXT(CLAY_STRING("ab c"), CLAY_TEXT_CONFIG({ .fontSize = 10, .textColor = { 255, 255, 255, 255 } }));
+            CLAY({ .layout = { .sizing = { CLAY_SIZING_FIXED(40), CLAY_SIZING_FIXED(40) } }, .image = { .imageData = &testImage } }) {}
+        }
+    }
+    return Clay_EndLayout();
+}
+
+static uint32_t *TestRender(int32_t threadCount, Clay_RenderCommandArray renderCommands) {
+    uint32_t *pixels = malloc(sizeof(uint32_t) * TEST_STRIDE * TEST_HEIGHT);
+    for (int32_t i = 0; i < TEST_STRIDE * TEST_HEIGHT; ++i) pixels[i] = TEST_PADDING_PIXEL;
+    Clay_SoftwareRenderer *renderer = Clay_Software_CreateRenderer(threadCount);
+    Clay_Software_SetGlyphFunction(renderer, TestGlyph, NULL);
+    Clay_Software_Render(renderer, (Clay_SoftwareFramebuffer) { pixels, TEST_WIDTH, TEST_HEIGHT, TEST_STRIDE }, renderCommands, (Clay_Color) { 0, 0, 0, 255 });
+    Clay_Software_DestroyRenderer(renderer);
+    return pixels;
+}
+
+int main(void) {
+    memset(testGlyphCoverage, 255, 6 * 8);
+    memset(testGlyphCoverage + 6 * 8, 128, 6 * 2);
+
+    uint32_t memorySize = Clay_MinMemorySize();
+    void *memory = malloc(memorySize);
+    Clay_Initialize(Clay_CreateArenaWithCapacityAndMemory(memorySize, memory), (Clay_Dimensions) { TEST_WIDTH, TEST_HEIGHT }, (Clay_ErrorHandler) {0});
+    // Measuring uses the glyph function only, so any renderer with it set will do
+    Clay_SoftwareRenderer *measureRenderer = Clay_Software_CreateRenderer(1);
+    Clay_Software_SetGlyphFunction(measureRenderer, TestGlyph, NULL);
+    Clay_SetMeasureTextFunction(Clay_Software_MeasureText, measureRenderer);
+    Clay_RenderCommandArray renderCommands = TestLayout();
+
+    uint32_t *single = TestRender(1, renderCommands);
+    uint32_t *threaded = TestRender(TEST_THREADS, renderCommands);
+    int failures = 0;
+
+    for (int32_t y = 0; y < TEST_HEIGHT; ++y) {
+        for (int32_t x = 0; x < TEST_STRIDE; ++x) {
+            uint32_t expected = single[y * TEST_STRIDE + x], actual = threaded[y * TEST_STRIDE + x];
+            if (actual != expected && failures++ < 10) {
+                printf("FAIL %d threads: pixel %d,%d is %08x, one thread drew %08x\n", TEST_THREADS, x, y, actual, expected);
+            }
+            if (x >= TEST_WIDTH && expected != TEST_PADDING_PIXEL && failures++ < 10) {
+                printf("FAIL row padding at %d,%d was overwritten with %08x\n", x, y, expected);
+            }
+        }
+    }
+    for (size_t i = 0; i < sizeof(testProbes) / sizeof(testProbes[0]); ++i) {
+        const TestProbe *probe = &testProbes[i];
+        uint32_t actual = single[probe->y * TEST_STRIDE + probe->x];
+        if (actual != probe->pixel) {
+            printf("FAIL %s: pixel %d,%d is %08x, expected %08x\n", probe->what, probe->x, probe->y, actual, probe->pixel);
+            failures++;
+        }
+    }
+
+    printf(failures ? "FAILED\n" : "OK\n");
+    free(single);
+    free(threaded);
+    Clay_Software_DestroyRenderer(measureRenderer);
+    free(memory);
+    return failures ? 1 : 0;
+}
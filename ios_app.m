@@ -3,6 +3,10 @@
 #include <UIKit/UIKit.h>
 #define CLAY_IMPLEMENTATION
 #include "./clay.h"
+#define CLAY_IMAGE_IMPLEMENTATION
+#include "./clay_image.h"
+#define CLAY_INPUT_IMPLEMENTATION
+#include "./clay_input.h"
 #include <stdint.h> // stdint's
 #include <stdbool.h> // bool
 #include <sys/mman.h> // for mmap
@@ -220,8 +224,9 @@ View_inserSubviewAbove(UIView *view, UIView *child, UIView *above)
 @property (strong, nonatomic) UIWindow *window;
 
 @property (strong, nonatomic) NSMutableDictionary *elementsCache;
-@property (strong, nonatomic) NSMutableDictionary *imageCache;
-@property TapState tapState;
+@property (nonatomic) Clay_ImageCache *imageCache;
+// The display link timestamp of the previous frame, zero before the first one
+@property (nonatomic) CFTimeInterval previousFrameTimestamp;
 
 @end
 
@@ -244,6 +249,7 @@ makeElementData(UIView *view)
   res[@"previousFrame"] = emptyData;
   res[@"previousConfig"] = emptyData;
   res[@"previousText"] = emptyString;
+  res[@"previousTextIdentity"] = emptyData;
   
   return res;
 }
@@ -257,6 +263,210 @@ getContentView(UIView *view)
   return view;
 }
 
+void
+IOS_paintRectangle(NSMutableDictionary *elementData, Clay_RectangleRenderData *config)
+{
+  UIView *element = elementData[@"view"];
+  NSData *previousConfig = elementData[@"previousConfig"];
+  if (isMemoryEqual((void *)previousConfig.bytes, previousConfig.length, (void *)config, sizeof(Clay_RectangleRenderData))) {
+    return;
+  }
+
+  UIView_setBorderRadius(element, config->cornerRadius);
+  elementData[@"previousConfig"] = [NSData dataWithBytes:(const void *)config length:sizeof(Clay_RectangleRenderData)];
+  Clay_Color bgColor = config->backgroundColor;
+  element.backgroundColor = Clay_colorToUIColor(bgColor);
+}
+
+typedef struct IOS_TextIdentity IOS_TextIdentity;
+struct IOS_TextIdentity {
+  u32 version;
+  u32 offset;
+  u32 length;
+};
+
+void
+IOS_paintText(NSMutableDictionary *elementData, Clay_TextRenderData *config)
+{
+  Clay_StringSlice string = config->stringContents;
+  NSData *previousConfig = elementData[@"previousConfig"];
+
+  if (isMemoryEqual((void *)previousConfig.bytes, previousConfig.length, (void *)config, sizeof(Clay_TextRenderData))) {
+    return;
+  }
+  elementData[@"previousConfig"] = [NSData dataWithBytes:(const void *)config length:sizeof(Clay_TextRenderData)];
+
+  UILabel *textElement = (UILabel *)elementData[@"view"];
+  textElement.textColor = Clay_colorToUIColor(config->textColor);
+  // Stored text is versioned by Clay, so a line is unchanged if its version and position in the text are
+  IOS_TextIdentity identity = { config->stringVersion, (u32)(string.chars - string.baseChars), (u32)string.length };
+  NSData *previousIdentity = elementData[@"previousTextIdentity"];
+  NSString *previousText = elementData[@"previousText"];
+  bool changed;
+  if (identity.version != 0) {
+    changed = !isMemoryEqual((void *)previousIdentity.bytes, previousIdentity.length, (void *)&identity, sizeof(IOS_TextIdentity));
+  } else {
+    changed = (u64)string.length != (u64)previousText.length || !isMemoryEqual((void *)[previousText cStringUsingEncoding:NSUTF8StringEncoding], previousText.length, (void *)string.chars, string.length);
+  }
+  if (changed) {
+    textElement.text = [[NSString alloc] initWithBytes:(void *)string.chars 
+                                                length:string.length 
+                                              encoding:NSUTF8StringEncoding];
+    elementData[@"previousText"] = textElement.text;
+    elementData[@"previousTextIdentity"] = [NSData dataWithBytes:(const void *)&identity length:sizeof(IOS_TextIdentity)];
+  }
+}
+
+// Image keys are paths relative to the app bundle
+bool
+IOS_LoadImageBytes(Clay_String key, Clay_ImageBytes *bytes, void *userData)
+{
+  (void)userData;
+  @autoreleasepool {
+    NSString *path = [[[NSBundle mainBundle] resourcePath] stringByAppendingPathComponent:[NSString stringWithFormat:@"%.*s", (int)key.length, key.chars]];
+    NSData *data = [NSData dataWithContentsOfFile:path];
+    if (!data) {
+      return false;
+    }
+    bytes->data = (const uint8_t *)data.bytes;
+    bytes->length = data.length;
+    bytes->handle = (void *)CFBridgingRetain(data);
+  }
+  return true;
+}
+
+void
+IOS_ReleaseImageBytes(Clay_ImageBytes bytes, void *userData)
+{
+  (void)userData;
+  CFRelease((CFTypeRef)bytes.handle);
+}
+
+// Decodes the formats clay_image.h doesn't, like PNG and JPEG, straight to the size the image is displayed at
+bool
+IOS_DecodeImage(Clay_ImageBytes bytes, i32 targetWidth, i32 targetHeight, Clay_ImageDecodedPixels *result, void *userData)
+{
+  (void)userData;
+  @autoreleasepool {
+    NSData *data = [NSData dataWithBytesNoCopy:(void *)bytes.data length:bytes.length freeWhenDone:NO];
+    UIImage *image = [UIImage imageWithData:data];
+    if (!image || !image.CGImage) {
+      return false;
+    }
+    i32 sourceWidth = (i32)CGImageGetWidth(image.CGImage);
+    i32 sourceHeight = (i32)CGImageGetHeight(image.CGImage);
+    i32 width, height;
+    Clay_Image_GetDecodeSize(sourceWidth, sourceHeight, targetWidth, targetHeight, &width, &height);
+    u8 *pixels = malloc((size_t)width * (size_t)height * 4);
+    if (!pixels) {
+      return false;
+    }
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef context = CGBitmapContextCreate(pixels, width, height, 8, (size_t)width * 4, colorSpace, kCGImageAlphaPremultipliedLast | kCGBitmapByteOrder32Big);
+    CGColorSpaceRelease(colorSpace);
+    if (!context) {
+      free(pixels);
+      return false;
+    }
+    CGContextSetInterpolationQuality(context, kCGInterpolationHigh);
+    CGContextDrawImage(context, CGRectMake(0, 0, width, height), image.CGImage);
+    CGContextRelease(context);
+    *result = (Clay_ImageDecodedPixels) { pixels, width, height, sourceWidth, sourceHeight };
+  }
+  return true;
+}
+
+void
+IOS_ReleaseImageRendererData(Clay_Image *image, void *userData)
+{
+  (void)userData;
+  CFRelease((CFTypeRef)image->rendererData);
+}
+
+void
+IOS_paintImage(NSMutableDictionary *elementData, Clay_ImageRenderData *config)
+{
+  UIImageView *imageView = (UIImageView *)elementData[@"view"];
+  Clay_Image *image = (Clay_Image *)config->imageData;
+  // Versions are zero until an image is ready, which shows the background color as a placeholder
+  u32 version = image && image->state == CLAY_IMAGE_STATE_READY ? image->version : 0;
+  UIView_setBorderRadius(imageView, config->cornerRadius);
+  imageView.backgroundColor = Clay_colorToUIColor(config->backgroundColor);
+  imageView.contentMode = UIViewContentModeScaleAspectFill;
+  imageView.clipsToBounds = true;
+  // Only the image is expensive to set, so skip it alone while the pixels haven't changed
+  NSNumber *previousVersion = elementData[@"previousImageVersion"];
+  if (previousVersion && previousVersion.unsignedIntValue == version) {
+    return;
+  }
+  elementData[@"previousImageVersion"] = @(version);
+  if (version == 0) {
+    imageView.image = nil;
+    return;
+  }
+  if (!image->rendererData) {
+    CFDataRef data = CFDataCreate(NULL, image->pixels, (CFIndex)image->width * image->height * 4);
+    CGDataProviderRef provider = CGDataProviderCreateWithCFData(data);
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGImageRef cgImage = CGImageCreate(image->width, image->height, 8, 32, (size_t)image->width * 4, colorSpace, kCGImageAlphaPremultipliedLast | kCGBitmapByteOrder32Big, provider, NULL, false, kCGRenderingIntentDefault);
+    image->rendererData = (void *)CFBridgingRetain([UIImage imageWithCGImage:cgImage]);
+    CGImageRelease(cgImage);
+    CGColorSpaceRelease(colorSpace);
+    CGDataProviderRelease(provider);
+    CFRelease(data);
+  }
+  imageView.image = (__bridge UIImage *)image->rendererData;
+}
+
+// Layout didn't change since the previous frame, so the view hierarchy and frames are already correct
+// and only the views of the updated render commands need repainting.
+void
+IOS_RenderPaintUpdates(Clay_RenderCommandArray renderCommands, Clay_RenderCommandUpdates updates, AppDelegate *delegate)
+{
+  for (i32 i = 0; i < updates.length; i++) {
+    Clay_RenderCommand *renderCommand = Clay_RenderCommandArray_Get(&renderCommands, updates.indexes[i]);
+    NSString *key                     = [NSString stringWithFormat:@"%u", renderCommand->id];
+    NSMutableDictionary *elementData  = delegate.elementsCache[key];
+    if (!elementData) {
+      continue;
+    }
+
+    switch (renderCommand->commandType)
+    {
+      case CLAY_RENDER_COMMAND_TYPE_RECTANGLE: {
+        IOS_paintRectangle(elementData, &renderCommand->renderData.rectangle);
+        break;
+      }
+      case CLAY_RENDER_COMMAND_TYPE_TEXT: {
+        IOS_paintText(elementData, &renderCommand->renderData.text);
+        break;
+      }
+      case CLAY_RENDER_COMMAND_TYPE_IMAGE: {
+        IOS_paintImage(elementData, &renderCommand->renderData.image);
+        break;
+      }
+      default:
+        break;
+    }
+  }
+}
+
+// Images that finished decoding don't change their render commands, so image views are checked for new versions separately
+void
+IOS_RenderImages(Clay_RenderCommandArray renderCommands, AppDelegate *delegate)
+{
+  for (i32 i = 0; i < renderCommands.length; i++) {
+    Clay_RenderCommand *renderCommand = Clay_RenderCommandArray_Get(&renderCommands, i);
+    if (renderCommand->commandType != CLAY_RENDER_COMMAND_TYPE_IMAGE) {
+      continue;
+    }
+    NSMutableDictionary *elementData = delegate.elementsCache[[NSString stringWithFormat:@"%u", renderCommand->id]];
+    if (elementData) {
+      IOS_paintImage(elementData, &renderCommand->renderData.image);
+    }
+  }
+}
+
 void
 IOS_Render(Clay_RenderCommandArray renderCommands,  AppDelegate *delegate) 
 {
@@ -351,16 +561,7 @@ IOS_Render(Clay_RenderCommandArray renderCommands,  AppDelegate *delegate)
     switch (renderCommand->commandType) 
     { 
       case CLAY_RENDER_COMMAND_TYPE_RECTANGLE: {
-        Clay_RectangleRenderData *config = &renderCommand->renderData.rectangle; 
-        NSData *previousConfig = elementData[@"previousConfig"];
-        if (isMemoryEqual((void *)previousConfig.bytes, previousConfig.length, (void *)config, sizeof(Clay_RectangleRenderData))) {
-          break; 
-        }
-
-        UIView_setBorderRadius(element, config->cornerRadius);
-        elementData[@"previousConfig"] = [NSData dataWithBytes:(const void *)config length:sizeof(Clay_RectangleRenderData)];
-        Clay_Color bgColor = config->backgroundColor;
-        element.backgroundColor = Clay_colorToUIColor(bgColor);
+        IOS_paintRectangle(elementData, &renderCommand->renderData.rectangle);
         break;
       }
       case CLAY_RENDER_COMMAND_TYPE_SCISSOR_START: { 
@@ -388,30 +589,11 @@ IOS_Render(Clay_RenderCommandArray renderCommands,  AppDelegate *delegate)
         break;
       }
       case CLAY_RENDER_COMMAND_TYPE_TEXT: {
-        
-        Clay_TextRenderData *config = &renderCommand->renderData.text; 
-        Clay_StringSlice string = config->stringContents;
-        NSData *previousConfig = elementData[@"previousConfig"];
-
-        if (isMemoryEqual((void *)previousConfig.bytes, previousConfig.length, (void *)config, sizeof(Clay_TextRenderData))) {
-          break; 
-        }
-        elementData[@"previousConfig"] = [NSData dataWithBytes:(const void *)config length:sizeof(Clay_TextRenderData)];
-
-        UILabel *textElement = (UILabel *)element;
-        textElement.textColor = Clay_colorToUIColor(config->textColor);
-        NSString *previousText = elementData[@"previousText"];
-        textElement.text = [[NSString alloc] initWithBytes:(void *)string.chars 
-                                                      length:string.length 
-                                                    encoding:NSUTF8StringEncoding];
-        if ((u64)string.length != (u64)previousText.length || !isMemoryEqual((void *)[previousText cStringUsingEncoding:NSUTF8StringEncoding], previousText.length, (void *)string.chars, string.length)) {
-          textElement.text = [[NSString alloc] initWithBytes:(void *)string.chars 
-                                                      length:string.length 
-                                                    encoding:NSUTF8StringEncoding];
-          elementData[@"previousText"] = textElement.text;
-
-        }
-
+        IOS_paintText(elementData, &renderCommand->renderData.text);
+        break;
+      }
+      case CLAY_RENDER_COMMAND_TYPE_IMAGE: {
+        IOS_paintImage(elementData, &renderCommand->renderData.image);
         break;
       }
       default: {
@@ -445,41 +627,51 @@ void HandleClayErrors(Clay_ErrorData errorData) {
 @interface GestureRecognizer : UIGestureRecognizer
 @end
 
+// Every touch is forwarded to the input queue, which the layout drains on the next frame
+void
+IOS_pushTouch(UITouch *touch, Clay_PointerEventType type)
+{
+  CGPoint point = [touch locationInView:touch.window];
+  uintptr_t touchId = (uintptr_t)touch;
+  Clay_Input_Push(&inputQueue, (Clay_PointerEvent) {
+    .type = type,
+    .pointerId = (u32)(touchId ^ (touchId >> 32)),
+    .position = { point.x, point.y },
+    .timestamp = touch.timestamp
+  });
+}
+
+void
+IOS_pushTouches(NSSet<UITouch *> *touches, Clay_PointerEventType type)
+{
+  for (UITouch *touch in touches) {
+    IOS_pushTouch(touch, type);
+    // Lifted touches stop hovering elements once the release has been seen
+    if (type == CLAY_POINTER_EVENT_UP) {
+      IOS_pushTouch(touch, CLAY_POINTER_EVENT_LEAVE);
+    }
+  }
+}
+
 @implementation GestureRecognizer 
 - (void) touchesBegan:(NSSet<UITouch *> *)touches withEvent:(UIEvent *)event
 {
-  if (touches.count == 1) {
-    UITouch *touch = touches.allObjects[0];
-    CGPoint point = [touch locationInView:touch.window];
-    tapState.point.x = point.x;
-    tapState.point.y = point.y;
-    tapState.isPressed = 3;
-  }
+  IOS_pushTouches(touches, CLAY_POINTER_EVENT_DOWN);
 }
 
 - (void) touchesMoved:(NSSet<UITouch *> *)touches withEvent:(UIEvent *)event
 {
-  if (touches.count == 1) {
-    UITouch *touch = touches.allObjects[0];
-    CGPoint point = [touch locationInView:touch.window];
-    tapState.point.x = point.x;
-    tapState.point.y = point.y;
-    tapState.isPressed = 3;
-  }
+  IOS_pushTouches(touches, CLAY_POINTER_EVENT_MOVE);
 }
 
 - (void) touchesEnded:(NSSet<UITouch *> *)touches withEvent:(UIEvent *)event
 {
-  if (touches.count == 1) { 
-    tapState.isPressed = 2;
-  }
+  IOS_pushTouches(touches, CLAY_POINTER_EVENT_UP);
 }
 
 - (void) touchesCancelled:(NSSet<UITouch *> *)touches withEvent:(UIEvent *)event
 {
-  if (touches.count == 1) {
-    tapState.isPressed = 2; 
-  }
+  IOS_pushTouches(touches, CLAY_POINTER_EVENT_CANCEL);
 }
 
 @end
@@ -512,6 +704,12 @@ void HandleClayErrors(Clay_ErrorData errorData) {
         .height = self.window.frame.size.height
     }, (Clay_ErrorHandler) { HandleClayErrors, nil });
     Clay_SetMeasureTextFunction(IOS_MeasureText, nil);
+    self.imageCache = Clay_Image_CreateCache((Clay_ImageCacheConfig) {
+        .loadFunction = IOS_LoadImageBytes,
+        .releaseBytesFunction = IOS_ReleaseImageBytes,
+        .decodeFunction = IOS_DecodeImage,
+        .releaseRendererData = IOS_ReleaseImageRendererData,
+    });
 
     CADisplayLink *displayLink = [CADisplayLink displayLinkWithTarget:self selector:@selector(step:)];
     [displayLink addToRunLoop:[NSRunLoop currentRunLoop]
@@ -519,6 +717,7 @@ void HandleClayErrors(Clay_ErrorData errorData) {
 
     GestureRecognizer *gestureRecognizer = [[GestureRecognizer alloc] init];
     [self.window addGestureRecognizer:gestureRecognizer];
+    self.window.multipleTouchEnabled = YES;
 
     [self.window makeKeyAndVisible];
 
@@ -533,8 +732,21 @@ void HandleClayErrors(Clay_ErrorData errorData) {
       .height = view.frame.size.height
   });
 
+  // Advance by the time since the previous frame, which is longer than one frame's duration whenever frames are dropped
+  CFTimeInterval elapsed = self.previousFrameTimestamp > 0 ? sender.timestamp - self.previousFrameTimestamp : 0;
+  self.previousFrameTimestamp = sender.timestamp;
+  Clay_UpdateTransitions(elapsed);
+  bool imagesChanged = Clay_Image_Update(self.imageCache);
   Clay_RenderCommandArray commands = IOS_layout();
-  IOS_Render(commands, self);
+  Clay_RenderCommandUpdates updates = Clay_GetRenderCommandUpdates();
+  if (updates.layoutChanged) {
+    IOS_Render(commands, self);
+  } else {
+    IOS_RenderPaintUpdates(commands, updates, self);
+    if (imagesChanged) {
+      IOS_RenderImages(commands, self);
+    }
+  }
 }
 
 @end
@@ -0,0 +1,29 @@
+// Dense array element reads and writes, a[i] with a number i.
+
+var N = 300000;
+var R = 10;
+
+bench("array write a[i]", function () {
+	var a = [], i, r;
+	for (r = 0; r < R; ++r)
+		for (i = 0; i < N; ++i)
+			a[i] = i;
+});
+
+bench("array read a[i]", function () {
+	var a = [], i, r, sum = 0;
+	for (i = 0; i < N; ++i)
+		a.push(i);
+	for (r = 0; r < R; ++r)
+		for (i = 0; i < N; ++i)
+			sum += a[i];
+});
+
+bench("array read-modify-write a[i]", function () {
+	var a = [], i, r;
+	for (i = 0; i < N; ++i)
+		a.push(0);
+	for (r = 0; r < R; ++r)
+		for (i = 0; i < N; ++i)
+			a[i] = a[i] + 1;
+});
@@ -0,0 +1,137 @@
+/*
+ * Micro-benchmark host: runs each script given on the command line.
+ *
+ * Scripts call bench(name, fn), which runs fn once and prints the
+ * processor time it took. Buffer(n) makes a userdata holding n numbers,
+ * read and written through both the named and the indexed callbacks.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mujs.h"
+
+#define TAG "Buffer"
+
+struct buffer {
+	int n;
+	double *v;
+};
+
+static int parseindex(const char *name, int n)
+{
+	char *end;
+	long k = strtol(name, &end, 10);
+	if (*name < '0' || *name > '9' || *end || k >= n)
+		return -1;
+	return (int)k;
+}
+
+static int Bindex(js_State *J, void *data, int op, int k)
+{
+	struct buffer *buf = data;
+	if (k >= buf->n)
+		return 0;
+	switch (op) {
+	case JS_INDEX_HAS:
+		js_pushnumber(J, buf->v[k]);
+		return 1;
+	case JS_INDEX_PUT:
+		buf->v[k] = js_tonumber(J, -1);
+		return 1;
+	}
+	return 0;
+}
+
+static int Bhas(js_State *J, void *data, const char *name)
+{
+	struct buffer *buf = data;
+	int k = parseindex(name, buf->n);
+	if (k >= 0) {
+		js_pushnumber(J, buf->v[k]);
+		return 1;
+	}
+	if (!strcmp(name, "length")) {
+		js_pushnumber(J, buf->n);
+		return 1;
+	}
+	return 0;
+}
+
+static int Bput(js_State *J, void *data, const char *name)
+{
+	struct buffer *buf = data;
+	int k = parseindex(name, buf->n);
+	if (k >= 0) {
+		buf->v[k] = js_tonumber(J, -1);
+		return 1;
+	}
+	return 0;
+}
+
+static void Bfinalize(js_State *J, void *data)
+{
+	struct buffer *buf = data;
+	free(buf->v);
+	free(buf);
+}
+
+static void jsB_Buffer(js_State *J)
+{
+	int n = js_tointeger(J, 1);
+	struct buffer *buf = malloc(sizeof *buf);
+	if (!buf)
+		js_error(J, "out of memory");
+	buf->n = n > 0 ? n : 0;
+	buf->v = calloc(buf->n ? buf->n : 1, sizeof *buf->v);
+	if (!buf->v) {
+		free(buf);
+		js_error(J, "out of memory");
+	}
+	js_getregistry(J, TAG);
+	js_newuserdatax(J, TAG, buf, Bhas, Bput, NULL, Bfinalize);
+	js_setuserdataindex(J, -1, Bindex);
+}
+
+static void jsB_bench(js_State *J)
+{
+	const char *name = js_tostring(J, 1);
+	clock_t start;
+
+	start = clock();
+	js_copy(J, 2);
+	js_pushundefined(J);
+	js_call(J, 0);
+	js_pop(J, 1);
+	printf("%-32s %6.3fs\n", name, (double)(clock() - start) / CLOCKS_PER_SEC);
+	js_pushundefined(J);
+}
+
+int main(int argc, char **argv)
+{
+	js_State *J;
+	int i, status = 0;
+
+	J = js_newstate(NULL, NULL, 0);
+	if (!J) {
+		fprintf(stderr, "cannot create state\n");
+		return 1;
+	}
+
+	js_newobject(J);
+	js_setregistry(J, TAG);
+
+	js_newcfunction(J, jsB_Buffer, "Buffer", 1);
+	js_setglobal(J, "Buffer");
+	js_newcfunction(J, jsB_bench, "bench", 2);
+	js_setglobal(J, "bench");
+
+	for (i = 1; i < argc; ++i)
+		if (js_dofile(J, argv[i]))
+			status = 1;
+
+	js_freestate(J);
+	return status;
+}
@@ -0,0 +1,18 @@
+// Character reads by index, s[i] with a number i.
+
+var N = 1000000;
+var text = "the quick brown fox jumps over the lazy dog";
+
+bench("string s[i]", function () {
+	var s = text, i, n = 0;
+	for (i = 0; i < N; ++i)
+		if (s[i % 43] === "o")
+			++n;
+});
+
+bench("String object s[i]", function () {
+	var s = new String(text), i, n = 0;
+	for (i = 0; i < N; ++i)
+		if (s[i % 43] === "o")
+			++n;
+});
@@ -0,0 +1,18 @@
+// Userdata element reads and writes, b[i] with a number i.
+
+var N = 300000;
+var R = 10;
+
+bench("userdata write b[i]", function () {
+	var b = Buffer(N), i, r;
+	for (r = 0; r < R; ++r)
+		for (i = 0; i < N; ++i)
+			b[i] = i;
+});
+
+bench("userdata read b[i]", function () {
+	var b = Buffer(N), i, r, sum = 0;
+	for (r = 0; r < R; ++r)
+		for (i = 0; i < N; ++i)
+			sum += b[i];
+});
@@ -17,28 +17,16 @@ void js_setlength(js_State *J, int idx, int len)
 	js_setproperty(J, idx < 0 ? idx - 1 : idx, "length");
 }
 
-int js_hasindex(js_State *J, int idx, int i)
+/* The array at idx, if all of its elements are stored densely */
+static js_Object *densearray(js_State *J, int idx, int len)
 {
-	char buf[32];
-	return js_hasproperty(J, idx, js_itoa(buf, i));
-}
-
-void js_getindex(js_State *J, int idx, int i)
-{
-	char buf[32];
-	js_getproperty(J, idx, js_itoa(buf, i));
-}
-
-void js_setindex(js_State *J, int idx, int i)
-{
-	char buf[32];
-	js_setproperty(J, idx, js_itoa(buf, i));
-}
-
-void js_delindex(js_State *J, int idx, int i)
-{
-	char buf[32];
-	js_delproperty(J, idx, js_itoa(buf, i));
+	js_Object *obj;
+	if (!js_isarray(J, idx))
+		return NULL;
+	obj = js_toobject(J, idx);
+	if (obj->u.a.simple && obj->u.a.flat_length == len && obj->extensible)
+		return obj;
+	return NULL;
 }
 
 static void jsB_new_Array(js_State *J)
@@ -87,21 +75,12 @@ static void Ap_concat(js_State *J)
 
 static void Ap_join(js_State *J)
 {
-	char * volatile out = NULL;
+	js_Buffer *sb = NULL;
 	const char *sep;
-	const char *r;
-	int seplen;
-	int k, n, len;
+	int k, len;
 
 	len = js_getlength(J, 0);
-
-	if (js_isdefined(J, 1)) {
-		sep = js_tostring(J, 1);
-		seplen = strlen(sep);
-	} else {
-		sep = ",";
-		seplen = 1;
-	}
+	sep = js_isdefined(J, 1) ? js_tostring(J, 1) : ",";
 
 	if (len == 0) {
 		js_pushliteral(J, "");
@@ -109,35 +88,23 @@ static void Ap_join(js_State *J)
 	}
 
 	if (js_try(J)) {
-		js_free(J, out);
+		js_free(J, sb);
 		js_throw(J);
 	}
 
-	n = 1;
 	for (k = 0; k < len; ++k) {
+		if (k > 0)
+			js_puts(J, &sb, sep);
 		js_getindex(J, 0, k);
-		if (js_isundefined(J, -1) || js_isnull(J, -1))
-			r = "";
-		else
-			r = js_tostring(J, -1);
-		n += strlen(r);
-
-		if (k == 0) {
-			out = js_malloc(J, n);
-			strcpy(out, r);
-		} else {
-			n += seplen;
-			out = js_realloc(J, out, n);
-			strcat(out, sep);
-			strcat(out, r);
-		}
-
+		if (!js_isundefined(J, -1) && !js_isnull(J, -1))
+			js_puts(J, &sb, js_tostring(J, -1));
 		js_pop(J, 1);
 	}
 
-	js_pushstring(J, out);
+	js_putc(J, &sb, 0);
+	js_pushstring(J, sb->s);
 	js_endtry(J);
-	js_free(J, out);
+	js_free(J, sb);
 }
 
 static void Ap_pop(js_State *J)
@@ -203,6 +170,7 @@ static void Ap_reverse(js_State *J)
 
 static void Ap_shift(js_State *J)
 {
+	js_Object *obj;
 	int k, len;
 
 	len = js_getlength(J, 0);
@@ -213,6 +181,14 @@ static void Ap_shift(js_State *J)
 		return;
 	}
 
+	obj = densearray(J, 0, len);
+	if (obj) {
+		js_pushvalue(J, obj->u.a.array[0]);
+		memmove(obj->u.a.array, obj->u.a.array + 1, (len - 1) * sizeof *obj->u.a.array);
+		obj->u.a.flat_length = obj->u.a.length = len - 1;
+		return;
+	}
+
 	js_getindex(J, 0, 0);
 
 	for (k = 1; k < len; ++k) {
@@ -248,68 +224,154 @@ static void Ap_slice(js_State *J)
 			js_setindex(J, -2, n);
 }
 
-static int compare(js_State *J, int x, int y, int *hasx, int *hasy, int hasfn)
+/*
+	Sort the defined values into a scratch array, which keeps them where the
+	garbage collector can see them while the comparator runs. The merge sort
+	is stable and moves indices into the scratch array, so each element is
+	read from and written back to the array being sorted only once. Without a
+	comparator, every value is converted to its string key once up front.
+*/
+
+struct sortstate
 {
-	const char *sx, *sy;
-	int c;
-
-	*hasx = js_hasindex(J, 0, x);
-	*hasy = js_hasindex(J, 0, y);
-
-	if (*hasx && *hasy) {
-		int unx = js_isundefined(J, -2);
-		int uny = js_isundefined(J, -1);
-		if (unx && uny) return 0;
-		if (unx) return 1;
-		if (uny) return -1;
-
-		if (hasfn) {
-			js_copy(J, 1); /* copy function */
-			js_pushundefined(J); /* set this object */
-			js_copy(J, -4); /* copy x */
-			js_copy(J, -4); /* copy y */
-			js_call(J, 2);
-			c = js_tonumber(J, -1);
-			js_pop(J, 1);
-			return c;
+	js_State *J;
+	js_Object *values; /* scratch array: values, then string keys */
+	const char **keys; /* or NULL if calling the comparator */
+	int *order, *tmp;
+};
+
+static int sortcompare(struct sortstate *S, int x, int y)
+{
+	js_State *J = S->J;
+	double c;
+
+	if (S->keys)
+		return strcmp(S->keys[x], S->keys[y]);
+
+	js_copy(J, 1); /* copy function */
+	js_pushundefined(J); /* set this object */
+	js_pushvalue(J, S->values->u.a.array[x]);
+	js_pushvalue(J, S->values->u.a.array[y]);
+	js_call(J, 2);
+	c = js_tonumber(J, -1);
+	js_pop(J, 1);
+	return c < 0 ? -1 : c > 0 ? 1 : 0;
+}
+
+static void sortrange(struct sortstate *S, int lo, int hi)
+{
+	int *a = S->order, *t = S->tmp;
+	int mid, i, j, k, x;
+
+	/* insertion sort short runs */
+	if (hi - lo <= 8) {
+		for (i = lo + 1; i < hi; ++i) {
+			x = a[i];
+			for (j = i; j > lo && sortcompare(S, a[j - 1], x) > 0; --j)
+				a[j] = a[j - 1];
+			a[j] = x;
+		}
+		return;
+	}
+
+	mid = lo + (hi - lo) / 2;
+	sortrange(S, lo, mid);
+	sortrange(S, mid, hi);
+
+	/* already in order */
+	if (sortcompare(S, a[mid - 1], a[mid]) <= 0)
+		return;
+
+	memcpy(t + lo, a + lo, (mid - lo) * sizeof *t);
+	i = lo; j = mid; k = lo;
+	while (i < mid && j < hi) {
+		if (sortcompare(S, a[j], t[i]) < 0)
+			a[k++] = a[j++];
+		else
+			a[k++] = t[i++];
+	}
+	while (i < mid)
+		a[k++] = t[i++];
+}
+
+/* Sort the n values in the scratch array and write them to the start of the array */
+static void sortvalues(js_State *J, int scratch, int n)
+{
+	struct sortstate S;
+	int i;
+
+	S.J = J;
+	S.values = js_toobject(J, scratch);
+	S.keys = NULL;
+	S.order = NULL;
+
+	if (js_try(J)) {
+		js_free(J, S.keys);
+		js_free(J, S.order);
+		js_throw(J);
+	}
+
+	if (!js_iscallable(J, 1)) {
+		for (i = 0; i < n; ++i) {
+			js_pushvalue(J, S.values->u.a.array[i]);
+			js_setindex(J, scratch, n + i);
 		}
+		S.keys = js_malloc(J, n * sizeof *S.keys);
+		for (i = 0; i < n; ++i)
+			S.keys[i] = jsV_tostring(J, &S.values->u.a.array[n + i]);
+	}
+
+	S.order = js_malloc(J, 2 * n * sizeof *S.order);
+	S.tmp = S.order + n;
+	for (i = 0; i < n; ++i)
+		S.order[i] = i;
+
+	sortrange(&S, 0, n);
 
-		sx = js_tostring(J, -2);
-		sy = js_tostring(J, -1);
-		return strcmp(sx, sy);
+	for (i = 0; i < n; ++i) {
+		js_pushvalue(J, S.values->u.a.array[S.order[i]]);
+		js_setindex(J, 0, i);
 	}
 
-	if (*hasx) return -1;
-	if (*hasy) return 1;
-	return 0;
+	js_endtry(J);
+	js_free(J, S.keys);
+	js_free(J, S.order);
 }
 
 static void Ap_sort(js_State *J)
 {
-	int len, i, k;
-	int hasx, hasy, hasfn;
+	int len, n, undefs, k, scratch;
 
 	len = js_getlength(J, 0);
+	if (len > JS_ARRAYLIMIT / 2)
+		js_rangeerror(J, "array is too large to sort");
+
+	scratch = js_gettop(J);
+	js_newarray(J);
 
-	hasfn = js_iscallable(J, 1);
-
-	for (i = 1; i < len; ++i) {
-		k = i;
-		while (k > 0 && compare(J, k - 1, k, &hasx, &hasy, hasfn) > 0) {
-			if (hasx && hasy) {
-				js_setindex(J, 0, k - 1);
-				js_setindex(J, 0, k);
-			} else if (hasx) {
-				js_delindex(J, 0, k - 1);
-				js_setindex(J, 0, k);
-			} else if (hasy) {
-				js_setindex(J, 0, k - 1);
-				js_delindex(J, 0, k);
+	/* collect the defined values, counting undefined values and holes */
+	n = undefs = 0;
+	for (k = 0; k < len; ++k) {
+		if (js_hasindex(J, 0, k)) {
+			if (js_isundefined(J, -1)) {
+				js_pop(J, 1);
+				++undefs;
+			} else {
+				js_setindex(J, scratch, n++);
 			}
-			--k;
 		}
 	}
 
+	/* sorted values, then undefined values, then holes */
+	if (n > 0)
+		sortvalues(J, scratch, n);
+	for (k = n; k < n + undefs; ++k) {
+		js_pushundefined(J);
+		js_setindex(J, 0, k);
+	}
+	for (; k < len; ++k)
+		js_delindex(J, 0, k);
+
 	js_copy(J, 0);
 }
 
@@ -317,6 +379,7 @@ static void Ap_splice(js_State *J)
 {
 	int top = js_gettop(J);
 	int len, start, del, add, k;
+	js_Object *obj;
 	double f;
 
 	js_newarray(J);
@@ -336,8 +399,22 @@ static void Ap_splice(js_State *J)
 			js_setindex(J, -2, k);
 	js_setlength(J, -1, del);
 
-	/* shift the tail to resize the hole left by deleted items */
 	add = top - 3;
+
+	obj = densearray(J, 0, len);
+	if (obj && len - del + add <= JS_ARRAYLIMIT) {
+		jsV_growarray(J, obj, len - del + add);
+		memmove(obj->u.a.array + start + add, obj->u.a.array + start + del,
+			(len - start - del) * sizeof *obj->u.a.array);
+		for (k = 0; k < add; ++k) {
+			obj->u.a.array[start + k] = *js_tovalue(J, 3 + k);
+			jsG_barrier(J, &obj->u.a.array[start + k]);
+		}
+		obj->u.a.flat_length = obj->u.a.length = len - del + add;
+		return;
+	}
+
+	/* shift the tail to resize the hole left by deleted items */
 	if (add < del) {
 		for (k = start; k < len - del; ++k) {
 			if (js_hasindex(J, 0, k + del))
@@ -369,9 +446,23 @@ static void Ap_unshift(js_State *J)
 {
 	int i, top = js_gettop(J);
 	int k, len;
+	js_Object *obj;
 
 	len = js_getlength(J, 0);
 
+	obj = densearray(J, 0, len);
+	if (obj && len + top - 1 <= JS_ARRAYLIMIT) {
+		jsV_growarray(J, obj, len + top - 1);
+		memmove(obj->u.a.array + top - 1, obj->u.a.array, len * sizeof *obj->u.a.array);
+		for (i = 1; i < top; ++i) {
+			obj->u.a.array[i - 1] = *js_tovalue(J, i);
+			jsG_barrier(J, &obj->u.a.array[i - 1]);
+		}
+		obj->u.a.flat_length = obj->u.a.length = len + top - 1;
+		js_pushnumber(J, len + top - 1);
+		return;
+	}
+
 	for (k = len; k > 0; --k) {
 		int from = k - 1;
 		int to = k + top - 2;
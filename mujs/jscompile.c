@@ -51,11 +51,11 @@ static void checkfutureword(JF, js_Ast *exp)
 	}
 }
 
-static js_Function *newfun(js_State *J, js_Ast *name, js_Ast *params, js_Ast *body, int script, int default_strict)
+static js_Function *newfun(js_State *J, js_Function *parent, js_Ast *name, js_Ast *params, js_Ast *body, int script, int default_strict)
 {
 	js_Function *F = js_malloc(J, sizeof *F);
 	memset(F, 0, sizeof *F);
-	F->gcmark = 0;
+	F->gcmark = JS_GCNEWMARK(J);
 	F->gcnext = J->gcfun;
 	J->gcfun = F;
 	++J->gccounter;
@@ -65,9 +65,20 @@ static js_Function *newfun(js_State *J, js_Ast *name, js_Ast *params, js_Ast *bo
 	F->script = script;
 	F->strict = default_strict;
 	F->name = name ? name->string : "";
+	F->parent = parent;
 
 	cfunbody(J, F, name, params, body);
 
+	if (F->cachelen) {
+		F->cachetab = js_malloc(J, F->cachelen * sizeof *F->cachetab);
+		memset(F->cachetab, 0, F->cachelen * sizeof *F->cachetab);
+	}
+
+	F->parent = NULL;
+	js_free(J, F->captab);
+	F->captab = NULL;
+	F->caplen = F->capcap = 0;
+
 	return F;
 }
 
@@ -136,6 +147,16 @@ static int addstring(JF, const char *value)
 	return F->strlen++;
 }
 
+static int addlocalname(JF, const char *name)
+{
+	if (F->varlen >= F->varcap) {
+		F->varcap = F->varcap ? F->varcap * 2 : 16;
+		F->vartab = js_realloc(J, F->vartab, F->varcap * sizeof *F->vartab);
+	}
+	F->vartab[F->varlen++] = name;
+	return F->varlen;
+}
+
 static void addlocal(JF, js_Ast *ident, int reuse)
 {
 	const char *name = ident->string;
@@ -156,11 +177,7 @@ static void addlocal(JF, js_Ast *ident, int reuse)
 			}
 		}
 	}
-	if (F->varlen >= F->varcap) {
-		F->varcap = F->varcap ? F->varcap * 2 : 16;
-		F->vartab = js_realloc(J, F->vartab, F->varcap * sizeof *F->vartab);
-	}
-	F->vartab[F->varlen++] = name;
+	addlocalname(J, F, name);
 }
 
 static int findlocal(JF, const char *name)
@@ -172,6 +189,42 @@ static int findlocal(JF, const char *name)
 	return -1;
 }
 
+static int addupvar(JF, const char *name, int reuse)
+{
+	int i;
+	if (reuse)
+		for (i = 0; i < F->uplen; ++i)
+			if (!strcmp(F->uptab[i], name))
+				return i;
+	if (F->uplen >= F->upcap) {
+		F->upcap = F->upcap ? F->upcap * 2 : 16;
+		F->uptab = js_realloc(J, F->uptab, F->upcap * sizeof *F->uptab);
+	}
+	F->uptab[F->uplen] = name;
+	return F->uplen++;
+}
+
+static int findupvar(JF, const char *name)
+{
+	int i;
+	for (i = F->uplen; i > 0; --i)
+		if (!strcmp(F->uptab[i-1], name))
+			return i - 1;
+	return -1;
+}
+
+static int comparename(const void *a, const void *b)
+{
+	return strcmp(*(const char **)a, *(const char **)b);
+}
+
+static int iscaptured(JF, const char *name)
+{
+	if (F->captureall)
+		return 1;
+	return F->caplen > 0 && bsearch(&name, F->captab, F->caplen, sizeof *F->captab, comparename) != NULL;
+}
+
 static void emitfunction(JF, js_Function *fun)
 {
 	emit(J, F, OP_CLOSURE);
@@ -202,11 +255,26 @@ static void emitstring(JF, int opcode, const char *str)
 {
 	emit(J, F, opcode);
 	emitraw(J, F, addstring(J, F, str));
+	/* these lookups get an inline cache */
+	if (opcode == OP_GETVAR || opcode == OP_GETPROP_S || opcode == OP_SETPROP_S)
+		emitraw(J, F, F->cachelen++);
+}
+
+static void emitupvar(JF, int oploc, int depth, int i)
+{
+	switch (oploc) {
+	case OP_GETLOCAL: emit(J, F, OP_GETUPVAR); break;
+	case OP_SETLOCAL: emit(J, F, OP_SETUPVAR); break;
+	default: emit(J, F, OP_FALSE); return; /* variables cannot be deleted */
+	}
+	emitraw(J, F, depth);
+	emitraw(J, F, i);
 }
 
 static void emitlocal(JF, int oploc, int opvar, js_Ast *ident)
 {
-	int i;
+	js_Function *G;
+	int i, depth;
 	checkfutureword(J, F, ident);
 	if (F->strict && oploc == OP_SETLOCAL) {
 		if (!strcmp(ident->string, "arguments"))
@@ -215,16 +283,42 @@ static void emitlocal(JF, int oploc, int opvar, js_Ast *ident)
 			jsC_error(J, ident, "'eval' is read-only in strict mode");
 	}
 	if (F->lightweight) {
-		i = findlocal(J, F, ident->string);
-		if (i >= 0) {
-			emit(J, F, oploc);
-			emitraw(J, F, i);
-			return;
+		/* look in the records of the enclosing functions up to the first one that is not lightweight */
+		depth = 0;
+		for (G = F; G && G->lightweight; G = G->parent) {
+			i = findupvar(J, G, ident->string);
+			if (i >= 0) {
+				emitupvar(J, F, oploc, depth, i);
+				return;
+			}
+			if (G == F) {
+				i = findlocal(J, F, ident->string);
+				if (i >= 0) {
+					emit(J, F, oploc);
+					emitraw(J, F, i);
+					return;
+				}
+			}
+			if (G->record)
+				++depth;
 		}
 	}
 	emitstring(J, F, opvar, ident->string);
 }
 
+/* Pop the value on top of the stack into a local variable of this function */
+static void emitinitlocal(JF, const char *name)
+{
+	int i = findupvar(J, F, name);
+	if (i >= 0) {
+		emitupvar(J, F, OP_SETLOCAL, 0, i);
+		emit(J, F, OP_POP);
+	} else {
+		emit(J, F, OP_INITLOCAL);
+		emitraw(J, F, findlocal(J, F, name));
+	}
+}
+
 static int here(JF)
 {
 	return F->codelen;
@@ -348,11 +442,11 @@ static void cobject(JF, js_Ast *list)
 			emit(J, F, OP_INITPROP);
 			break;
 		case EXP_PROP_GET:
-			emitfunction(J, F, newfun(J, NULL, NULL, kv->c, 0, F->strict));
+			emitfunction(J, F, newfun(J, F, NULL, NULL, kv->c, 0, F->strict));
 			emit(J, F, OP_INITGETTER);
 			break;
 		case EXP_PROP_SET:
-			emitfunction(J, F, newfun(J, NULL, kv->b, kv->c, 0, F->strict));
+			emitfunction(J, F, newfun(J, F, NULL, kv->b, kv->c, 0, F->strict));
 			emit(J, F, OP_INITSETTER);
 			break;
 		}
@@ -580,7 +674,7 @@ static void cexp(JF, js_Ast *exp)
 		break;
 
 	case EXP_FUN:
-		emitfunction(J, F, newfun(J, exp->a, exp->b, exp->c, 0, F->strict));
+		emitfunction(J, F, newfun(J, F, exp->a, exp->b, exp->c, 0, F->strict));
 		break;
 
 	case EXP_IDENTIFIER:
@@ -853,13 +947,12 @@ static void cexit(JF, enum js_AstType T, js_Ast *node, js_Ast *target)
 			}
 			/* came from catch block */
 			if (prev == node->c) {
+				if (!F->lightweight)
+					emit(J, F, OP_ENDCATCH);
 				/* ... with finally */
 				if (node->d) {
-					emit(J, F, OP_ENDCATCH);
 					emit(J, F, OP_ENDTRY);
 					cstm(J, F, node->d); /* finally */
-				} else {
-					emit(J, F, OP_ENDCATCH);
 				}
 			}
 			break;
@@ -869,6 +962,24 @@ static void cexit(JF, enum js_AstType T, js_Ast *node, js_Ast *target)
 
 /* Try/catch/finally */
 
+/* Lightweight functions keep the exception in a new local that is only visible in the catch block */
+static void ccatch(JF, js_Ast *catchvar, js_Ast *catchstm)
+{
+	const char *name = catchvar->string;
+	int i;
+	if (F->lightweight) {
+		i = addlocalname(J, F, name);
+		emit(J, F, OP_INITLOCAL);
+		emitraw(J, F, i);
+		cstm(J, F, catchstm);
+		F->vartab[i-1] = ""; /* hide it again */
+	} else {
+		emitstring(J, F, OP_CATCH, name);
+		cstm(J, F, catchstm);
+		emit(J, F, OP_ENDCATCH);
+	}
+}
+
 static void ctryfinally(JF, js_Ast *trystm, js_Ast *finallystm)
 {
 	int L1;
@@ -897,9 +1008,7 @@ static void ctrycatch(JF, js_Ast *trystm, js_Ast *catchvar, js_Ast *catchstm)
 			if (!strcmp(catchvar->string, "eval"))
 				jsC_error(J, catchvar, "redefining 'eval' is not allowed in strict mode");
 		}
-		emitstring(J, F, OP_CATCH, catchvar->string);
-		cstm(J, F, catchstm);
-		emit(J, F, OP_ENDCATCH);
+		ccatch(J, F, catchvar, catchstm);
 		L2 = emitjump(J, F, OP_JUMP); /* skip past the try block */
 	}
 	label(J, F, L1);
@@ -928,9 +1037,7 @@ static void ctrycatchfinally(JF, js_Ast *trystm, js_Ast *catchvar, js_Ast *catch
 			if (!strcmp(catchvar->string, "eval"))
 				jsC_error(J, catchvar, "redefining 'eval' is not allowed in strict mode");
 		}
-		emitstring(J, F, OP_CATCH, catchvar->string);
-		cstm(J, F, catchstm);
-		emit(J, F, OP_ENDCATCH);
+		ccatch(J, F, catchvar, catchstm);
 		L3 = emitjump(J, F, OP_JUMP); /* skip past the try block to the finally block */
 	}
 	label(J, F, L1);
@@ -1219,10 +1326,31 @@ static void cstmlist(JF, js_Ast *list)
 
 /* Analyze */
 
+/* Collect the names used in inner functions, which may refer to our variables */
+static void capture(JF, js_Ast *node)
+{
+	if (node->type == EXP_IDENTIFIER) {
+		if (!strcmp(node->string, "eval")) {
+			F->captureall = 1;
+		} else if (strcmp(node->string, "arguments")) {
+			if (F->caplen >= F->capcap) {
+				F->capcap = F->capcap ? F->capcap * 2 : 16;
+				F->captab = js_realloc(J, F->captab, F->capcap * sizeof *F->captab);
+			}
+			F->captab[F->caplen++] = node->string;
+		}
+	}
+
+	if (node->a) capture(J, F, node->a);
+	if (node->b) capture(J, F, node->b);
+	if (node->c) capture(J, F, node->c);
+	if (node->d) capture(J, F, node->d);
+}
+
 static void analyze(JF, js_Ast *node)
 {
 	if (isfun(node->type)) {
-		F->lightweight = 0;
+		capture(J, F, node);
 		return; /* don't scan inner functions */
 	}
 
@@ -1230,13 +1358,8 @@ static void analyze(JF, js_Ast *node)
 		F->lightweight = 0;
 	}
 
-	if (node->type == STM_TRY && node->c) {
-		F->lightweight = 0;
-	}
-
 	if (node->type == EXP_IDENTIFIER) {
 		if (!strcmp(node->string, "arguments")) {
-			F->lightweight = 0;
 			F->arguments = 1;
 		} else if (!strcmp(node->string, "eval")) {
 			/* eval may only be used as a direct function call */
@@ -1273,8 +1396,11 @@ static void cparams(JF, js_Ast *list)
 
 static void cvardecs(JF, js_Ast *node)
 {
-	if (isfun(node->type))
+	if (isfun(node->type)) {
+		if (node->type == AST_FUNDEC && F->lightweight)
+			addlocal(J, F, node->a, 1);
 		return; /* stop at inner functions */
+	}
 
 	if (node->type == EXP_VAR) {
 		checkfutureword(J, F, node->a);
@@ -1295,13 +1421,50 @@ static void cfundecs(JF, js_Ast *list)
 	while (list) {
 		js_Ast *stm = list->a;
 		if (stm->type == AST_FUNDEC) {
-			emitfunction(J, F, newfun(J, stm->a, stm->b, stm->c, 0, F->strict));
-			emitstring(J, F, OP_INITVAR, stm->a->string);
+			emitfunction(J, F, newfun(J, F, stm->a, stm->b, stm->c, 0, F->strict));
+			if (F->lightweight)
+				emitinitlocal(J, F, stm->a->string);
+			else
+				emitstring(J, F, OP_INITVAR, stm->a->string);
 		}
 		list = list->b;
 	}
 }
 
+static int catchcaptured(JF, js_Ast *node)
+{
+	if (isfun(node->type))
+		return 0;
+	if (node->type == STM_TRY && node->b && iscaptured(J, F, node->b->string))
+		return 1;
+	return (node->a && catchcaptured(J, F, node->a)) ||
+		(node->b && catchcaptured(J, F, node->b)) ||
+		(node->c && catchcaptured(J, F, node->c)) ||
+		(node->d && catchcaptured(J, F, node->d));
+}
+
+/* Move the locals that inner functions use to the environment record, and copy in the parameters */
+static void cupvars(JF)
+{
+	int i, k;
+
+	for (i = 0; i < F->varlen; ++i)
+		if (iscaptured(J, F, F->vartab[i]))
+			F->record = 1;
+
+	for (i = 0; i < F->varlen; ++i) {
+		if (iscaptured(J, F, F->vartab[i])) {
+			k = addupvar(J, F, F->vartab[i], 1);
+			if (i < F->numparams + F->arguments) {
+				emit(J, F, OP_GETLOCAL);
+				emitraw(J, F, i + 1);
+				emitupvar(J, F, OP_SETLOCAL, 0, k);
+				emit(J, F, OP_POP);
+			}
+		}
+	}
+}
+
 static void cfunbody(JF, js_Ast *name, js_Ast *params, js_Ast *body)
 {
 	F->lightweight = 1;
@@ -1312,6 +1475,12 @@ static void cfunbody(JF, js_Ast *name, js_Ast *params, js_Ast *body)
 
 	if (body)
 		analyze(J, F, body);
+	if (F->caplen > 0)
+		qsort(F->captab, F->caplen, sizeof *F->captab, comparename);
+
+	/* each catch needs a new binding if inner functions can see it */
+	if (F->lightweight && body && catchcaptured(J, F, body))
+		F->lightweight = 0;
 
 	/* Check if first statement is 'use strict': */
 	if (body && body->type == AST_LIST && body->a && body->a->type == EXP_STRING)
@@ -1320,23 +1489,38 @@ static void cfunbody(JF, js_Ast *name, js_Ast *params, js_Ast *body)
 
 	cparams(J, F, params);
 
+	if (F->lightweight && F->arguments) {
+		/* the arguments object goes in the local after the parameters, unless a parameter shadows it */
+		if (findlocal(J, F, "arguments") > 0)
+			F->arguments = 0;
+		else
+			addlocalname(J, F, "arguments");
+	}
+
 	if (name) {
 		checkfutureword(J, F, name);
-		emit(J, F, OP_CURRENT);
 		if (F->lightweight) {
 			addlocal(J, F, name, 0);
-			emit(J, F, OP_INITLOCAL);
-			emitraw(J, F, findlocal(J, F, name->string));
 		} else {
+			emit(J, F, OP_CURRENT);
 			emitstring(J, F, OP_INITVAR, name->string);
 		}
 	}
 
-	if (body) {
+	if (body)
 		cvardecs(J, F, body);
-		cfundecs(J, F, body);
+
+	if (F->lightweight) {
+		cupvars(J, F);
+		if (name) {
+			emit(J, F, OP_CURRENT);
+			emitinitlocal(J, F, name->string);
+		}
 	}
 
+	if (body)
+		cfundecs(J, F, body);
+
 	if (F->script) {
 		emit(J, F, OP_UNDEF);
 		cstmlist(J, F, body);
@@ -1350,10 +1534,10 @@ static void cfunbody(JF, js_Ast *name, js_Ast *params, js_Ast *body)
 
 js_Function *jsC_compilefunction(js_State *J, js_Ast *prog)
 {
-	return newfun(J, prog->a, prog->b, prog->c, 0, J->default_strict);
+	return newfun(J, NULL, prog->a, prog->b, prog->c, 0, J->default_strict);
 }
 
 js_Function *jsC_compile(js_State *J, js_Ast *prog)
 {
-	return newfun(J, NULL, NULL, prog, 1, J->default_strict);
+	return newfun(J, NULL, NULL, NULL, prog, 1, J->default_strict);
 }
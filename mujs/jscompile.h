@@ -36,10 +36,13 @@ enum js_OpCode
 	OP_SETLOCAL,	/* <value> -K- <value> */
 	OP_DELLOCAL,	/* -K- false */
 
+	OP_GETUPVAR,	/* -D,K- <value> */
+	OP_SETUPVAR,	/* <value> -D,K- <value> */
+
 	OP_INITVAR,	/* <value> -S- */
 	OP_DEFVAR,	/* -S- */
 	OP_HASVAR,	/* -S- ( <value> | undefined ) */
-	OP_GETVAR,	/* -S- <value> */
+	OP_GETVAR,	/* -S,cache- <value> */
 	OP_SETVAR,	/* <value> -S- <value> */
 	OP_DELVAR,	/* -S- <success> */
 
@@ -50,9 +53,9 @@ enum js_OpCode
 	OP_INITSETTER,	/* <obj> <key> <closure> -- <obj> */
 
 	OP_GETPROP,	/* <obj> <name> -- <value> */
-	OP_GETPROP_S,	/* <obj> -S- <value> */
+	OP_GETPROP_S,	/* <obj> -S,cache- <value> */
 	OP_SETPROP,	/* <obj> <name> <value> -- <value> */
-	OP_SETPROP_S,	/* <obj> <value> -S- <value> */
+	OP_SETPROP_S,	/* <obj> <value> -S,cache- <value> */
 	OP_DELPROP,	/* <obj> <name> -- <success> */
 	OP_DELPROP_S,	/* <obj> -S- <success> */
 
@@ -116,6 +119,20 @@ enum js_OpCode
 	OP_LINE,	/* -K- */
 };
 
+/*
+	Inline cache of a property lookup, remembering where the instruction
+	last found its property: the shapes of the objects walked to reach the
+	one holding it, and its slot there. An empty cache has depth 0.
+*/
+struct js_InlineCache
+{
+	js_Shape *shape[JS_CACHEDEPTH];
+	unsigned int serial[JS_CACHEDEPTH];
+	int depth;
+	int type;
+	int slot;
+};
+
 struct js_Function
 {
 	const char *name;
@@ -140,6 +157,20 @@ struct js_Function
 	const char **vartab;
 	int varcap, varlen;
 
+	/* variables used by inner functions, kept in an environment record */
+	int record;
+	const char **uptab;
+	int upcap, uplen;
+
+	js_InlineCache *cachetab;
+	int cachelen;
+
+	/* scope analysis, only valid while compiling */
+	js_Function *parent;
+	const char **captab;
+	int caplen, capcap;
+	int captureall;
+
 	const char *filename;
 	int line, lastline;
 
@@ -727,6 +727,8 @@ void jsC_dumpfunction(js_State *J, js_Function *F)
 		printf("\tfunction %d %s\n", i, F->funtab[i]->name);
 	for (i = 0; i < F->varlen; ++i)
 		printf("\tlocal %d %s\n", i + 1, F->vartab[i]);
+	for (i = 0; i < F->uplen; ++i)
+		printf("\tupvar %d %s\n", i, F->uptab[i]);
 
 	printf("{\n");
 	while (p < end) {
@@ -749,20 +751,31 @@ void jsC_dumpfunction(js_State *J, js_Function *F)
 			p += 2;
 			break;
 
+		case OP_GETVAR:
+		case OP_GETPROP_S:
+		case OP_SETPROP_S:
+			pc(' ');
+			ps(F->strtab[*p++]);
+			printf(" #%d", *p++);
+			break;
+
 		case OP_INITVAR:
 		case OP_DEFVAR:
-		case OP_GETVAR:
 		case OP_HASVAR:
 		case OP_SETVAR:
 		case OP_DELVAR:
-		case OP_GETPROP_S:
-		case OP_SETPROP_S:
 		case OP_DELPROP_S:
 		case OP_CATCH:
 			pc(' ');
 			ps(F->strtab[*p++]);
 			break;
 
+		case OP_GETUPVAR:
+		case OP_SETUPVAR:
+			printf(" %d %d", p[0], p[1]);
+			p += 2;
+			break;
+
 		case OP_LINE:
 		case OP_CLOSURE:
 		case OP_INITLOCAL:
@@ -805,7 +818,7 @@ void js_dumpvalue(js_State *J, js_Value v)
 	case JS_TNUMBER: printf("%.9g", v.u.number); break;
 	case JS_TSHRSTR: printf("'%s'", v.u.shrstr); break;
 	case JS_TLITSTR: printf("'%s'", v.u.litstr); break;
-	case JS_TMEMSTR: printf("'%s'", v.u.memstr->p); break;
+	case JS_TMEMSTR: printf("'%s'", jsV_flatstring(J, v.u.memstr)); break;
 	case JS_TOBJECT:
 		if (v.u.object == J->G) {
 			printf("[Global]");
@@ -839,19 +852,25 @@ void js_dumpvalue(js_State *J, js_Value v)
 
 static void js_dumpproperty(js_State *J, js_Property *node)
 {
-	if (node->left->level)
-		js_dumpproperty(J, node->left);
 	printf("\t%s: ", node->name);
 	js_dumpvalue(J, node->value);
 	printf(",\n");
-	if (node->right->level)
-		js_dumpproperty(J, node->right);
 }
 
 void js_dumpobject(js_State *J, js_Object *obj)
 {
+	const int *order;
+	int k;
 	printf("{\n");
-	if (obj->properties->level)
-		js_dumpproperty(J, obj->properties);
+	if (obj->type == JS_CARRAY && obj->u.a.simple) {
+		for (k = 0; k < obj->u.a.flat_length; ++k) {
+			printf("\t%d: ", k);
+			js_dumpvalue(J, obj->u.a.array[k]);
+			printf(",\n");
+		}
+	}
+	order = jsV_propertyorder(J, obj);
+	for (k = 0; k < obj->count; ++k)
+		js_dumpproperty(J, &obj->properties[order[k]]);
 	printf("}\n");
 }
@@ -5,8 +5,6 @@
 
 #include "regexp.h"
 
-static void jsG_markobject(js_State *J, int mark, js_Object *obj);
-
 static void jsG_freeenvironment(js_State *J, js_Environment *env)
 {
 	js_free(J, env);
@@ -18,15 +16,35 @@ static void jsG_freefunction(js_State *J, js_Function *fun)
 	js_free(J, fun->numtab);
 	js_free(J, fun->strtab);
 	js_free(J, fun->vartab);
+	js_free(J, fun->uptab);
+	js_free(J, fun->captab);
+	js_free(J, fun->cachetab);
 	js_free(J, fun->code);
 	js_free(J, fun);
 }
 
-static void jsG_freeproperty(js_State *J, js_Property *node)
+/* Inline caches do not keep shapes alive, so forget the ones that are about to be freed */
+static void jsG_clearcaches(js_State *J, js_Function *fun)
+{
+	js_InlineCache *c;
+	int i, k;
+	for (i = 0; i < fun->cachelen; ++i) {
+		c = &fun->cachetab[i];
+		for (k = 0; k < c->depth; ++k) {
+			if (c->shape[k] && c->shape[k]->gcmark != J->gcmark) {
+				c->depth = 0;
+				break;
+			}
+		}
+	}
+}
+
+static void jsG_freestring(js_State *J, js_String *str)
 {
-	if (node->left->level) jsG_freeproperty(J, node->left);
-	if (node->right->level) jsG_freeproperty(J, node->right);
-	js_free(J, node);
+	if (str->p != str->data)
+		js_free(J, str->p);
+	js_free(J, str->runes.step);
+	js_free(J, str);
 }
 
 static void jsG_freeiterator(js_State *J, js_Iterator *node)
@@ -40,8 +58,11 @@ static void jsG_freeiterator(js_State *J, js_Iterator *node)
 
 static void jsG_freeobject(js_State *J, js_Object *obj)
 {
-	if (obj->properties->level)
-		jsG_freeproperty(J, obj->properties);
+	js_free(J, obj->properties);
+	if (obj->shape && obj->shape->dictionary)
+		jsV_freeshape(J, obj->shape);
+	if (obj->type == JS_CARRAY)
+		js_free(J, obj->u.a.array);
 	if (obj->type == JS_CREGEXP) {
 		js_free(J, obj->u.r.source);
 		js_regfreex(J->alloc, J->actx, obj->u.r.prog);
@@ -53,167 +74,356 @@ static void jsG_freeobject(js_State *J, js_Object *obj)
 	js_free(J, obj);
 }
 
-static void jsG_markfunction(js_State *J, int mark, js_Function *fun)
+/*
+	The collector is incremental: a cycle marks and then sweeps the heap in
+	bounded steps, and the program runs in between. An object is white until
+	it is marked, gray while it waits on the gray stack to have its contents
+	marked, and black after that. The store barriers shade any value stored
+	into an object or environment record while marking, so no black object
+	refers to a white one. The stack and the environments change without
+	barriers, so the roots are marked again before sweeping starts.
+
+	Strings, functions, shapes and environments are marked at once, since
+	they are small or never change; only objects go on the gray stack.
+*/
+
+static int jsG_scanobject(js_State *J, js_Object *obj);
+
+/* Recurse into the smaller operand only, like jsV_flattenrope */
+static void jsG_markstring(js_State *J, js_String *str)
+{
+	while (str->gcmark != J->gcmark) {
+		str->gcmark = J->gcmark;
+		if (str->p)
+			return;
+		if (str->left->size < str->right->size) {
+			jsG_markstring(J, str->left);
+			str = str->right;
+		} else {
+			jsG_markstring(J, str->right);
+			str = str->left;
+		}
+	}
+}
+
+static void jsG_markfunction(js_State *J, js_Function *fun)
 {
 	int i;
-	fun->gcmark = mark;
+	fun->gcmark = J->gcmark;
 	for (i = 0; i < fun->funlen; ++i)
-		if (fun->funtab[i]->gcmark != mark)
-			jsG_markfunction(J, mark, fun->funtab[i]);
+		if (fun->funtab[i]->gcmark != J->gcmark)
+			jsG_markfunction(J, fun->funtab[i]);
 }
 
-static void jsG_markenvironment(js_State *J, int mark, js_Environment *env)
+void jsG_shadeobject(js_State *J, js_Object *obj)
 {
-	do {
-		env->gcmark = mark;
-		if (env->variables->gcmark != mark)
-			jsG_markobject(J, mark, env->variables);
-		env = env->outer;
-	} while (env && env->gcmark != mark);
+	js_Object **gray;
+	int cap;
+
+	if (obj->gcmark == J->gcmark)
+		return;
+	obj->gcmark = J->gcmark;
+
+	if (J->gcgraytop == J->gcgraycap) {
+		cap = J->gcgraycap ? J->gcgraycap * 2 : 256;
+		gray = J->alloc(J->actx, J->gcgray, cap * sizeof *gray);
+		if (!gray) {
+			/* no room to put it off until later */
+			jsG_scanobject(J, obj);
+			return;
+		}
+		J->gcgray = gray;
+		J->gcgraycap = cap;
+	}
+	J->gcgray[J->gcgraytop++] = obj;
 }
 
-static void jsG_markproperty(js_State *J, int mark, js_Property *node)
+void jsG_shadevalue(js_State *J, js_Value *v)
 {
-	if (node->left->level) jsG_markproperty(J, mark, node->left);
-	if (node->right->level) jsG_markproperty(J, mark, node->right);
-
-	if (node->value.type == JS_TMEMSTR && node->value.u.memstr->gcmark != mark)
-		node->value.u.memstr->gcmark = mark;
-	if (node->value.type == JS_TOBJECT && node->value.u.object->gcmark != mark)
-		jsG_markobject(J, mark, node->value.u.object);
-	if (node->getter && node->getter->gcmark != mark)
-		jsG_markobject(J, mark, node->getter);
-	if (node->setter && node->setter->gcmark != mark)
-		jsG_markobject(J, mark, node->setter);
+	if (v->type == JS_TMEMSTR && v->u.memstr->gcmark != J->gcmark)
+		jsG_markstring(J, v->u.memstr);
+	if (v->type == JS_TOBJECT)
+		jsG_shadeobject(J, v->u.object);
 }
 
-static void jsG_markobject(js_State *J, int mark, js_Object *obj)
+void jsG_shadeshape(js_State *J, js_Shape *sh)
 {
-	obj->gcmark = mark;
-	if (obj->properties->level)
-		jsG_markproperty(J, mark, obj->properties);
-	if (obj->prototype && obj->prototype->gcmark != mark)
-		jsG_markobject(J, mark, obj->prototype);
-	if (obj->type == JS_CITERATOR) {
-		jsG_markobject(J, mark, obj->u.iter.target);
+	while (sh && sh->gcmark != J->gcmark) {
+		sh->gcmark = J->gcmark;
+		sh = sh->parent;
 	}
-	if (obj->type == JS_CFUNCTION || obj->type == JS_CSCRIPT) {
-		if (obj->u.f.scope && obj->u.f.scope->gcmark != mark)
-			jsG_markenvironment(J, mark, obj->u.f.scope);
-		if (obj->u.f.function && obj->u.f.function->gcmark != mark)
-			jsG_markfunction(J, mark, obj->u.f.function);
+}
+
+static void jsG_shadevalues(js_State *J, js_Value *v, int n)
+{
+	while (n--)
+		jsG_shadevalue(J, v++);
+}
+
+/* Returns the work done, counting the environments and slots visited */
+static int jsG_markenvironment(js_State *J, js_Environment *env)
+{
+	int work = 0;
+	while (env && env->gcmark != J->gcmark) {
+		env->gcmark = J->gcmark;
+		if (env->variables) {
+			jsG_shadeobject(J, env->variables);
+		} else {
+			if (env->function->gcmark != J->gcmark)
+				jsG_markfunction(J, env->function);
+			jsG_shadevalues(J, env->slots, env->function->uplen);
+			work += env->function->uplen;
+		}
+		++work;
+		env = env->outer;
 	}
+	return work;
 }
 
-static void jsG_markstack(js_State *J, int mark)
+/* Returns the work done, counting the object and the properties and elements visited */
+static int jsG_scanobject(js_State *J, js_Object *obj)
 {
-	js_Value *v = J->stack;
-	int n = J->top;
+	js_Property *ref = obj->properties;
+	int n = obj->count;
+	int work = 1 + n;
+
+	jsG_shadeshape(J, obj->shape);
 	while (n--) {
-		if (v->type == JS_TMEMSTR && v->u.memstr->gcmark != mark)
-			v->u.memstr->gcmark = mark;
-		if (v->type == JS_TOBJECT && v->u.object->gcmark != mark)
-			jsG_markobject(J, mark, v->u.object);
-		++v;
+		jsG_shadevalue(J, &ref->value);
+		if (ref->getter)
+			jsG_shadeobject(J, ref->getter);
+		if (ref->setter)
+			jsG_shadeobject(J, ref->setter);
+		++ref;
+	}
+	if (obj->type == JS_CARRAY && obj->u.a.simple) {
+		jsG_shadevalues(J, obj->u.a.array, obj->u.a.flat_length);
+		work += obj->u.a.flat_length;
+	}
+	if (obj->type == JS_CSTRING && obj->u.s.memstr && obj->u.s.memstr->gcmark != J->gcmark)
+		jsG_markstring(J, obj->u.s.memstr);
+	if (obj->prototype)
+		jsG_shadeobject(J, obj->prototype);
+	if (obj->type == JS_CITERATOR)
+		jsG_shadeobject(J, obj->u.iter.target);
+	if (obj->type == JS_CFUNCTION || obj->type == JS_CSCRIPT) {
+		if (obj->u.f.scope)
+			work += jsG_markenvironment(J, obj->u.f.scope);
+		if (obj->u.f.function && obj->u.f.function->gcmark != J->gcmark)
+			jsG_markfunction(J, obj->u.f.function);
 	}
+	return work;
 }
 
-void js_gc(js_State *J, int report)
+static void jsG_markroots(js_State *J)
 {
-	js_Function *fun, *nextfun, **prevnextfun;
-	js_Object *obj, *nextobj, **prevnextobj;
-	js_String *str, *nextstr, **prevnextstr;
-	js_Environment *env, *nextenv, **prevnextenv;
-	int nenv = 0, nfun = 0, nobj = 0, nstr = 0;
-	int genv = 0, gfun = 0, gobj = 0, gstr = 0;
-	int mark;
 	int i;
 
-	mark = J->gcmark = J->gcmark == 1 ? 2 : 1;
-
-	jsG_markobject(J, mark, J->Object_prototype);
-	jsG_markobject(J, mark, J->Array_prototype);
-	jsG_markobject(J, mark, J->Function_prototype);
-	jsG_markobject(J, mark, J->Boolean_prototype);
-	jsG_markobject(J, mark, J->Number_prototype);
-	jsG_markobject(J, mark, J->String_prototype);
-	jsG_markobject(J, mark, J->RegExp_prototype);
-	jsG_markobject(J, mark, J->Date_prototype);
+	jsG_shadeobject(J, J->Object_prototype);
+	jsG_shadeobject(J, J->Array_prototype);
+	jsG_shadeobject(J, J->Function_prototype);
+	jsG_shadeobject(J, J->Boolean_prototype);
+	jsG_shadeobject(J, J->Number_prototype);
+	jsG_shadeobject(J, J->String_prototype);
+	jsG_shadeobject(J, J->RegExp_prototype);
+	jsG_shadeobject(J, J->Date_prototype);
 
-	jsG_markobject(J, mark, J->Error_prototype);
-	jsG_markobject(J, mark, J->EvalError_prototype);
-	jsG_markobject(J, mark, J->RangeError_prototype);
-	jsG_markobject(J, mark, J->ReferenceError_prototype);
-	jsG_markobject(J, mark, J->SyntaxError_prototype);
-	jsG_markobject(J, mark, J->TypeError_prototype);
-	jsG_markobject(J, mark, J->URIError_prototype);
+	jsG_shadeobject(J, J->Error_prototype);
+	jsG_shadeobject(J, J->EvalError_prototype);
+	jsG_shadeobject(J, J->RangeError_prototype);
+	jsG_shadeobject(J, J->ReferenceError_prototype);
+	jsG_shadeobject(J, J->SyntaxError_prototype);
+	jsG_shadeobject(J, J->TypeError_prototype);
+	jsG_shadeobject(J, J->URIError_prototype);
 
-	jsG_markobject(J, mark, J->R);
-	jsG_markobject(J, mark, J->G);
+	jsG_shadeobject(J, J->R);
+	jsG_shadeobject(J, J->G);
 
-	jsG_markstack(J, mark);
+	jsG_shadevalues(J, J->stack, J->top);
 
-	jsG_markenvironment(J, mark, J->E);
-	jsG_markenvironment(J, mark, J->GE);
+	jsG_markenvironment(J, J->E);
+	jsG_markenvironment(J, J->GE);
 	for (i = 0; i < J->envtop; ++i)
-		jsG_markenvironment(J, mark, J->envstack[i]);
-
-	prevnextenv = &J->gcenv;
-	for (env = J->gcenv; env; env = nextenv) {
-		nextenv = env->gcnext;
-		if (env->gcmark != mark) {
-			*prevnextenv = nextenv;
-			jsG_freeenvironment(J, env);
-			++genv;
-		} else {
-			prevnextenv = &env->gcnext;
+		jsG_markenvironment(J, J->envstack[i]);
+}
+
+static void jsG_startcycle(js_State *J)
+{
+	J->gcmark = J->gcmark == 1 ? 2 : 1;
+	J->gcstate = JS_GCMARK;
+	jsG_markroots(J);
+}
+
+/* Scan gray objects until there are none left or the work is done, and return the work left */
+static int jsG_propagate(js_State *J, int work)
+{
+	while (work > 0 && J->gcgraytop > 0)
+		work -= jsG_scanobject(J, J->gcgray[--J->gcgraytop]);
+	return work;
+}
+
+/* Mark the roots again and everything they lead to, in one go, and start sweeping */
+static void jsG_finishmark(js_State *J)
+{
+	jsG_markroots(J);
+	while (J->gcgraytop > 0)
+		jsG_scanobject(J, J->gcgray[--J->gcgraytop]);
+
+	J->gcsweepenv = &J->gcenv;
+	J->gcsweepfun = &J->gcfun;
+	J->gcsweepobj = &J->gcobj;
+	J->gcsweepstr = &J->gcstr;
+	J->gcstate = JS_GCSWEEPENV;
+}
+
+/* Dead shapes are unlinked from the tree of transitions and freed all at once */
+static void jsG_sweepshapes(js_State *J)
+{
+	js_Shape *sh, *nextsh, **prevnextsh;
+
+	/* unlink dead shapes from the tree of transitions before any are freed */
+	for (sh = J->gcshape; sh; sh = sh->gcnext) {
+		if (sh->gcmark != J->gcmark && (!sh->parent || sh->parent->gcmark == J->gcmark)) {
+			for (prevnextsh = sh->parent ? &sh->parent->kids : &J->shapes; *prevnextsh != sh; prevnextsh = &(*prevnextsh)->sibling)
+				;
+			*prevnextsh = sh->sibling;
 		}
-		++nenv;
 	}
 
-	prevnextfun = &J->gcfun;
-	for (fun = J->gcfun; fun; fun = nextfun) {
-		nextfun = fun->gcnext;
-		if (fun->gcmark != mark) {
-			*prevnextfun = nextfun;
-			jsG_freefunction(J, fun);
-			++gfun;
+	prevnextsh = &J->gcshape;
+	for (sh = J->gcshape; sh; sh = nextsh) {
+		nextsh = sh->gcnext;
+		if (sh->gcmark != J->gcmark) {
+			*prevnextsh = nextsh;
+			jsV_freeshape(J, sh);
 		} else {
-			prevnextfun = &fun->gcnext;
+			prevnextsh = &sh->gcnext;
 		}
-		++nfun;
 	}
+}
 
-	prevnextobj = &J->gcobj;
-	for (obj = J->gcobj; obj; obj = nextobj) {
-		nextobj = obj->gcnext;
-		if (obj->gcmark != mark) {
-			*prevnextobj = nextobj;
-			jsG_freeobject(J, obj);
-			++gobj;
-		} else {
-			prevnextobj = &obj->gcnext;
+/*
+	Sweep the lists in turn, from where the last step stopped. Allocations
+	go to the heads of the lists, behind the cursors, and are marked while
+	sweeping, so the cursors stay valid in between steps.
+*/
+static void jsG_sweep(js_State *J, int work)
+{
+	js_Environment *env;
+	js_Function *fun;
+	js_Object *obj;
+	js_String *str;
+
+	if (J->gcstate == JS_GCSWEEPENV) {
+		while (work > 0 && (env = *J->gcsweepenv)) {
+			if (env->gcmark != J->gcmark) {
+				*J->gcsweepenv = env->gcnext;
+				jsG_freeenvironment(J, env);
+			} else {
+				J->gcsweepenv = &env->gcnext;
+			}
+			--work;
 		}
-		++nobj;
+		if (!*J->gcsweepenv)
+			J->gcstate = JS_GCSWEEPFUN;
 	}
 
-	prevnextstr = &J->gcstr;
-	for (str = J->gcstr; str; str = nextstr) {
-		nextstr = str->gcnext;
-		if (str->gcmark != mark) {
-			*prevnextstr = nextstr;
-			js_free(J, str);
-			++gstr;
-		} else {
-			prevnextstr = &str->gcnext;
+	if (J->gcstate == JS_GCSWEEPFUN) {
+		while (work > 0 && (fun = *J->gcsweepfun)) {
+			if (fun->gcmark != J->gcmark) {
+				*J->gcsweepfun = fun->gcnext;
+				jsG_freefunction(J, fun);
+			} else {
+				jsG_clearcaches(J, fun);
+				J->gcsweepfun = &fun->gcnext;
+			}
+			--work;
 		}
-		++nstr;
+		if (!*J->gcsweepfun)
+			J->gcstate = JS_GCSWEEPOBJ;
 	}
 
+	if (J->gcstate == JS_GCSWEEPOBJ) {
+		while (work > 0 && (obj = *J->gcsweepobj)) {
+			if (obj->gcmark != J->gcmark) {
+				*J->gcsweepobj = obj->gcnext;
+				jsG_freeobject(J, obj);
+			} else {
+				J->gcsweepobj = &obj->gcnext;
+			}
+			--work;
+		}
+		if (!*J->gcsweepobj)
+			J->gcstate = JS_GCSWEEPSTR;
+	}
+
+	if (J->gcstate == JS_GCSWEEPSTR) {
+		while (work > 0 && (str = *J->gcsweepstr)) {
+			if (str->gcmark != J->gcmark) {
+				*J->gcsweepstr = str->gcnext;
+				jsG_freestring(J, str);
+			} else {
+				J->gcsweepstr = &str->gcnext;
+			}
+			--work;
+		}
+		if (!*J->gcsweepstr) {
+			jsG_sweepshapes(J);
+			J->gcstate = JS_GCPAUSE;
+			J->gccounter = 0;
+		}
+	}
+}
+
+int js_gcstep(js_State *J, int work)
+{
+	if (J->gcstate == JS_GCPAUSE)
+		jsG_startcycle(J);
+
+	if (J->gcstate == JS_GCMARK) {
+		work = jsG_propagate(J, work);
+		if (J->gcgraytop > 0)
+			return 0;
+		jsG_finishmark(J);
+	}
+
+	jsG_sweep(J, work);
+	return J->gcstate == JS_GCPAUSE;
+}
+
+static void jsG_count(js_State *J, int n[4])
+{
+	js_Environment *env;
+	js_Function *fun;
+	js_Object *obj;
+	js_String *str;
+
+	n[0] = n[1] = n[2] = n[3] = 0;
+	for (env = J->gcenv; env; env = env->gcnext) ++n[0];
+	for (fun = J->gcfun; fun; fun = fun->gcnext) ++n[1];
+	for (obj = J->gcobj; obj; obj = obj->gcnext) ++n[2];
+	for (str = J->gcstr; str; str = str->gcnext) ++n[3];
+}
+
+void js_gc(js_State *J, int report)
+{
+	int n[4], k[4];
+
+	/* finish the cycle in progress, which may have kept garbage made since it started */
+	if (J->gcstate != JS_GCPAUSE)
+		js_gcstep(J, INT_MAX);
+
+	jsG_startcycle(J);
+	jsG_finishmark(J);
+	if (report)
+		jsG_count(J, n);
+	jsG_sweep(J, INT_MAX);
+
 	if (report) {
 		char buf[256];
+		jsG_count(J, k);
 		snprintf(buf, sizeof buf, "garbage collected: %d/%d envs, %d/%d funs, %d/%d objs, %d/%d strs",
-			genv, nenv, gfun, nfun, gobj, nobj, gstr, nstr);
+			n[0] - k[0], n[0], n[1] - k[1], n[1], n[2] - k[2], n[2], n[3] - k[3], n[3]);
 		js_report(J, buf);
 	}
 }
@@ -224,6 +434,7 @@ void js_freestate(js_State *J)
 	js_Object *obj, *nextobj;
 	js_Environment *env, *nextenv;
 	js_String *str, *nextstr;
+	js_Shape *sh, *nextsh;
 
 	for (env = J->gcenv; env; env = nextenv)
 		nextenv = env->gcnext, jsG_freeenvironment(J, env);
@@ -232,11 +443,16 @@ void js_freestate(js_State *J)
 	for (obj = J->gcobj; obj; obj = nextobj)
 		nextobj = obj->gcnext, jsG_freeobject(J, obj);
 	for (str = J->gcstr; str; str = nextstr)
-		nextstr = str->gcnext, js_free(J, str);
+		nextstr = str->gcnext, jsG_freestring(J, str);
+	for (sh = J->gcshape; sh; sh = nextsh)
+		nextsh = sh->gcnext, jsV_freeshape(J, sh);
 
 	jsS_freestrings(J);
 
+	js_free(J, J->gcgray);
+
 	js_free(J, J->lexbuf.text);
+	js_free(J, J->litcache.runes.step);
 	J->alloc(J->actx, J->stack, 0);
 	J->alloc(J->actx, J, 0);
 }
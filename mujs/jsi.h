@@ -60,8 +60,10 @@ typedef struct js_Regexp js_Regexp;
 typedef struct js_Value js_Value;
 typedef struct js_Object js_Object;
 typedef struct js_String js_String;
+typedef struct js_Shape js_Shape;
 typedef struct js_Ast js_Ast;
 typedef struct js_Function js_Function;
+typedef struct js_InlineCache js_InlineCache;
 typedef struct js_Environment js_Environment;
 typedef struct js_StringNode js_StringNode;
 typedef struct js_Jumpbuf js_Jumpbuf;
@@ -69,11 +71,18 @@ typedef struct js_StackTrace js_StackTrace;
 
 /* Limits */
 
-#define JS_STACKSIZE 256	/* value stack size */
+#define JS_STACKSIZE 4096	/* value stack size */
 #define JS_ENVLIMIT 64		/* environment stack size */
 #define JS_TRYLIMIT 64		/* exception stack size */
-#define JS_GCLIMIT 10000	/* run gc cycle every N allocations */
+#define JS_GCLIMIT 10000	/* start gc cycle every N allocations */
+#define JS_GCSTEP 250		/* run gc step every N allocations during a cycle */
+#define JS_GCSTEPWORK 5000	/* objects, properties and elements visited by a gc step */
 #define JS_ASTLIMIT 100		/* max nested expressions */
+#define JS_ARRAYLIMIT (1<<26)	/* max length of dense array storage */
+#define JS_STRLIMIT (1<<28)	/* max string length in bytes */
+#define JS_SHAPELIMIT 32	/* max properties of objects with shared shapes */
+#define JS_SHAPESCAN 8		/* max properties of shapes looked up without a hash table */
+#define JS_CACHEDEPTH 4		/* max objects walked by an inline cache hit */
 
 /* instruction size -- change to int if you get integer overflow syntax errors */
 typedef unsigned short js_Instruction;
@@ -142,8 +151,26 @@ void *js_savetrypc(js_State *J, js_Instruction *pc);
 #define js_trypc(J, PC) \
 	setjmp(js_savetrypc(J, PC))
 
+/* Garbage collector phases */
+
+enum {
+	JS_GCPAUSE,
+	JS_GCMARK,
+	JS_GCSWEEPENV,
+	JS_GCSWEEPFUN,
+	JS_GCSWEEPOBJ,
+	JS_GCSWEEPSTR,
+};
+
+/* Allocations are white, except while sweeping, when they must survive the cycle in progress */
+#define JS_GCNEWMARK(J) ((J)->gcstate >= JS_GCSWEEPENV ? (J)->gcmark : 0)
+
 /* State struct */
 
+/* Byte offsets of every JS_RUNESTEP-th rune and of the last rune looked up, for indexing a non-ASCII string */
+#define JS_RUNESTEP 64
+typedef struct js_RuneIndex { int *step; int cursor, offset; } js_RuneIndex;
+
 struct js_State
 {
 	void *actx;
@@ -154,6 +181,9 @@ struct js_State
 
 	js_StringNode *strings;
 
+	/* the last literal string indexed, which has no js_String to cache its length and cursor in */
+	struct { const char *s; int size, length; char ascii; js_RuneIndex runes; } litcache;
+
 	int default_strict;
 	int strict;
 
@@ -208,10 +238,26 @@ struct js_State
 	/* garbage collector list */
 	int gcmark;
 	int gccounter;
+	int gcstate;
 	js_Environment *gcenv;
 	js_Function *gcfun;
 	js_Object *gcobj;
 	js_String *gcstr;
+	js_Shape *gcshape;
+
+	/* objects marked but not yet scanned, and where sweeping each list has got to */
+	js_Object **gcgray;
+	int gcgraytop, gcgraycap;
+	js_Environment **gcsweepenv;
+	js_Function **gcsweepfun;
+	js_Object **gcsweepobj;
+	js_String **gcsweepstr;
+
+	/* shapes with one property, which are the children of the empty shape */
+	js_Shape *shapes;
+
+	/* inline cache statistics */
+	unsigned long cachehits, cachemisses;
 
 	/* environments on the call stack but currently not in scope */
 	int envtop;
@@ -62,7 +62,7 @@ static void Op_hasOwnProperty(js_State *J)
 	js_Object *self = js_toobject(J, 0);
 	const char *name = js_tostring(J, 1);
 	js_Property *ref = jsV_getownproperty(J, self, name);
-	js_pushboolean(J, ref != NULL);
+	js_pushboolean(J, ref != NULL || jsV_getflatindex(J, self, name) != NULL);
 }
 
 static void Op_isPrototypeOf(js_State *J)
@@ -86,7 +86,7 @@ static void Op_propertyIsEnumerable(js_State *J)
 	js_Object *self = js_toobject(J, 0);
 	const char *name = js_tostring(J, 1);
 	js_Property *ref = jsV_getownproperty(J, self, name);
-	js_pushboolean(J, ref && !(ref->atts & JS_DONTENUM));
+	js_pushboolean(J, (ref && !(ref->atts & JS_DONTENUM)) || jsV_getflatindex(J, self, name) != NULL);
 }
 
 static void O_getPrototypeOf(js_State *J)
@@ -104,11 +104,21 @@ static void O_getPrototypeOf(js_State *J)
 static void O_getOwnPropertyDescriptor(js_State *J)
 {
 	js_Object *obj;
-	js_Property *ref;
+	js_Property *ref, flat;
+	js_Value *v;
+	const char *name;
 	if (!js_isobject(J, 1))
 		js_typeerror(J, "not an object");
 	obj = js_toobject(J, 1);
-	ref = jsV_getproperty(J, obj, js_tostring(J, 2));
+	name = js_tostring(J, 2);
+	ref = jsV_getproperty(J, obj, name);
+	v = jsV_getflatindex(J, obj, name);
+	if (v) {
+		/* dense array elements are plain data properties */
+		memset(&flat, 0, sizeof flat);
+		flat.value = *v;
+		ref = &flat;
+	}
 	if (!ref)
 		js_pushundefined(J);
 	else {
@@ -137,20 +147,21 @@ static void O_getOwnPropertyDescriptor(js_State *J)
 	}
 }
 
-static int O_getOwnPropertyNames_walk(js_State *J, js_Property *ref, int i)
+static int O_pushflatindices(js_State *J, js_Object *obj)
 {
-	if (ref->left->level)
-		i = O_getOwnPropertyNames_walk(J, ref->left, i);
-	js_pushliteral(J, ref->name);
-	js_setindex(J, -2, i++);
-	if (ref->right->level)
-		i = O_getOwnPropertyNames_walk(J, ref->right, i);
-	return i;
+	char buf[32];
+	int k;
+	for (k = 0; k < obj->u.a.flat_length; ++k) {
+		js_pushstring(J, js_itoa(buf, k));
+		js_setindex(J, -2, k);
+	}
+	return k;
 }
 
 static void O_getOwnPropertyNames(js_State *J)
 {
 	js_Object *obj;
+	const int *order;
 	int k;
 	int i;
 
@@ -160,10 +171,15 @@ static void O_getOwnPropertyNames(js_State *J)
 
 	js_newarray(J);
 
-	if (obj->properties->level)
-		i = O_getOwnPropertyNames_walk(J, obj->properties, 0);
-	else
-		i = 0;
+	i = 0;
+	if (obj->type == JS_CARRAY && obj->u.a.simple)
+		i = O_pushflatindices(J, obj);
+
+	order = jsV_propertyorder(J, obj);
+	for (k = 0; k < obj->count; ++k) {
+		js_pushliteral(J, obj->properties[order[k]].name);
+		js_setindex(J, -2, i++);
+	}
 
 	if (obj->type == JS_CARRAY) {
 		js_pushliteral(J, "length");
@@ -254,51 +270,41 @@ static void O_defineProperty(js_State *J)
 	js_copy(J, 1);
 }
 
-static void O_defineProperties_walk(js_State *J, js_Property *ref)
-{
-	if (ref->left->level)
-		O_defineProperties_walk(J, ref->left);
-	if (!(ref->atts & JS_DONTENUM)) {
-		js_pushvalue(J, ref->value);
-		ToPropertyDescriptor(J, js_toobject(J, 1), ref->name, js_toobject(J, -1));
-		js_pop(J, 1);
-	}
-	if (ref->right->level)
-		O_defineProperties_walk(J, ref->right);
-}
-
 static void O_defineProperties(js_State *J)
 {
 	js_Object *props;
+	js_Property *ref;
+	const char *name;
 
 	if (!js_isobject(J, 1)) js_typeerror(J, "not an object");
 	if (!js_isobject(J, 2)) js_typeerror(J, "not an object");
 
 	props = js_toobject(J, 2);
-	if (props->properties->level)
-		O_defineProperties_walk(J, props->properties);
+	if (props->type == JS_CARRAY)
+		jsV_unflattenarray(J, props);
+
+	/* the descriptors may have getters that change props, so walk a snapshot of the names */
+	js_pushobject(J, jsV_newiterator(J, props, 1));
+	while ((name = jsV_nextiterator(J, js_toobject(J, -1)))) {
+		ref = jsV_getownproperty(J, props, name);
+		if (ref) {
+			js_pushvalue(J, ref->value);
+			ToPropertyDescriptor(J, js_toobject(J, 1), name, js_toobject(J, -1));
+			js_pop(J, 1);
+		}
+	}
+	js_pop(J, 1);
 
 	js_copy(J, 1);
 }
 
-static void O_create_walk(js_State *J, js_Object *obj, js_Property *ref)
-{
-	if (ref->left->level)
-		O_create_walk(J, obj, ref->left);
-	if (!(ref->atts & JS_DONTENUM)) {
-		if (ref->value.type != JS_TOBJECT)
-			js_typeerror(J, "not an object");
-		ToPropertyDescriptor(J, obj, ref->name, ref->value.u.object);
-	}
-	if (ref->right->level)
-		O_create_walk(J, obj, ref->right);
-}
-
 static void O_create(js_State *J)
 {
 	js_Object *obj;
 	js_Object *proto;
 	js_Object *props;
+	js_Property *ref;
+	const char *name;
 
 	if (js_isobject(J, 1))
 		proto = js_toobject(J, 1);
@@ -314,27 +320,26 @@ static void O_create(js_State *J)
 		if (!js_isobject(J, 2))
 			js_typeerror(J, "not an object");
 		props = js_toobject(J, 2);
-		if (props->properties->level)
-			O_create_walk(J, obj, props->properties);
-	}
-}
-
-static int O_keys_walk(js_State *J, js_Property *ref, int i)
-{
-	if (ref->left->level)
-		i = O_keys_walk(J, ref->left, i);
-	if (!(ref->atts & JS_DONTENUM)) {
-		js_pushliteral(J, ref->name);
-		js_setindex(J, -2, i++);
+		if (props->type == JS_CARRAY)
+			jsV_unflattenarray(J, props);
+		js_pushobject(J, jsV_newiterator(J, props, 1));
+		while ((name = jsV_nextiterator(J, js_toobject(J, -1)))) {
+			ref = jsV_getownproperty(J, props, name);
+			if (ref) {
+				if (ref->value.type != JS_TOBJECT)
+					js_typeerror(J, "not an object");
+				ToPropertyDescriptor(J, obj, name, ref->value.u.object);
+			}
+		}
+		js_pop(J, 1);
 	}
-	if (ref->right->level)
-		i = O_keys_walk(J, ref->right, i);
-	return i;
 }
 
 static void O_keys(js_State *J)
 {
 	js_Object *obj;
+	js_Property *ref;
+	const int *order;
 	int i, k;
 
 	if (!js_isobject(J, 1))
@@ -343,10 +348,18 @@ static void O_keys(js_State *J)
 
 	js_newarray(J);
 
-	if (obj->properties->level)
-		i = O_keys_walk(J, obj->properties, 0);
-	else
-		i = 0;
+	i = 0;
+	if (obj->type == JS_CARRAY && obj->u.a.simple)
+		i = O_pushflatindices(J, obj);
+
+	order = jsV_propertyorder(J, obj);
+	for (k = 0; k < obj->count; ++k) {
+		ref = &obj->properties[order[k]];
+		if (!(ref->atts & JS_DONTENUM)) {
+			js_pushliteral(J, ref->name);
+			js_setindex(J, -2, i++);
+		}
+	}
 
 	if (obj->type == JS_CSTRING) {
 		for (k = 0; k < obj->u.s.length; ++k) {
@@ -371,18 +384,10 @@ static void O_isExtensible(js_State *J)
 	js_pushboolean(J, js_toobject(J, 1)->extensible);
 }
 
-static void O_seal_walk(js_State *J, js_Property *ref)
-{
-	if (ref->left->level)
-		O_seal_walk(J, ref->left);
-	ref->atts |= JS_DONTCONF;
-	if (ref->right->level)
-		O_seal_walk(J, ref->right);
-}
-
 static void O_seal(js_State *J)
 {
 	js_Object *obj;
+	int k;
 
 	if (!js_isobject(J, 1))
 		js_typeerror(J, "not an object");
@@ -390,28 +395,19 @@ static void O_seal(js_State *J)
 	obj = js_toobject(J, 1);
 	obj->extensible = 0;
 
-	if (obj->properties->level)
-		O_seal_walk(J, obj->properties);
+	if (obj->type == JS_CARRAY)
+		jsV_unflattenarray(J, obj);
 
-	js_copy(J, 1);
-}
+	for (k = 0; k < obj->count; ++k)
+		obj->properties[k].atts |= JS_DONTCONF;
 
-static int O_isSealed_walk(js_State *J, js_Property *ref)
-{
-	if (ref->left->level)
-		if (!O_isSealed_walk(J, ref->left))
-			return 0;
-	if (!(ref->atts & JS_DONTCONF))
-		return 0;
-	if (ref->right->level)
-		if (!O_isSealed_walk(J, ref->right))
-			return 0;
-	return 1;
+	js_copy(J, 1);
 }
 
 static void O_isSealed(js_State *J)
 {
 	js_Object *obj;
+	int k;
 
 	if (!js_isobject(J, 1))
 		js_typeerror(J, "not an object");
@@ -422,24 +418,25 @@ static void O_isSealed(js_State *J)
 		return;
 	}
 
-	if (obj->properties->level)
-		js_pushboolean(J, O_isSealed_walk(J, obj->properties));
-	else
-		js_pushboolean(J, 1);
-}
+	if (obj->type == JS_CARRAY && obj->u.a.simple && obj->u.a.flat_length > 0) {
+		js_pushboolean(J, 0);
+		return;
+	}
 
-static void O_freeze_walk(js_State *J, js_Property *ref)
-{
-	if (ref->left->level)
-		O_freeze_walk(J, ref->left);
-	ref->atts |= JS_READONLY | JS_DONTCONF;
-	if (ref->right->level)
-		O_freeze_walk(J, ref->right);
+	for (k = 0; k < obj->count; ++k) {
+		if (!(obj->properties[k].atts & JS_DONTCONF)) {
+			js_pushboolean(J, 0);
+			return;
+		}
+	}
+
+	js_pushboolean(J, 1);
 }
 
 static void O_freeze(js_State *J)
 {
 	js_Object *obj;
+	int k;
 
 	if (!js_isobject(J, 1))
 		js_typeerror(J, "not an object");
@@ -447,28 +444,19 @@ static void O_freeze(js_State *J)
 	obj = js_toobject(J, 1);
 	obj->extensible = 0;
 
-	if (obj->properties->level)
-		O_freeze_walk(J, obj->properties);
+	if (obj->type == JS_CARRAY)
+		jsV_unflattenarray(J, obj);
 
-	js_copy(J, 1);
-}
+	for (k = 0; k < obj->count; ++k)
+		obj->properties[k].atts |= JS_READONLY | JS_DONTCONF;
 
-static int O_isFrozen_walk(js_State *J, js_Property *ref)
-{
-	if (ref->left->level)
-		if (!O_isFrozen_walk(J, ref->left))
-			return 0;
-	if (!(ref->atts & (JS_READONLY | JS_DONTCONF)))
-		return 0;
-	if (ref->right->level)
-		if (!O_isFrozen_walk(J, ref->right))
-			return 0;
-	return 1;
+	js_copy(J, 1);
 }
 
 static void O_isFrozen(js_State *J)
 {
 	js_Object *obj;
+	int k;
 
 	if (!js_isobject(J, 1))
 		js_typeerror(J, "not an object");
@@ -479,10 +467,19 @@ static void O_isFrozen(js_State *J)
 		return;
 	}
 
-	if (obj->properties->level)
-		js_pushboolean(J, O_isFrozen_walk(J, obj->properties));
-	else
-		js_pushboolean(J, 1);
+	if (obj->type == JS_CARRAY && obj->u.a.simple && obj->u.a.flat_length > 0) {
+		js_pushboolean(J, 0);
+		return;
+	}
+
+	for (k = 0; k < obj->count; ++k) {
+		if (!(obj->properties[k].atts & (JS_READONLY | JS_DONTCONF))) {
+			js_pushboolean(J, 0);
+			return;
+		}
+	}
+
+	js_pushboolean(J, 1);
 }
 
 void jsB_initobject(js_State *J)
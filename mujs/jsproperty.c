@@ -2,178 +2,314 @@
 #include "jsvalue.h"
 
 /*
-	Use an AA-tree to quickly look up properties in objects:
+	Properties are stored in an array of slots in each object, and found
+	through the object's shape, which maps property names to slots.
 
-	The level of every leaf node is one.
-	The level of every left child is one less than its parent.
-	The level of every right child is equal or one less than its parent.
-	The level of every right grandchild is less than its grandparent.
-	Every node of level greater than one has two children.
+	Objects that had the same properties added in the same order share a
+	shape. The shapes form a tree rooted in the empty shape, where each
+	shape adds one property to its parent, so adding a property to an object
+	moves it to a child of its shape. An object with more than JS_SHAPELIMIT
+	properties, or one that has had a property deleted, gets a dictionary
+	instead: a shape of its own that is changed in place.
 
-	A link where the child's level is equal to that of its parent is called a horizontal link.
-	Individual right horizontal links are allowed, but consecutive ones are forbidden.
-	Left horizontal links are forbidden.
+	Shapes with more than JS_SHAPESCAN properties, and dictionaries, have a
+	hash table of slots. Smaller shapes are scanned. Property names are
+	interned, so a name is usually matched by comparing pointers.
 
-	skew() fixes left horizontal links.
-	split() fixes consecutive right horizontal links.
+	Properties are enumerated in the order of their names.
 */
 
-static js_Property sentinel = {
-	"",
-	&sentinel, &sentinel,
-	0, 0,
-	{ {0}, {0}, JS_TUNDEFINED },
-	NULL, NULL
-};
+static unsigned int hashname(const char *s)
+{
+	unsigned int h = 2166136261;
+	while (*s)
+		h = (h ^ *(unsigned char *)s++) * 16777619;
+	return h;
+}
 
-static js_Property *newproperty(js_State *J, js_Object *obj, const char *name)
+static int samename(js_Property *ref, const char *name, unsigned int hash)
 {
-	js_Property *node = js_malloc(J, sizeof *node);
-	node->name = js_intern(J, name);
-	node->left = node->right = &sentinel;
-	node->level = 1;
-	node->atts = 0;
-	node->value.type = JS_TUNDEFINED;
-	node->value.u.number = 0;
-	node->getter = NULL;
-	node->setter = NULL;
-	++obj->count;
-	return node;
+	return ref->hash == hash && (ref->name == name || !strcmp(ref->name, name));
 }
 
-static js_Property *lookup(js_Property *node, const char *name)
+static void tableinsert(js_Shape *sh, js_Property *slots, int k)
 {
-	while (node != &sentinel) {
-		int c = strcmp(name, node->name);
-		if (c == 0)
-			return node;
-		else if (c < 0)
-			node = node->left;
-		else
-			node = node->right;
+	int mask = sh->tablesize - 1;
+	int i = slots[k].hash & mask;
+	while (sh->table[i] >= 0)
+		i = (i + 1) & mask;
+	sh->table[i] = k;
+}
+
+/* Remove slot k, moving back the entries after it that would no longer be found */
+static void tableremove(js_Shape *sh, js_Property *slots, int k)
+{
+	int mask = sh->tablesize - 1;
+	int i = slots[k].hash & mask;
+	int j, h;
+	while (sh->table[i] != k)
+		i = (i + 1) & mask;
+	for (j = (i + 1) & mask; sh->table[j] >= 0; j = (j + 1) & mask) {
+		h = slots[sh->table[j]].hash & mask;
+		if (i < j ? (h <= i || h > j) : (h <= i && h > j)) {
+			sh->table[i] = sh->table[j];
+			i = j;
+		}
 	}
-	return NULL;
+	sh->table[i] = -1;
 }
 
-static js_Property *skew(js_Property *node)
+/* Hash the n slots into a table with room for at least twice as many as n + 1 */
+static void buildtable(js_State *J, js_Shape *sh, js_Property *slots, int n)
 {
-	if (node->left->level == node->level) {
-		js_Property *temp = node;
-		node = node->left;
-		temp->left = node->right;
-		node->right = temp;
+	int *table;
+	int size = 16;
+	int k;
+	while (size < (n + 1) * 2)
+		size *= 2;
+	table = js_malloc(J, size * sizeof *table);
+	memset(table, -1, size * sizeof *table);
+	js_free(J, sh->table);
+	sh->table = table;
+	sh->tablesize = size;
+	for (k = 0; k < n; ++k)
+		tableinsert(sh, slots, k);
+}
+
+static js_Shape *newshape(js_State *J, js_Shape *parent, const char *name)
+{
+	js_Shape *sh = js_malloc(J, sizeof *sh);
+	sh->parent = parent;
+	sh->kids = NULL;
+	sh->sibling = NULL;
+	sh->name = name;
+	sh->count = parent ? parent->count + 1 : 1;
+	sh->dictionary = 0;
+	sh->serial = 0;
+	sh->table = NULL;
+	sh->tablesize = 0;
+	sh->order = NULL;
+	sh->gcmark = JS_GCNEWMARK(J);
+	sh->gcnext = J->gcshape;
+	J->gcshape = sh;
+	return sh;
+}
+
+/* Give the object a shape of its own, which is not shared or looked up in the shape tree */
+static void makedictionary(js_State *J, js_Object *obj)
+{
+	js_Shape *sh = js_malloc(J, sizeof *sh);
+	sh->parent = sh->kids = sh->sibling = NULL;
+	sh->name = NULL;
+	sh->count = 0;
+	sh->dictionary = 1;
+	sh->serial = 0;
+	sh->table = NULL;
+	sh->order = NULL;
+	sh->gcmark = 0;
+	sh->gcnext = NULL;
+	if (js_try(J)) {
+		js_free(J, sh);
+		js_throw(J);
 	}
-	return node;
+	buildtable(J, sh, obj->properties, obj->count);
+	js_endtry(J);
+	obj->shape = sh;
 }
 
-static js_Property *split(js_Property *node)
+static int lookup(js_State *J, js_Object *obj, const char *name, unsigned int hash)
 {
-	if (node->right->right->level == node->level) {
-		js_Property *temp = node;
-		node = node->right;
-		temp->right = node->left;
-		node->left = temp;
-		++node->level;
+	js_Shape *sh = obj->shape;
+	js_Property *slots = obj->properties;
+	int i, k, mask;
+
+	if (!sh)
+		return -1;
+
+	if (!sh->table) {
+		if (obj->count <= JS_SHAPESCAN) {
+			for (k = 0; k < obj->count; ++k)
+				if (samename(&slots[k], name, hash))
+					return k;
+			return -1;
+		}
+		buildtable(J, sh, slots, obj->count);
 	}
-	return node;
+
+	mask = sh->tablesize - 1;
+	for (i = hash & mask; (k = sh->table[i]) >= 0; i = (i + 1) & mask)
+		if (samename(&slots[k], name, hash))
+			return k;
+	return -1;
 }
 
-static js_Property *insert(js_State *J, js_Object *obj, js_Property *node, const char *name, js_Property **result)
+static js_Property *insert(js_State *J, js_Object *obj, const char *name, unsigned int hash)
 {
-	if (node != &sentinel) {
-		int c = strcmp(name, node->name);
-		if (c < 0)
-			node->left = insert(J, obj, node->left, name, result);
-		else if (c > 0)
-			node->right = insert(J, obj, node->right, name, result);
+	js_Shape *sh, *kid, **kids, **prev;
+	js_Property *ref;
+
+	name = js_intern(J, name);
+
+	if (obj->count == obj->capacity) {
+		int cap = obj->capacity ? obj->capacity * 2 : 4;
+		obj->properties = js_realloc(J, obj->properties, cap * sizeof *obj->properties);
+		obj->capacity = cap;
+	}
+
+	if (obj->count >= JS_SHAPELIMIT && !obj->shape->dictionary)
+		makedictionary(J, obj);
+
+	sh = obj->shape;
+	if (sh && sh->dictionary) {
+		if ((obj->count + 1) * 2 > sh->tablesize)
+			buildtable(J, sh, obj->properties, obj->count);
+		js_free(J, sh->order);
+		sh->order = NULL;
+		++sh->serial;
+	} else {
+		/* follow the transition for this name, or make a new one */
+		kids = sh ? &sh->kids : &J->shapes;
+		for (prev = kids; (kid = *prev); prev = &kid->sibling)
+			if (kid->name == name)
+				break;
+		if (kid)
+			*prev = kid->sibling;
 		else
-			return *result = node;
-		node = skew(node);
-		node = split(node);
-		return node;
+			kid = newshape(J, sh, name);
+		kid->sibling = *kids;
+		*kids = kid;
+		obj->shape = kid;
+		jsG_barriershape(J, kid);
 	}
-	return *result = newproperty(J, obj, name);
+
+	ref = &obj->properties[obj->count++];
+	ref->name = name;
+	ref->hash = hash;
+	ref->atts = 0;
+	ref->value.type = JS_TUNDEFINED;
+	ref->value.u.number = 0;
+	ref->getter = NULL;
+	ref->setter = NULL;
+
+	if (sh && sh->dictionary)
+		tableinsert(sh, obj->properties, obj->count - 1);
+
+	return ref;
 }
 
-static void freeproperty(js_State *J, js_Object *obj, js_Property *node)
+static void delete(js_State *J, js_Object *obj, int k)
 {
-	js_free(J, node);
+	js_Property *slots;
+	js_Shape *sh;
+	int last, mask, i;
+
+	if (!obj->shape->dictionary)
+		makedictionary(J, obj);
+
+	sh = obj->shape;
+	slots = obj->properties;
+	last = obj->count - 1;
+
+	tableremove(sh, slots, k);
+	if (k != last) {
+		/* move the last slot into the hole */
+		mask = sh->tablesize - 1;
+		for (i = slots[last].hash & mask; sh->table[i] != last; i = (i + 1) & mask)
+			;
+		sh->table[i] = k;
+		slots[k] = slots[last];
+	}
 	--obj->count;
+
+	js_free(J, sh->order);
+	sh->order = NULL;
+	++sh->serial;
 }
 
-static js_Property *delete(js_State *J, js_Object *obj, js_Property *node, const char *name)
+static void siftdown(js_Property *slots, int *a, int i, int n)
 {
-	js_Property *temp, *succ;
-
-	if (node != &sentinel) {
-		int c = strcmp(name, node->name);
-		if (c < 0) {
-			node->left = delete(J, obj, node->left, name);
-		} else if (c > 0) {
-			node->right = delete(J, obj, node->right, name);
-		} else {
-			if (node->left == &sentinel) {
-				temp = node;
-				node = node->right;
-				freeproperty(J, obj, temp);
-			} else if (node->right == &sentinel) {
-				temp = node;
-				node = node->left;
-				freeproperty(J, obj, temp);
-			} else {
-				succ = node->right;
-				while (succ->left != &sentinel)
-					succ = succ->left;
-				node->name = succ->name;
-				node->atts = succ->atts;
-				node->value = succ->value;
-				node->right = delete(J, obj, node->right, succ->name);
-			}
-		}
+	int c, t;
+	while ((c = 2 * i + 1) < n) {
+		if (c + 1 < n && strcmp(slots[a[c]].name, slots[a[c + 1]].name) < 0)
+			++c;
+		if (strcmp(slots[a[i]].name, slots[a[c]].name) >= 0)
+			break;
+		t = a[i], a[i] = a[c], a[c] = t;
+		i = c;
+	}
+}
 
-		if (node->left->level < node->level - 1 ||
-			node->right->level < node->level - 1)
-		{
-			if (node->right->level > --node->level)
-				node->right->level = node->level;
-			node = skew(node);
-			node->right = skew(node->right);
-			node->right->right = skew(node->right->right);
-			node = split(node);
-			node->right = split(node->right);
+/* The slots of the properties in the order they are enumerated, kept in the shape until it changes */
+const int *jsV_propertyorder(js_State *J, js_Object *obj)
+{
+	js_Shape *sh = obj->shape;
+	int *a, i, t, n = obj->count;
+
+	if (n == 0)
+		return NULL;
+
+	if (!sh->order) {
+		a = js_malloc(J, n * sizeof *a);
+		for (i = 0; i < n; ++i)
+			a[i] = i;
+		for (i = n / 2 - 1; i >= 0; --i)
+			siftdown(obj->properties, a, i, n);
+		for (i = n - 1; i > 0; --i) {
+			t = a[0], a[0] = a[i], a[i] = t;
+			siftdown(obj->properties, a, 0, i);
 		}
+		sh->order = a;
 	}
-	return node;
+	return sh->order;
+}
+
+void jsV_freeshape(js_State *J, js_Shape *sh)
+{
+	js_free(J, sh->table);
+	js_free(J, sh->order);
+	js_free(J, sh);
 }
 
 js_Object *jsV_newobject(js_State *J, enum js_Class type, js_Object *prototype)
 {
-	js_Object *obj = js_malloc(J, sizeof *obj);
+	js_Object *obj;
+
+	/* Inherited elements are looked up among the properties */
+	if (prototype && prototype->type == JS_CARRAY)
+		jsV_unflattenarray(J, prototype);
+
+	obj = js_malloc(J, sizeof *obj);
 	memset(obj, 0, sizeof *obj);
-	obj->gcmark = 0;
+	obj->gcmark = JS_GCNEWMARK(J);
 	obj->gcnext = J->gcobj;
 	J->gcobj = obj;
 	++J->gccounter;
 
 	obj->type = type;
-	obj->properties = &sentinel;
+	obj->shape = NULL;
+	obj->properties = NULL;
 	obj->prototype = prototype;
 	obj->extensible = 1;
+	if (type == JS_CARRAY)
+		obj->u.a.simple = 1;
 	return obj;
 }
 
 js_Property *jsV_getownproperty(js_State *J, js_Object *obj, const char *name)
 {
-	return lookup(obj->properties, name);
+	int k = lookup(J, obj, name, hashname(name));
+	return k < 0 ? NULL : &obj->properties[k];
 }
 
 js_Property *jsV_getpropertyx(js_State *J, js_Object *obj, const char *name, int *own)
 {
+	unsigned int hash = hashname(name);
+	int k;
 	*own = 1;
 	do {
-		js_Property *ref = lookup(obj->properties, name);
-		if (ref)
-			return ref;
+		k = lookup(J, obj, name, hash);
+		if (k >= 0)
+			return &obj->properties[k];
 		obj = obj->prototype;
 		*own = 0;
 	} while (obj);
@@ -182,10 +318,12 @@ js_Property *jsV_getpropertyx(js_State *J, js_Object *obj, const char *name, int
 
 js_Property *jsV_getproperty(js_State *J, js_Object *obj, const char *name)
 {
+	unsigned int hash = hashname(name);
+	int k;
 	do {
-		js_Property *ref = lookup(obj->properties, name);
-		if (ref)
-			return ref;
+		k = lookup(J, obj, name, hash);
+		if (k >= 0)
+			return &obj->properties[k];
 		obj = obj->prototype;
 	} while (obj);
 	return NULL;
@@ -193,10 +331,12 @@ js_Property *jsV_getproperty(js_State *J, js_Object *obj, const char *name)
 
 static js_Property *jsV_getenumproperty(js_State *J, js_Object *obj, const char *name)
 {
+	unsigned int hash = hashname(name);
+	int k;
 	do {
-		js_Property *ref = lookup(obj->properties, name);
-		if (ref && !(ref->atts & JS_DONTENUM))
-			return ref;
+		k = lookup(J, obj, name, hash);
+		if (k >= 0 && !(obj->properties[k].atts & JS_DONTENUM))
+			return &obj->properties[k];
 		obj = obj->prototype;
 	} while (obj);
 	return NULL;
@@ -204,41 +344,46 @@ static js_Property *jsV_getenumproperty(js_State *J, js_Object *obj, const char
 
 js_Property *jsV_setproperty(js_State *J, js_Object *obj, const char *name)
 {
-	js_Property *result;
+	unsigned int hash = hashname(name);
+	int k = lookup(J, obj, name, hash);
+
+	if (k >= 0)
+		return &obj->properties[k];
 
 	if (!obj->extensible) {
-		result = lookup(obj->properties, name);
-		if (J->strict && !result)
+		if (J->strict)
 			js_typeerror(J, "object is non-extensible");
-		return result;
+		return NULL;
 	}
 
-	obj->properties = insert(J, obj, obj->properties, name, &result);
-
-	return result;
+	return insert(J, obj, name, hash);
 }
 
 void jsV_delproperty(js_State *J, js_Object *obj, const char *name)
 {
-	obj->properties = delete(J, obj, obj->properties, name);
+	int k = lookup(J, obj, name, hashname(name));
+	if (k >= 0)
+		delete(J, obj, k);
 }
 
 /* Flatten hierarchy of enumerable properties into an iterator object */
 
-static js_Iterator *itwalk(js_State *J, js_Iterator *iter, js_Property *prop, js_Object *seen)
+static js_Iterator *itwalk(js_State *J, js_Iterator *iter, js_Object *obj, js_Object *seen)
 {
-	if (prop->right != &sentinel)
-		iter = itwalk(J, iter, prop->right, seen);
-	if (!(prop->atts & JS_DONTENUM)) {
-		if (!seen || !jsV_getenumproperty(J, seen, prop->name)) {
-			js_Iterator *head = js_malloc(J, sizeof *head);
-			head->name = prop->name;
-			head->next = iter;
-			iter = head;
+	const int *order = jsV_propertyorder(J, obj);
+	js_Property *ref;
+	int i;
+	for (i = obj->count - 1; i >= 0; --i) {
+		ref = &obj->properties[order[i]];
+		if (!(ref->atts & JS_DONTENUM)) {
+			if (!seen || !jsV_getenumproperty(J, seen, ref->name)) {
+				js_Iterator *head = js_malloc(J, sizeof *head);
+				head->name = ref->name;
+				head->next = iter;
+				iter = head;
+			}
 		}
 	}
-	if (prop->left != &sentinel)
-		iter = itwalk(J, iter, prop->left, seen);
 	return iter;
 }
 
@@ -247,62 +392,47 @@ static js_Iterator *itflatten(js_State *J, js_Object *obj)
 	js_Iterator *iter = NULL;
 	if (obj->prototype)
 		iter = itflatten(J, obj->prototype);
-	if (obj->properties != &sentinel)
-		iter = itwalk(J, iter, obj->properties, obj->prototype);
-	return iter;
+	return itwalk(J, iter, obj, obj->prototype);
 }
 
 js_Object *jsV_newiterator(js_State *J, js_Object *obj, int own)
 {
-	char buf[32];
-	int k;
 	js_Object *io = jsV_newobject(J, JS_CITERATOR, NULL);
 	io->u.iter.target = obj;
-	if (own) {
-		io->u.iter.head = NULL;
-		if (obj->properties != &sentinel)
-			io->u.iter.head = itwalk(J, io->u.iter.head, obj->properties, NULL);
-	} else {
+	if (obj->type == JS_CARRAY && obj->u.a.simple)
+		io->u.iter.n = obj->u.a.flat_length;
+	if (obj->type == JS_CSTRING)
+		io->u.iter.n = obj->u.s.length;
+	if (own)
+		io->u.iter.head = itwalk(J, NULL, obj, NULL);
+	else
 		io->u.iter.head = itflatten(J, obj);
-	}
-	if (obj->type == JS_CSTRING) {
-		js_Iterator *tail = io->u.iter.head;
-		if (tail)
-			while (tail->next)
-				tail = tail->next;
-		for (k = 0; k < obj->u.s.length; ++k) {
-			js_itoa(buf, k);
-			if (!jsV_getenumproperty(J, obj, buf)) {
-				js_Iterator *node = js_malloc(J, sizeof *node);
-				node->name = js_intern(J, js_itoa(buf, k));
-				node->next = NULL;
-				if (!tail)
-					io->u.iter.head = tail = node;
-				else {
-					tail->next = node;
-					tail = node;
-				}
-			}
-		}
-	}
 	return io;
 }
 
 const char *jsV_nextiterator(js_State *J, js_Object *io)
 {
 	int k;
+	js_Object *target;
+	char buf[32];
 	if (io->type != JS_CITERATOR)
 		js_typeerror(J, "not an iterator");
+	target = io->u.iter.target;
+	while (io->u.iter.i < io->u.iter.n) {
+		k = io->u.iter.i++;
+		strcpy(io->u.iter.buf, js_itoa(buf, k));
+		if (target->type == JS_CSTRING)
+			return io->u.iter.buf;
+		if (target->u.a.simple ? k < target->u.a.flat_length : jsV_getproperty(J, target, io->u.iter.buf) != NULL)
+			return io->u.iter.buf;
+	}
 	while (io->u.iter.head) {
 		js_Iterator *next = io->u.iter.head->next;
 		const char *name = io->u.iter.head->name;
 		js_free(J, io->u.iter.head);
 		io->u.iter.head = next;
-		if (jsV_getproperty(J, io->u.iter.target, name))
+		if (jsV_getproperty(J, target, name))
 			return name;
-		if (io->u.iter.target->type == JS_CSTRING)
-			if (js_isarrayindex(J, name, &k) && k < io->u.iter.target->u.s.length)
-				return name;
 	}
 	return NULL;
 }
@@ -314,7 +444,10 @@ void jsV_resizearray(js_State *J, js_Object *obj, int newlen)
 	char buf[32];
 	const char *s;
 	int k;
-	if (newlen < obj->u.a.length) {
+	if (obj->u.a.simple) {
+		if (newlen < obj->u.a.flat_length)
+			obj->u.a.flat_length = newlen;
+	} else if (newlen < obj->u.a.length) {
 		if (obj->u.a.length > obj->count * 2) {
 			js_Object *it = jsV_newiterator(J, obj, 1);
 			while ((s = jsV_nextiterator(J, it))) {
@@ -330,3 +463,57 @@ void jsV_resizearray(js_State *J, js_Object *obj, int newlen)
 	}
 	obj->u.a.length = newlen;
 }
+
+/* Dense storage for arrays without holes, see jsV_unflattenarray */
+
+void jsV_growarray(js_State *J, js_Object *obj, int n)
+{
+	int cap = obj->u.a.flat_capacity;
+	if (n <= cap)
+		return;
+	if (cap < 8)
+		cap = 8;
+	while (cap < n)
+		cap = cap > JS_ARRAYLIMIT / 2 ? JS_ARRAYLIMIT : cap * 2;
+	obj->u.a.array = js_realloc(J, obj->u.a.array, cap * sizeof *obj->u.a.array);
+	obj->u.a.flat_capacity = cap;
+}
+
+/* Move the elements into the properties, once the array has holes or elements with attributes */
+
+void jsV_unflattenarray(js_State *J, js_Object *obj)
+{
+	char buf[32];
+	js_Property *ref;
+	int volatile k = 0;
+
+	if (!obj->u.a.simple)
+		return;
+
+	if (js_try(J)) {
+		while (k > 0)
+			jsV_delproperty(J, obj, js_itoa(buf, --k));
+		js_throw(J);
+	}
+	for (; k < obj->u.a.flat_length; ++k) {
+		js_itoa(buf, k);
+		ref = insert(J, obj, buf, hashname(buf));
+		ref->value = obj->u.a.array[k];
+	}
+	js_endtry(J);
+
+	js_free(J, obj->u.a.array);
+	obj->u.a.array = NULL;
+	obj->u.a.flat_length = 0;
+	obj->u.a.flat_capacity = 0;
+	obj->u.a.simple = 0;
+}
+
+js_Value *jsV_getflatindex(js_State *J, js_Object *obj, const char *name)
+{
+	int k;
+	if (obj->type == JS_CARRAY && obj->u.a.simple)
+		if (js_isarrayindex(J, name, &k) && k < obj->u.a.flat_length)
+			return &obj->u.a.array[k];
+	return NULL;
+}
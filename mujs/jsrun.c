@@ -60,16 +60,73 @@ void js_free(js_State *J, void *ptr)
 
 js_String *jsV_newmemstring(js_State *J, const char *s, int n)
 {
-	js_String *v = js_malloc(J, soffsetof(js_String, p) + n + 1);
-	memcpy(v->p, s, n);
-	v->p[n] = 0;
-	v->gcmark = 0;
+	js_String *v = js_malloc(J, soffsetof(js_String, data) + n + 1);
+	int i;
+	memcpy(v->data, s, n);
+	v->data[n] = 0;
+	v->p = v->data;
+	v->left = v->right = NULL;
+	v->size = n;
+	for (i = 0; i < n; ++i)
+		if (s[i] & 0x80)
+			break;
+	v->ascii = i == n;
+	v->length = v->ascii ? n : -1;
+	v->runes.step = NULL;
+	v->runes.cursor = v->runes.offset = 0;
+	v->gcmark = JS_GCNEWMARK(J);
+	v->gcnext = J->gcstr;
+	J->gcstr = v;
+	++J->gccounter;
+	return v;
+}
+
+js_String *jsV_newropestring(js_State *J, js_String *a, js_String *b)
+{
+	js_String *v = js_malloc(J, soffsetof(js_String, data) + 1);
+	v->p = NULL;
+	v->left = a;
+	v->right = b;
+	v->size = a->size + b->size;
+	v->ascii = a->ascii && b->ascii;
+	v->length = a->length >= 0 && b->length >= 0 ? a->length + b->length : -1;
+	v->runes.step = NULL;
+	v->runes.cursor = v->runes.offset = 0;
+	v->gcmark = JS_GCNEWMARK(J);
 	v->gcnext = J->gcstr;
 	J->gcstr = v;
 	++J->gccounter;
 	return v;
 }
 
+/* Recurse into the smaller operand only, so the depth is logarithmic however lopsided the tree is */
+static void jsV_flattenrope(js_String *v, char *out)
+{
+	while (!v->p) {
+		if (v->left->size < v->right->size) {
+			jsV_flattenrope(v->left, out);
+			out += v->left->size;
+			v = v->right;
+		} else {
+			jsV_flattenrope(v->right, out + v->left->size);
+			v = v->left;
+		}
+	}
+	memcpy(out, v->p, v->size);
+}
+
+const char *jsV_flatstring(js_State *J, js_String *v)
+{
+	if (!v->p) {
+		char *p = js_malloc(J, v->size + 1);
+		jsV_flattenrope(v, p);
+		p[v->size] = 0;
+		v->p = p;
+		v->left = v->right = NULL;
+	}
+	return v->p;
+}
+
 #define CHECKSTACK(n) if (TOP + n >= JS_STACKSIZE) js_stackoverflow(J)
 
 void js_pushvalue(js_State *J, js_Value v)
@@ -437,6 +494,9 @@ void js_rot(js_State *J, int n)
 int js_isarrayindex(js_State *J, const char *p, int *idx)
 {
 	int n = 0;
+	/* only the canonical form of a number is an index */
+	if (p[0] == 0 || (p[0] == '0' && p[1] != 0))
+		return 0;
 	while (*p) {
 		int c = *p++;
 		if (c >= '0' && c <= '9') {
@@ -461,6 +521,22 @@ static void js_pushrune(js_State *J, Rune rune)
 	}
 }
 
+/* Rune k of a String object, looked up through the js_String or literal cache of its string */
+static int jsR_stringobjectrune(js_State *J, js_Object *obj, int k)
+{
+	js_Value v;
+	if (obj->u.s.memstr) {
+		v.type = JS_TMEMSTR;
+		v.u.memstr = obj->u.s.memstr;
+	} else if (obj->u.s.string == obj->u.s.shrstr) {
+		return js_runeat(J, obj->u.s.string, k);
+	} else {
+		v.type = JS_TLITSTR;
+		v.u.litstr = obj->u.s.string;
+	}
+	return jsV_runeat(J, &v, k);
+}
+
 static int jsR_hasproperty(js_State *J, js_Object *obj, const char *name)
 {
 	js_Property *ref;
@@ -471,6 +547,12 @@ static int jsR_hasproperty(js_State *J, js_Object *obj, const char *name)
 			js_pushnumber(J, obj->u.a.length);
 			return 1;
 		}
+		if (obj->u.a.simple && js_isarrayindex(J, name, &k)) {
+			if (k < obj->u.a.flat_length) {
+				js_pushvalue(J, obj->u.a.array[k]);
+				return 1;
+			}
+		}
 	}
 
 	else if (obj->type == JS_CSTRING) {
@@ -480,7 +562,7 @@ static int jsR_hasproperty(js_State *J, js_Object *obj, const char *name)
 		}
 		if (js_isarrayindex(J, name, &k)) {
 			if (k >= 0 && k < obj->u.s.length) {
-				js_pushrune(J, js_runeat(J, obj->u.s.string, k));
+				js_pushrune(J, jsR_stringobjectrune(J, obj, k));
 				return 1;
 			}
 		}
@@ -488,7 +570,7 @@ static int jsR_hasproperty(js_State *J, js_Object *obj, const char *name)
 
 	else if (obj->type == JS_CREGEXP) {
 		if (!strcmp(name, "source")) {
-			js_pushliteral(J, obj->u.r.source);
+			js_pushstring(J, obj->u.r.source);
 			return 1;
 		}
 		if (!strcmp(name, "global")) {
@@ -535,6 +617,25 @@ static void jsR_getproperty(js_State *J, js_Object *obj, const char *name)
 		js_pushundefined(J);
 }
 
+/* Store into the dense elements of a simple array, unless that would leave a hole */
+static int jsR_setflatindex(js_State *J, js_Object *obj, int k, js_Value *value)
+{
+	if (k < obj->u.a.flat_length) {
+		obj->u.a.array[k] = *value;
+		jsG_barrier(J, value);
+		return 1;
+	}
+	if (k == obj->u.a.flat_length && k < JS_ARRAYLIMIT && obj->extensible) {
+		jsV_growarray(J, obj, k + 1);
+		obj->u.a.array[obj->u.a.flat_length++] = *value;
+		jsG_barrier(J, value);
+		if (k >= obj->u.a.length)
+			obj->u.a.length = k + 1;
+		return 1;
+	}
+	return 0;
+}
+
 static void jsR_setproperty(js_State *J, js_Object *obj, const char *name)
 {
 	js_Value *value = stackidx(J, -1);
@@ -551,9 +652,16 @@ static void jsR_setproperty(js_State *J, js_Object *obj, const char *name)
 			jsV_resizearray(J, obj, newlen);
 			return;
 		}
-		if (js_isarrayindex(J, name, &k))
+		if (js_isarrayindex(J, name, &k)) {
+			if (obj->u.a.simple) {
+				if (jsR_setflatindex(J, obj, k, value))
+					return;
+				if (obj->extensible)
+					jsV_unflattenarray(J, obj);
+			}
 			if (k >= obj->u.a.length)
 				obj->u.a.length = k + 1;
+		}
 	}
 
 	else if (obj->type == JS_CSTRING) {
@@ -602,9 +710,10 @@ static void jsR_setproperty(js_State *J, js_Object *obj, const char *name)
 		ref = jsV_setproperty(J, obj, name);
 
 	if (ref) {
-		if (!(ref->atts & JS_READONLY))
+		if (!(ref->atts & JS_READONLY)) {
 			ref->value = *value;
-		else
+			jsG_barrier(J, value);
+		} else
 			goto readonly;
 	}
 
@@ -624,6 +733,8 @@ static void jsR_defproperty(js_State *J, js_Object *obj, const char *name,
 	if (obj->type == JS_CARRAY) {
 		if (!strcmp(name, "length"))
 			goto readonly;
+		if (obj->u.a.simple && js_isarrayindex(J, name, &k))
+			jsV_unflattenarray(J, obj);
 	}
 
 	else if (obj->type == JS_CSTRING) {
@@ -650,21 +761,24 @@ static void jsR_defproperty(js_State *J, js_Object *obj, const char *name,
 	ref = jsV_setproperty(J, obj, name);
 	if (ref) {
 		if (value) {
-			if (!(ref->atts & JS_READONLY))
+			if (!(ref->atts & JS_READONLY)) {
 				ref->value = *value;
-			else if (J->strict)
+				jsG_barrier(J, value);
+			} else if (J->strict)
 				js_typeerror(J, "'%s' is read-only", name);
 		}
 		if (getter) {
-			if (!(ref->atts & JS_DONTCONF))
+			if (!(ref->atts & JS_DONTCONF)) {
 				ref->getter = getter;
-			else if (J->strict)
+				jsG_barrierobject(J, getter);
+			} else if (J->strict)
 				js_typeerror(J, "'%s' is non-configurable", name);
 		}
 		if (setter) {
-			if (!(ref->atts & JS_DONTCONF))
+			if (!(ref->atts & JS_DONTCONF)) {
 				ref->setter = setter;
-			else if (J->strict)
+				jsG_barrierobject(J, setter);
+			} else if (J->strict)
 				js_typeerror(J, "'%s' is non-configurable", name);
 		}
 		ref->atts |= atts;
@@ -685,6 +799,15 @@ static int jsR_delproperty(js_State *J, js_Object *obj, const char *name)
 	if (obj->type == JS_CARRAY) {
 		if (!strcmp(name, "length"))
 			goto dontconf;
+		if (obj->u.a.simple && js_isarrayindex(J, name, &k)) {
+			/* removing the last element leaves no hole */
+			if (k == obj->u.a.flat_length - 1) {
+				--obj->u.a.flat_length;
+				return 1;
+			}
+			if (k < obj->u.a.flat_length)
+				jsV_unflattenarray(J, obj);
+		}
 	}
 
 	else if (obj->type == JS_CSTRING) {
@@ -819,6 +942,133 @@ int js_hasproperty(js_State *J, int idx, const char *name)
 	return jsR_hasproperty(J, js_toobject(J, idx), name);
 }
 
+/* Integer keys that skip formatting the index for arrays, strings and indexed userdata */
+
+static int jsR_isindex(js_State *J, int idx, int *k)
+{
+	js_Value *v = stackidx(J, idx);
+	if (v->type == JS_TNUMBER && v->u.number >= 0 && v->u.number <= INT_MAX) {
+		*k = v->u.number;
+		return *k == v->u.number;
+	}
+	return 0;
+}
+
+static int jsR_hasindex(js_State *J, js_Object *obj, int k)
+{
+	char buf[32];
+	if (obj->type == JS_CARRAY) {
+		if (obj->u.a.simple && k >= 0 && k < obj->u.a.flat_length) {
+			js_pushvalue(J, obj->u.a.array[k]);
+			return 1;
+		}
+	}
+	else if (obj->type == JS_CSTRING) {
+		if (k >= 0 && k < obj->u.s.length) {
+			js_pushrune(J, jsR_stringobjectrune(J, obj, k));
+			return 1;
+		}
+	}
+	else if (obj->type == JS_CUSERDATA) {
+		if (obj->u.user.index && k >= 0 && obj->u.user.index(J, obj->u.user.data, JS_INDEX_HAS, k))
+			return 1;
+	}
+	return jsR_hasproperty(J, obj, js_itoa(buf, k));
+}
+
+/* Index a primitive string without wrapping it in a String object */
+static int jsR_hasstringindex(js_State *J, int idx, int k)
+{
+	js_Value *v = stackidx(J, idx);
+	if (k < jsV_stringlength(J, v)) {
+		js_pushrune(J, jsV_runeat(J, v, k));
+		return 1;
+	}
+	return 0;
+}
+
+/* Read a property of a primitive string without wrapping it in a String object, unless a getter needs one */
+static int jsR_getstringproperty(js_State *J, int idx, const char *name)
+{
+	js_Property *ref;
+	int k;
+
+	if (!strcmp(name, "length")) {
+		js_pushnumber(J, jsV_stringlength(J, stackidx(J, idx)));
+		return 1;
+	}
+	if (js_isarrayindex(J, name, &k))
+		if (jsR_hasstringindex(J, idx, k))
+			return 1;
+
+	ref = jsV_getproperty(J, J->String_prototype, name);
+	if (ref && ref->getter)
+		return 0;
+	if (ref)
+		js_pushvalue(J, ref->value);
+	else
+		js_pushundefined(J);
+	return 1;
+}
+
+static void jsR_getindex(js_State *J, js_Object *obj, int k)
+{
+	if (!jsR_hasindex(J, obj, k))
+		js_pushundefined(J);
+}
+
+static void jsR_setindex(js_State *J, js_Object *obj, int k)
+{
+	char buf[32];
+	if (obj->type == JS_CARRAY) {
+		if (obj->u.a.simple && k >= 0 && jsR_setflatindex(J, obj, k, stackidx(J, -1)))
+			return;
+	}
+	else if (obj->type == JS_CUSERDATA) {
+		if (obj->u.user.index && k >= 0 && obj->u.user.index(J, obj->u.user.data, JS_INDEX_PUT, k))
+			return;
+	}
+	jsR_setproperty(J, obj, js_itoa(buf, k));
+}
+
+static int jsR_delindex(js_State *J, js_Object *obj, int k)
+{
+	char buf[32];
+	if (obj->type == JS_CARRAY) {
+		/* removing the last element leaves no hole */
+		if (obj->u.a.simple && k >= 0 && k == obj->u.a.flat_length - 1) {
+			--obj->u.a.flat_length;
+			return 1;
+		}
+	}
+	else if (obj->type == JS_CUSERDATA) {
+		if (obj->u.user.index && k >= 0 && obj->u.user.index(J, obj->u.user.data, JS_INDEX_DELETE, k))
+			return 1;
+	}
+	return jsR_delproperty(J, obj, js_itoa(buf, k));
+}
+
+int js_hasindex(js_State *J, int idx, int i)
+{
+	return jsR_hasindex(J, js_toobject(J, idx), i);
+}
+
+void js_getindex(js_State *J, int idx, int i)
+{
+	jsR_getindex(J, js_toobject(J, idx), i);
+}
+
+void js_setindex(js_State *J, int idx, int i)
+{
+	jsR_setindex(J, js_toobject(J, idx), i);
+	js_pop(J, 1);
+}
+
+void js_delindex(js_State *J, int idx, int i)
+{
+	jsR_delindex(J, js_toobject(J, idx), i);
+}
+
 /* Iterator */
 
 void js_pushiterator(js_State *J, int idx, int own)
@@ -836,16 +1086,49 @@ const char *js_nextiterator(js_State *J, int idx)
 js_Environment *jsR_newenvironment(js_State *J, js_Object *vars, js_Environment *outer)
 {
 	js_Environment *E = js_malloc(J, sizeof *E);
-	E->gcmark = 0;
+	E->gcmark = JS_GCNEWMARK(J);
 	E->gcnext = J->gcenv;
 	J->gcenv = E;
 	++J->gccounter;
 
 	E->outer = outer;
 	E->variables = vars;
+	E->function = NULL;
+	E->slots = NULL;
+	return E;
+}
+
+js_Environment *jsR_newrecord(js_State *J, js_Function *F, js_Environment *outer)
+{
+	js_Environment *E = js_malloc(J, sizeof *E + F->uplen * sizeof *E->slots);
+	int i;
+	E->gcmark = JS_GCNEWMARK(J);
+	E->gcnext = J->gcenv;
+	J->gcenv = E;
+	++J->gccounter;
+
+	E->outer = outer;
+	E->variables = NULL;
+	E->function = F;
+	E->slots = (js_Value*)(E + 1);
+	for (i = 0; i < F->uplen; ++i) {
+		E->slots[i].type = JS_TUNDEFINED;
+		E->slots[i].u.number = 0;
+	}
 	return E;
 }
 
+/* Code compiled at run time, such as eval, can only find the variables in records by name */
+static js_Value *jsR_findupvar(js_Environment *E, const char *name)
+{
+	js_Function *F = E->function;
+	int i;
+	for (i = F->uplen; i > 0; --i)
+		if (!strcmp(F->uptab[i-1], name))
+			return &E->slots[i-1];
+	return NULL;
+}
+
 static void js_initvar(js_State *J, const char *name, int idx)
 {
 	jsR_defproperty(J, J->E->variables, name, JS_DONTENUM | JS_DONTCONF, stackidx(J, idx), NULL, NULL);
@@ -860,7 +1143,17 @@ static int js_hasvar(js_State *J, const char *name)
 {
 	js_Environment *E = J->E;
 	do {
-		js_Property *ref = jsV_getproperty(J, E->variables, name);
+		js_Property *ref;
+		if (!E->variables) {
+			js_Value *slot = jsR_findupvar(E, name);
+			if (slot) {
+				js_pushvalue(J, *slot);
+				return 1;
+			}
+			E = E->outer;
+			continue;
+		}
+		ref = jsV_getproperty(J, E->variables, name);
 		if (ref) {
 			if (ref->getter) {
 				js_pushobject(J, ref->getter);
@@ -880,7 +1173,18 @@ static void js_setvar(js_State *J, const char *name)
 {
 	js_Environment *E = J->E;
 	do {
-		js_Property *ref = jsV_getproperty(J, E->variables, name);
+		js_Property *ref;
+		if (!E->variables) {
+			js_Value *slot = jsR_findupvar(E, name);
+			if (slot) {
+				*slot = *stackidx(J, -1);
+				jsG_barrier(J, slot);
+				return;
+			}
+			E = E->outer;
+			continue;
+		}
+		ref = jsV_getproperty(J, E->variables, name);
 		if (ref) {
 			if (ref->setter) {
 				js_pushobject(J, ref->setter);
@@ -890,9 +1194,10 @@ static void js_setvar(js_State *J, const char *name)
 				js_pop(J, 1);
 				return;
 			}
-			if (!(ref->atts & JS_READONLY))
+			if (!(ref->atts & JS_READONLY)) {
 				ref->value = *stackidx(J, -1);
-			else if (J->strict)
+				jsG_barrier(J, &ref->value);
+			} else if (J->strict)
 				js_typeerror(J, "'%s' is read-only", name);
 			return;
 		}
@@ -907,7 +1212,14 @@ static int js_delvar(js_State *J, const char *name)
 {
 	js_Environment *E = J->E;
 	do {
-		js_Property *ref = jsV_getownproperty(J, E->variables, name);
+		js_Property *ref;
+		if (!E->variables) {
+			if (jsR_findupvar(E, name))
+				return 0;
+			E = E->outer;
+			continue;
+		}
+		ref = jsV_getownproperty(J, E->variables, name);
 		if (ref) {
 			if (ref->atts & JS_DONTCONF) {
 				if (J->strict)
@@ -922,6 +1234,185 @@ static int js_delvar(js_State *J, const char *name)
 	return jsR_delproperty(J, J->G, name);
 }
 
+/* Inline caches */
+
+/* Some classes keep properties outside the slots, and their lookups cannot be cached */
+static int jsR_iscacheable(js_Object *obj, const char *name)
+{
+	switch (obj->type) {
+	case JS_CARRAY:
+	case JS_CSTRING:
+		return strcmp(name, "length") != 0;
+	case JS_CREGEXP:
+	case JS_CUSERDATA:
+		return 0;
+	default:
+		return 1;
+	}
+}
+
+static int jsR_sameshape(js_Object *obj, js_InlineCache *c, int i)
+{
+	if (obj->shape != c->shape[i])
+		return 0;
+	return !obj->shape || obj->shape->serial == c->serial[i];
+}
+
+static void jsR_cacheshape(js_Object *obj, js_InlineCache *c, int i)
+{
+	c->shape[i] = obj->shape;
+	c->serial[i] = obj->shape ? obj->shape->serial : 0;
+}
+
+/* Find the property the cache remembers for obj, if obj and its prototypes still have the shapes it saw */
+static js_Property *jsR_cachedproperty(js_State *J, js_Object *obj, js_InlineCache *c)
+{
+	int i;
+	if (c->depth == 0 || (int)obj->type != c->type)
+		return NULL;
+	for (i = 0; obj && jsR_sameshape(obj, c, i); obj = obj->prototype)
+		if (++i == c->depth)
+			return &obj->properties[c->slot];
+	return NULL;
+}
+
+static void jsR_getcachedproperty(js_State *J, js_Object *obj, const char *name, js_InlineCache *c)
+{
+	js_Property *ref = jsR_cachedproperty(J, obj, c);
+	js_Object *o;
+	int i;
+
+	if (ref) {
+		++J->cachehits;
+	} else {
+		++J->cachemisses;
+		if (!jsR_iscacheable(obj, name)) {
+			jsR_getproperty(J, obj, name);
+			return;
+		}
+		c->depth = 0;
+		for (i = 0, o = obj; o && !ref; ++i, o = o->prototype) {
+			if (i == JS_CACHEDEPTH) {
+				/* too deep to cache, so continue the lookup from here */
+				ref = jsV_getproperty(J, o, name);
+				break;
+			}
+			jsR_cacheshape(o, c, i);
+			ref = jsV_getownproperty(J, o, name);
+			if (ref) {
+				c->type = obj->type;
+				c->slot = ref - o->properties;
+				c->depth = i + 1;
+			}
+		}
+		if (!ref) {
+			js_pushundefined(J);
+			return;
+		}
+	}
+
+	if (ref->getter) {
+		js_pushobject(J, ref->getter);
+		js_pushobject(J, obj);
+		js_call(J, 0);
+	} else {
+		js_pushvalue(J, ref->value);
+	}
+}
+
+static void jsR_setcachedproperty(js_State *J, js_Object *obj, const char *name, js_InlineCache *c)
+{
+	js_Property *ref = jsR_cachedproperty(J, obj, c);
+
+	/* only plain writable own properties are cached */
+	if (ref && !ref->getter && !ref->setter && !(ref->atts & JS_READONLY)) {
+		++J->cachehits;
+		ref->value = *stackidx(J, -1);
+		jsG_barrier(J, &ref->value);
+		return;
+	}
+
+	++J->cachemisses;
+	jsR_setproperty(J, obj, name);
+	c->depth = 0;
+	if (jsR_iscacheable(obj, name)) {
+		ref = jsV_getownproperty(J, obj, name);
+		if (ref) {
+			jsR_cacheshape(obj, c, 0);
+			c->type = obj->type;
+			c->slot = ref - obj->properties;
+			c->depth = 1;
+		}
+	}
+}
+
+/*
+	Variables are cached only through environments without prototypes,
+	which rules out most 'with' statements. Environment records are
+	skipped: an instruction always sees records of the same functions,
+	and their names never change.
+*/
+static int jsR_hascachedvar(js_State *J, const char *name, js_InlineCache *c)
+{
+	js_Environment *E;
+	js_Object *vars;
+	js_Property *ref = NULL;
+	int i;
+
+	for (i = 0, E = J->E; i < c->depth && E; E = E->outer) {
+		vars = E->variables;
+		if (!vars)
+			continue;
+		if (vars->prototype || !jsR_sameshape(vars, c, i))
+			break;
+		if (++i == c->depth) {
+			++J->cachehits;
+			ref = &vars->properties[c->slot];
+			goto found;
+		}
+	}
+
+	++J->cachemisses;
+	c->depth = 0;
+	for (i = 0, E = J->E; i < JS_CACHEDEPTH && E; E = E->outer) {
+		vars = E->variables;
+		if (!vars) {
+			if (jsR_findupvar(E, name))
+				break;
+			continue;
+		}
+		if (vars->prototype)
+			break;
+		jsR_cacheshape(vars, c, i);
+		ref = jsV_getownproperty(J, vars, name);
+		if (ref) {
+			c->slot = ref - vars->properties;
+			c->depth = i + 1;
+			goto found;
+		}
+		++i;
+	}
+	return js_hasvar(J, name);
+
+found:
+	if (ref->getter) {
+		js_pushobject(J, ref->getter);
+		js_pushobject(J, vars);
+		js_call(J, 0);
+	} else {
+		js_pushvalue(J, ref->value);
+	}
+	return 1;
+}
+
+void js_cachestats(js_State *J, unsigned long *hits, unsigned long *misses)
+{
+	if (hits)
+		*hits = J->cachehits;
+	if (misses)
+		*misses = J->cachemisses;
+}
+
 /* Function calls */
 
 static void jsR_savescope(js_State *J, js_Environment *newE)
@@ -937,13 +1428,38 @@ static void jsR_restorescope(js_State *J)
 	J->E = J->envstack[--J->envtop];
 }
 
+static void jsR_pusharguments(js_State *J, int n)
+{
+	int i;
+	js_newobject(J);
+	if (!J->strict) {
+		js_currentfunction(J);
+		js_defproperty(J, -2, "callee", JS_DONTENUM);
+	}
+	js_pushnumber(J, n);
+	js_defproperty(J, -2, "length", JS_DONTENUM);
+	for (i = 0; i < n; ++i) {
+		js_copy(J, i + 1);
+		js_setindex(J, -2, i);
+	}
+}
+
 static void jsR_calllwfunction(js_State *J, int n, js_Function *F, js_Environment *scope)
 {
-	js_Value v;
+	js_Value v, arguments;
 	int i;
 
+	if (F->record)
+		scope = jsR_newrecord(J, F, scope);
+
 	jsR_savescope(J, scope);
 
+	if (F->arguments) {
+		jsR_pusharguments(J, n);
+		arguments = *stackidx(J, -1);
+		js_pop(J, 1);
+	}
+
 	if (n > F->numparams) {
 		js_pop(J, n - F->numparams);
 		n = F->numparams;
@@ -951,6 +1467,10 @@ static void jsR_calllwfunction(js_State *J, int n, js_Function *F, js_Environmen
 	for (i = n; i < F->varlen; ++i)
 		js_pushundefined(J);
 
+	/* the local after the parameters */
+	if (F->arguments)
+		STACK[BOT + F->numparams + 1] = arguments;
+
 	jsR_run(J, F);
 	v = *stackidx(J, -1);
 	TOP = --BOT; /* clear stack */
@@ -969,17 +1489,7 @@ static void jsR_callfunction(js_State *J, int n, js_Function *F, js_Environment
 	jsR_savescope(J, scope);
 
 	if (F->arguments) {
-		js_newobject(J);
-		if (!J->strict) {
-			js_currentfunction(J);
-			js_defproperty(J, -2, "callee", JS_DONTENUM);
-		}
-		js_pushnumber(J, n);
-		js_defproperty(J, -2, "length", JS_DONTENUM);
-		for (i = 0; i < n; ++i) {
-			js_copy(J, i + 1);
-			js_setindex(J, -2, i);
-		}
+		jsR_pusharguments(J, n);
 		js_initvar(J, "arguments", -1);
 		js_pop(J, 1);
 	}
@@ -1239,8 +1749,19 @@ static void jsR_dumpstack(js_State *J)
 
 static void jsR_dumpenvironment(js_State *J, js_Environment *E, int d)
 {
+	int i;
 	printf("scope %d ", d);
-	js_dumpobject(J, E->variables);
+	if (E->variables) {
+		js_dumpobject(J, E->variables);
+	} else {
+		printf("{\n");
+		for (i = 0; i < E->function->uplen; ++i) {
+			printf("\t%s: ", E->function->uptab[i]);
+			js_dumpvalue(J, E->slots[i]);
+			printf(",\n");
+		}
+		printf("}\n");
+	}
 	if (E->outer)
 		jsR_dumpenvironment(J, E->outer, d+1);
 }
@@ -1280,6 +1801,7 @@ static void jsR_run(js_State *J, js_Function *F)
 	js_Function **FT = F->funtab;
 	double *NT = F->numtab;
 	const char **ST = F->strtab;
+	js_InlineCache *CT = F->cachetab;
 	js_Instruction *pcstart = F->code;
 	js_Instruction *pc = F->code;
 	enum js_OpCode opcode;
@@ -1288,18 +1810,19 @@ static void jsR_run(js_State *J, js_Function *F)
 
 	const char *str;
 	js_Object *obj;
+	js_Environment *env;
 	double x, y;
 	unsigned int ux, uy;
 	int ix, iy, okay;
-	int b;
+	int b, k;
 
 	savestrict = J->strict;
 	J->strict = F->strict;
 
 	while (1) {
-		if (J->gccounter > JS_GCLIMIT) {
+		if (J->gccounter > (J->gcstate == JS_GCPAUSE ? JS_GCLIMIT : JS_GCSTEP)) {
 			J->gccounter = 0;
-			js_gc(J, 0);
+			js_gcstep(J, JS_GCSTEPWORK);
 		}
 
 		opcode = *pc++;
@@ -1361,6 +1884,20 @@ static void jsR_run(js_State *J, js_Function *F)
 			js_pushboolean(J, 0);
 			break;
 
+		case OP_GETUPVAR:
+			for (env = J->E, k = *pc++; k > 0; --k)
+				env = env->outer;
+			CHECKSTACK(1);
+			STACK[TOP++] = env->slots[*pc++];
+			break;
+
+		case OP_SETUPVAR:
+			for (env = J->E, k = *pc++; k > 0; --k)
+				env = env->outer;
+			env->slots[*pc++] = STACK[TOP-1];
+			jsG_barrier(J, &STACK[TOP-1]);
+			break;
+
 		case OP_INITVAR:
 			js_initvar(J, ST[*pc++], -1);
 			js_pop(J, 1);
@@ -1372,7 +1909,7 @@ static void jsR_run(js_State *J, js_Function *F)
 
 		case OP_GETVAR:
 			str = ST[*pc++];
-			if (!js_hasvar(J, str))
+			if (!jsR_hascachedvar(J, str, &CT[*pc++]))
 				js_referenceerror(J, "'%s' is not defined", str);
 			break;
 
@@ -1401,8 +1938,12 @@ static void jsR_run(js_State *J, js_Function *F)
 
 		case OP_INITPROP:
 			obj = js_toobject(J, -3);
-			str = js_tostring(J, -2);
-			jsR_setproperty(J, obj, str);
+			if (jsR_isindex(J, -2, &k)) {
+				jsR_setindex(J, obj, k);
+			} else {
+				str = js_tostring(J, -2);
+				jsR_setproperty(J, obj, str);
+			}
 			js_pop(J, 2);
 			break;
 
@@ -1421,37 +1962,59 @@ static void jsR_run(js_State *J, js_Function *F)
 			break;
 
 		case OP_GETPROP:
-			str = js_tostring(J, -1);
-			obj = js_toobject(J, -2);
-			jsR_getproperty(J, obj, str);
+			if (jsR_isindex(J, -1, &k)) {
+				if (!js_isstring(J, -2) || !jsR_hasstringindex(J, -2, k)) {
+					obj = js_toobject(J, -2);
+					jsR_getindex(J, obj, k);
+				}
+			} else {
+				str = js_tostring(J, -1);
+				if (!js_isstring(J, -2) || !jsR_getstringproperty(J, -2, str)) {
+					obj = js_toobject(J, -2);
+					jsR_getproperty(J, obj, str);
+				}
+			}
 			js_rot3pop2(J);
 			break;
 
 		case OP_GETPROP_S:
 			str = ST[*pc++];
-			obj = js_toobject(J, -1);
-			jsR_getproperty(J, obj, str);
+			k = *pc++;
+			if (!js_isstring(J, -1) || !jsR_getstringproperty(J, -1, str)) {
+				obj = js_toobject(J, -1);
+				jsR_getcachedproperty(J, obj, str, &CT[k]);
+			}
 			js_rot2pop1(J);
 			break;
 
 		case OP_SETPROP:
-			str = js_tostring(J, -2);
-			obj = js_toobject(J, -3);
-			jsR_setproperty(J, obj, str);
+			if (jsR_isindex(J, -2, &k)) {
+				obj = js_toobject(J, -3);
+				jsR_setindex(J, obj, k);
+			} else {
+				str = js_tostring(J, -2);
+				obj = js_toobject(J, -3);
+				jsR_setproperty(J, obj, str);
+			}
 			js_rot3pop2(J);
 			break;
 
 		case OP_SETPROP_S:
 			str = ST[*pc++];
 			obj = js_toobject(J, -2);
-			jsR_setproperty(J, obj, str);
+			jsR_setcachedproperty(J, obj, str, &CT[*pc++]);
 			js_rot2pop1(J);
 			break;
 
 		case OP_DELPROP:
-			str = js_tostring(J, -1);
-			obj = js_toobject(J, -2);
-			b = jsR_delproperty(J, obj, str);
+			if (jsR_isindex(J, -1, &k)) {
+				obj = js_toobject(J, -2);
+				b = jsR_delindex(J, obj, k);
+			} else {
+				str = js_tostring(J, -1);
+				obj = js_toobject(J, -2);
+				b = jsR_delproperty(J, obj, str);
+			}
 			js_pop(J, 2);
 			js_pushboolean(J, b);
 			break;
@@ -1476,7 +2039,10 @@ static void jsR_run(js_State *J, js_Function *F)
 			obj = js_toobject(J, -1);
 			str = jsV_nextiterator(J, obj);
 			if (str) {
-				js_pushliteral(J, str);
+				if (str == obj->u.iter.buf)
+					js_pushstring(J, str);
+				else
+					js_pushliteral(J, str);
 				js_pushboolean(J, 1);
 			} else {
 				js_pop(J, 1);
@@ -2,11 +2,16 @@
 #define js_run_h
 
 js_Environment *jsR_newenvironment(js_State *J, js_Object *variables, js_Environment *outer);
+js_Environment *jsR_newrecord(js_State *J, js_Function *F, js_Environment *outer);
 
 struct js_Environment
 {
 	js_Environment *outer;
-	js_Object *variables;
+	js_Object *variables; /* NULL for environment records */
+
+	/* the slots of an environment record, named by the function's uptab */
+	js_Function *function;
+	js_Value *slots;
 
 	js_Environment *gcnext;
 	int gcmark;
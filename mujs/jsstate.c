@@ -62,6 +62,7 @@ static void js_loadstringx(js_State *J, const char *filename, const char *source
 {
 	js_Ast *P;
 	js_Function *F;
+	js_Environment *scope;
 
 	if (js_try(J)) {
 		jsP_freeparse(J);
@@ -71,7 +72,15 @@ static void js_loadstringx(js_State *J, const char *filename, const char *source
 	P = jsP_parse(J, filename, source);
 	F = jsC_compile(J, P);
 	jsP_freeparse(J);
-	js_newscript(J, F, iseval ? (J->strict ? J->E : NULL) : J->GE);
+
+	scope = J->GE;
+	if (iseval) {
+		scope = J->strict ? J->E : NULL;
+		/* environment records cannot hold the variables that the code declares */
+		if (!J->E->variables)
+			scope = jsR_newenvironment(J, jsV_newobject(J, JS_COBJECT, NULL), J->E);
+	}
+	js_newscript(J, F, scope);
 
 	js_endtry(J);
 }
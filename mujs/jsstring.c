@@ -11,6 +11,17 @@ static const char *checkstring(js_State *J, int idx)
 	return js_tostring(J, idx);
 }
 
+/* The string value at idx, so that its length and last looked up rune are cached across calls */
+static js_Value *checkstringvalue(js_State *J, int idx)
+{
+	checkstring(J, idx);
+	if (!js_isstring(J, idx)) {
+		js_pushstring(J, js_tostring(J, idx));
+		js_replace(J, idx);
+	}
+	return js_tovalue(J, idx);
+}
+
 int js_runeat(js_State *J, const char *s, int i)
 {
 	Rune rune = 0;
@@ -67,24 +78,27 @@ static void jsB_String(js_State *J)
 
 static void Sp_toString(js_State *J)
 {
-	js_Object *self = js_toobject(J, 0);
+	js_Object *self;
+	if (js_isstring(J, 0)) {
+		js_copy(J, 0);
+		return;
+	}
+	self = js_toobject(J, 0);
 	if (self->type != JS_CSTRING) js_typeerror(J, "not a string");
-	js_pushliteral(J, self->u.s.string);
+	js_pushstring(J, self->u.s.string);
 }
 
 static void Sp_valueOf(js_State *J)
 {
-	js_Object *self = js_toobject(J, 0);
-	if (self->type != JS_CSTRING) js_typeerror(J, "not a string");
-	js_pushliteral(J, self->u.s.string);
+	Sp_toString(J);
 }
 
 static void Sp_charAt(js_State *J)
 {
 	char buf[UTFmax + 1];
-	const char *s = checkstring(J, 0);
+	js_Value *self = checkstringvalue(J, 0);
 	int pos = js_tointeger(J, 1);
-	Rune rune = js_runeat(J, s, pos);
+	Rune rune = jsV_runeat(J, self, pos);
 	if (rune > 0) {
 		buf[runetochar(buf, &rune)] = 0;
 		js_pushstring(J, buf);
@@ -95,9 +109,9 @@ static void Sp_charAt(js_State *J)
 
 static void Sp_charCodeAt(js_State *J)
 {
-	const char *s = checkstring(J, 0);
+	js_Value *self = checkstringvalue(J, 0);
 	int pos = js_tointeger(J, 1);
-	Rune rune = js_runeat(J, s, pos);
+	Rune rune = jsV_runeat(J, self, pos);
 	if (rune > 0)
 		js_pushnumber(J, rune);
 	else
@@ -138,14 +152,15 @@ static void Sp_concat(js_State *J)
 
 static void Sp_indexOf(js_State *J)
 {
-	const char *haystack = checkstring(J, 0);
+	js_Value *self = checkstringvalue(J, 0);
 	const char *needle = js_tostring(J, 1);
 	int pos = js_tointeger(J, 2);
 	int len = strlen(needle);
-	int k = 0;
+	int k = pos < 0 ? 0 : pos;
+	const char *haystack = jsV_runeptr(J, self, k);
 	Rune rune;
-	while (*haystack) {
-		if (k >= pos && !strncmp(haystack, needle, len)) {
+	while (haystack && *haystack) {
+		if (!strncmp(haystack, needle, len)) {
 			js_pushnumber(J, k);
 			return;
 		}
@@ -181,9 +196,9 @@ static void Sp_localeCompare(js_State *J)
 
 static void Sp_slice(js_State *J)
 {
-	const char *str = checkstring(J, 0);
+	js_Value *self = checkstringvalue(J, 0);
 	const char *ss, *ee;
-	int len = utflen(str);
+	int len = jsV_stringlength(J, self);
 	int s = js_tointeger(J, 1);
 	int e = js_isdefined(J, 2) ? js_tointeger(J, 2) : len;
 
@@ -194,11 +209,11 @@ static void Sp_slice(js_State *J)
 	e = e < 0 ? 0 : e > len ? len : e;
 
 	if (s < e) {
-		ss = js_utfidxtoptr(str, s);
-		ee = js_utfidxtoptr(ss, e - s);
+		ss = jsV_runeptr(J, self, s);
+		ee = jsV_runeptr(J, self, e);
 	} else {
-		ss = js_utfidxtoptr(str, e);
-		ee = js_utfidxtoptr(ss, s - e);
+		ss = jsV_runeptr(J, self, e);
+		ee = jsV_runeptr(J, self, s);
 	}
 
 	js_pushlstring(J, ss, ee - ss);
@@ -206,9 +221,9 @@ static void Sp_slice(js_State *J)
 
 static void Sp_substring(js_State *J)
 {
-	const char *str = checkstring(J, 0);
+	js_Value *self = checkstringvalue(J, 0);
 	const char *ss, *ee;
-	int len = utflen(str);
+	int len = jsV_stringlength(J, self);
 	int s = js_tointeger(J, 1);
 	int e = js_isdefined(J, 2) ? js_tointeger(J, 2) : len;
 
@@ -216,11 +231,11 @@ static void Sp_substring(js_State *J)
 	e = e < 0 ? 0 : e > len ? len : e;
 
 	if (s < e) {
-		ss = js_utfidxtoptr(str, s);
-		ee = js_utfidxtoptr(ss, e - s);
+		ss = jsV_runeptr(J, self, s);
+		ee = jsV_runeptr(J, self, e);
 	} else {
-		ss = js_utfidxtoptr(str, e);
-		ee = js_utfidxtoptr(ss, s - e);
+		ss = jsV_runeptr(J, self, e);
+		ee = jsV_runeptr(J, self, s);
 	}
 
 	js_pushlstring(J, ss, ee - ss);
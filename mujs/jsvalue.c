@@ -5,7 +5,10 @@
 #include "utf.h"
 
 #define JSV_ISSTRING(v) (v->type==JS_TSHRSTR || v->type==JS_TMEMSTR || v->type==JS_TLITSTR)
-#define JSV_TOSTRING(v) (v->type==JS_TSHRSTR ? v->u.shrstr : v->type==JS_TLITSTR ? v->u.litstr : v->type==JS_TMEMSTR ? v->u.memstr->p : "")
+/* concatenations up to this many bytes are copied instead of deferred */
+#define JSV_FLATMAX 256
+
+#define JSV_TOSTRING(v) (v->type==JS_TSHRSTR ? v->u.shrstr : v->type==JS_TLITSTR ? v->u.litstr : v->type==JS_TMEMSTR ? jsV_flatstring(J, v->u.memstr) : "")
 
 int jsV_numbertointeger(double n)
 {
@@ -123,7 +126,7 @@ int jsV_toboolean(js_State *J, js_Value *v)
 	case JS_TBOOLEAN: return v->u.boolean;
 	case JS_TNUMBER: return v->u.number != 0 && !isnan(v->u.number);
 	case JS_TLITSTR: return v->u.litstr[0] != 0;
-	case JS_TMEMSTR: return v->u.memstr->p[0] != 0;
+	case JS_TMEMSTR: return v->u.memstr->size != 0;
 	case JS_TOBJECT: return 1;
 	}
 }
@@ -211,7 +214,7 @@ double jsV_tonumber(js_State *J, js_Value *v)
 	case JS_TBOOLEAN: return v->u.boolean;
 	case JS_TNUMBER: return v->u.number;
 	case JS_TLITSTR: return jsV_stringtonumber(J, v->u.litstr);
-	case JS_TMEMSTR: return jsV_stringtonumber(J, v->u.memstr->p);
+	case JS_TMEMSTR: return jsV_stringtonumber(J, jsV_flatstring(J, v->u.memstr));
 	case JS_TOBJECT:
 		jsV_toprimitive(J, v, JS_HNUMBER);
 		return jsV_tonumber(J, v);
@@ -295,7 +298,7 @@ const char *jsV_tostring(js_State *J, js_Value *v)
 	case JS_TNULL: return "null";
 	case JS_TBOOLEAN: return v->u.boolean ? "true" : "false";
 	case JS_TLITSTR: return v->u.litstr;
-	case JS_TMEMSTR: return v->u.memstr->p;
+	case JS_TMEMSTR: return jsV_flatstring(J, v->u.memstr);
 	case JS_TNUMBER:
 		p = jsV_numbertostring(J, buf, v->u.number);
 		if (p == buf) {
@@ -335,26 +338,155 @@ static js_Object *jsV_newnumber(js_State *J, double v)
 	return obj;
 }
 
-static js_Object *jsV_newstring(js_State *J, const char *v)
+/* String objects share the storage of the primitive value instead of interning a copy */
+static js_Object *jsV_newstring(js_State *J, js_Value *v)
 {
 	js_Object *obj = jsV_newobject(J, JS_CSTRING, J->String_prototype);
-	obj->u.s.string = js_intern(J, v); /* TODO: js_String */
-	obj->u.s.length = utflen(v);
+	switch (v->type) {
+	default:
+	case JS_TSHRSTR:
+		strcpy(obj->u.s.shrstr, v->u.shrstr);
+		obj->u.s.string = obj->u.s.shrstr;
+		break;
+	case JS_TLITSTR:
+		obj->u.s.string = v->u.litstr;
+		break;
+	case JS_TMEMSTR:
+		obj->u.s.memstr = v->u.memstr;
+		obj->u.s.string = jsV_flatstring(J, v->u.memstr);
+		break;
+	}
+	obj->u.s.length = jsV_stringlength(J, v);
 	return obj;
 }
 
+/* Measure a literal string, which is never freed, into the literal cache */
+static void jsV_cacheliteral(js_State *J, const char *s)
+{
+	const char *p = s;
+	Rune rune;
+	int n = 0;
+	js_free(J, J->litcache.runes.step);
+	J->litcache.runes.step = NULL;
+	J->litcache.runes.cursor = J->litcache.runes.offset = 0;
+	J->litcache.ascii = 1;
+	while (*p) {
+		if (*(unsigned char *)p < Runeself) {
+			++p;
+		} else {
+			p += chartorune(&rune, p);
+			J->litcache.ascii = 0;
+		}
+		++n;
+	}
+	J->litcache.s = s;
+	J->litcache.size = p - s;
+	J->litcache.length = n;
+}
+
+/* Length in runes of a string value, cached in its js_String or the literal cache */
+int jsV_stringlength(js_State *J, js_Value *v)
+{
+	switch (v->type) {
+	default:
+	case JS_TSHRSTR: return utflen(v->u.shrstr);
+	case JS_TLITSTR:
+		if (J->litcache.s != v->u.litstr)
+			jsV_cacheliteral(J, v->u.litstr);
+		return J->litcache.length;
+	case JS_TMEMSTR:
+		if (v->u.memstr->length < 0)
+			v->u.memstr->length = utflen(jsV_flatstring(J, v->u.memstr));
+		return v->u.memstr->length;
+	}
+}
+
+static void jsV_indexrunes(js_State *J, js_RuneIndex *x, const char *s, int length)
+{
+	const char *p = s;
+	int k, n = length / JS_RUNESTEP;
+	x->step = js_malloc(J, (n + 1) * sizeof *x->step);
+	for (k = 0; k <= n; ++k) {
+		x->step[k] = p - s;
+		if (k < n)
+			p = js_utfidxtoptr(p, JS_RUNESTEP);
+	}
+}
+
+/* Walk from the last rune looked up, or from the nearest step before i */
+static const char *jsV_seekrune(js_State *J, js_RuneIndex *x, const char *s, int length, int i)
+{
+	const char *p;
+	if (i > length)
+		return NULL;
+	if (i < x->cursor || i - x->cursor >= JS_RUNESTEP) {
+		if (i < JS_RUNESTEP) {
+			x->cursor = x->offset = 0;
+		} else {
+			if (!x->step)
+				jsV_indexrunes(J, x, s, length);
+			x->cursor = i - i % JS_RUNESTEP;
+			x->offset = x->step[i / JS_RUNESTEP];
+		}
+	}
+	p = js_utfidxtoptr(s + x->offset, i - x->cursor);
+	if (p) {
+		x->cursor = i;
+		x->offset = p - s;
+	}
+	return p;
+}
+
+/* Pointer to rune i of a string value, or NULL if it has fewer than i runes */
+const char *jsV_runeptr(js_State *J, js_Value *v, int i)
+{
+	js_String *str;
+	const char *s;
+
+	if (i < 0)
+		return NULL;
+
+	switch (v->type) {
+	default:
+		return js_utfidxtoptr(jsV_tostring(J, v), i);
+	case JS_TLITSTR:
+		if (J->litcache.s != v->u.litstr)
+			jsV_cacheliteral(J, v->u.litstr);
+		s = J->litcache.s;
+		if (J->litcache.ascii)
+			return i <= J->litcache.size ? s + i : NULL;
+		return jsV_seekrune(J, &J->litcache.runes, s, J->litcache.length, i);
+	case JS_TMEMSTR:
+		str = v->u.memstr;
+		s = jsV_flatstring(J, str);
+		if (str->ascii)
+			return i <= str->size ? s + i : NULL;
+		return jsV_seekrune(J, &str->runes, s, jsV_stringlength(J, v), i);
+	}
+}
+
+/* Rune i of a string value, or 0 if it is out of range */
+int jsV_runeat(js_State *J, js_Value *v, int i)
+{
+	const char *p = jsV_runeptr(J, v, i);
+	Rune rune = 0;
+	if (p && *p)
+		chartorune(&rune, p);
+	return rune;
+}
+
 /* ToObject() on a value */
 js_Object *jsV_toobject(js_State *J, js_Value *v)
 {
 	switch (v->type) {
 	default:
-	case JS_TSHRSTR: return jsV_newstring(J, v->u.shrstr);
+	case JS_TSHRSTR: return jsV_newstring(J, v);
 	case JS_TUNDEFINED: js_typeerror(J, "cannot convert undefined to object");
 	case JS_TNULL: js_typeerror(J, "cannot convert null to object");
 	case JS_TBOOLEAN: return jsV_newboolean(J, v->u.boolean);
 	case JS_TNUMBER: return jsV_newnumber(J, v->u.number);
-	case JS_TLITSTR: return jsV_newstring(J, v->u.litstr);
-	case JS_TMEMSTR: return jsV_newstring(J, v->u.memstr->p);
+	case JS_TLITSTR: return jsV_newstring(J, v);
+	case JS_TMEMSTR: return jsV_newstring(J, v);
 	case JS_TOBJECT: return v->u.object;
 	}
 }
@@ -388,7 +520,11 @@ void js_newnumber(js_State *J, double v)
 
 void js_newstring(js_State *J, const char *v)
 {
-	js_pushobject(J, jsV_newstring(J, v));
+	js_Object *obj;
+	js_pushstring(J, v);
+	obj = jsV_newstring(J, js_tovalue(J, -1));
+	js_pop(J, 1);
+	js_pushobject(J, obj);
 }
 
 void js_newfunction(js_State *J, js_Function *fun, js_Environment *scope)
@@ -480,6 +616,14 @@ void js_newuserdata(js_State *J, const char *tag, void *data, js_Finalize finali
 	js_newuserdatax(J, tag, data, NULL, NULL, NULL, finalize);
 }
 
+void js_setuserdataindex(js_State *J, int idx, js_Index index)
+{
+	js_Object *obj = js_toobject(J, idx);
+	if (obj->type != JS_CUSERDATA)
+		js_typeerror(J, "not a userdata");
+	obj->u.user.index = index;
+}
+
 /* Non-trivial operations on values. These are implemented using the stack. */
 
 int js_instanceof(js_State *J)
@@ -508,26 +652,71 @@ int js_instanceof(js_State *J)
 	return 0;
 }
 
+/* Characters and size of a concatenation operand, without flattening it if it is a concatenation itself */
+static const char *jsV_toconcatstring(js_State *J, js_Value *v, int *n)
+{
+	const char *s;
+	if (v->type == JS_TMEMSTR) {
+		*n = v->u.memstr->size;
+		return v->u.memstr->p;
+	}
+	s = jsV_tostring(J, v);
+	*n = v->type == JS_TMEMSTR ? v->u.memstr->size : (int)strlen(s);
+	return s;
+}
+
+static js_Value jsV_memstringvalue(js_String *v)
+{
+	js_Value value;
+	value.type = JS_TMEMSTR;
+	value.u.memstr = v;
+	return value;
+}
+
 void js_concat(js_State *J)
 {
 	js_toprimitive(J, -2, JS_HNONE);
 	js_toprimitive(J, -1, JS_HNONE);
 
 	if (js_isstring(J, -2) || js_isstring(J, -1)) {
-		const char *sa = js_tostring(J, -2);
-		const char *sb = js_tostring(J, -1);
-		/* TODO: create js_String directly */
-		char *sab = js_malloc(J, strlen(sa) + strlen(sb) + 1);
-		strcpy(sab, sa);
-		strcat(sab, sb);
-		if (js_try(J)) {
-			js_free(J, sab);
-			js_throw(J);
+		js_Value *va = js_tovalue(J, -2);
+		js_Value *vb = js_tovalue(J, -1);
+		js_String *a, *b, *ab;
+		const char *sa, *sb;
+		int na, nb;
+		sa = jsV_toconcatstring(J, va, &na);
+		sb = jsV_toconcatstring(J, vb, &nb);
+		if (na > JS_STRLIMIT - nb)
+			js_rangeerror(J, "invalid string length");
+		if (na + nb <= JSV_FLATMAX) {
+			char buf[JSV_FLATMAX];
+			memcpy(buf, sa, na);
+			memcpy(buf + na, sb, nb);
+			js_pop(J, 2);
+			js_pushlstring(J, buf, na + nb);
+			return;
+		}
+		a = va->type == JS_TMEMSTR ? va->u.memstr : NULL;
+		b = vb->type == JS_TMEMSTR ? vb->u.memstr : NULL;
+		if (a && !a->p && a->right->size + nb <= JSV_FLATMAX) {
+			/* appending to a concatenation with a short tail: copy the tail instead of deepening the tree */
+			char buf[JSV_FLATMAX];
+			memcpy(buf, a->right->p, a->right->size);
+			memcpy(buf + a->right->size, sb, nb);
+			ab = jsV_newropestring(J, a->left, jsV_newmemstring(J, buf, a->right->size + nb));
+		} else if (b && !b->p && na + b->left->size <= JSV_FLATMAX) {
+			/* likewise when prepending */
+			char buf[JSV_FLATMAX];
+			memcpy(buf, sa, na);
+			memcpy(buf + na, b->left->p, b->left->size);
+			ab = jsV_newropestring(J, jsV_newmemstring(J, buf, na + b->left->size), b->right);
+		} else {
+			if (!a) a = jsV_newmemstring(J, sa, na);
+			if (!b) b = jsV_newmemstring(J, sb, nb);
+			ab = jsV_newropestring(J, a, b);
 		}
 		js_pop(J, 2);
-		js_pushstring(J, sab);
-		js_endtry(J);
-		js_free(J, sab);
+		js_pushvalue(J, jsV_memstringvalue(ab));
 	} else {
 		double x = js_tonumber(J, -2);
 		double y = js_tonumber(J, -1);
@@ -61,11 +61,24 @@ struct js_Value
 	char type; /* type tag and zero terminator for shrstr */
 };
 
+/*
+	A memory string is either flat, with its characters in p, or a
+	concatenation of two other strings, which is flattened into a new buffer
+	the first time its characters are needed. This makes repeated
+	concatenation linear instead of quadratic.
+*/
+
 struct js_String
 {
 	js_String *gcnext;
+	js_String *left, *right; /* operands of a concatenation, until it is flattened */
+	char *p; /* the characters, or NULL until a concatenation is flattened */
+	int size; /* in bytes */
+	int length; /* in runes, or -1 until it is needed */
+	js_RuneIndex runes; /* built as runes are looked up by index, unless the string is ASCII */
+	char ascii; /* every character is ASCII, so runes and bytes coincide */
 	char gcmark;
-	char p[1];
+	char data[1]; /* storage for p when the string is created flat */
 };
 
 struct js_Regexp
@@ -80,8 +93,10 @@ struct js_Object
 {
 	enum js_Class type;
 	int extensible;
-	js_Property *properties;
+	js_Shape *shape; /* maps property names to slots, or NULL while there are none */
+	js_Property *properties; /* slots */
 	int count; /* number of properties, for array sparseness check */
+	int capacity;
 	js_Object *prototype;
 	union {
 		int boolean;
@@ -89,9 +104,15 @@ struct js_Object
 		struct {
 			const char *string;
 			int length;
+			js_String *memstr; /* the value refers to, or NULL for literals and shrstr */
+			char shrstr[16];
 		} s;
 		struct {
 			int length;
+			int simple; /* elements are stored densely in array, not as properties */
+			int flat_length;
+			int flat_capacity;
+			js_Value *array;
 		} a;
 		struct {
 			js_Function *function;
@@ -107,6 +128,8 @@ struct js_Object
 		struct {
 			js_Object *target;
 			js_Iterator *head;
+			int i, n; /* dense array elements still to visit */
+			char buf[12]; /* name of the current dense array element */
 		} iter;
 		struct {
 			const char *tag;
@@ -114,6 +137,7 @@ struct js_Object
 			js_HasProperty has;
 			js_Put put;
 			js_Delete delete;
+			js_Index index;
 			js_Finalize finalize;
 		} user;
 	} u;
@@ -124,14 +148,29 @@ struct js_Object
 struct js_Property
 {
 	const char *name;
-	js_Property *left, *right;
-	int level;
+	unsigned int hash;
 	int atts;
 	js_Value value;
 	js_Object *getter;
 	js_Object *setter;
 };
 
+struct js_Shape
+{
+	js_Shape *parent; /* the shape without the last property */
+	js_Shape *kids; /* shapes that add one property to this one */
+	js_Shape *sibling;
+	const char *name; /* the last property */
+	int count;
+	int dictionary; /* owned by one object and changed in place */
+	unsigned int serial; /* bumped whenever a dictionary is changed */
+	int *table; /* slots by name hash, or NULL for small shapes */
+	int tablesize;
+	int *order; /* slots sorted by name, built when first enumerated */
+	js_Shape *gcnext;
+	int gcmark;
+};
+
 struct js_Iterator
 {
 	const char *name;
@@ -140,6 +179,8 @@ struct js_Iterator
 
 /* jsrun.c */
 js_String *jsV_newmemstring(js_State *J, const char *s, int n);
+js_String *jsV_newropestring(js_State *J, js_String *a, js_String *b);
+const char *jsV_flatstring(js_State *J, js_String *v);
 js_Value *js_tovalue(js_State *J, int idx);
 void js_toprimitive(js_State *J, int idx, int hint);
 js_Object *js_toobject(js_State *J, int idx);
@@ -152,6 +193,9 @@ double jsV_tonumber(js_State *J, js_Value *v);
 double jsV_tointeger(js_State *J, js_Value *v);
 const char *jsV_tostring(js_State *J, js_Value *v);
 js_Object *jsV_toobject(js_State *J, js_Value *v);
+int jsV_stringlength(js_State *J, js_Value *v);
+const char *jsV_runeptr(js_State *J, js_Value *v, int i);
+int jsV_runeat(js_State *J, js_Value *v, int i);
 void jsV_toprimitive(js_State *J, js_Value *v, int preferred);
 
 const char *js_itoa(char buf[32], int a);
@@ -172,11 +216,28 @@ js_Property *jsV_getproperty(js_State *J, js_Object *obj, const char *name);
 js_Property *jsV_setproperty(js_State *J, js_Object *obj, const char *name);
 js_Property *jsV_nextproperty(js_State *J, js_Object *obj, const char *name);
 void jsV_delproperty(js_State *J, js_Object *obj, const char *name);
+const int *jsV_propertyorder(js_State *J, js_Object *obj);
+void jsV_freeshape(js_State *J, js_Shape *sh);
 
 js_Object *jsV_newiterator(js_State *J, js_Object *obj, int own);
 const char *jsV_nextiterator(js_State *J, js_Object *iter);
 
 void jsV_resizearray(js_State *J, js_Object *obj, int newlen);
+void jsV_growarray(js_State *J, js_Object *obj, int n);
+void jsV_unflattenarray(js_State *J, js_Object *obj);
+js_Value *jsV_getflatindex(js_State *J, js_Object *obj, const char *name);
+
+/* jsgc.c */
+void jsG_shadevalue(js_State *J, js_Value *v);
+void jsG_shadeobject(js_State *J, js_Object *obj);
+void jsG_shadeshape(js_State *J, js_Shape *sh);
+
+/* Store barriers: call after storing into an object or environment record that may have been scanned */
+#define jsG_barrier(J, v) ((J)->gcstate == JS_GCMARK ? jsG_shadevalue(J, v) : (void)0)
+#define jsG_barrierobject(J, obj) ((J)->gcstate == JS_GCMARK ? jsG_shadeobject(J, obj) : (void)0)
+
+/* Shapes the transition tree holds on to are not marked, so they are revived when an object takes one */
+#define jsG_barriershape(J, sh) ((J)->gcstate != JS_GCPAUSE ? jsG_shadeshape(J, sh) : (void)0)
 
 /* jsdump.c */
 void js_dumpobject(js_State *J, js_Object *obj);
@@ -39,6 +39,7 @@ typedef void (*js_Finalize)(js_State *J, void *p);
 typedef int (*js_HasProperty)(js_State *J, void *p, const char *name);
 typedef int (*js_Put)(js_State *J, void *p, const char *name);
 typedef int (*js_Delete)(js_State *J, void *p, const char *name);
+typedef int (*js_Index)(js_State *J, void *p, int op, int idx);
 typedef void (*js_Report)(js_State *J, const char *message);
 
 /* Basic functions */
@@ -49,6 +50,8 @@ void js_setreport(js_State *J, js_Report report);
 js_Panic js_atpanic(js_State *J, js_Panic panic);
 void js_freestate(js_State *J);
 void js_gc(js_State *J, int report);
+int js_gcstep(js_State *J, int work);
+void js_cachestats(js_State *J, unsigned long *hits, unsigned long *misses);
 
 int js_dostring(js_State *J, const char *source);
 int js_dofile(js_State *J, const char *filename);
@@ -78,6 +81,13 @@ enum {
 	JS_REGEXP_M = 4,
 };
 
+/* Userdata indexed access operations */
+enum {
+	JS_INDEX_HAS,
+	JS_INDEX_PUT,
+	JS_INDEX_DELETE,
+};
+
 /* Property attribute flags */
 enum {
 	JS_READONLY = 1,
@@ -156,6 +166,7 @@ void js_newcfunction(js_State *J, js_CFunction fun, const char *name, int length
 void js_newcconstructor(js_State *J, js_CFunction fun, js_CFunction con, const char *name, int length);
 void js_newuserdata(js_State *J, const char *tag, void *data, js_Finalize finalize);
 void js_newuserdatax(js_State *J, const char *tag, void *data, js_HasProperty has, js_Put put, js_Delete del, js_Finalize finalize);
+void js_setuserdataindex(js_State *J, int idx, js_Index index);
 void js_newregexp(js_State *J, const char *pattern, int flags);
 
 void js_pushiterator(js_State *J, int idx, int own);
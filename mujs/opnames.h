@@ -24,6 +24,8 @@
 "getlocal",
 "setlocal",
 "dellocal",
+"getupvar",
+"setupvar",
 "initvar",
 "defvar",
 "hasvar",